@@ -0,0 +1,79 @@
+/* -*- c++ -*- */
+/*
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+
+#ifndef INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_H
+#define INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_H
+
+#include <op25_repeater/api.h>
+#include <gnuradio/block.h>
+
+namespace gr {
+  namespace op25_repeater {
+
+    /*!
+     * \brief CQPSK demodulator: Gardner timing recovery, differential
+     * decode, Costas loop and phase to symbol conversion in one block.
+     * \ingroup op25_repeater
+     *
+     * Takes the channel filtered complex baseband and produces one float
+     * per symbol at the -3/-1/+1/+3 levels fsk4_slicer_fb expects. This is
+     * the same processing as gardner_cc -> diff_phasor_cc ->
+     * costas_loop_cc(order 4) -> complex_to_arg -> multiply_const_ff(4/pi).
+     *
+     * The phase is taken with fast_atan2f. From GNU Radio 3.10 on,
+     * complex_to_arg uses volk atan2 instead, so there the output is
+     * close to that chain's but not bit-identical.
+     */
+    class OP25_REPEATER_API cqpsk_demod_cf : virtual public gr::block
+    {
+     public:
+     	#if GNURADIO_VERSION < 0x030900
+         typedef boost::shared_ptr<cqpsk_demod_cf> sptr;
+	    #else
+        typedef std::shared_ptr<cqpsk_demod_cf> sptr;
+	    #endif
+
+
+      /*!
+       * \brief Return a shared_ptr to a new instance of op25_repeater::cqpsk_demod_cf.
+       *
+       * \param samples_per_symbol  nominal Gardner omega
+       * \param gain_mu             Gardner timing loop gain
+       * \param gain_omega          Gardner rate loop gain
+       * \param costas_alpha        Costas loop bandwidth
+       * \param lock_threshold      Gardner lock detector threshold
+       */
+      static sptr make(float samples_per_symbol,
+                       float gain_mu,
+                       float gain_omega,
+                       float costas_alpha,
+                       float lock_threshold = 0.28);
+      virtual void set_omega(float omega) {}
+      virtual void set_phase(float phase) {}
+      virtual void set_frequency(float freq) {}
+      virtual void reset() {}
+      virtual bool locked() { return false; }
+      virtual float quality() { return 0; }
+    };
+
+  } // namespace op25_repeater
+} // namespace gr
+
+#endif /* INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_H */
+
@@ -61,6 +61,8 @@ namespace gr {
                 virtual void crypt_key(uint16_t keyid, uint8_t algid, const std::vector<uint8_t> &key) {}
                 typedef void (*voice_codec_cb_t)(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
                 virtual void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data) {}
+                // bytes of decoder state held by this block, for the recorder memory report
+                virtual size_t memory_usage(void) { return 0; }
         };
 
     } // namespace op25_repeater
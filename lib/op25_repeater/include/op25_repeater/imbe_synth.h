@@ -0,0 +1,55 @@
+/* -*- c++ -*- */
+/* 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_OP25_REPEATER_IMBE_SYNTH_H
+#define INCLUDED_OP25_REPEATER_IMBE_SYNTH_H
+
+#include <op25_repeater/api.h>
+#include <stdint.h>
+#include <memory>
+
+namespace gr {
+  namespace op25_repeater {
+
+    /*!
+     * \brief Vocodes P25 Phase 1 IMBE frames outside the flowgraph
+     * \ingroup op25_repeater
+     *
+     * Plays back the frames a p25_frame_assembler tagged with
+     * set_defer_vocoding() through the same vocoder it would have run.
+     * Holds the vocoder state, which carries over from one transmission to
+     * the next just as it does in the frame assembler, so use one per call.
+     */
+    class OP25_REPEATER_API imbe_synth
+    {
+     public:
+      typedef std::shared_ptr<imbe_synth> sptr;
+
+      static const int SAMPLES_PER_FRAME = 160;
+
+      static sptr make(bool soft_vocoder);
+      virtual ~imbe_synth() {}
+
+      // u[0..7], E0 and ET as imbe_header_decode() returns them
+      virtual void decode(int16_t samples[SAMPLES_PER_FRAME], const uint32_t u[8], uint32_t E0, uint32_t ET) = 0;
+    };
+
+  } // namespace op25_repeater
+} // namespace gr
+
+#endif /* INCLUDED_OP25_REPEATER_IMBE_SYNTH_H */
@@ -66,6 +66,11 @@ namespace gr {
       virtual  void clear_silence_frame_count() {};
       typedef void (*voice_codec_cb_t)(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
       virtual void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data) {};
+      // Phase 1 voice comes out as silence, each frame tagged "imbe" with its
+      // u[0..7], E0 and ET for imbe_synth to vocode later
+      virtual void set_defer_vocoding(bool defer) {};
+      // bytes of decoder state held by this block, for the recorder memory report
+      virtual size_t memory_usage(void) { return 0; };
     };
 
   } // namespace op25_repeater
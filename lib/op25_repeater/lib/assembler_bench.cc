@@ -0,0 +1,235 @@
+/*
+ * Stand-alone check and benchmark for where p25_frame_assembler ends a
+ * transmission.
+ *
+ * A Phase 1 voice stream is made with p25p1_voice_encode: transmissions of
+ * one to ten LDUs, each closed by a TDU and followed by a short gap, so that
+ * one call can decode two TDUs. The stream is run through the assembler
+ * with audio output on, once with the block free to produce as much as it
+ * likes and then held to one or two LDUs of audio per call. Held to 864
+ * samples, the TDU is decoded while more audio than one call can take is
+ * still queued ahead of it, so the terminate tag has to wait for that audio
+ * to go out. Each transmission must end on its terminate tag with exactly
+ * its own LDUs' audio. Then the flowgraph is timed and the rate is reported
+ * in symbols per second.
+ *
+ * usage: assembler_bench [seconds per benchmark]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <gnuradio/io_signature.h>
+#include <gnuradio/sync_block.h>
+#include <gnuradio/top_block.h>
+#if GNURADIO_VERSION < 0x030800
+#include <gnuradio/blocks/vector_source_b.h>
+#else
+#include <gnuradio/blocks/vector_source.h>
+#endif
+#include <op25_repeater/p25_frame_assembler.h>
+
+#include "p25_frame.h"
+#include "p25p1_voice_encode.h"
+#include "op25_audio.h"
+
+using namespace gr::op25_repeater;
+
+static const int TRANSMISSIONS = 12;
+static const int MAX_LDUS = 10;
+static const int LDU_SAMPLES = 9 * 160;	// nine IMBE frames of 20 ms
+static const int GAP = 200;		// idle dibits after each TDU
+static const int TAIL = 8192;		// idle dibits at the end, flush the queued audio
+static const uint64_t TDU_NID = 0x29333977728ced6eULL;	// NAC 0x293, DUID 3
+static const size_t TDU_BITS = 144;
+static const char NO_AUDIO[] = "nowhere";	// neither udp:// nor file://
+
+static std::mt19937 rng(44);
+
+static int failures = 0;
+
+static void fail(const char *what, int max_items)
+{
+	if (failures++ < 10)
+		printf("mismatch: %s, %d items per call\n", what, max_items);
+}
+
+// noutput_items limits to run with, 0 for none
+static const int CASES[] = { 0, 864, 1728 };
+
+/*
+ * Keeps the samples and the positions of the terminate tags, the way
+ * transmission_sink would see them.
+ */
+class tdu_sink : public gr::sync_block
+{
+public:
+#if GNURADIO_VERSION < 0x030900
+	typedef boost::shared_ptr<tdu_sink> sptr;
+#else
+	typedef std::shared_ptr<tdu_sink> sptr;
+#endif
+
+	static sptr make() { return gnuradio::get_initial_sptr(new tdu_sink()); }
+
+	std::vector<int16_t> samples;
+	std::vector<uint64_t> terminates;
+
+	int work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items)
+	{
+		static const pmt::pmt_t terminate_key(pmt::intern("terminate"));
+		std::vector<gr::tag_t> tags;
+		get_tags_in_range(tags, 0, nitems_read(0), nitems_read(0) + noutput_items, terminate_key);
+		for (size_t i = 0; i < tags.size(); i++)
+			terminates.push_back(tags[i].offset);
+
+		const int16_t *in = (const int16_t *) input_items[0];
+		samples.insert(samples.end(), in, in + noutput_items);
+		return noutput_items;
+	}
+
+private:
+	tdu_sink() : gr::sync_block("tdu_sink",
+	                            gr::io_signature::make(1, 1, sizeof(int16_t)),
+	                            gr::io_signature::make(0, 0, 0)) {}
+};
+
+struct stream {
+	std::vector<uint8_t> dibits;
+	std::vector<int> ldus;		// per transmission
+};
+
+// Dibits of a TDU: frame sync and NID, the rest of the frame zero
+static void append_tdu(std::vector<uint8_t>& s)
+{
+	bit_vector tdu(TDU_BITS);
+	p25_setup_frame_header(tdu, TDU_NID);
+	for (size_t i = 0; i < TDU_BITS; i += 2)
+		s.push_back(tdu.extract(i, i + 2));
+}
+
+/*
+ * TRANSMISSIONS transmissions of 1 to MAX_LDUS LDUs, made from a tone with
+ * a little noise so that the vocoder sees voice.
+ */
+static stream make_stream()
+{
+	op25_audio audio(NO_AUDIO, 0);
+	stream s;
+	for (int t = 0; t < TRANSMISSIONS; t++) {
+		const int nldu = 1 + rng() % MAX_LDUS;
+		std::deque<uint8_t> dibits;
+		p25p1_voice_encode encoder(false, 0, audio, false, dibits);
+		std::vector<int16_t> pcm(nldu * LDU_SAMPLES);
+		const double f = 2 * M_PI * (300 + rng() % 1500) / 8000.0;
+		for (size_t i = 0; i < pcm.size(); i++)
+			pcm[i] = 8000 * sin(f * i) + (int)(rng() % 512) - 256;
+		encoder.compress_samp(&pcm[0], pcm.size());
+
+		s.dibits.insert(s.dibits.end(), dibits.begin(), dibits.end());
+		s.ldus.push_back(nldu);
+		append_tdu(s.dibits);
+		s.dibits.insert(s.dibits.end(), GAP, 0);
+	}
+	s.dibits.insert(s.dibits.end(), TAIL, 0);
+	return s;
+}
+
+// Runs the dibits through the assembler, at most max_items per call if given
+static tdu_sink::sptr assemble(const std::vector<uint8_t>& dibits, int max_items)
+{
+	gr::top_block_sptr tb = gr::make_top_block("assembler_bench");
+	gr::blocks::vector_source_b::sptr src = gr::blocks::vector_source_b::make(dibits);
+	p25_frame_assembler::sptr assembler = p25_frame_assembler::make(0, false, "127.0.0.1", 0, 0, true, true, false, gr::msg_queue::make(2), true, false, true);
+	tdu_sink::sptr sink = tdu_sink::make();
+	if (max_items)
+		assembler->set_max_noutput_items(max_items);
+	tb->connect(src, 0, assembler, 0);
+	tb->connect(assembler, 0, sink, 0);
+	tb->run();
+	return sink;
+}
+
+static void check(const stream& s, int max_items)
+{
+	const tdu_sink::sptr sink = assemble(s.dibits, max_items);
+
+	printf("%4d items per call: %zu samples, %zu terminate tags\n",
+	       max_items, sink->samples.size(), sink->terminates.size());
+	if (sink->terminates.size() != s.ldus.size()) {
+		fail("terminate tag count", max_items);
+		return;
+	}
+	// each transmission runs from past the last tag to its own tag
+	uint64_t start = 0;
+	for (size_t t = 0; t < s.ldus.size(); t++) {
+		const uint64_t end = sink->terminates[t] + 1;
+		uint64_t len = end - start;
+		// a TDU decoded after all its audio went out comes on one zero
+		// sample of its own, which transmission_sink drops
+		if (len == (uint64_t)s.ldus[t] * LDU_SAMPLES + 1 && sink->samples[end - 1] == 0)
+			len--;
+		if (len != (uint64_t)s.ldus[t] * LDU_SAMPLES) {
+			printf("transmission %zu: %llu samples, expected %d\n", t,
+			       (unsigned long long)len, s.ldus[t] * LDU_SAMPLES);
+			fail("transmission length", max_items);
+		}
+		start = end;
+	}
+	if (start != sink->samples.size())
+		fail("samples after the last TDU", max_items);
+}
+
+static void report(const char *name, double rate)
+{
+	printf("%-36s %12.0f symbols/s\n", name, rate);
+}
+
+// Runs the flowgraph over the stream until secs have passed, returns symbols/s
+static double bench(double secs, const stream& s, int max_items)
+{
+	typedef std::chrono::steady_clock clock;
+	long count = 0;
+	volatile size_t sink = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		sink += assemble(s.dibits, max_items)->samples.size();
+		count += s.dibits.size();
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 1.0;
+
+	// the assembler logs every call at trace
+	boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::info);
+
+	const stream s = make_stream();
+	for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++)
+		check(s, CASES[i]);
+	if (failures) {
+		printf("%d mismatches against the encoded stream\n", failures);
+		return 1;
+	}
+	printf("p25_frame_assembler ends every transmission at its TDU\n");
+
+	report("p25_frame_assembler", bench(secs, s, 0));
+	report("p25_frame_assembler, 864 per call", bench(secs, s, 864));
+	return 0;
+}
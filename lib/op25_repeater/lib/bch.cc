@@ -25,7 +25,19 @@ static const int bchG[48] = {
 	1, 1, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 0, 0, 1, 1
 };
 
-int bchDec(bit_vector& Codeword)
+// Codeword.extract(0, 63) puts Codeword[j] at bit (62 - j), which makes it the
+// reciprocal of the codeword polynomial. It is a codeword exactly when it
+// divides by the reciprocal of bchG, 0xd4dcbbd0c9b3. The remainder is linear,
+// so the 16 bits above it are reduced with one lookup per nibble:
+// bchRem[i][n] = (n << (47 + 4 * i)) mod 0xd4dcbbd0c9b3
+static const uint64_t bchRem[4][16] = {
+	{0x000000000000ULL, 0x54dcbbd0c9b3ULL, 0x7d65cc715ad5ULL, 0x29b977a19366ULL, 0x2e1723327c19ULL, 0x7acb98e2b5aaULL, 0x5372ef4326ccULL, 0x07ae5493ef7fULL, 0x5c2e4664f832ULL, 0x08f2fdb43181ULL, 0x214b8a15a2e7ULL, 0x759731c56b54ULL, 0x72396556842bULL, 0x26e5de864d98ULL, 0x0f5ca927defeULL, 0x5b8012f7174dULL},
+	{0x000000000000ULL, 0x6c80371939d7ULL, 0x0ddcd5e2ba1dULL, 0x615ce2fb83caULL, 0x1bb9abc5743aULL, 0x77399cdc4dedULL, 0x16657e27ce27ULL, 0x7ae5493ef7f0ULL, 0x3773578ae874ULL, 0x5bf36093d1a3ULL, 0x3aaf82685269ULL, 0x562fb5716bbeULL, 0x2ccafc4f9c4eULL, 0x404acb56a599ULL, 0x211629ad2653ULL, 0x4d961eb41f84ULL},
+	{0x000000000000ULL, 0x6ee6af15d0e8ULL, 0x0911e5fb6863ULL, 0x67f74aeeb88bULL, 0x1223cbf6d0c6ULL, 0x7cc564e3002eULL, 0x1b322e0db8a5ULL, 0x75d48118684dULL, 0x244797eda18cULL, 0x4aa138f87164ULL, 0x2d567216c9efULL, 0x43b0dd031907ULL, 0x36645c1b714aULL, 0x5882f30ea1a2ULL, 0x3f75b9e01929ULL, 0x519316f5c9c1ULL},
+	{0x000000000000ULL, 0x488f2fdb4318ULL, 0x45c2e4664f83ULL, 0x0d4dcbbd0c9bULL, 0x5f59731c56b5ULL, 0x17d65cc715adULL, 0x1a9b977a1936ULL, 0x5214b8a15a2eULL, 0x6a6e5de864d9ULL, 0x22e1723327c1ULL, 0x2facb98e2b5aULL, 0x672396556842ULL, 0x35372ef4326cULL, 0x7db8012f7174ULL, 0x70f5ca927defULL, 0x387ae5493ef7ULL}
+};
+
+int bchDec(bch_codeword& Codeword)
 {
 
    int elp[24][ 22], S[23];
@@ -36,11 +48,28 @@ int bchDec(bit_vector& Codeword)
 
    SynError = 0; CantDecode = 0;
 
+   // bit (62 - j) of cw is Codeword[j], only the set bits add to the syndromes
+   const uint64_t cw = Codeword.extract(0, 63);
+
+   // nearly every NID arrives intact, skip the syndromes when cw is a codeword
+   uint64_t rem = cw & 0x7fffffffffffULL;
+   for(i = 0; i < 4; i++) {
+      rem ^= bchRem[i][(cw >> (47 + 4 * i)) & 0xf];
+   }
+   if( rem == 0) { return 0; }
+
    for(i = 1; i <= 22; i++) {
+      if( (i & 1) == 0) {
+         // binary code, so S(2k) = S(k)^2: double the log
+         S[i] = (S[i / 2] == -1) ? -1 : (2 * S[i / 2]) % 63;
+         if( S[i] != -1) { SynError = 1; }
+         continue;
+      }
       S[i] = 0;
       // FOR j = 0 TO 62
-      for(j = 0; j <= 62; j++) {
-         if( Codeword[j]) { S[i] = S[i] ^ bchGFexp[(i * j) % 63]; }
+      for(uint64_t bits = cw; bits; bits &= bits - 1) {
+         j = 62 - __builtin_ctzll(bits);
+         S[i] = S[i] ^ bchGFexp[(i * j) % 63];
       }
       if( S[i]) { SynError = 1; }
       S[i] = bchGFlog[S[i]];
@@ -1,4 +1,3 @@
-#include <vector>
-typedef std::vector<bool> bit_vector;
-int bchDec(bit_vector& Codeword);
-
+#include "bit_array.h"
+typedef bit_array<64> bch_codeword;
+int bchDec(bch_codeword& Codeword);
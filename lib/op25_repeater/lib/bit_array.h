@@ -0,0 +1,204 @@
+//
+// This file is part of OP25
+//
+// OP25 is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// OP25 is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OP25; see the file COPYING. If not, write to the Free
+// Software Foundation, Inc., 51 Franklin Street, Boston, MA
+// 02110-1301, USA.
+
+#ifndef INCLUDED_OP25_REPEATER_BIT_ARRAY_H
+#define INCLUDED_OP25_REPEATER_BIT_ARRAY_H
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Fixed capacity bit container, a drop in for the std::vector<bool> the
+ * framers used to build frames in.
+ *
+ * Bits are packed MSB first into 64 bit words held inline, so a frame never
+ * touches the heap, and bit i is bit (63 - i % 64) of word i / 64. That is
+ * the order the air interface sends them in, which lets extract() and
+ * insert() move up to 64 bits with a couple of shifts instead of a loop.
+ *
+ * Bits at and above size() are always zero. Every access must stay below
+ * N. Growing past it is a bug: push_back() and append() assert, and in a
+ * release build report it on stderr once and drop what does not fit.
+ */
+template <size_t N>
+class bit_array {
+public:
+	static const size_t WORDS = (N + 63) / 64;
+
+	class reference {
+	public:
+		reference(uint64_t& word, uint64_t mask) : d_word(word), d_mask(mask) {}
+		operator bool() const { return (d_word & d_mask) != 0; }
+		reference& operator=(bool b) {
+			d_word = (d_word & ~d_mask) | (-(uint64_t)b & d_mask);
+			return *this;
+		}
+		reference& operator=(const reference& r) { return *this = (bool) r; }
+	private:
+		uint64_t& d_word;
+		const uint64_t d_mask;
+	};
+
+	bit_array() : d_size(0) { memset(d_words, 0, sizeof(d_words)); }
+	explicit bit_array(size_t n) : d_size(n < N ? n : N) { memset(d_words, 0, sizeof(d_words)); }
+
+	size_t size() const { return d_size; }
+	static size_t capacity() { return N; }
+	const uint64_t* words() const { return d_words; }
+
+	void clear() {
+		memset(d_words, 0, ((d_size + 63) / 64) * sizeof(uint64_t));
+		d_size = 0;
+	}
+
+	void resize(size_t n) {
+		if (n > N)
+			n = N;
+		if (n < d_size)
+			zero(n, d_size);
+		d_size = n;
+	}
+
+	void push_back(bool b) {
+		if (d_size >= N) {
+			overflow(1);
+			return;
+		}
+		d_words[d_size / 64] |= (uint64_t)b << (63 - d_size % 64);
+		d_size++;
+	}
+
+	/* Appends the low n bits of value, MSB first, like n push_back() calls */
+	void append(uint64_t value, size_t n) {
+		if (d_size + n > N) {
+			const size_t excess = d_size + n - N;
+			overflow(excess);
+			value = excess < 64 ? value >> excess : 0;
+			n = N - d_size;
+		}
+		insert(d_size, d_size + n, value);
+		d_size += n;
+	}
+
+	bool test(size_t i) const { return (d_words[i / 64] >> (63 - i % 64)) & 1; }
+	void set(size_t i, bool b) { reference(d_words[i / 64], mask(i)) = b; }
+
+	bool operator[](size_t i) const { return test(i); }
+	reference operator[](size_t i) { return reference(d_words[i / 64], mask(i)); }
+
+	/*
+	 * Value of bits [begin, end), at most 64 of them, with bit begin as the
+	 * MSB. Same result as the extract() in op25_yank.h.
+	 */
+	uint64_t extract(size_t begin, size_t end) const {
+		const size_t n = end - begin;
+		if (n == 0)
+			return 0;
+		const size_t w = begin / 64, off = begin % 64;
+		uint64_t x = d_words[w] << off;
+		if (off + n > 64)
+			x |= d_words[w + 1] >> (64 - off);
+		return x >> (64 - n);
+	}
+
+	/*
+	 * Stores the low (end - begin) bits of value in [begin, end), the
+	 * inverse of extract().
+	 */
+	void insert(size_t begin, size_t end, uint64_t value) {
+		const size_t n = end - begin;
+		if (n == 0)
+			return;
+		const size_t w = begin / 64, off = begin % 64;
+		if (n < 64)
+			value &= ((uint64_t)1 << n) - 1;
+		if (off + n <= 64) {
+			const size_t shift = 64 - off - n;
+			const uint64_t m = (n < 64 ? ((uint64_t)1 << n) - 1 : ~(uint64_t)0) << shift;
+			d_words[w] = (d_words[w] & ~m) | (value << shift);
+		} else {
+			const size_t tail = off + n - 64;	// bits that spill into the next word
+			d_words[w] = (d_words[w] & ~((~(uint64_t)0) >> off)) | (value >> tail);
+			const uint64_t m = ~(uint64_t)0 << (64 - tail);
+			d_words[w + 1] = (d_words[w + 1] & ~m) | (value << (64 - tail));
+		}
+	}
+
+	/*
+	 * Deinterleave: bit i of this array becomes bit pos[i] of src, for i in
+	 * [0, n). Bits are collected a word at a time rather than through
+	 * reference.
+	 */
+	template <size_t M, class T>
+	void gather(const bit_array<M>& src, const T pos[], size_t n) {
+		size_t i = 0;
+		for (size_t w = 0; i < n; w++) {
+			const size_t len = (n - i) < 64 ? (n - i) : 64;
+			uint64_t acc = 0;
+			for (size_t j = 0; j < len; j++, i++)
+				acc = (acc << 1) | src.test(pos[i]);
+			d_words[w] = acc << (64 - len);
+		}
+		if (n < d_size)
+			zero(n, d_size);
+		d_size = n;
+	}
+
+	/*
+	 * Interleave: the inverse of gather(), bit pos[i] of dst becomes bit i
+	 * of this array.
+	 */
+	template <size_t M, class T>
+	void scatter(bit_array<M>& dst, const T pos[], size_t n) const {
+		for (size_t i = 0; i < n; i++)
+			dst.set(pos[i], test(i));
+	}
+
+private:
+	uint64_t d_words[WORDS];
+	size_t d_size;
+
+	static uint64_t mask(size_t i) { return (uint64_t)1 << (63 - i % 64); }
+
+	static void overflow(size_t dropped) {
+		assert(!"bit_array capacity exceeded");
+		static bool reported = false;
+		if (!reported) {
+			reported = true;
+			fprintf(stderr, "bit_array<%zu>: capacity exceeded, %zu bits dropped\n", N, dropped);
+		}
+	}
+
+	void zero(size_t begin, size_t end) {
+		while (begin < end) {
+			const size_t n = (end - begin) < (64 - begin % 64) ? (end - begin) : (64 - begin % 64);
+			insert(begin, begin + n, 0);
+			begin += n;
+		}
+	}
+};
+
+/* Sized for the longest frame the framers assemble, a P25 Phase 1 LDU */
+typedef bit_array<1728> bit_vector;
+typedef const bit_vector const_bit_vector;
+typedef bit_array<144> voice_codeword;
+
+#endif /* INCLUDED_OP25_REPEATER_BIT_ARRAY_H */
@@ -0,0 +1,246 @@
+/*
+ * Stand-alone check and benchmark for bit_array, the container the framers
+ * build frames in.
+ *
+ * First bit_array is compared against std::vector<bool> over random
+ * push_back, append, extract, insert, resize and gather calls. Then a P25
+ * Phase 1 LDU is put through the framer's steps: 864 dibits are loaded,
+ * the frame header is set and the nine voice codewords are deinterleaved
+ * and header decoded. The rate is reported in LDUs per second, next to the
+ * same load and deinterleave done on std::vector<bool>.
+ *
+ * usage: bit_bench [seconds per benchmark]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "bit_array.h"
+#include "op25_imbe_frame.h"
+#include "op25_p25_frame.h"
+
+static const int SET_SIZE = 64;
+static const size_t LDU_DIBITS = P25_VOICE_FRAME_SIZE / 2;
+
+static std::mt19937 rng(41);
+
+static int failures = 0;
+
+static void fail(const char *what, int iteration)
+{
+	if (failures++ < 10)
+		printf("mismatch: %s, iteration %d\n", what, iteration);
+}
+
+static bool same(const bit_vector& a, const std::vector<bool>& b)
+{
+	if (a.size() != b.size())
+		return false;
+	for (size_t i = 0; i < b.size(); i++)
+		if (a[i] != b[i])
+			return false;
+	// bits past size() must stay zero
+	for (size_t i = a.size(); i < bit_vector::capacity(); i++)
+		if (a.test(i))
+			return false;
+	return true;
+}
+
+static void check_ops(int iterations)
+{
+	for (int it = 0; it < iterations; it++) {
+		bit_vector a;
+		std::vector<bool> b;
+
+		for (int op = 0; op < 64; op++) {
+			switch (rng() % 5) {
+			case 0: {	// push_back
+				size_t n = rng() % 40;
+				for (size_t i = 0; i < n && b.size() < bit_vector::capacity(); i++) {
+					bool v = rng() & 1;
+					a.push_back(v);
+					b.push_back(v);
+				}
+				break;
+			}
+			case 1: {	// append
+				size_t n = 1 + rng() % 64;
+				if (b.size() + n > bit_vector::capacity())
+					break;
+				uint64_t v = ((uint64_t)rng() << 32) | rng();
+				a.append(v, n);
+				for (size_t i = 0; i < n; i++)
+					b.push_back((v >> (n - 1 - i)) & 1);
+				break;
+			}
+			case 2: {	// insert
+				if (b.empty())
+					break;
+				size_t begin = rng() % b.size();
+				size_t n = 1 + rng() % 64;
+				if (begin + n > b.size())
+					n = b.size() - begin;
+				uint64_t v = ((uint64_t)rng() << 32) | rng();
+				a.insert(begin, begin + n, v);
+				for (size_t i = 0; i < n; i++)
+					b[begin + i] = (v >> (n - 1 - i)) & 1;
+				break;
+			}
+			case 3: {	// resize
+				size_t n = rng() % (bit_vector::capacity() + 1);
+				a.resize(n);
+				b.resize(n);
+				break;
+			}
+			case 4: {	// extract
+				if (b.empty())
+					break;
+				size_t begin = rng() % b.size();
+				size_t n = 1 + rng() % 64;
+				if (begin + n > b.size())
+					n = b.size() - begin;
+				uint64_t expect = 0;
+				for (size_t i = 0; i < n; i++)
+					expect = (expect << 1) | b[begin + i];
+				if (a.extract(begin, begin + n) != expect)
+					fail("extract", it);
+				break;
+			}
+			}
+			if (!same(a, b)) {
+				fail("contents", it);
+				break;
+			}
+		}
+	}
+}
+
+static void check_gather(int iterations)
+{
+	for (int it = 0; it < iterations; it++) {
+		bit_vector frame(P25_VOICE_FRAME_SIZE);
+		std::vector<bool> ref(P25_VOICE_FRAME_SIZE);
+		for (size_t i = 0; i < P25_VOICE_FRAME_SIZE; i++) {
+			bool v = rng() & 1;
+			frame[i] = v;
+			ref[i] = v;
+		}
+		for (size_t n = 0; n < nof_voice_codewords; n++) {
+			voice_codeword cw;
+			imbe_deinterleave(frame, cw, n);
+			for (size_t i = 0; i < voice_codeword_sz; i++)
+				if (cw[i] != ref[voice_codeword_bits[n][i]]) {
+					fail("gather", it);
+					break;
+				}
+
+			bit_vector back(P25_VOICE_FRAME_SIZE);
+			imbe_interleave(back, cw, n);
+			for (size_t i = 0; i < voice_codeword_sz; i++)
+				if (back[voice_codeword_bits[n][i]] != ref[voice_codeword_bits[n][i]]) {
+					fail("scatter", it);
+					break;
+				}
+		}
+	}
+}
+
+// Runs fn(i) over the test set until secs have passed, returns LDUs/s
+template <typename F>
+static double run(double secs, F fn)
+{
+	typedef std::chrono::steady_clock clock;
+	long count = 0;
+	volatile long sink = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		for (int i = 0; i < SET_SIZE; i++)
+			sink += fn(i);
+		count += SET_SIZE;
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+static void report(const char *name, double rate)
+{
+	printf("%-36s %12.0f LDU/s\n", name, rate);
+}
+
+static void bench_ldu(double secs)
+{
+	std::vector<std::vector<uint8_t> > dibits(SET_SIZE, std::vector<uint8_t>(LDU_DIBITS));
+	for (int i = 0; i < SET_SIZE; i++)
+		for (size_t j = 0; j < LDU_DIBITS; j++)
+			dibits[i][j] = rng() & 3;
+
+	bit_vector frame;
+	report("bit_array load + deinterleave", run(secs, [&](int i) {
+		frame.resize(P25_VOICE_FRAME_SIZE);
+		for (size_t j = 0; j < LDU_DIBITS; j++)
+			frame.insert(j * 2, j * 2 + 2, dibits[i][j]);
+		long sum = 0;
+		for (size_t n = 0; n < nof_voice_codewords; n++) {
+			voice_codeword cw;
+			imbe_deinterleave(frame, cw, n);
+			sum += cw.extract(0, 64);
+		}
+		return sum;
+	}));
+
+	std::vector<bool> vframe;
+	report("vector<bool> load + deinterleave", run(secs, [&](int i) {
+		vframe.clear();
+		for (size_t j = 0; j < LDU_DIBITS; j++) {
+			vframe.push_back(dibits[i][j] >> 1);
+			vframe.push_back(dibits[i][j] & 1);
+		}
+		long sum = 0;
+		for (size_t n = 0; n < nof_voice_codewords; n++) {
+			std::vector<bool> cw(voice_codeword_sz);
+			for (size_t k = 0; k < voice_codeword_sz; k++)
+				cw[k] = vframe[voice_codeword_bits[n][k]];
+			for (size_t k = 0; k < 64; k++)
+				sum = (sum << 1) | cw[k];
+		}
+		return sum;
+	}));
+
+	report("bit_array LDU + header decode", run(secs, [&](int i) {
+		frame.resize(P25_VOICE_FRAME_SIZE);
+		for (size_t j = 0; j < LDU_DIBITS; j++)
+			frame.insert(j * 2, j * 2 + 2, dibits[i][j]);
+		p25_setup_frame_header(frame, 0x2935 + i);
+		long errs = 0;
+		for (size_t n = 0; n < nof_voice_codewords; n++) {
+			voice_codeword cw;
+			uint32_t u[8], E0, ET;
+			imbe_deinterleave(frame, cw, n);
+			errs += imbe_header_decode(cw, u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], E0, ET);
+		}
+		return errs;
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 1.0;
+
+	check_ops(20000);
+	check_gather(2000);
+	if (failures) {
+		printf("%d mismatches against std::vector<bool>\n", failures);
+		return 1;
+	}
+	printf("bit_array matches std::vector<bool>\n");
+
+	bench_ldu(secs);
+	return 0;
+}
@@ -0,0 +1,244 @@
+/*
+ * Stand-alone check and benchmark for cqpsk_demod_cf against the chain of
+ * blocks it replaces: gardner_cc -> diff_phasor_cc -> costas_loop_cc(order
+ * 4) -> complex_to_arg -> multiply_const_ff(4/pi).
+ *
+ * Synthetic pi/4 DQPSK is made at the Phase 1 and Phase 2 rates: random
+ * symbols with a boxcar pulse, a symbol clock a little off the nominal
+ * rate, a carrier offset and uniform noise. Each signal is run through both
+ * flowgraphs. Before GNU Radio 3.10 the outputs must be the same bit for
+ * bit; from 3.10 complex_to_arg uses volk atan2 where the block uses
+ * fast_atan2f, so there they must agree to within ATAN_TOLERANCE. Past the
+ * first LOCK_SYMBOLS, nearly all symbols must also be close to one of the
+ * -3/-1/+1/+3 levels, so that a demodulator that lost lock cannot pass.
+ * Then both flowgraphs are timed and the rate is reported in samples per
+ * second.
+ *
+ * usage: cqpsk_bench [seconds per benchmark]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <complex>
+#include <random>
+#include <algorithm>
+#include <vector>
+
+#include <gnuradio/top_block.h>
+#include <gnuradio/blocks/complex_to_arg.h>
+#include <gnuradio/digital/diff_phasor_cc.h>
+#if GNURADIO_VERSION < 0x030800
+#include <gnuradio/blocks/multiply_const_ff.h>
+#include <gnuradio/blocks/vector_source_c.h>
+#include <gnuradio/blocks/vector_sink_f.h>
+#else
+#include <gnuradio/blocks/multiply_const.h>
+#include <gnuradio/blocks/vector_source.h>
+#include <gnuradio/blocks/vector_sink.h>
+#endif
+#include <op25_repeater/costas_loop_cc.h>
+#include <op25_repeater/cqpsk_demod_cf.h>
+#include <op25_repeater/gardner_cc.h>
+
+// the loop settings of p25_recorder_qpsk_demod and p25_trunking
+static const float GAIN_MU = 0.025;
+static const float GAIN_OMEGA = 0.1 * GAIN_MU * GAIN_MU;
+static const float COSTAS_ALPHA = 0.008;
+
+static const int CHECK_SYMBOLS = 50000;
+static const int BENCH_SYMBOLS = 500000;
+static const int TAIL = 256;		// zeros after the signal, flushes the blocks
+static const int LOCK_SYMBOLS = 1000;
+static const double MIN_ON_LEVEL = 0.99;
+static const float ATAN_TOLERANCE = 1e-3;	// in symbol levels, 4/pi per radian
+
+static std::mt19937 rng(50);
+
+static int failures = 0;
+
+static void fail(const char *what, int sps)
+{
+	if (failures++ < 10)
+		printf("mismatch: %s, %d samples per symbol\n", what, sps);
+}
+
+struct test_case {
+	int sps;
+	double skew;		// symbol clock error, in samples per sample
+	double offset;		// carrier offset, in radians per sample
+};
+
+static const test_case CASES[] = {
+	{ 5,  0.0,   0.0   },
+	{ 5,  1e-4,  0.002 },
+	{ 4, -1e-4, -0.003 },
+	{ 4,  0.0,   0.01  },
+	{ 5,  3e-4,  0.0   },
+};
+
+// Uniform in [-1, 1)
+static float uniform()
+{
+	return (float)(rng() >> 8) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+/*
+ * nsym pi/4 DQPSK symbols at sps samples each, shaped by a boxcar one
+ * symbol long and resampled by linear interpolation at 1 + skew samples
+ * per sample.
+ */
+static std::vector<gr_complex> make_signal(int nsym, int sps, double skew, double offset)
+{
+	std::vector<gr_complex> up;
+	int phase = 0;		// in multiples of pi/4
+	for (int s = 0; s < nsym; s++) {
+		phase += 2 * (rng() % 4) + 1;
+		up.insert(up.end(), sps, std::polar(1.0f, (float)(M_PI / 4 * (phase & 7))));
+	}
+
+	std::vector<gr_complex> shaped(up.size());
+	gr_complex acc = 0;
+	for (size_t i = 0; i < up.size(); i++) {
+		acc += up[i];
+		if (i >= (size_t)sps)
+			acc -= up[i - sps];
+		shaped[i] = acc / (float)sps;
+	}
+
+	std::vector<gr_complex> x;
+	double t = 0.0;
+	for (size_t n = 0; t + 1 < shaped.size(); n++, t += 1.0 + skew) {
+		const size_t i = (size_t)t;
+		const float f = t - i;
+		const gr_complex v = shaped[i] * (1.0f - f) + shaped[i + 1] * f;
+		x.push_back(v * std::polar(1.0f, (float)fmod(offset * n, 2 * M_PI)) +
+		            gr_complex(0.05f * uniform(), 0.05f * uniform()));
+	}
+	x.insert(x.end(), TAIL, gr_complex(0, 0));
+	return x;
+}
+
+static std::vector<float> run(gr::top_block_sptr tb, gr::basic_block_sptr first, gr::basic_block_sptr last,
+                              const std::vector<gr_complex>& x)
+{
+	gr::blocks::vector_source_c::sptr src = gr::blocks::vector_source_c::make(x);
+	gr::blocks::vector_sink_f::sptr sink = gr::blocks::vector_sink_f::make();
+	tb->connect(src, 0, first, 0);
+	tb->connect(last, 0, sink, 0);
+	tb->run();
+	return sink->data();
+}
+
+// Symbols out of the chain of blocks
+static std::vector<float> demod_chain(const std::vector<gr_complex>& x, int sps)
+{
+	gr::top_block_sptr tb = gr::make_top_block("cqpsk_bench");
+	gr::op25_repeater::gardner_cc::sptr clock = gr::op25_repeater::gardner_cc::make(sps, GAIN_MU, GAIN_OMEGA);
+	gr::digital::diff_phasor_cc::sptr diffdec = gr::digital::diff_phasor_cc::make();
+	gr::op25_repeater::costas_loop_cc::sptr costas = gr::op25_repeater::costas_loop_cc::make(COSTAS_ALPHA, 4, (2 * M_PI) / 4);
+	gr::blocks::complex_to_arg::sptr to_float = gr::blocks::complex_to_arg::make();
+	gr::blocks::multiply_const_ff::sptr rescale = gr::blocks::multiply_const_ff::make(1 / (M_PI / 4));
+	tb->connect(clock, 0, diffdec, 0);
+	tb->connect(diffdec, 0, costas, 0);
+	tb->connect(costas, 0, to_float, 0);
+	tb->connect(to_float, 0, rescale, 0);
+	return run(tb, clock, rescale, x);
+}
+
+// Symbols out of cqpsk_demod_cf
+static std::vector<float> demod_fused(const std::vector<gr_complex>& x, int sps)
+{
+	gr::top_block_sptr tb = gr::make_top_block("cqpsk_bench");
+	gr::op25_repeater::cqpsk_demod_cf::sptr demod = gr::op25_repeater::cqpsk_demod_cf::make(sps, GAIN_MU, GAIN_OMEGA, COSTAS_ALPHA);
+	return run(tb, demod, demod, x);
+}
+
+// Distance between two phases in symbol levels, which wrap at +/-4
+static float level_distance(float a, float b)
+{
+	float d = fabsf(a - b);
+	return (d > 4) ? 8 - d : d;
+}
+
+static void check(const test_case& c)
+{
+	const std::vector<gr_complex> x = make_signal(CHECK_SYMBOLS, c.sps, c.skew, c.offset);
+	const std::vector<float> a = demod_chain(x, c.sps);
+	const std::vector<float> b = demod_fused(x, c.sps);
+
+	// the scheduler may leave a different few samples of the tail unread
+	const size_t n = std::min(a.size(), b.size());
+	float max_diff = 0;
+	for (size_t i = 0; i < n; i++)
+		max_diff = std::max(max_diff, level_distance(a[i], b[i]));
+
+	size_t on_level = 0;
+	for (size_t i = LOCK_SYMBOLS; i < n; i++)
+		if (level_distance(b[i], 2 * floorf(b[i] / 2) + 1) < 0.5f)
+			on_level++;
+	const double on_level_rate = (n > LOCK_SYMBOLS) ? (double)on_level / (n - LOCK_SYMBOLS) : 0.0;
+
+	printf("%d sps, skew %+.0e, offset %+.3f: %zu symbols, %.4f on a level, largest difference %g\n",
+	       c.sps, c.skew, c.offset, n, on_level_rate, max_diff);
+	if (n < CHECK_SYMBOLS - 64)
+		fail("too few symbols", c.sps);
+#if GNURADIO_VERSION < 0x030a00
+	if (memcmp(&a[0], &b[0], sizeof(float) * n) != 0)
+		fail("output differs from the chain", c.sps);
+#else
+	if (max_diff > ATAN_TOLERANCE)
+		fail("output differs from the chain", c.sps);
+#endif
+	if (on_level_rate < MIN_ON_LEVEL)
+		fail("not locked", c.sps);
+}
+
+static void report(const char *name, double rate)
+{
+	printf("%-36s %12.0f samples/s\n", name, rate);
+}
+
+// Runs demod() over x until secs have passed, returns samples/s
+template <typename F>
+static double bench(double secs, const std::vector<gr_complex>& x, F demod)
+{
+	typedef std::chrono::steady_clock clock;
+	long count = 0;
+	volatile size_t sink = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		sink += demod(x).size();
+		count += x.size();
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 1.0;
+
+	for (size_t i = 0; i < sizeof(CASES) / sizeof(CASES[0]); i++)
+		check(CASES[i]);
+	if (failures) {
+		printf("%d mismatches against the chain of blocks\n", failures);
+		return 1;
+	}
+	printf("cqpsk_demod_cf matches the chain of blocks\n");
+
+	const std::vector<gr_complex> x = make_signal(BENCH_SYMBOLS, 5, 1e-4, 0.002);
+	report("gardner_cc ... multiply_const_ff", bench(secs, x, [](const std::vector<gr_complex>& x) {
+		return demod_chain(x, 5);
+	}));
+	report("cqpsk_demod_cf", bench(secs, x, [](const std::vector<gr_complex>& x) {
+		return demod_fused(x, 5);
+	}));
+	return 0;
+}
@@ -0,0 +1,252 @@
+/* -*- c++ -*- */
+/*
+ * Fused CQPSK demodulator, built from the OP25 gardner_cc (KA1RBI) and
+ * costas_loop_cc (GNU Radio) blocks.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <gnuradio/io_signature.h>
+#include "cqpsk_demod_cf_impl.h"
+
+#include <gnuradio/math.h>
+#include <gnuradio/expj.h>
+#include <gnuradio/filter/mmse_fir_interpolator_cc.h>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdio>
+
+static const int   NUM_COMPLEX=100;
+
+// radians to the -3/-1/+1/+3 symbol levels
+static const float SYMBOL_SCALE = 1 / (M_PI / 4);
+
+namespace gr {
+    namespace op25_repeater {
+
+cqpsk_demod_cf::sptr
+cqpsk_demod_cf::make(float samples_per_symbol, float gain_mu, float gain_omega, float costas_alpha, float lock_threshold) {
+      return gnuradio::get_initial_sptr
+        (new cqpsk_demod_cf_impl(samples_per_symbol, gain_mu, gain_omega, costas_alpha, lock_threshold));
+}
+
+/*
+ * The private constructor
+ */
+cqpsk_demod_cf_impl::cqpsk_demod_cf_impl(float samples_per_symbol, float gain_mu, float gain_omega, float costas_alpha, float lock_threshold)
+                                : gr::block("cqpsk_demod_cf",
+                                            gr::io_signature::make(1, 1, sizeof(gr_complex)),
+                                            gr::io_signature::make(1, 1, sizeof(float))),
+    d_mu(0),
+    d_gain_omega(gain_omega),
+    d_omega_rel(0.002),
+    d_gain_mu(gain_mu),
+    d_lock_threshold(lock_threshold),
+    d_lock_accum(480),                      // detect timing lock based on last 480 symbols
+    d_last_sample(0), d_interp(new gr::filter::mmse_fir_interpolator_cc()),
+    d_dl(new gr_complex[NUM_COMPLEX]),
+    d_dl_index(0),
+    d_prev(0),
+    d_phase(0), d_freq(0),
+    d_max_phase(M_PI / 2)                   // 2pi / order, as the recorders configured costas_loop_cc
+{
+        if (costas_alpha < 0)
+            throw std::out_of_range("cqpsk_demod_cf: invalid costas loop bandwidth. Must be >= 0.");
+
+        // costas_loop_cc::update_gains() for a critically damped loop
+        const float damping = sqrtf(2.0f) / 2.0f;
+        float denom = (1.0 + 2.0 * damping * costas_alpha + costas_alpha * costas_alpha);
+        d_alpha = (4 * damping * costas_alpha) / denom;
+        d_beta = (4 * costas_alpha * costas_alpha) / denom;
+
+        set_omega(samples_per_symbol);
+        set_relative_rate (1.0 / d_omega);
+        set_history(d_twice_sps);			// ensure extra input is available
+}
+
+/*
+ * Our virtual destructor.
+ */
+cqpsk_demod_cf_impl::~cqpsk_demod_cf_impl()
+{
+    delete [] d_dl;
+    delete d_interp;
+}
+
+void
+cqpsk_demod_cf_impl::reset()
+{
+    gr::thread::scoped_lock lock(d_mutex);
+    d_last_sample = 0;
+    d_lock_accum.reset();
+    d_phase = 0;
+    d_freq = 0;
+}
+
+void
+cqpsk_demod_cf_impl::set_omega (float omega)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+    assert (omega >= 2.0);
+    d_omega = omega;
+    d_min_omega = omega*(1.0 - d_omega_rel);
+    d_max_omega = omega*(1.0 + d_omega_rel);
+    d_omega_mid = 0.5*(d_min_omega+d_max_omega);
+    d_twice_sps = 2 * (int) ceilf(d_omega);
+    d_dl_index = d_dl_index % d_twice_sps;	// work() wraps at d_twice_sps exactly
+    int num_complex = std::max(d_twice_sps*2, 16);
+    if (num_complex > NUM_COMPLEX)
+        fprintf(stderr, "cqpsk_demod_cf: warning omega %f size %d exceeds NUM_COMPLEX %d\n", omega, num_complex, NUM_COMPLEX);
+    *d_dl = gr_complex(0,0);
+}
+
+void
+cqpsk_demod_cf_impl::set_phase (float phase)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+    d_phase = phase;
+    if (d_phase > d_max_phase)
+        d_phase = d_max_phase;
+    else if (d_phase < -d_max_phase)
+        d_phase = -d_max_phase;
+}
+
+void
+cqpsk_demod_cf_impl::set_frequency (float freq)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+    d_freq = freq;
+    if (d_freq > 1.0f)
+        d_freq = 1.0f;
+    else if (d_freq < -1.0f)
+        d_freq = -1.0f;
+}
+
+void
+cqpsk_demod_cf_impl::forecast(int noutput_items, gr_vector_int &ninput_items_required)
+{
+    unsigned ninputs = ninput_items_required.size();
+    for (unsigned i=0; i < ninputs; i++)
+        ninput_items_required[i] =
+    (int) ceil((noutput_items * d_omega) + d_interp->ntaps());
+}
+
+/*
+ * Everything after timing recovery, for one symbol: differential decode
+ * against the previous symbol, derotate and advance the order 4 Costas
+ * loop, then scale the phase to a symbol level.
+ */
+inline float
+cqpsk_demod_cf_impl::symbol(gr_complex interp_samp)
+{
+    const gr_complex diff = interp_samp * conj(d_prev);
+    d_prev = interp_samp;
+
+    const gr_complex sample = diff * gr_expj(-d_phase);
+
+    float error = ((sample.real() > 0 ? 1.0 : -1.0) * sample.imag() -
+                   (sample.imag() > 0 ? 1.0 : -1.0) * sample.real());
+    error = gr::branchless_clip(error, 1.0);
+
+    d_freq = d_freq + d_beta * error;
+    d_phase = d_phase + d_freq + d_alpha * error;
+    if (d_phase > d_max_phase)
+        d_phase = d_max_phase;
+    else if (d_phase < -d_max_phase)
+        d_phase = -d_max_phase;
+    if (d_freq > 1.0f)
+        d_freq = 1.0f;
+    else if (d_freq < -1.0f)
+        d_freq = -1.0f;
+
+    return gr::fast_atan2f(sample.imag(), sample.real()) * SYMBOL_SCALE;
+}
+
+int
+cqpsk_demod_cf_impl::general_work (int noutput_items,
+                                      gr_vector_int &ninput_items,
+                                      gr_vector_const_void_star &input_items,
+                                      gr_vector_void_star &output_items)
+{
+    gr::thread::scoped_lock lock(d_mutex);
+    const gr_complex *in = (const gr_complex *) input_items[0];
+    float *out = (float *) output_items[0];
+
+    int i=0, o=0;
+
+    while((o < noutput_items) && (i < ninput_items[0])) {
+        while((d_mu > 1.0) && (i < ninput_items[0]))  {
+            d_mu --;
+            const gr_complex sample = (in[i]==in[i]) ? in[i] : gr_complex(0, 0);   // Check for NaN values and set to 0
+            d_dl[d_dl_index] = sample;
+            d_dl[d_dl_index + d_twice_sps] = sample;
+            if (++d_dl_index == d_twice_sps)
+                d_dl_index = 0;
+            i++;
+        }
+
+        if (i < ninput_items[0]) {
+            float half_omega = d_omega / 2.0;
+            int half_sps = (int) floorf(half_omega);
+            float half_mu = d_mu + half_omega - (float) half_sps;
+            if (half_mu > 1.0) {
+                half_mu -= 1.0;
+                half_sps += 1;
+            }
+            // at this point half_sps represents the whole part, and
+            // half_mu the fractional part, of the halfway mark.
+            // locate two points, separated by half of one symbol time
+            // interp_samp is (we hope) at the optimum sampling point
+            gr_complex interp_samp_mid = d_interp->interpolate(&d_dl[ d_dl_index ], d_mu);
+            gr_complex interp_samp = d_interp->interpolate(&d_dl[ d_dl_index + half_sps], half_mu);
+
+            float error_real = (d_last_sample.real() - interp_samp.real()) * interp_samp_mid.real();
+            float error_imag = (d_last_sample.imag() - interp_samp.imag()) * interp_samp_mid.imag();
+            d_last_sample = interp_samp;	// save for next time
+            float symbol_error = error_real + error_imag; // Gardner loop error
+            if (std::isnan(symbol_error)) symbol_error = 0.0;
+            if (symbol_error < -1.0) symbol_error = -1.0;
+            if (symbol_error >  1.0) symbol_error =  1.0;
+
+            // Lock detector, based on research paper presented by Yair Linn
+            // IEEE Transactions on Wireless Communications Vol 5, No 2, Feb 2006
+            float ie2 = interp_samp.real() * interp_samp.real();
+            float io2 = interp_samp_mid.real() * interp_samp_mid.real();
+            float qe2 = interp_samp.imag() * interp_samp.imag();
+            float qo2 = interp_samp_mid.imag() * interp_samp_mid.imag();
+            float yi = ((ie2+io2) != 0) ? (ie2-io2)/(ie2+io2) : 0;
+            float yq = ((qe2+qo2) != 0) ? (qe2-qo2)/(qe2+qo2) : 0;
+            d_lock_accum.add(yi + yq);
+
+            d_omega = d_omega + (d_gain_omega * symbol_error * abs(interp_samp));           // update omega based on loop error
+            d_omega = d_omega_mid + gr::branchless_clip(d_omega-d_omega_mid, d_omega_rel);  // make sure we don't walk away
+
+            d_mu += d_omega + d_gain_mu * symbol_error;                                     // update mu based on loop error
+
+            out[o++] = symbol(interp_samp);
+        }
+    }
+
+    consume_each(i);
+    return o;
+}
+
+    } /* namespace op25_repeater */
+} /* namespace gr */
@@ -0,0 +1,86 @@
+/* -*- c++ -*- */
+/*
+ * Fused CQPSK demodulator, built from the OP25 gardner_cc (KA1RBI) and
+ * costas_loop_cc (GNU Radio) blocks.
+ *
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ *
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_IMPL_H
+#define INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_IMPL_H
+
+#include <op25_repeater/cqpsk_demod_cf.h>
+
+#include <gnuradio/gr_complex.h>
+#include <gnuradio/filter/mmse_fir_interpolator_cc.h>
+#include <boost/thread/mutex.hpp>
+
+#include "gardner_cc_impl.h"	// id_avg
+
+namespace gr {
+    namespace op25_repeater {
+
+class cqpsk_demod_cf_impl : public cqpsk_demod_cf
+{
+    public:
+        cqpsk_demod_cf_impl(float samples_per_symbol, float gain_mu, float gain_omega, float costas_alpha, float lock_threshold);
+        ~cqpsk_demod_cf_impl();
+
+        void forecast (int noutput_items, gr_vector_int &ninput_items_required);
+
+        int general_work(int noutput_items,
+                         gr_vector_int &ninput_items,
+                         gr_vector_const_void_star &input_items,
+                         gr_vector_void_star &output_items);
+
+        void set_omega (float omega);
+        void set_phase (float phase);
+        void set_frequency (float freq);
+        void reset();
+        bool locked() { return (d_lock_accum.avg() >= d_lock_threshold ? true : false); }
+        float quality() { return d_lock_accum.avg(); }
+
+    private:
+        float symbol(gr_complex interp_samp);
+
+        // gardner_cc
+        float d_mu;
+        float d_omega, d_gain_omega, d_omega_rel, d_max_omega, d_min_omega, d_omega_mid;
+        float d_gain_mu;
+        float d_lock_threshold;
+        id_avg d_lock_accum;
+        boost::mutex d_mutex;
+
+        gr_complex d_last_sample;
+        gr::filter::mmse_fir_interpolator_cc *d_interp;
+
+        gr_complex *d_dl;
+        int         d_dl_index;
+        int         d_twice_sps;
+
+        // diff_phasor_cc
+        gr_complex  d_prev;
+
+        // costas_loop_cc, order 4
+        float d_phase, d_freq;
+        float d_max_phase;
+        float d_alpha, d_beta;
+};
+
+    } // namespace op25_repeater
+} // namespace gr
+
+#endif /* INCLUDED_OP25_REPEATER_CQPSK_DEMOD_CF_IMPL_H */
@@ -176,21 +176,28 @@ dmr_cai::extract_cach_fragment() {
 			break;
 		case 1: // Begin Short_LC
 			d_cach_sig.clear();
-			for (size_t i=0; i<sizeof(cach_payload_bits); i++)
-				d_cach_sig.push_back(d_frame[CACH + cach_payload_bits[i]]);
+			append_cach_payload();
 			break;
 		case 2: // End Short_LC or CSBK
-			for (size_t i=0; i<sizeof(cach_payload_bits); i++)
-				d_cach_sig.push_back(d_frame[CACH + cach_payload_bits[i]]);
+			append_cach_payload();
 			decode_shortLC();
 			break;
 		case 3: // Continue Short_LC or CSBK
-			for (size_t i=0; i<sizeof(cach_payload_bits); i++)
-				d_cach_sig.push_back(d_frame[CACH + cach_payload_bits[i]]);
+			append_cach_payload();
 			break;
 	}
 }
 
+void
+dmr_cai::append_cach_payload() {
+	// Continue/End without a Begin (a missed burst, or a CSBK) pile up
+	// past the four fragments of a Short_LC; only the first four are decoded
+	if (d_cach_sig.size() + sizeof(cach_payload_bits) > d_cach_sig.capacity())
+		return;
+	for (size_t i=0; i<sizeof(cach_payload_bits); i++)
+		d_cach_sig.push_back(d_frame[CACH + cach_payload_bits[i]]);
+}
+
 bool
 dmr_cai::decode_shortLC()
 {
@@ -25,11 +25,10 @@
 #include <vector>
 #include <gnuradio/msg_queue.h>
 
+#include "bit_array.h"
 #include "dmr_slot.h"
 #include "log_ts.h"
 
-typedef std::vector<bool> bit_vector;
-
 static const unsigned int slot_ids[] = {0, 1, 0, 0, 1, 1, 0, 1};
 
 class dmr_cai {
@@ -51,7 +50,7 @@ private:
 
 	uint8_t d_frame[FRAME_SIZE];       // array of bits comprising the current frame
 	dmr_slot d_slot[2];
-	bit_vector d_cach_sig;
+	bit_array<68> d_cach_sig;	// four bursts of CACH payload
 	int d_slot_mask;
 	int d_chan;
 	int d_shift_reg;
@@ -61,6 +60,7 @@ private:
 	log_ts& logts;
 
 	void extract_cach_fragment();
+	void append_cach_payload();
 	bool decode_shortLC();
 	void send_msg(const std::string& m_buf, const int m_type);
 };
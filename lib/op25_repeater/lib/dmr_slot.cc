@@ -690,7 +690,7 @@ dmr_slot::decode_pinf(uint8_t* pinf) {
 
 bool
 dmr_slot::decode_emb() {
-	bit_vector emb_sig;
+	qr1676_codeword emb_sig;
 
 	// deinterleave
 	for (unsigned int i = SYNC_EMB; i < (SYNC_EMB + 8); i++)
@@ -28,11 +28,11 @@
 #include "frame_sync_magics.h"
 #include "dmr_const.h"
 #include "bptc19696.h"
+#include "golay2087.h"
 #include "trellis.h"
 #include "ezpwd/rs"
 #include "log_ts.h"
 
-typedef std::vector<bool> bit_vector;
 typedef std::vector<uint8_t> byte_vector;
 
 enum data_state { DATA_INVALID = 0, DATA_VALID, DATA_INCOMPLETE };
@@ -79,7 +79,7 @@ public:
 
 private:
 	uint8_t     d_slot[SLOT_SIZE];	// array of bits comprising the current slot
-	bit_vector  d_slot_type;
+	golay2087_codeword d_slot_type;
 	byte_vector d_emb;		// last received Embedded data
 	byte_vector d_mbc;		// last received MBC data
 	byte_vector d_dhdr;		// last received Data Header data
@@ -144,8 +144,8 @@ private:
 	inline uint8_t  get_rc()         { return d_rc_valid ? d_rc : 0; };
 	inline uint8_t  get_sb()         { return d_sb_valid ? d_sb : 0; };
 
-	inline uint8_t  get_slot_cc()    { return d_slot_type.size() ? ((d_slot_type[0] << 3) + (d_slot_type[1] << 2) + (d_slot_type[2] << 1) + d_slot_type[3]) : 0xf; };
-	inline uint8_t  get_data_type()  { return d_slot_type.size() ? ((d_slot_type[4] << 3) + (d_slot_type[5] << 2) + (d_slot_type[6] << 1) + d_slot_type[7]) : 0x9; };
+	inline uint8_t  get_slot_cc()    { return d_slot_type.size() ? d_slot_type.extract(0, 4) : 0xf; };
+	inline uint8_t  get_data_type()  { return d_slot_type.size() ? d_slot_type.extract(4, 8) : 0x9; };
 
 	inline uint8_t  get_dhdr_dpf()   { return d_dhdr_valid ? (d_dhdr[0] & 0xf) : 0; };
 	inline uint8_t  get_dhdr_sap()   { return d_dhdr_valid ? (d_dhdr[1] >> 4) & 0xf : 0; };
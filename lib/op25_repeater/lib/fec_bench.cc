@@ -0,0 +1,234 @@
+/*
+ * Stand-alone benchmark for the FEC decoders used by the P25 and DMR
+ * framers. Each decoder is fed a fixed set of valid codewords with a given
+ * number of bit errors and the decode rate is reported in codewords per
+ * second.
+ *
+ * usage: fec_bench [seconds per decoder]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "op25_golay.h"
+#include "op25_hamming.h"
+#include "golay2087.h"
+#include "hamming.h"
+#include "bch.h"
+#include "trellis.h"
+
+static const int SET_SIZE = 4096;
+
+static std::mt19937 rng(25);
+
+static uint32_t flip_bits(uint32_t cw, int nbits, int errs)
+{
+	for (int i = 0; i < errs; i++)
+		cw ^= 1U << (rng() % nbits);
+	return cw;
+}
+
+// Runs fn(i) over the test set until secs have passed, returns codewords/s
+template <typename F>
+static double run(double secs, F fn)
+{
+	typedef std::chrono::steady_clock clock;
+	long count = 0;
+	volatile long sink = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		for (int i = 0; i < SET_SIZE; i++)
+			sink += fn(i);
+		count += SET_SIZE;
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+static void report(const char *name, int errs, double rate)
+{
+	printf("%-24s %d err  %12.0f cw/s\n", name, errs, rate);
+}
+
+static void bench_golay_23(double secs, int errs)
+{
+	std::vector<uint32_t> cw(SET_SIZE);
+	for (int i = 0; i < SET_SIZE; i++)
+		cw[i] = flip_bits(golay_23_encode(rng() & 0xfff), 23, errs);
+
+	report("golay_23_decode", errs, run(secs, [&](int i) {
+		uint32_t v = cw[i];
+		return (long)golay_23_decode(v);
+	}));
+}
+
+static void bench_hamming_15(double secs, int errs)
+{
+	std::vector<uint16_t> cw(SET_SIZE);
+	for (int i = 0; i < SET_SIZE; i++)
+		cw[i] = flip_bits(hamming_15_encode(rng() & 0x7ff), 15, errs);
+
+	report("hamming_15_decode", errs, run(secs, [&](int i) {
+		uint16_t v = cw[i];
+		return (long)hamming_15_decode(v);
+	}));
+}
+
+static void bench_golay_2087(double secs, int errs)
+{
+	std::vector<golay2087_codeword> cw(SET_SIZE, golay2087_codeword(20));
+	for (int i = 0; i < SET_SIZE; i++) {
+		cw[i].insert(0, 8, rng() & 0xff);
+		CGolay2087::encode(cw[i]);
+		cw[i].insert(0, 20, flip_bits(cw[i].extract(0, 20), 20, errs));
+	}
+
+	report("CGolay2087::decode", errs, run(secs, [&](int i) {
+		golay2087_codeword v = cw[i];
+		return (long)CGolay2087::decode(v);
+	}));
+}
+
+static void bench_qr_1676(double secs, int errs)
+{
+	std::vector<qr1676_codeword> cw(SET_SIZE, qr1676_codeword(16));
+	for (int i = 0; i < SET_SIZE; i++) {
+		cw[i].insert(0, 7, rng() & 0x7f);
+		CQR1676::encode(cw[i]);
+		cw[i].insert(0, 16, flip_bits(cw[i].extract(0, 16), 16, errs));
+	}
+
+	report("CQR1676::decode", errs, run(secs, [&](int i) {
+		qr1676_codeword v = cw[i];
+		return (long)CQR1676::decode(v);
+	}));
+}
+
+static void bench_hamming_16114(double secs, int errs)
+{
+	std::vector<bool> cw(SET_SIZE * 16);
+	for (int i = 0; i < SET_SIZE; i++) {
+		bool d[16];
+		for (int j = 0; j < 11; j++)
+			d[j] = rng() & 1;
+		CHamming::encode16114(d);
+		for (int j = 0; j < errs; j++) {
+			int n = rng() % 16;
+			d[n] = !d[n];
+		}
+		for (int j = 0; j < 16; j++)
+			cw[i * 16 + j] = d[j];
+	}
+
+	report("CHamming::decode16114", errs, run(secs, [&](int i) {
+		bool d[16];
+		for (int j = 0; j < 16; j++)
+			d[j] = cw[i * 16 + j];
+		return (long)CHamming::decode16114(d);
+	}));
+}
+
+/*
+ * P25 NID: BCH(63,16,23). Codewords are built as m(x) * g(x) in the bit
+ * order bchDec() reads them back with extract(0, 63).
+ */
+static void bench_bch(double secs, int errs)
+{
+	static const uint64_t BCH_GEN = 0xd4dcbbd0c9b3ULL; // reciprocal of bchG
+	std::vector<bch_codeword> cw(SET_SIZE, bch_codeword(64));
+	for (int i = 0; i < SET_SIZE; i++) {
+		uint64_t m = rng() & 0xffff, v = 0;
+		for (int j = 0; j < 16; j++)
+			if (m & (1 << j))
+				v ^= BCH_GEN << j;
+		for (int j = 0; j < errs; j++)
+			v ^= (uint64_t)1 << (rng() % 63);
+		cw[i].insert(0, 63, v);
+	}
+
+	report("bchDec", errs, run(secs, [&](int i) {
+		bch_codeword v = cw[i];
+		return (long)bchDec(v);
+	}));
+}
+
+/*
+ * DMR 3/4 rate trellis. The burst is one bit per byte, 98 payload dibits
+ * either side of the 68 bit sync / slot type field, like dmr_slot hands it in.
+ */
+static void bench_trellis(double secs, int errs)
+{
+	static const unsigned char ENCODE[] = {
+		0, 8, 4, 12, 2, 10, 6, 14,  4, 12, 2, 10, 6, 14, 0, 8,
+		1, 9, 5, 13, 3, 11, 7, 15,  5, 13, 3, 11, 7, 15, 1, 9,
+		3, 11, 7, 15, 1, 9, 5, 13,  7, 15, 1, 9, 5, 13, 3, 11,
+		2, 10, 6, 14, 0, 8, 4, 12,  6, 14, 0, 8, 4, 12, 2, 10};
+	// constellation point to its two dibits, each as the bit pair b1 * 2 + b2
+	static const unsigned char POINT_BITS[16][2] = {
+		{0, 2}, {2, 2}, {1, 3}, {3, 3}, {3, 2}, {1, 2}, {2, 3}, {0, 3},
+		{3, 1}, {1, 1}, {2, 0}, {0, 0}, {0, 1}, {2, 1}, {1, 0}, {3, 0}};
+	static const unsigned int INTERLEAVE[98] = {
+		0, 1, 8, 9, 16, 17, 24, 25, 32, 33, 40, 41, 48, 49, 56, 57, 64, 65, 72, 73, 80, 81, 88, 89, 96, 97,
+		2, 3, 10, 11, 18, 19, 26, 27, 34, 35, 42, 43, 50, 51, 58, 59, 66, 67, 74, 75, 82, 83, 90, 91,
+		4, 5, 12, 13, 20, 21, 28, 29, 36, 37, 44, 45, 52, 53, 60, 61, 68, 69, 76, 77, 84, 85, 92, 93,
+		6, 7, 14, 15, 22, 23, 30, 31, 38, 39, 46, 47, 54, 55, 62, 63, 70, 71, 78, 79, 86, 87, 94, 95};
+
+	std::vector<unsigned char> bursts(SET_SIZE * 264);
+	for (int i = 0; i < SET_SIZE; i++) {
+		unsigned char *data = &bursts[i * 264];
+		unsigned char dibits[98];
+		unsigned int state = 0;
+		for (int j = 0; j < 49; j++) {
+			unsigned int tribit = (j < 48) ? rng() % 8 : 0;
+			unsigned int point = ENCODE[state * 8 + tribit];
+			state = tribit;
+			dibits[j * 2 + 0] = POINT_BITS[point][0];
+			dibits[j * 2 + 1] = POINT_BITS[point][1];
+		}
+		for (int j = 0; j < 98; j++) {
+			unsigned char dibit = dibits[INTERLEAVE[j]];
+			int n = j * 2;
+			if (n >= 98) n += 68;
+			data[n] = dibit >> 1;
+			n = j * 2 + 1;
+			if (n >= 98) n += 68;
+			data[n] = dibit & 1;
+		}
+		for (int j = 0; j < errs; j++) {
+			int n = rng() % 196;
+			if (n >= 98) n += 68;
+			data[n] ^= 1;
+		}
+	}
+
+	CDMRTrellis trellis;
+	report("CDMRTrellis::decode", errs, run(secs, [&](int i) {
+		unsigned char payload[18];
+		return (long)trellis.decode(&bursts[i * 264], payload);
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 0.5;
+	if (secs <= 0)
+		secs = 0.5;
+
+	// clean codewords, then up to what each code can correct
+	for (int errs = 0; errs <= 3; errs++) bench_golay_23(secs, errs);
+	for (int errs = 0; errs <= 1; errs++) bench_hamming_15(secs, errs);
+	for (int errs = 0; errs <= 3; errs++) bench_golay_2087(secs, errs);
+	for (int errs = 0; errs <= 2; errs++) bench_qr_1676(secs, errs);
+	for (int errs = 0; errs <= 1; errs++) bench_hamming_16114(secs, errs);
+	for (int errs = 0; errs <= 4; errs += 2) bench_bch(secs, errs);
+	for (int errs = 0; errs <= 3; errs++) bench_trellis(secs, errs);
+	return 0;
+}
@@ -85,6 +85,10 @@ namespace gr {
                 d_sync->set_voice_codec_callback(cb, user_data);
         }
 
+        size_t frame_assembler_impl::memory_usage(void) {
+            return sizeof(*this) + (d_sync ? d_sync->memory_usage() : 0);
+        }
+
         void frame_assembler_impl::set_debug(int debug) {
             if (d_sync)
                 d_sync->set_debug(debug);
@@ -139,10 +143,11 @@ namespace gr {
 
                 const uint8_t *in = (const uint8_t *) input_items[0];
 
+                // decode no more than both slot queues have room for, the rest waits for the next call
+                const int nsyms = audio_queue_budget(output_queue[0], audio_queue_budget(output_queue[1], ninput_items[0]));
+
                 if (d_sync) {
-                    for (int i=0; i<ninput_items[0]; i++) {
-                        d_sync->rx_sym(in[i]);
-                    }
+                    d_sync->rx_syms(in, nsyms);
                 }
         
         int amt_produce = 0;
@@ -155,9 +160,6 @@ namespace gr {
           amt_produce = output_queue.size();
         }
 */  
-        produce(0, output_queue[0].size());
-        produce(1, output_queue[1].size());
-
             if ((output_queue[0].size() > 0) || ( output_queue[1].size() > 0)) {
         //BOOST_LOG_TRIVIAL(info) << "DMR Frame Assembler - Amt Prod: " << amt_produce << " output_queue 0: " << output_queue[0].size() << " output_queue 1: " << output_queue[1].size() <<" noutput_items: " <<  noutput_items;
         }
@@ -183,17 +185,17 @@ namespace gr {
         if (terminated) {
             add_item_tag(0, nitems_written(0), pmt::intern("terminate"), pmt::from_long(1), pmt::intern(name()));
         }*/
-          for (int i = 0; i < output_queue[slot_id].size(); i++) {
-              //BOOST_LOG_TRIVIAL(info) << output_queue[slot_id][i];
-            out[i] = output_queue[slot_id][i];
+          size_t dropped = output_queue[slot_id].take_dropped();
+          if (dropped > 0) {
+            BOOST_LOG_TRIVIAL(error) << "DMR Frame Assembler - slot " << slot_id << " output_queue full, dropped " << dropped << " samples";
           }
-          output_queue[slot_id].clear();
-          //output_queue[slot_id].erase(output_queue[slot_id].begin(), output_queue[slot_id].begin() + output_queue[slot_id].size());
+          // anything that does not fit in this call stays queued for the next one
+          produce(slot_id, output_queue[slot_id].pop(out, noutput_items));
         }
 
         //BOOST_LOG_TRIVIAL(info) << "DMR Frame Assembler - Amt Prod: " << amt_produce << " output_items 0: " << len(output_items[0]) << " output_items 1: " << len(output_items[1]) <<" noutput_items: " <<  noutput_items;
         
-        consume_each(ninput_items[0]);
+        consume_each(nsyms);
         // Tell runtime system how many output items we produced.
         return WORK_CALLED_PRODUCE;
 
@@ -31,6 +31,7 @@
 #include <deque>
 #include <array>
 #include "rx_base.h"
+#include "ring_buffer.h"
 #include "log_ts.h"
 
 typedef std::deque<uint8_t> dibit_queue;
@@ -45,7 +46,7 @@ namespace gr {
                 int d_msgq_id;
                 gr::msg_queue::sptr d_msg_queue;
                 //std::deque<int16_t> output_queue[2];
-                std::array<std::deque<int16_t>, 2> output_queue;
+                std::array<audio_queue, 2> output_queue;
                 rx_base* d_sync;
 
                 // internal functions
@@ -59,6 +60,7 @@ namespace gr {
                 void crypt_reset();
                 void crypt_key(uint16_t keyid, uint8_t algid, const std::vector<uint8_t> &key);
                 void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data);
+                size_t memory_usage(void);
 
             public:
                 log_ts logts;
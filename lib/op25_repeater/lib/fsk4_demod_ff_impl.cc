@@ -26,9 +26,14 @@
 #endif
 
 #include <stdio.h>
+#include <algorithm>
 #include <gnuradio/io_signature.h>
 #include "fsk4_demod_ff_impl.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /*
  * This table was machine-generated by gen_interpolator_taps.
  * DO NOT EDIT BY HAND.
@@ -168,6 +173,51 @@ static const float TAPS[NSTEPS+1][NTAPS] = {
    {  0.00000e+00,  0.00000e+00,  0.00000e+00,  1.00000e+00,  0.00000e+00,  0.00000e+00,  0.00000e+00,  0.00000e+00 }, // 128/128
 };
 
+/*
+ * Interpolates the NTAPS samples at x for the step imu and the one after it,
+ * the second value gives the direction for the symbol clock loop. Products
+ * are formed in float and summed in double in tap order, as the scalar loop
+ * does, so both paths give the same result bit for bit.
+ */
+static inline void
+interpolate(const float *x, int imu, double &interp, double &interp_p1)
+{
+#if defined(__SSE2__)
+  const __m128 x_lo = _mm_loadu_ps(x);
+  const __m128 x_hi = _mm_loadu_ps(x + 4);
+  const __m128 a_lo = _mm_mul_ps(_mm_loadu_ps(TAPS[imu]), x_lo);
+  const __m128 a_hi = _mm_mul_ps(_mm_loadu_ps(TAPS[imu] + 4), x_hi);
+  const __m128 b_lo = _mm_mul_ps(_mm_loadu_ps(TAPS[imu + 1]), x_lo);
+  const __m128 b_hi = _mm_mul_ps(_mm_loadu_ps(TAPS[imu + 1] + 4), x_hi);
+
+  // pair up the two products of each tap, lane 0 is interp, lane 1 interp_p1
+  const __m128 p01 = _mm_unpacklo_ps(a_lo, b_lo);
+  const __m128 p23 = _mm_unpackhi_ps(a_lo, b_lo);
+  const __m128 p45 = _mm_unpacklo_ps(a_hi, b_hi);
+  const __m128 p67 = _mm_unpackhi_ps(a_hi, b_hi);
+
+  __m128d acc = _mm_setzero_pd();
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(p01));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(p01, p01)));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(p23));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(p23, p23)));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(p45));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(p45, p45)));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(p67));
+  acc = _mm_add_pd(acc, _mm_cvtps_pd(_mm_movehl_ps(p67, p67)));
+
+  interp = _mm_cvtsd_f64(acc);
+  interp_p1 = _mm_cvtsd_f64(_mm_unpackhi_pd(acc, acc));
+#else
+  interp = 0.0;
+  interp_p1 = 0.0;
+  for(int i = 0; i < NTAPS; i++) {
+    interp    += TAPS[imu    ][i] * x[i];
+    interp_p1 += TAPS[imu + 1][i] * x[i];
+  }
+#endif
+}
+
 namespace gr {
   namespace op25_repeater {
 
@@ -186,8 +236,7 @@ namespace gr {
 		  gr::io_signature::make(1, 1, sizeof(float)),
 		  gr::io_signature::make(1, 1, sizeof(float))),
 	d_block_rate(sample_rate_Hz / symbol_rate_Hz),
-	d_history(new float[NTAPS]),
-	d_history_last(0),
+	d_history(NTAPS - 1, 0.0),
 	d_queue(queue),
 	d_symbol_clock(0.0),
 	d_symbol_spread(2.0), // nominal symbol spread of 2.0 gives outputs at -3, -1, +1, +3
@@ -196,8 +245,6 @@ namespace gr {
     {
       fine_frequency_correction = 0.0;
       coarse_frequency_correction = 0.0;
-
-      std::fill(&d_history[0], &d_history[NTAPS], 0.0);
     }
 
     /*
@@ -246,13 +293,20 @@ namespace gr {
       const float *in = (const float *)input_items[0];
       float *out = (float *)output_items[0];
 
+      // the interpolator window for in[i] starts at d_history[i]
+      d_history.resize(NTAPS - 1 + noutput_items);
+      std::copy(in, in + noutput_items, d_history.begin() + (NTAPS - 1));
+
       // first we run through all provided data
       for(int i = 0; i < noutput_items; i++) {
-	if(tracking_loop_mmse(in[i], &out[n])) {
+	if(tracking_loop_mmse(&d_history[i], &out[n])) {
 	  ++n;
 	}
       }
 
+      // keep the newest samples for the start of the next window
+      std::copy(d_history.end() - (NTAPS - 1), d_history.end(), d_history.begin());
+
       // send frequency adjusment request if needed 
       //send_frequency_correction();
 
@@ -287,13 +341,10 @@ namespace gr {
     }
     
     bool
-    fsk4_demod_ff_impl::tracking_loop_mmse(float input, float *output)
+    fsk4_demod_ff_impl::tracking_loop_mmse(const float *window, float *output)
     {
       d_symbol_clock += d_symbol_time;
       
-      d_history[d_history_last++] = input;
-      d_history_last %= NTAPS;
-      
       if(d_symbol_clock > 1.0) {
 	
 	d_symbol_clock -= 1.0;
@@ -302,37 +353,14 @@ namespace gr {
 	// but found to be slightly inferior.  Using MMSE
 	// interpolation shouldn't be a terrible burden
 	
-#if 0
-	int imu = min(static_cast<int>(floor(0.5 + (NSTEPS * (d_symbol_clock / d_symbol_time)))), NSTEPS - 1);
-	int imu_p1 = imu + 1;
-#else
+	// the taps for imu + 1 are used as well, so it stops one short of NSTEPS
 	int imu = (int) floor(0.5 + (NSTEPS * ((d_symbol_clock / d_symbol_time))));
-	int imu_p1 = imu + 1;
-	if (imu >= NSTEPS) { 
+	if (imu >= NSTEPS)
 	  imu = NSTEPS - 1;
-	  imu_p1 = NSTEPS;
-	}
-#endif
 	
-#if 0
-	double interp = 0.0;
-	double interp_p1 = 0.0;
-	for(size_t i = 0, j = d_history_last; i < NTAPS; ++i) {
-	  interp += TAPS[imu][i] * d_history[j];
-	  interp_p1 += TAPS[imu_p1][i] * d_history[j];
-	  j = (j + 1) % NTAPS;
-	}
-#else
-	size_t j = d_history_last;
-	double interp = 0.0;
-	double interp_p1 = 0.0;
-	for(int i=0; i<NTAPS; i++)
-	  {
-	    interp    +=  TAPS[imu   ][i] * d_history[j];
-	    interp_p1 +=  TAPS[imu_p1][i] * d_history[j];
-	    j = (j+1) % NTAPS;
-	  }
-#endif
+	double interp;
+	double interp_p1;
+	interpolate(window, imu, interp, interp_p1);
 	
 	// our output symbol will be interpolated value corrected for
 	// symbol_spread and frequency offset
@@ -347,46 +375,34 @@ namespace gr {
 	// which will be +/- 0.5 * symbol_spread and +/- 1.5 *
 	// symbol_spread remember: nominal symbol_spread will be 2.0
 	
-	double symbol_error;
+	// The hard decision indexes the level and gain tables instead of
+	// branching, random symbols make such branches mispredict. The outer
+	// levels track at half gain and the sign of the gain is the direction
+	// the spread moves in; the arithmetic is the same as one branch each.
+	static const double LEVEL_2FSK[2] = { -0.5, 0.5 };
+	static const double GAIN_2FSK[2]  = { -1.0, 1.0 };
+	static const double LEVEL_4FSK[4] = { -1.5, -0.5, 0.5, 1.5 };
+	static const double GAIN_4FSK[4]  = { -0.5, -1.0, 1.0, 0.5 };
 	const double K_SYMBOL_SPREAD = 0.0100; // tracking loop gain constant
 
-	if (d_bfsk) { // 2L-FSK
-		if(interp < 0.0) {
-	      // symbol is -1: Expected at -0.5 * symbol_spread
-	      symbol_error = interp + (0.5 * d_symbol_spread);
-	      d_symbol_spread -= (symbol_error * K_SYMBOL_SPREAD);
-	    } else {
-	      // symbol is +1: Expected at +0.5 * symbol_spread
-	      symbol_error = interp - (0.5 * d_symbol_spread);
-	      d_symbol_spread += (symbol_error * K_SYMBOL_SPREAD);
-	    }
-	} else {     // 4L-FSK
-		if(interp < - d_symbol_spread) {
-		  // symbol is -3: Expected at -1.5 * symbol_spread
-		  symbol_error = interp + (1.5 * d_symbol_spread);
-		  d_symbol_spread -= (symbol_error * 0.5 * K_SYMBOL_SPREAD);
-		} else if(interp < 0.0) {
-		  // symbol is -1: Expected at -0.5 * symbol_spread
-		  symbol_error = interp + (0.5 * d_symbol_spread);
-		  d_symbol_spread -= (symbol_error * K_SYMBOL_SPREAD);
-		} else if(interp < d_symbol_spread) {
-		  // symbol is +1: Expected at +0.5 * symbol_spread
-		  symbol_error = interp - (0.5 * d_symbol_spread);
-		  d_symbol_spread += (symbol_error * K_SYMBOL_SPREAD);
-		} else {
-		  // symbol is +3: Expected at +1.5 * symbol_spread
-		  symbol_error = interp - (1.5 * d_symbol_spread);
-		  d_symbol_spread += (symbol_error * 0.5 * K_SYMBOL_SPREAD);
-		}
+	int sym;
+	const double *level, *gain;
+	if (d_bfsk) { // 2L-FSK: symbols -1, +1
+	  sym = !(interp < 0.0);
+	  level = LEVEL_2FSK;
+	  gain = GAIN_2FSK;
+	} else {     // 4L-FSK: symbols -3, -1, +1, +3
+	  sym = !(interp < - d_symbol_spread) + !(interp < 0.0) + !(interp < d_symbol_spread);
+	  level = LEVEL_4FSK;
+	  gain = GAIN_4FSK;
 	}
+	const double symbol_error = interp - (level[sym] * d_symbol_spread);
+	d_symbol_spread += (symbol_error * gain[sym]) * K_SYMBOL_SPREAD;
 	
 	// symbol clock tracking loop gain
 	const double K_SYMBOL_TIMING = 0.025;
-	if(interp_p1 < interp) {
-	  d_symbol_clock += symbol_error * K_SYMBOL_TIMING;  
-	} else {
-	  d_symbol_clock -= symbol_error * K_SYMBOL_TIMING;
-	}
+	const double clock_step = symbol_error * K_SYMBOL_TIMING;
+	d_symbol_clock += (interp_p1 < interp) ? clock_step : -clock_step;
 	
 	// constraints on symbol spreading
 	const double SYMBOL_SPREAD_MAX = 2.4; // upper range limit: +20%
@@ -24,9 +24,7 @@
 #ifndef INCLUDED_OP25_REPEATER_FSK4_DEMOD_FF_IMPL_H
 #define INCLUDED_OP25_REPEATER_FSK4_DEMOD_FF_IMPL_H
 
-#if GNURADIO_VERSION >= 0x030a00
-#include <boost/smart_ptr/scoped_array.hpp>
-#endif
+#include <vector>
 #include <op25_repeater/fsk4_demod_ff.h>
 
 namespace gr {
@@ -36,8 +34,8 @@ namespace gr {
     {
      private:
       float d_block_rate;
-      boost::scoped_array<float> d_history;
-      size_t d_history_last;
+      // the NTAPS - 1 samples before this call's input, followed by the input
+      std::vector<float> d_history;
       gr::msg_queue::sptr d_queue;
       double d_symbol_clock;
       double d_symbol_spread;
@@ -52,9 +50,10 @@ namespace gr {
       void send_frequency_correction();
 
       /**
-       * Tracking loop.
+       * Tracking loop, window points at the NTAPS samples ending with the
+       * current input.
        */
-      bool tracking_loop_mmse(float input, float *output);
+      bool tracking_loop_mmse(const float *window, float *output);
 
      public:
       fsk4_demod_ff_impl(gr::msg_queue::sptr queue, float sample_rate_Hz, float symbol_rate_Hz, bool bfsk = false);
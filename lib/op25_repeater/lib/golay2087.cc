@@ -24,6 +24,7 @@
 #include <vector>
 
 #include "golay2087.h"
+#include "op25_golay.h"
 
 const unsigned int ENCODING_TABLE_2087[] =
 	{0x0000U, 0xB08EU, 0xE093U, 0x501DU, 0x70A9U, 0xC027U, 0x903AU, 0x20B4U, 0x60DCU, 0xD052U, 0x804FU, 0x30C1U,
@@ -246,12 +247,26 @@ const unsigned int DECODING_TABLE_1576[] =
 	 0x0801U, 0x0800U, 0x0280U, 0x0802U, 0x0410U, 0x0804U, 0x0412U, 0x0806U, 0x0809U, 0x0808U, 0x1021U, 0x1020U, 
 	 0x5000U, 0x2200U, 0x5002U, 0x2202U};
 
+// (pattern >> 8) * X8 mod GENPOL_QR
+const unsigned int SYNDROME_TABLE_1576[] =
+	{0x00, 0x39, 0x72, 0x4b, 0xe4, 0xdd, 0x96, 0xaf,
+	 0xf1, 0xc8, 0x83, 0xba, 0x15, 0x2c, 0x67, 0x5e,
+	 0xdb, 0xe2, 0xa9, 0x90, 0x3f, 0x06, 0x4d, 0x74,
+	 0x2a, 0x13, 0x58, 0x61, 0xce, 0xf7, 0xbc, 0x85,
+	 0x8f, 0xb6, 0xfd, 0xc4, 0x6b, 0x52, 0x19, 0x20,
+	 0x7e, 0x47, 0x0c, 0x35, 0x9a, 0xa3, 0xe8, 0xd1,
+	 0x54, 0x6d, 0x26, 0x1f, 0xb0, 0x89, 0xc2, 0xfb,
+	 0xa5, 0x9c, 0xd7, 0xee, 0x41, 0x78, 0x33, 0x0a,
+	 0x27, 0x1e, 0x55, 0x6c, 0xc3, 0xfa, 0xb1, 0x88,
+	 0xd6, 0xef, 0xa4, 0x9d, 0x32, 0x0b, 0x40, 0x79,
+	 0xfc, 0xc5, 0x8e, 0xb7, 0x18, 0x21, 0x6a, 0x53,
+	 0x0d, 0x34, 0x7f, 0x46, 0xe9, 0xd0, 0x9b, 0xa2,
+	 0xa8, 0x91, 0xda, 0xe3, 0x4c, 0x75, 0x3e, 0x07,
+	 0x59, 0x60, 0x2b, 0x12, 0xbd, 0x84, 0xcf, 0xf6,
+	 0x73, 0x4a, 0x01, 0x38, 0x97, 0xae, 0xe5, 0xdc,
+	 0x82, 0xbb, 0xf0, 0xc9, 0x66, 0x5f, 0x14, 0x2d};
+
 #define X8              0x00000100   /* vector representation of X^{8} */
-#define X11             0x00000800   /* vector representation of X^{11} */
-#define X14             0x00004000   /* vector representation of X^{14} */
-#define X18             0x00040000   /* vector representation of X^{18} */
-#define MASK7           0xffffff00   /* auxiliary vector for testing */
-#define MASK8           0xfffff800   /* auxiliary vector for testing */
 #define GENPOL_GL       0x00000c75   /* generator polynomial, g(x) */
 #define GENPOL_QR       0x00000139   /* generator polinomial, g(x) */
 
@@ -265,33 +280,21 @@ unsigned int CGolay2087::getSyndrome1987(unsigned int pattern)
  * bits, when constructing the encoding table; (2) pattern = error pattern,
  * when constructing the decoding table; and (3) pattern = received vector, to
  * obtain its syndrome in decoding.
+ *
+ * The (20,8) code shares GENPOL_GL with the APCO Golay(23,12) code, so the
+ * table driven remainder from op25_golay.h applies to its 19 bit patterns.
  */
 {
-	unsigned int aux = X18;
-
-	if (pattern >= X11) {
-		while (pattern & MASK8) {
-			while (!(aux & pattern))
-				aux = aux >> 1;
-
-			pattern ^= (aux  / X11) * GENPOL_GL;
-		}
-	}
- 
-	return pattern;
+	return golay_23_syndrome(pattern);
 }
 
-unsigned int CGolay2087::decode(bit_vector& data)
+unsigned int CGolay2087::decode(golay2087_codeword& data)
 {
 	if (data.size() < 20)
 		return -1;
 
-	unsigned int code = 0;
 	unsigned int parity_bit = data[19];			// save parity bit
-	for (int i = 0; i < 19; i++) {				// parity bit ignored for table lookup
-		code <<= 1;
-		code |= data[i] & 0x1;
-	}
+	unsigned int code = data.extract(0, 19);		// parity bit ignored for table lookup
 
 	unsigned int syndrome = getSyndrome1987(code);
 	unsigned int error_pattern = DECODING_TABLE_1987[syndrome];
@@ -304,32 +307,22 @@ unsigned int CGolay2087::decode(bit_vector& data)
 		if (__builtin_popcount(code) & 0x1)		// fail if codeword has odd parity
 			errs = 4;
 
-		for (int i = 19; i >= 0; i--) {
-			data[i] = code & 0x1;
-			code >>= 1;
-		}
+		data.insert(0, 20, code);
 	}
 	return errs;
 }
 
-void CGolay2087::encode(bit_vector& data)
+void CGolay2087::encode(golay2087_codeword& data)
 {
 	if (data.size() < 20)
 		return;
 
-	unsigned int value = 0;
-	for (int i = 0; i < 8; i++) {
-		value <<= 1;
-		value |= data[i] & 0x1;
-	}
+	unsigned int value = data.extract(0, 8);
 
 	unsigned int cksum = ENCODING_TABLE_2087[value];
 	unsigned int cksum_le = (((cksum & 0xff) << 4) | (cksum >> 12)); // swap Endian-ness and drop 4 unused bits
 	
-	for (int i = 19; i >= 8; i--) {
-		data[i] = cksum_le & 0x1;
-		cksum_le >>= 1;
-	}
+	data.insert(8, 20, cksum_le);
 }
 
 unsigned int CQR1676::getSyndrome1576(unsigned int pattern)
@@ -341,55 +334,36 @@ unsigned int CQR1676::getSyndrome1576(unsigned int pattern)
  * bits, when constructing the encoding table; (2) pattern = error pattern,
  * when constructing the decoding table; and (3) pattern = received vector, to
  * obtain its syndrome in decoding.
+ *
+ * The remainder is linear in the pattern, so the 7 bits above X8 are
+ * reduced with a single lookup in SYNDROME_TABLE_1576.
  */
 {
-	unsigned int aux = X14;
- 
-	if (pattern >= X8) {
-		while (pattern & MASK7) {
-			while (!(aux & pattern))
-				aux = aux >> 1;
-
-			pattern ^= (aux / X8) * GENPOL_QR;
-		}
-	}
-
-	return pattern;
+	return (pattern & 0xffU) ^ SYNDROME_TABLE_1576[(pattern >> 8) & 0x7fU];
 }
 
 // Compute the EMB against a precomputed list of correct words
-void CQR1676::encode(bit_vector& data)
+void CQR1676::encode(qr1676_codeword& data)
 {
 	if (data.size() < 16)
 		return;
 
 	// 7 bits data
-	unsigned int value = 0;
-	for (int i = 0; i < 7; i++) {
-		value <<= 1;
-		value |= data[i] & 0x1;
-	}
+	unsigned int value = data.extract(0, 7);
 
 	// 7 bits data + 9 bits parity
 	unsigned int cksum = ENCODING_TABLE_1676[value];
 
-	for (int i = 15; i >= 7; i--) {
-		data[i] = cksum & 0x1;
-		cksum >>= 1;
-	}
+	data.insert(7, 16, cksum);
 }
 
-unsigned char CQR1676::decode(bit_vector& data)
+unsigned char CQR1676::decode(qr1676_codeword& data)
 {
 	if (data.size() < 16)
 		return -1;
 
-	unsigned int code = 0;
 	unsigned int parity_bit = data[15];			// save parity bit
-	for (int i = 0; i < 15; i++) {				// parity bit ignored for table lookup
-		code <<= 1;
-		code |= data[i] & 0x1;
-	}
+	unsigned int code = data.extract(0, 15);		// parity bit ignored for table lookup
 
 	unsigned int syndrome = getSyndrome1576(code);
 	unsigned int error_pattern = DECODING_TABLE_1576[syndrome];
@@ -401,10 +375,7 @@ unsigned char CQR1676::decode(bit_vector& data)
 		errs = __builtin_popcount(error_pattern);	// save number of corrections identified
 		if (__builtin_popcount(code) & 0x1)		// fail if codeword has odd parity
 			errs = 4;
-		for (int i = 15; i >= 0; i--) {
-			data[i] = code & 0x1;
-			code >>= 1;
-		}
+		data.insert(0, 16, code);
 	}
 	return errs;
 }
@@ -22,14 +22,15 @@
 #ifndef Golay2087_H
 #define Golay2087_H
 
-#include <vector>
+#include "bit_array.h"
 
-typedef std::vector<bool> bit_vector;
+typedef bit_array<20> golay2087_codeword;
+typedef bit_array<16> qr1676_codeword;
 
 class CGolay2087 {
 public:
-	static void encode(bit_vector& data);
-	static unsigned int decode(bit_vector& data);
+	static void encode(golay2087_codeword& data);
+	static unsigned int decode(golay2087_codeword& data);
 
 private:
 	static unsigned int getSyndrome1987(unsigned int pattern);
@@ -37,8 +38,8 @@ private:
 
 class CQR1676 {
 public:
-	static void encode(bit_vector& data);
-	static unsigned char decode(bit_vector& data);
+	static void encode(qr1676_codeword& data);
+	static unsigned char decode(qr1676_codeword& data);
 
 private:
 	static unsigned int getSyndrome1576(unsigned int pattern);
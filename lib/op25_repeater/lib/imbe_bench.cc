@@ -0,0 +1,136 @@
+/*
+ * Stand-alone check and benchmark for software_imbe_decoder against the
+ * scalar decoder it replaced, kept in software_imbe_decoder_scalar.
+ *
+ * Random full-rate frames are decoded by both, one decoder of each kind
+ * running over the whole sequence so that the state carried from frame to
+ * frame is exercised too. The planned FFTs and the VOLK cosine round
+ * differently from the scalar code, so a sample may be off by MAX_DIFF, and
+ * at most MAX_DIFF_RATE of the samples may differ at all. Then both
+ * decoders are timed and the rate is reported in frames per second.
+ *
+ * usage: imbe_bench [seconds per benchmark]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "software_imbe_decoder.h"
+#include "software_imbe_decoder_scalar.h"
+
+static const int CHECK_FRAMES = 20000;
+static const int BENCH_FRAMES = 2000;
+static const int MAX_DIFF = 1;
+static const double MAX_DIFF_RATE = 0.01;
+
+static std::mt19937 rng(42);
+
+static int failures = 0;
+
+static void fail(const char *what)
+{
+	if (failures++ < 10)
+		printf("mismatch: %s\n", what);
+}
+
+// The eight parameter vectors of a full-rate frame, at their field widths
+struct frame {
+	uint32_t u[8];
+};
+
+static std::vector<frame> make_frames(int n)
+{
+	static const int bits[8] = { 12, 12, 12, 12, 11, 11, 11, 7 };
+	std::vector<frame> frames(n);
+	for (int i = 0; i < n; i++)
+		for (int k = 0; k < 8; k++)
+			frames[i].u[k] = rng() & ((1 << bits[k]) - 1);
+	return frames;
+}
+
+template <typename D>
+static void decode(D& decoder, const frame& f, int16_t samples[IMBE_SAMPLES_PER_FRAME])
+{
+	decoder.decode_fullrate(samples, f.u[0], f.u[1], f.u[2], f.u[3], f.u[4], f.u[5], f.u[6], f.u[7], 0, 0);
+}
+
+static void check()
+{
+	const std::vector<frame> frames = make_frames(CHECK_FRAMES);
+	software_imbe_decoder a;
+	software_imbe_decoder_scalar b;
+	long differ = 0;
+	int max_diff = 0;
+
+	for (size_t i = 0; i < frames.size(); i++) {
+		int16_t sa[IMBE_SAMPLES_PER_FRAME], sb[IMBE_SAMPLES_PER_FRAME];
+		decode(a, frames[i], sa);
+		decode(b, frames[i], sb);
+		for (int n = 0; n < IMBE_SAMPLES_PER_FRAME; n++) {
+			const int d = abs(sa[n] - sb[n]);
+			if (d) {
+				differ++;
+				if (d > max_diff)
+					max_diff = d;
+			}
+		}
+	}
+
+	const double rate = (double)differ / ((long)frames.size() * IMBE_SAMPLES_PER_FRAME);
+	printf("%zu frames: %.4f of samples differ, largest difference %d\n", frames.size(), rate, max_diff);
+	if (max_diff > MAX_DIFF)
+		fail("sample off by more than MAX_DIFF");
+	if (rate > MAX_DIFF_RATE)
+		fail("too many samples differ");
+}
+
+static void report(const char *name, double rate)
+{
+	printf("%-36s %12.0f frames/s\n", name, rate);
+}
+
+// Decodes frames with a D until secs have passed, returns frames/s
+template <typename D>
+static double bench(double secs, const std::vector<frame>& frames)
+{
+	typedef std::chrono::steady_clock clock;
+	D decoder;
+	long count = 0;
+	volatile int sink = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		for (size_t i = 0; i < frames.size(); i++) {
+			int16_t samples[IMBE_SAMPLES_PER_FRAME];
+			decode(decoder, frames[i], samples);
+			sink += samples[0];
+		}
+		count += frames.size();
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 1.0;
+
+	check();
+	if (failures) {
+		printf("%d mismatches against the scalar decoder\n", failures);
+		return 1;
+	}
+	printf("software_imbe_decoder matches the scalar decoder\n");
+
+	const std::vector<frame> frames = make_frames(BENCH_FRAMES);
+	report("software_imbe_decoder_scalar", bench<software_imbe_decoder_scalar>(secs, frames));
+	report("software_imbe_decoder", bench<software_imbe_decoder>(secs, frames));
+	return 0;
+}
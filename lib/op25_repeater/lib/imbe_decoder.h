@@ -28,7 +28,7 @@
 #include <boost/shared_ptr.hpp>
 #include <vector>
 
-typedef std::vector<bool> voice_codeword;
+#include "bit_array.h"
 
 
 	#if GNURADIO_VERSION < 0x030900
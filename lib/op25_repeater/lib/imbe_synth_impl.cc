@@ -0,0 +1,61 @@
+/* -*- c++ -*- */
+/* 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#include "imbe_synth_impl.h"
+
+namespace gr {
+  namespace op25_repeater {
+
+    imbe_synth::sptr
+    imbe_synth::make(bool soft_vocoder)
+    {
+      return imbe_synth::sptr(new imbe_synth_impl(soft_vocoder));
+    }
+
+    imbe_synth_impl::imbe_synth_impl(bool soft_vocoder) :
+      d_soft_vocoder(soft_vocoder)
+    {
+    }
+
+    imbe_synth_impl::~imbe_synth_impl()
+    {
+    }
+
+    // Same two vocoders, and the same parameter handling, as p25p1_fdma::process_voice()
+    void
+    imbe_synth_impl::decode(int16_t samples[SAMPLES_PER_FRAME], const uint32_t u[8], uint32_t E0, uint32_t ET)
+    {
+      if (d_soft_vocoder) {
+        if (!d_software_decoder)
+          d_software_decoder.reset(new software_imbe_decoder());
+        d_software_decoder->decode_fullrate(samples, u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], E0, ET);
+      } else {
+        int16_t frame_vector[8];
+
+        for (int i=0; i < 8; i++) {
+          frame_vector[i] = u[i] & 0xFFFF;
+        }
+        frame_vector[7] >>= 1;
+        if (!d_vocoder)
+          d_vocoder.reset(new imbe_vocoder());
+        d_vocoder->imbe_decode(frame_vector, samples);
+      }
+    }
+
+  } /* namespace op25_repeater */
+} /* namespace gr */
@@ -0,0 +1,50 @@
+/* -*- c++ -*- */
+/* 
+ * This is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * This software is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this software; see the file COPYING.  If not, write to
+ * the Free Software Foundation, Inc., 51 Franklin Street,
+ * Boston, MA 02110-1301, USA.
+ */
+
+#ifndef INCLUDED_OP25_REPEATER_IMBE_SYNTH_IMPL_H
+#define INCLUDED_OP25_REPEATER_IMBE_SYNTH_IMPL_H
+
+#include <op25_repeater/imbe_synth.h>
+
+#include <memory>
+
+#include "software_imbe_decoder.h"
+#include "imbe_vocoder/imbe_vocoder.h"
+
+namespace gr {
+  namespace op25_repeater {
+
+    class imbe_synth_impl : public imbe_synth
+    {
+     private:
+      bool d_soft_vocoder;
+      // only the one selected is built, with the first frame
+      std::unique_ptr<software_imbe_decoder> d_software_decoder;
+      std::unique_ptr<imbe_vocoder> d_vocoder;
+
+     public:
+      imbe_synth_impl(bool soft_vocoder);
+      ~imbe_synth_impl();
+
+      void decode(int16_t samples[SAMPLES_PER_FRAME], const uint32_t u[8], uint32_t E0, uint32_t ET);
+    };
+
+  } // namespace op25_repeater
+} // namespace gr
+
+#endif /* INCLUDED_OP25_REPEATER_IMBE_SYNTH_IMPL_H */
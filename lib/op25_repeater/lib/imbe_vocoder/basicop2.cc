@@ -56,8 +56,14 @@ Word16 saturate (Word32 L_var1);
  |   Constants and Globals                                                   |
  |___________________________________________________________________________|
 */
-Flag Overflow = 0;
-Flag Carry = 0;
+/*
+ * Only the carry chain operators (L_add_c, L_sub_c, L_macNs, L_msuNs and
+ * L_sat) keep these up to date, the saturating operators just saturate.
+ * The vocoder never looks at either flag, and dropping the stores keeps
+ * decoders running on different threads from sharing a cache line.
+ */
+thread_local Flag Overflow = 0;
+thread_local Flag Carry = 0;
 
 /*___________________________________________________________________________
  |                                                                           |
@@ -98,12 +104,10 @@ saturate (Word32 L_var1)
 
     if (L_var1 > 0X00007fffL)
     {
-        Overflow = 1;
         var_out = MAX_16;
     }
     else if (L_var1 < (Word32) 0xffff8000L)
     {
-        Overflow = 1;
         var_out = MIN_16;
     }
     else
@@ -319,7 +323,6 @@ Word16 shl (Word16 var1, Word16 var2)
 
         if ((var2 > 15 && var1 != 0) || (result != (Word32) ((Word16) result)))
         {
-            Overflow = 1;
             var_out = (var1 > 0) ? MAX_16 : MIN_16;
         }
         else
@@ -510,7 +513,6 @@ Word32 L_mult (Word16 var1, Word16 var2)
     }
     else
     {
-        Overflow = 1;
         L_var_out = MAX_32;
     }
 
@@ -955,7 +957,6 @@ Word32 L_add (Word32 L_var1, Word32 L_var2)
         if ((L_var_out ^ L_var1) & MIN_32)
         {
             L_var_out = (L_var1 < 0) ? MIN_32 : MAX_32;
-            Overflow = 1;
         }
     }
 #if (WMOPS)
@@ -1007,7 +1008,6 @@ Word32 L_sub (Word32 L_var1, Word32 L_var2)
         if ((L_var_out ^ L_var1) & MIN_32)
         {
             L_var_out = (L_var1 < 0L) ? MIN_32 : MAX_32;
-            Overflow = 1;
         }
     }
 #if (WMOPS)
@@ -1376,7 +1376,6 @@ Word32 L_shl (Word32 L_var1, Word16 var2)
         {
             if (L_var1 > (Word32) 0X3fffffffL)
             {
-                Overflow = 1;
                 L_var_out = MAX_32;
                 break;
             }
@@ -1384,7 +1383,6 @@ Word32 L_shl (Word32 L_var1, Word16 var2)
             {
                 if (L_var1 < (Word32) 0xc0000000L)
                 {
-                    Overflow = 1;
                     L_var_out = MIN_32;
                     break;
                 }
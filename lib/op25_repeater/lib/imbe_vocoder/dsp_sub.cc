@@ -27,6 +27,7 @@
 #include "math_sub.h"
 #include "encode.h"
 #include "imbe_vocoder.h"
+#include "vec_sub.h"
 
 //-----------------------------------------------------------------------------
 //	PURPOSE:
@@ -52,6 +53,7 @@ void imbe_vocoder::idct(Word16 *in, Word16 m_lim, Word16 i_lim, Word16 *out)
 	UWord16 angl_acc;
 	Word32  sum;
 	Word16  i, m;
+	Word16  angl_vec[MAX_BLOCK_LEN], cos_vec[MAX_BLOCK_LEN];
 
 	if(m_lim == 1)
 	{
@@ -67,13 +69,17 @@ void imbe_vocoder::idct(Word16 *in, Word16 m_lim, Word16 i_lim, Word16 *out)
 	angl_step = angl_intl;
 	for(i = 0; i < i_lim; i++)
 	{
-		sum = 0;
 		angl_acc = angl_step;
 		for(m = 1; m < m_lim; m++)
 		{
-			sum = L_add(sum, L_shr( L_mult(in[m], cos_fxp(angl_acc)), 7));
+			angl_vec[m] = angl_acc;
 			angl_acc += angl_step;			
 		}
+		v_cos(&cos_vec[1], &angl_vec[1], m_lim - 1);
+
+		// Each term is below 2^24 in magnitude, so with m_lim <= MAX_BLOCK_LEN
+		// the sum cannot saturate and the order of the additions does not matter
+		sum = L_v_mac_shr(&in[1], &cos_vec[1], 7, m_lim - 1);
 		sum = L_add(sum, L_shr( L_deposit_h(in[0]), 8));
 		out[i] = extract_l(L_shr_r (sum, 8)); 
 		angl_step += angl_intl_2; 
@@ -104,6 +110,7 @@ void imbe_vocoder::dct(Word16 *in, Word16 m_lim, Word16 i_lim, Word16 *out)
 	UWord16 angl_acc;
 	Word32  sum;
 	Word16  i, m;
+	Word16  angl_vec[MAX_BLOCK_LEN], cos_vec[MAX_BLOCK_LEN];
 
 	if(m_lim == 1)
 	{
@@ -127,13 +134,16 @@ void imbe_vocoder::dct(Word16 *in, Word16 m_lim, Word16 i_lim, Word16 *out)
 	angl_step  = angl_intl_2;
 	for(i = 1; i < i_lim; i++)
 	{
-		sum = 0;
 		angl_acc = angl_begin;
 		for(m = 0; m < m_lim; m++)
 		{
-			sum = L_add(sum, L_deposit_l(mult(in[m], cos_fxp(angl_acc))));
+			angl_vec[m] = angl_acc;
 			angl_acc += angl_step;			
 		}
+		v_cos(cos_vec, angl_vec, m_lim);
+
+		// The terms are 16 bit, the sum cannot saturate
+		sum = L_v_mult_sum(in, cos_vec, m_lim);
 		out[i] = extract_l(L_mpy_ls(sum, angl_intl_2));
 
 		angl_step  += angl_intl_2;  
@@ -144,24 +154,41 @@ void imbe_vocoder::dct(Word16 *in, Word16 m_lim, Word16 i_lim, Word16 *out)
 
 
 
+namespace {
+	// Twiddle factors for the FFTLENGTH point FFT, read-only once built
+	struct fft_twiddles
+	{
+		Word16 wr[FFTLENGTH / 2 + 1];
+		Word16 wi[FFTLENGTH / 2 + 1];
+
+		fft_twiddles()
+		{
+			Word16 i, fft_len2, shift, step, theta;
+
+			fft_len2 = shr(FFTLENGTH, 1);
+			shift    = norm_s(fft_len2);
+			step     = shl(2, shift);
+			theta    = 0;
+
+			for(i = 0; i <= fft_len2; i++) 
+			{
+				wr[i] = cos_fxp(theta);    
+				wi[i] = sin_fxp(theta);    
+				if(i >= (fft_len2 - 1))
+					theta = ONE_Q15;
+				else
+					theta = add(theta, step);
+			}
+		}
+	};
+}
+
 void imbe_vocoder::fft_init(void)
 {
-	Word16 i, fft_len2, shift, step, theta;
-
-	fft_len2 = shr(FFTLENGTH, 1);
-	shift    = norm_s(fft_len2);
-	step     = shl(2, shift);
-	theta    = 0;
+	static const fft_twiddles twiddles;
 
-	for(i = 0; i <= fft_len2; i++) 
-	{
-		wr_array[i] = cos_fxp(theta);    
-		wi_array[i] = sin_fxp(theta);    
-		if(i >= (fft_len2 - 1))
-			theta = ONE_Q15;
-		else
-			theta = add(theta, step);
-	}
+	wr_array = twiddles.wr;
+	wi_array = twiddles.wi;
 }
 
 
@@ -192,12 +219,11 @@ void imbe_vocoder::fft_init(void)
 
 void imbe_vocoder::fft(Word16 *datam1, Word16 nn, Word16 isign)
 {
-	Word16 n, mmax, m, j, istep, i;
-	Word16 wr, wi, temp1;
-	Word32 L_tempr, L_tempi;
+	Word16 n, mmax, m, j, istep, i, k, half;
+	Word16 temp1;
 	Word16 *data;
-	Word32 L_temp1, L_temp2;
-	Word16 index, index_step;
+	Word16 index_step;
+	Word16 wr_vec[FFTLENGTH / 2], wi_vec[FFTLENGTH / 2];
 
 	//  Use pointer indexed from 1 instead of 0	
 	data = &datam1[-1];
@@ -228,49 +254,28 @@ void imbe_vocoder::fft(Word16 *datam1, Word16 nn, Word16 isign)
 	{
 		istep = shl(mmax,1);  // istep = 2 * mmax 
 
-		index = 0;
 		index_step = shr(index_step,1);
 
-		wr = ONE_Q15;
-		wi = 0;
-		for ( m = 1; m < mmax; m+=2) 
+		// Twiddle factors of this stage, the m-th butterfly of every group
+		// uses index m * index_step
+		half = shr(mmax,1);
+		wr_vec[0] = ONE_Q15;
+		wi_vec[0] = 0;
+		for ( k = 1; k < half; k++) 
 		{
-			for ( i = m; i <= n; i += istep) 
-			{
-				j = i + mmax;
-
-				// tempr = wr * data[j] - wi * data[j+1] 
-				L_temp1 = L_shr(L_mult(wr,data[j]),1);
-				L_temp2 = L_shr(L_mult(wi,data[j+1]),1);
-				L_tempr = L_sub(L_temp1,L_temp2);
-
-				// tempi = wr * data[j+1] + wi * data[j] 
-				L_temp1 = L_shr(L_mult(wr,data[j+1]),1);
-				L_temp2 = L_shr(L_mult(wi,data[j]),1);
-				L_tempi = L_add(L_temp1,L_temp2);
-
-
-				// data[j] = data[i] - tempr 
-				L_temp1 = L_shr(L_deposit_h(data[i]),1);
-				data[j] = round(L_sub(L_temp1,L_tempr));
-
-				// data[i] += tempr 
-				data[i] = round(L_add(L_temp1,L_tempr));
-
-				// data[j+1] = data[i+1] - tempi 
-				L_temp1 = L_shr(L_deposit_h(data[i+1]),1);
-				data[j+1] = round(L_sub(L_temp1,L_tempi));
-
-				// data[i+1] += tempi 
-				data[i+1] = round(L_add(L_temp1,L_tempi));
-			}
-			index = add(index,index_step);
-			wr = wr_array[index];
+			wr_vec[k] = wr_array[k * index_step];
 			if (isign < 0)
-				wi = negate(wi_array[index]);
+				wi_vec[k] = negate(wi_array[k * index_step]);
 			else
-				wi = wi_array[index];
+				wi_vec[k] = wi_array[k * index_step];
 		}
+
+		// The butterflies of a stage are independent of each other, so
+		// they are done a group at a time, with the data for consecutive
+		// twiddle factors next to each other in memory
+		for ( i = 0; i < nn; i += mmax) 
+			v_fft_bfly((Cmplx16 *)&datam1[2 * i], (Cmplx16 *)&datam1[2 * i + mmax], wr_vec, wi_vec, half);
+
 		mmax = istep;
 	}
 } 
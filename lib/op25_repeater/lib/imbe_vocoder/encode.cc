@@ -42,9 +42,7 @@
 
 void imbe_vocoder::encode_init(void)
 {
-	v_zap(pitch_est_buf, PITCH_EST_BUF_SIZE);
-	v_zap(pitch_ref_buf, PITCH_EST_BUF_SIZE);
-	v_zap(pe_lpf_mem, PE_LPF_ORD);
+	enc_bufs.reset();	// allocated and zeroed by the next encode()
 	pitch_est_init();
 	fft_init();
 	dc_rmv_mem = 0;
@@ -57,6 +55,14 @@ void imbe_vocoder::encode(IMBE_PARAM *imbe_param, Word16 *frame_vector, Word16 *
 {
 	Word16 i;
 	Word16 *wr_ptr, *sig_ptr;
+
+	if (!enc_bufs)
+		enc_bufs.reset(new encoder_buffers());
+
+	Word16 *pitch_est_buf = enc_bufs->pitch_est_buf;
+	Word16 *pitch_ref_buf = enc_bufs->pitch_ref_buf;
+	Word16 *pe_lpf_mem = enc_bufs->pe_lpf_mem;
+	Cmplx16 *fft_buf = enc_bufs->fft_buf;
 	
 	for(i = 0; i < PITCH_EST_BUF_SIZE - FRAME; i++)
 	{
@@ -90,7 +96,7 @@ void imbe_vocoder::encode(IMBE_PARAM *imbe_param, Word16 *frame_vector, Word16 *
 	for(i = 111; i < 146; i++) 
 		fft_buf[i].re = fft_buf[i].im = 0;
 
-	fft((Word16 *)&fft_buf, FFTLENGTH, 1);
+	fft((Word16 *)fft_buf, FFTLENGTH, 1);
 
 	pitch_ref(imbe_param, fft_buf);
 	v_uv_det(imbe_param, fft_buf);
@@ -12,12 +12,7 @@
 static bool already_printed = false;
 
 void imbe_vocoder::clear() {
-	memset(wr_array, 0, sizeof(wr_array));
-	memset(wi_array, 0, sizeof(wi_array));
-	memset(pitch_est_buf, 0, sizeof(pitch_est_buf));
-	memset(pitch_ref_buf, 0, sizeof(pitch_ref_buf));
-	memset(pe_lpf_mem, 0, sizeof(pe_lpf_mem));
-	memset(fft_buf, 0, sizeof(fft_buf));
+	enc_bufs.reset();
 	memset(sa_prev1, 0, sizeof(sa_prev1));
 	memset(sa_prev2, 0, sizeof(sa_prev2));
 	memset(uv_mem, 0, sizeof(uv_mem));
@@ -55,12 +50,6 @@ imbe_vocoder::imbe_vocoder (void) :
 	dc_rmv_mem(0),
 	d_gain_adjust(0)
 {
-	memset(wr_array, 0, sizeof(wr_array));
-	memset(wi_array, 0, sizeof(wi_array));
-	memset(pitch_est_buf, 0, sizeof(pitch_est_buf));
-	memset(pitch_ref_buf, 0, sizeof(pitch_ref_buf));
-	memset(pe_lpf_mem, 0, sizeof(pe_lpf_mem));
-	memset(fft_buf, 0, sizeof(fft_buf));
 	memset(sa_prev1, 0, sizeof(sa_prev1));
 	memset(sa_prev2, 0, sizeof(sa_prev2));
 	memset(uv_mem, 0, sizeof(uv_mem));
@@ -84,3 +73,8 @@ imbe_vocoder::imbe_vocoder (void) :
 		fprintf(stderr,"under certain conditions; see the file ``LICENSE'' for details.\n");
 	}
 }
+
+size_t imbe_vocoder::memory_usage() const
+{
+	return sizeof(*this) + (enc_bufs ? sizeof(encoder_buffers) : 0);
+}
@@ -9,6 +9,7 @@
 
 #include <stdint.h>
 #include <string.h>
+#include <memory>
 
 #include "imbe.h"
 #include "dsp_sub.h"
@@ -38,6 +39,8 @@ public:
 	void set_gain_adjust(float gain_adjust) {d_gain_adjust = gain_adjust;}
 	// decodes IMBE codec parameters in float format into 160 audio samples (snd)	
 	void decode_tap(Word16 *snd, int L, float w0, const int *Vl, const float *Ml);
+	// bytes held by this instance, including the encoder buffers once allocated
+	size_t memory_usage() const;
 private:
 	IMBE_PARAM my_imbe_param;
 
@@ -56,13 +59,20 @@ private:
 	Word16 sa_prev3[NUM_HARMS_MAX];
 	Word32 th_max;
 	Word16 v_uv_dsn[NUM_BANDS_MAX];
-	Word16 wr_array[FFTLENGTH / 2 + 1];
-	Word16 wi_array[FFTLENGTH / 2 + 1];
-	Word16 pitch_est_buf[PITCH_EST_BUF_SIZE];
-	Word16 pitch_ref_buf[PITCH_EST_BUF_SIZE];
+	// FFT twiddle factors, shared by all instances
+	const Word16 *wr_array;
+	const Word16 *wi_array;
 	Word32 dc_rmv_mem;
-	Cmplx16 fft_buf[FFTLENGTH];
-	Word16 pe_lpf_mem[PE_LPF_ORD];
+
+	// Encoder input history, only allocated by the first imbe_encode() so
+	// that decode-only instances don't carry it
+	struct encoder_buffers {
+		Word16 pitch_est_buf[PITCH_EST_BUF_SIZE];
+		Word16 pitch_ref_buf[PITCH_EST_BUF_SIZE];
+		Cmplx16 fft_buf[FFTLENGTH];
+		Word16 pe_lpf_mem[PE_LPF_ORD];
+	};
+	std::unique_ptr<encoder_buffers> enc_bufs;
 	float d_gain_adjust;
 
 	/* member functions */
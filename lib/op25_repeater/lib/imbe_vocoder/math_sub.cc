@@ -234,6 +234,85 @@ Word16 sin_fxp(Word16 x)
 		return ty;
 }
 
+//-----------------------------------------------------------------------------
+//	cos_fxp() without the basic_op.h calls, so that the vector versions
+//	below reduce to a table lookup and a few integer operations per element.
+//	The result is identical for every input: negate() only saturates for
+//	x == MIN_16, and none of the other steps can overflow.
+//-----------------------------------------------------------------------------
+static inline Word16 cos_fxp_inl(Word16 x)
+{
+	Word32 tx, index1, index2, m, ty, sign;
+
+	tx = (x < 0) ? ((x == MIN_16) ? MAX_16 : -x) : x;
+
+	sign = (tx > X05_Q15);
+	if(sign)
+		tx = ONE_Q15 - tx;
+
+	// index1 == 128 (tx == X05_Q15) has m == 0 and cos_table[128] == 0
+	index1 = tx >> 7;
+	index2 = index1 + (index1 < 128);
+	m = (tx - (index1 << 7)) << 8;
+
+	ty = cos_table[index1] + ((m * (cos_table[index2] - cos_table[index1])) >> 15);
+
+	return (Word16)(sign ? -ty : ty);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Compute cos_fxp() of a vector of angles
+//
+//  INPUT:
+//		x         - Pointer to the angles, in Q1.15 radians/PI
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = cos_fxp(x[i])
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_cos(Word16 *vec, const Word16 *x, Word16 n)
+{
+	Word16 i;
+
+	for(i = 0; i < n; i++)
+		vec[i] = cos_fxp_inl(x[i]);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Compute cos_fxp() along a linear phase track, as the
+//      synthesis loops do with their 32 bit phase accumulators
+//
+//  INPUT:
+//		L_ph_acc  - Phase of the first element, angle in the high word
+//		L_ph_step - Phase increment, added modulo 2^32
+//      n         - size of vec
+//
+//	OUTPUT:
+//		vec[i] = cos_fxp(extract_h(L_ph_acc + i * L_ph_step))
+//
+//	RETURN:
+//		Phase accumulator advanced by n steps
+//
+//-----------------------------------------------------------------------------
+Word32 v_cos_ph(Word16 *vec, Word32 L_ph_acc, Word32 L_ph_step, Word16 n)
+{
+	UWord32 ph_acc = L_ph_acc;
+	Word16 i;
+
+	for(i = 0; i < n; i++)
+	{
+		vec[i] = cos_fxp_inl((Word16)(ph_acc >> 16));
+		ph_acc += L_ph_step;
+	}
+	return (Word32)ph_acc;
+}
+
 
 //-----------------------------------------------------------------------------
 // Table for routine sqrt_l_exp()     
@@ -58,6 +58,42 @@ Word16 cos_fxp(Word16 x);
 //-----------------------------------------------------------------------------
 Word16 sin_fxp(Word16 x);
 
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Compute cos_fxp() of a vector of angles
+//
+//  INPUT:
+//		x         - Pointer to the angles, in Q1.15 radians/PI
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = cos_fxp(x[i])
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_cos(Word16 *vec, const Word16 *x, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Compute cos_fxp() along a linear phase track, as the
+//      synthesis loops do with their 32 bit phase accumulators
+//
+//  INPUT:
+//		L_ph_acc  - Phase of the first element, angle in the high word
+//		L_ph_step - Phase increment, added modulo 2^32
+//      n         - size of vec
+//
+//	OUTPUT:
+//		vec[i] = cos_fxp(extract_h(L_ph_acc + i * L_ph_step))
+//
+//	RETURN:
+//		Phase accumulator advanced by n steps
+//
+//-----------------------------------------------------------------------------
+Word32 v_cos_ph(Word16 *vec, Word32 L_ph_acc, Word32 L_ph_step, Word16 n);
+
 //-----------------------------------------------------------------------------
 //	PURPOSE:
 //				Multiply a 32 bit number (L_var2) and a 16 bit
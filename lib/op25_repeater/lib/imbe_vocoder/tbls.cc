@@ -252,6 +252,20 @@ const Word16 ws[49] =
 	26869, 27525, 28180, 28835, 29491, 30146, 30801, 31457, 32112 
 };
 
+//-----------------------------------------------------------------------------
+//
+// Speech Synthesis Window, time reversed: ws_r[i] = ws[48 - i]
+//
+//-----------------------------------------------------------------------------
+const Word16 ws_r[49] =
+{
+	32112, 31457, 30801, 30146, 29491, 28835, 28180, 27525, 26869, 26214,
+	25559, 24903, 24248, 23592, 22937, 22282, 21626, 20971, 20316, 19660,
+	19005, 18350, 17694, 17039, 16384, 15728, 15073, 14417, 13762, 13107,
+	12451, 11796, 11141, 10485,  9830,  9175,  8519,  7864,  7208,  6553,
+	5898,   5242,  4587,  3932,  3276,  2621,  1966,  1310,   655 
+};
+
 /*
 const Word16 ws_ws[49] =
 {
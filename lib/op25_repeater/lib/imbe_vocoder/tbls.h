@@ -74,6 +74,13 @@ extern const UWord16 hi_ord_step_size_tbl[];
 //-----------------------------------------------------------------------------
 extern const Word16 ws[];
 
+//-----------------------------------------------------------------------------
+//
+// Speech Synthesis Window, time reversed
+//
+//-----------------------------------------------------------------------------
+extern const Word16 ws_r[];
+
 //-----------------------------------------------------------------------------
 //
 // Squared Pitch Estimation Window 64*wi^2
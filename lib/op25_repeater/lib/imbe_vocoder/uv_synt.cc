@@ -30,6 +30,7 @@
 #include "tbls.h"
 #include "encode.h"
 #include "imbe_vocoder.h"
+#include "vec_sub.h"
 
 
 
@@ -48,6 +49,7 @@ void imbe_vocoder::uv_synt_init(void)
 void imbe_vocoder::uv_synt(IMBE_PARAM *imbe_param, Word16 *snd)
 {
 	Cmplx16 Uw[FFTLENGTH];
+	Word16 uw_re[49];
 	Word16 i, index_a, index_b, index_aux, ha, hb, *v_uv_dsn_ptr, *sa_ptr, sa;
     Word32 fund_freq, fund_freq_2, fund_freq_acc_a, fund_freq_acc_b;
 
@@ -122,26 +124,13 @@ void imbe_vocoder::uv_synt(IMBE_PARAM *imbe_param, Word16 *snd)
 	for(i = 0; i < 105; i++)
 		snd[i] = uv_mem[i];
 
-	index_aux = 73;
-	for(i = 105; i < FRAME; i++)
-		snd[i] = shl(Uw[index_aux++].re, 3);
+	v_re_shl(&snd[105], &Uw[73], 3, FRAME - 105);
 
 
 	// Weighted Overlap Add Algorithm
-	index_aux = 24;
-	index_a   = 0;
-	index_b   = 48;
-	for(i = 56; i < 105; i++)
-	{
-		snd[i] = extract_h(L_add(L_mult(snd[i], ws[index_b]), L_mult(shl(Uw[index_aux].re, 3), ws[index_a])));
-
-		index_aux++;
-		index_a++;
-		index_b--;
-	}
+	v_re_shl(uw_re, &Uw[24], 3, 105 - 56);
+	v_wola(&snd[56], &snd[56], ws_r, uw_re, ws, 105 - 56);
 	
-	index_aux = 128;
-	for(i = 0; i < 105; i++)
-		uv_mem[i] = shl(Uw[index_aux++].re, 3);
+	v_re_shl(uv_mem, &Uw[128], 3, 105);
 }
 
@@ -31,6 +31,7 @@
 #include "tbls.h"
 #include "encode.h"
 #include "imbe_vocoder.h"
+#include "vec_sub.h"
 
 
 
@@ -60,7 +61,9 @@ void imbe_vocoder::v_synt(IMBE_PARAM *imbe_param, Word16 *snd)
 {
 	Word32 L_tmp, L_tmp1, fund_freq, L_snd[FRAME], L_ph_acc, L_ph_step;
 	Word32 L_ph_acc_aux, L_ph_step_prev, L_amp_acc, L_amp_step, L_ph_step_aux;
-	Word16 num_harms, i, j, *vu_dsn, *sa, *s_ptr, *s_ptr_aux, num_harms_max, num_harms_max_4;
+	Word16 num_harms, i, j, *vu_dsn, *sa, num_harms_max, num_harms_max_4;
+	Word16 cos_vec[FRAME], ph_vec[FRAME];
+	Word32 L_amp[FRAME];
 	UWord32 ph_mem_prev[NUM_HARMS_MAX], dph[NUM_HARMS_MAX];
 	Word16 num_harms_inv, num_harms_sh, num_uv;
 	Word16 freq_flag;
@@ -121,93 +124,48 @@ void imbe_vocoder::v_synt(IMBE_PARAM *imbe_param, Word16 *snd)
 		if(vu_dsn[i] == 0 && vu_dsn_prev[i] == 0)
 			continue;
 
+		// The sample loops below are done a block at a time: the harmonic's
+		// waveform is computed into cos_vec, then windowed, scaled and added
+		// into L_snd with the saturating vector operators of vec_sub.h.
+
 		if(vu_dsn[i] == 1 && vu_dsn_prev[i] == 0)  // unvoiced => voiced
 		{
-			s_ptr = (Word16 *)ws;
 			L_ph_acc = ph_mem[i] - (((L_ph_step >> 7) * 104) << 7);
-			for(j = 56; j <= 104; j++)
-			{
-				L_tmp = L_mult(*s_ptr++, sa[i]);
-				L_tmp = L_mpy_ls(L_tmp, cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc += L_ph_step;
-			}
+			L_ph_acc = v_cos_ph(cos_vec, L_ph_acc, L_ph_step, 104 - 56 + 1);   // j = 56..104
+			L_v_add_harm_win(&L_snd[56], ws, sa[i], cos_vec, 104 - 56 + 1);
 
-			for(j = 105; j <= 159; j++)
-			{
-				L_tmp = L_mult(sa[i], cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc += L_ph_step;
-			}
+			v_cos_ph(cos_vec, L_ph_acc, L_ph_step, 159 - 105 + 1);              // j = 105..159
+			L_v_add_harm(&L_snd[105], sa[i], cos_vec, 159 - 105 + 1);
 			continue;
 		}
 
  
 		if(vu_dsn[i] == 0 && vu_dsn_prev[i] == 1)  // voiced => unvoiced
 		{
-			s_ptr = (Word16 *)&ws[48];
-			L_ph_acc = ph_mem_prev[i];
+			L_ph_acc = v_cos_ph(cos_vec, ph_mem_prev[i], L_ph_step_prev, 55 - 0 + 1);   // j = 0..55
+			L_v_add_harm(L_snd, sa_prev3[i], cos_vec, 55 - 0 + 1);
 
-			for(j = 0; j <= 55; j++)
-			{
-				L_tmp = L_mult(sa_prev3[i], cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc += L_ph_step_prev;
-			}
-
-			for(j = 56; j <= 104; j++)
-			{
-				L_tmp = L_mult(*s_ptr--, sa_prev3[i]);
-				L_tmp = L_mpy_ls(L_tmp, cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc += L_ph_step_prev;
-			}
+			v_cos_ph(cos_vec, L_ph_acc, L_ph_step_prev, 104 - 56 + 1);                 // j = 56..104
+			L_v_add_harm_win(&L_snd[56], ws_r, sa_prev3[i], cos_vec, 104 - 56 + 1);
 			continue;
 		}
 
 		if(i >=7 || freq_flag)
 		{
-			s_ptr_aux     = (Word16 *)&ws[48];
-			L_ph_acc_aux  = ph_mem_prev[i];
+			// The fading out previous harmonic is added before the fading in
+			// current one, as the sample by sample loop did
+			L_ph_acc_aux = v_cos_ph(cos_vec, ph_mem_prev[i], L_ph_step_prev, 55 - 0 + 1);   // j = 0..55
+			L_v_add_harm(L_snd, sa_prev3[i], cos_vec, 55 - 0 + 1);
 
-			s_ptr    = (Word16 *)ws;
-			L_ph_acc = ph_mem[i] - (((L_ph_step >> 7) * 104) << 7);
+			v_cos_ph(cos_vec, L_ph_acc_aux, L_ph_step_prev, 104 - 56 + 1);                 // j = 56..104
+			L_v_add_harm_win(&L_snd[56], ws_r, sa_prev3[i], cos_vec, 104 - 56 + 1);
 
-			for(j = 0; j <= 55; j++)
-			{
-				L_tmp = L_mult(sa_prev3[i], cos_fxp(extract_h(L_ph_acc_aux)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc_aux += L_ph_step_prev;
-			}
-
-			for(j = 56; j <= 104; j++)
-			{
-				L_tmp = L_mult(*s_ptr_aux--, sa_prev3[i]);
-				L_tmp = L_mpy_ls(L_tmp, cos_fxp(extract_h(L_ph_acc_aux)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-
-				L_tmp = L_mult(*s_ptr++, sa[i]);
-				L_tmp = L_mpy_ls(L_tmp, cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-
-				L_ph_acc_aux += L_ph_step_prev;
-				L_ph_acc += L_ph_step;
-			}
+			L_ph_acc = ph_mem[i] - (((L_ph_step >> 7) * 104) << 7);
+			L_ph_acc = v_cos_ph(cos_vec, L_ph_acc, L_ph_step, 104 - 56 + 1);
+			L_v_add_harm_win(&L_snd[56], ws, sa[i], cos_vec, 104 - 56 + 1);
 
-			for(j = 105; j <= 159; j++)
-			{
-				L_tmp = L_mult(sa[i], cos_fxp(extract_h(L_ph_acc)));
-				L_tmp = L_shr(L_tmp, 1);
-				L_snd[j] = L_add(L_snd[j], L_tmp);
-				L_ph_acc += L_ph_step;
-			}
+			v_cos_ph(cos_vec, L_ph_acc, L_ph_step, 159 - 105 + 1);                         // j = 105..159
+			L_v_add_harm(&L_snd[105], sa[i], cos_vec, 159 - 105 + 1);
 			continue;
 		}
 	
@@ -227,17 +185,18 @@ void imbe_vocoder::v_synt(IMBE_PARAM *imbe_param, Word16 *snd)
 			L_ph_acc_aux = ((L_ph_step_aux >> 9) * j) << 9; 
 			L_ph_acc_aux = ((L_ph_acc_aux >> 9) * j) << 9; 
 
-			L_tmp = L_mpy_ls(L_amp_acc, cos_fxp(extract_h(L_ph_acc + L_ph_acc_aux)));			
-			L_snd[j] = L_add(L_snd[j], L_tmp);
+			ph_vec[j] = extract_h(L_ph_acc + L_ph_acc_aux);
 
-			L_amp_acc = L_add(L_amp_acc, L_amp_step);
 			L_ph_acc += L_ph_step_prev;
 			L_ph_acc += L_tmp1;
 		}
+
+		v_cos(cos_vec, ph_vec, 160);
+		L_v_ramp(L_amp, L_amp_acc, L_amp_step, 160);
+		L_v_add_mpy_ls(L_snd, L_amp, cos_vec, 160);
 	}
 
-	for(i = 0; i < FRAME; i++)
-		*snd++ = extract_h(L_snd[i]);
+	v_extract_h(snd, L_snd, FRAME);
 
 	v_zap(vu_dsn_prev, NUM_HARMS_MAX);
 	v_equ(vu_dsn_prev, imbe_param->v_uv_dsn, num_harms);
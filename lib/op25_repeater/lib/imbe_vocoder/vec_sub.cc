@@ -0,0 +1,521 @@
+/*
+ * Project 25 IMBE Encoder/Decoder Fixed-Point implementation
+ * Developed by Pavel Yazev E-mail: pyazev@gmail.com
+ * Version 1.0 (c) Copyright 2009
+ * 
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * The software is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "typedef.h"
+#include "basic_op.h"
+#include "imbe.h"
+#include "vec_sub.h"
+
+#include <stdint.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+//	Flag free scalar forms of the basic operators, used for the loop tails
+//	and on targets without SSE2.
+//-----------------------------------------------------------------------------
+static inline Word32 L_add_s(Word32 L_var1, Word32 L_var2)
+{
+	Word32 L_var_out = (Word32)((UWord32)L_var1 + (UWord32)L_var2);
+
+	if((((L_var1 ^ L_var2) & MIN_32) == 0) && ((L_var_out ^ L_var1) & MIN_32))
+		L_var_out = (L_var1 < 0) ? MIN_32 : MAX_32;
+	return L_var_out;
+}
+
+static inline Word32 L_sub_s(Word32 L_var1, Word32 L_var2)
+{
+	Word32 L_var_out = (Word32)((UWord32)L_var1 - (UWord32)L_var2);
+
+	if((((L_var1 ^ L_var2) & MIN_32) != 0) && ((L_var_out ^ L_var1) & MIN_32))
+		L_var_out = (L_var1 < 0) ? MIN_32 : MAX_32;
+	return L_var_out;
+}
+
+static inline Word32 L_deposit_h_s(Word16 var1)
+{
+	return (Word32)((UWord32)(UWord16)var1 << 16);
+}
+
+static inline Word16 round_s(Word32 L_var1)
+{
+	return (Word16)(L_add_s(L_var1, (Word32)0x00008000L) >> 16);
+}
+
+static inline Word32 L_mult_s(Word16 var1, Word16 var2)
+{
+	Word32 L_var_out = (Word32)var1 * (Word32)var2;
+
+	return (L_var_out != (Word32)0x40000000L) ? L_var_out * 2 : MAX_32;
+}
+
+static inline Word32 L_mpy_ls_s(Word32 L_var2, Word16 var1)
+{
+	Word32 L_var_out;
+
+	L_var_out = (var1 * (Word32)((L_var2 & 0xFFFF) >> 1) * 2) >> 15;
+	return L_add_s(L_var_out, L_mult_s(var1, (Word16)(L_var2 >> 16)));
+}
+
+#if defined(__SSE2__)
+//-----------------------------------------------------------------------------
+//	Four lane forms. 32 bit lanes hold Word32 values, or Word16 values in
+//	their low half with the high half zero where _mm_madd_epi16() is used
+//	as a 16 x 16 -> 32 bit multiply.
+//-----------------------------------------------------------------------------
+static inline __m128i L_add_x4(__m128i a, __m128i b)
+{
+	__m128i sum = _mm_add_epi32(a, b);
+	__m128i ovf = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum)), 31);
+	__m128i sat = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(MAX_32));
+
+	return _mm_or_si128(_mm_andnot_si128(ovf, sum), _mm_and_si128(ovf, sat));
+}
+
+static inline __m128i L_sub_x4(__m128i a, __m128i b)
+{
+	__m128i diff = _mm_sub_epi32(a, b);
+	__m128i ovf = _mm_srai_epi32(_mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, diff)), 31);
+	__m128i sat = _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(MAX_32));
+
+	return _mm_or_si128(_mm_andnot_si128(ovf, diff), _mm_and_si128(ovf, sat));
+}
+
+// L_mult() from the plain product var1 * var2
+static inline __m128i L_mult_x4(__m128i prod)
+{
+	return _mm_xor_si128(_mm_slli_epi32(prod, 1), _mm_cmpeq_epi32(prod, _mm_set1_epi32(0x40000000L)));
+}
+
+// Products of eight Word16 pairs, lanes 0..3 in lo and 4..7 in hi
+static inline void mul_x8(__m128i a, __m128i b, __m128i *lo, __m128i *hi)
+{
+	__m128i pl = _mm_mullo_epi16(a, b);
+	__m128i ph = _mm_mulhi_epi16(a, b);
+
+	*lo = _mm_unpacklo_epi16(pl, ph);
+	*hi = _mm_unpackhi_epi16(pl, ph);
+}
+
+// L_mpy_ls(L_var2, var1), var1 in the low half of each lane
+static inline __m128i L_mpy_ls_x4(__m128i L_var2, __m128i var1)
+{
+	__m128i lo = _mm_srli_epi32(_mm_slli_epi32(L_var2, 16), 17);
+	__m128i hi = _mm_srli_epi32(L_var2, 16);
+	__m128i L_tmp = _mm_srai_epi32(_mm_slli_epi32(_mm_madd_epi16(var1, lo), 1), 15);
+
+	return L_add_x4(L_tmp, L_mult_x4(_mm_madd_epi16(var1, hi)));
+}
+#endif
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a constant amplitude harmonic into a 32 bit signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		amp       - Harmonic amplitude
+//		cos_vec   - Harmonic waveform, see v_cos_ph()
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i], L_shr(L_mult(amp, cos_vec[i]), 1))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_harm(Word32 *L_vec, Word16 amp, const Word16 *cos_vec, Word16 n)
+{
+	Word16 i = 0;
+
+#if defined(__SSE2__)
+	__m128i a = _mm_set1_epi16(amp), lo, hi;
+
+	for(; i + 8 <= n; i += 8)
+	{
+		mul_x8(a, _mm_loadu_si128((const __m128i *)&cos_vec[i]), &lo, &hi);
+		lo = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i]), _mm_srai_epi32(L_mult_x4(lo), 1));
+		hi = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i + 4]), _mm_srai_epi32(L_mult_x4(hi), 1));
+		_mm_storeu_si128((__m128i *)&L_vec[i], lo);
+		_mm_storeu_si128((__m128i *)&L_vec[i + 4], hi);
+	}
+#endif
+	for(; i < n; i++)
+		L_vec[i] = L_add_s(L_vec[i], L_mult_s(amp, cos_vec[i]) >> 1);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a windowed harmonic into a 32 bit signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		win       - Pointer to the window
+//		amp       - Harmonic amplitude
+//		cos_vec   - Harmonic waveform, see v_cos_ph()
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i],
+//		                 L_shr(L_mpy_ls(L_mult(win[i], amp), cos_vec[i]), 1))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_harm_win(Word32 *L_vec, const Word16 *win, Word16 amp, const Word16 *cos_vec, Word16 n)
+{
+	Word16 i = 0;
+
+#if defined(__SSE2__)
+	__m128i a = _mm_set1_epi16(amp), z = _mm_setzero_si128(), lo, hi, c;
+
+	for(; i + 8 <= n; i += 8)
+	{
+		mul_x8(_mm_loadu_si128((const __m128i *)&win[i]), a, &lo, &hi);
+		c  = _mm_loadu_si128((const __m128i *)&cos_vec[i]);
+		lo = L_mpy_ls_x4(L_mult_x4(lo), _mm_unpacklo_epi16(c, z));
+		hi = L_mpy_ls_x4(L_mult_x4(hi), _mm_unpackhi_epi16(c, z));
+		lo = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i]), _mm_srai_epi32(lo, 1));
+		hi = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i + 4]), _mm_srai_epi32(hi, 1));
+		_mm_storeu_si128((__m128i *)&L_vec[i], lo);
+		_mm_storeu_si128((__m128i *)&L_vec[i + 4], hi);
+	}
+#endif
+	for(; i < n; i++)
+		L_vec[i] = L_add_s(L_vec[i], L_mpy_ls_s(L_mult_s(win[i], amp), cos_vec[i]) >> 1);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a harmonic with a per sample 32 bit amplitude into a 32 bit
+//      signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		L_amp     - Pointer to the amplitudes
+//		cos_vec   - Harmonic waveform
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i], L_mpy_ls(L_amp[i], cos_vec[i]))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_mpy_ls(Word32 *L_vec, const Word32 *L_amp, const Word16 *cos_vec, Word16 n)
+{
+	Word16 i = 0;
+
+#if defined(__SSE2__)
+	__m128i z = _mm_setzero_si128(), lo, hi, c;
+
+	for(; i + 8 <= n; i += 8)
+	{
+		c  = _mm_loadu_si128((const __m128i *)&cos_vec[i]);
+		lo = L_mpy_ls_x4(_mm_loadu_si128((const __m128i *)&L_amp[i]), _mm_unpacklo_epi16(c, z));
+		hi = L_mpy_ls_x4(_mm_loadu_si128((const __m128i *)&L_amp[i + 4]), _mm_unpackhi_epi16(c, z));
+		lo = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i]), lo);
+		hi = L_add_x4(_mm_loadu_si128((const __m128i *)&L_vec[i + 4]), hi);
+		_mm_storeu_si128((__m128i *)&L_vec[i], lo);
+		_mm_storeu_si128((__m128i *)&L_vec[i + 4], hi);
+	}
+#endif
+	for(; i < n; i++)
+		L_vec[i] = L_add_s(L_vec[i], L_mpy_ls_s(L_amp[i], cos_vec[i]));
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Fill a vector with a saturating 32 bit ramp
+//
+//  INPUT:
+//		L_start   - First value
+//		L_step    - Increment
+//      n         - size of L_vec
+//
+//	OUTPUT:
+//		L_vec[0] = L_start, L_vec[i] = L_add(L_vec[i - 1], L_step)
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_ramp(Word32 *L_vec, Word32 L_start, Word32 L_step, Word16 n)
+{
+	Word16 i;
+	int64_t acc;
+
+	// With a constant step the ramp only ever saturates towards the sign of
+	// the step and then stays there, so each element is the clipped exact
+	// value and no element depends on the one before it.
+	for(i = 0; i < n; i++)
+	{
+		acc = (int64_t)L_start + (int64_t)i * L_step;
+		L_vec[i] = (acc > MAX_32) ? MAX_32 : (acc < MIN_32) ? MIN_32 : (Word32)acc;
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Take the high words of a 32 bit vector
+//
+//  INPUT:
+//		L_vec     - Pointer to the source vector
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = extract_h(L_vec[i])
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_extract_h(Word16 *vec, const Word32 *L_vec, Word16 n)
+{
+	Word16 i = 0;
+
+#if defined(__SSE2__)
+	for(; i + 8 <= n; i += 8)
+		_mm_storeu_si128((__m128i *)&vec[i],
+		                 _mm_packs_epi32(_mm_srai_epi32(_mm_loadu_si128((const __m128i *)&L_vec[i]), 16),
+		                                 _mm_srai_epi32(_mm_loadu_si128((const __m128i *)&L_vec[i + 4]), 16)));
+#endif
+	for(; i < n; i++)
+		vec[i] = (Word16)(L_vec[i] >> 16);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Copy the real parts of a complex vector with a saturating left shift
+//
+//  INPUT:
+//		cvec      - Pointer to the complex source vector
+//		scale     - left shift factor, 0 to 15
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = shl(cvec[i].re, scale)
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_re_shl(Word16 *vec, const Cmplx16 *cvec, Word16 scale, Word16 n)
+{
+	Word16 i = 0;
+	Word32 tmp;
+
+#if defined(__SSE2__)
+	__m128i sh = _mm_cvtsi32_si128(scale), lo, hi;
+
+	// re is the low half of each 32 bit Cmplx16, _mm_packs_epi32() saturates
+	for(; i + 8 <= n; i += 8)
+	{
+		lo = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)&cvec[i]), 16), 16);
+		hi = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128((const __m128i *)&cvec[i + 4]), 16), 16);
+		_mm_storeu_si128((__m128i *)&vec[i], _mm_packs_epi32(_mm_sll_epi32(lo, sh), _mm_sll_epi32(hi, sh)));
+	}
+#endif
+	for(; i < n; i++)
+	{
+		tmp = (Word32)cvec[i].re << scale;
+		vec[i] = (tmp > MAX_16) ? MAX_16 : (tmp < MIN_16) ? MIN_16 : (Word16)tmp;
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Weighted overlap add of two 16 bit vectors
+//
+//  INPUT:
+//		vec1, win1 - First signal and its window
+//		vec2, win2 - Second signal and its window
+//      n          - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = extract_h(L_add(L_mult(vec1[i], win1[i]), L_mult(vec2[i], win2[i])))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_wola(Word16 *vec, const Word16 *vec1, const Word16 *win1, const Word16 *vec2, const Word16 *win2, Word16 n)
+{
+	Word16 i = 0;
+
+#if defined(__SSE2__)
+	__m128i lo1, hi1, lo2, hi2;
+
+	for(; i + 8 <= n; i += 8)
+	{
+		mul_x8(_mm_loadu_si128((const __m128i *)&vec1[i]), _mm_loadu_si128((const __m128i *)&win1[i]), &lo1, &hi1);
+		mul_x8(_mm_loadu_si128((const __m128i *)&vec2[i]), _mm_loadu_si128((const __m128i *)&win2[i]), &lo2, &hi2);
+		lo1 = _mm_srai_epi32(L_add_x4(L_mult_x4(lo1), L_mult_x4(lo2)), 16);
+		hi1 = _mm_srai_epi32(L_add_x4(L_mult_x4(hi1), L_mult_x4(hi2)), 16);
+		_mm_storeu_si128((__m128i *)&vec[i], _mm_packs_epi32(lo1, hi1));
+	}
+#endif
+	for(; i < n; i++)
+		vec[i] = (Word16)(L_add_s(L_mult_s(vec1[i], win1[i]), L_mult_s(vec2[i], win2[i])) >> 16);
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Radix 2 butterflies of one FFT stage, in the fixed point form
+//      used by fft(): t = b[k] * w[k], b[k] = a[k] - t, a[k] = a[k] + t,
+//      with the products and sums halved and rounded back to 16 bit
+//
+//  INPUT:
+//		a, b      - Pointers to the two halves of a butterfly group
+//		wr, wi    - Pointers to the twiddle factors, Q1.15
+//      n         - number of butterflies
+//
+//	OUTPUT:
+//		a and b updated in place
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_fft_bfly(Cmplx16 *a, Cmplx16 *b, const Word16 *wr, const Word16 *wi, Word16 n)
+{
+	Word16 k = 0;
+	Word32 L_tempr, L_tempi, L_temp1;
+
+	// The halved products are below 2^30 in magnitude, so L_tempr and
+	// L_tempi are formed without saturation. The final sums can saturate.
+#if defined(__SSE2__)
+	__m128i rnd = _mm_set1_epi32(0x8000L), mask_h = _mm_set1_epi32((int)0xFFFF0000L);
+	__m128i w, vwr, vwi, wr_l, wr_h, wi_l, wi_h, va, vb, tr, ti, ar, ai, xr, xi;
+
+	// Each 32 bit lane is one Cmplx16, re in the low half. _mm_madd_epi16()
+	// against a lane holding the twiddle in one half and zero in the other
+	// picks out the product with re or with im.
+	for(; k + 4 <= n; k += 4)
+	{
+		w    = _mm_loadl_epi64((const __m128i *)&wr[k]);
+		vwr  = _mm_unpacklo_epi16(w, w);
+		w    = _mm_loadl_epi64((const __m128i *)&wi[k]);
+		vwi  = _mm_unpacklo_epi16(w, w);
+		wr_l = _mm_srli_epi32(_mm_slli_epi32(vwr, 16), 16);
+		wr_h = _mm_slli_epi32(vwr, 16);
+		wi_l = _mm_srli_epi32(_mm_slli_epi32(vwi, 16), 16);
+		wi_h = _mm_slli_epi32(vwi, 16);
+
+		va = _mm_loadu_si128((const __m128i *)&a[k]);
+		vb = _mm_loadu_si128((const __m128i *)&b[k]);
+
+		// tempr = wr * b.re - wi * b.im, tempi = wr * b.im + wi * b.re
+		tr = _mm_sub_epi32(_mm_srai_epi32(L_mult_x4(_mm_madd_epi16(wr_l, vb)), 1),
+		                   _mm_srai_epi32(L_mult_x4(_mm_madd_epi16(wi_h, vb)), 1));
+		ti = _mm_add_epi32(_mm_srai_epi32(L_mult_x4(_mm_madd_epi16(wr_h, vb)), 1),
+		                   _mm_srai_epi32(L_mult_x4(_mm_madd_epi16(wi_l, vb)), 1));
+
+		// a.re and a.im as Q1.31 halved
+		ar = _mm_srai_epi32(_mm_slli_epi32(va, 16), 1);
+		ai = _mm_srai_epi32(_mm_and_si128(va, mask_h), 1);
+
+		xr = _mm_srli_epi32(L_add_x4(L_sub_x4(ar, tr), rnd), 16);
+		xi = _mm_and_si128(L_add_x4(L_sub_x4(ai, ti), rnd), mask_h);
+		_mm_storeu_si128((__m128i *)&b[k], _mm_or_si128(xr, xi));
+
+		xr = _mm_srli_epi32(L_add_x4(L_add_x4(ar, tr), rnd), 16);
+		xi = _mm_and_si128(L_add_x4(L_add_x4(ai, ti), rnd), mask_h);
+		_mm_storeu_si128((__m128i *)&a[k], _mm_or_si128(xr, xi));
+	}
+#endif
+	for(; k < n; k++)
+	{
+		L_tempr = (L_mult_s(wr[k], b[k].re) >> 1) - (L_mult_s(wi[k], b[k].im) >> 1);
+		L_tempi = (L_mult_s(wr[k], b[k].im) >> 1) + (L_mult_s(wi[k], b[k].re) >> 1);
+
+		L_temp1 = L_deposit_h_s(a[k].re) >> 1;
+		b[k].re = round_s(L_sub_s(L_temp1, L_tempr));
+		a[k].re = round_s(L_add_s(L_temp1, L_tempr));
+
+		L_temp1 = L_deposit_h_s(a[k].im) >> 1;
+		b[k].im = round_s(L_sub_s(L_temp1, L_tempi));
+		a[k].im = round_s(L_add_s(L_temp1, L_tempi));
+	}
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Sum of L_shr(L_mult(vec1[i], vec2[i]), shift) without saturation.
+//      The caller guarantees the sum fits in 32 bits, which makes the
+//      result the same as accumulating with L_add().
+//
+//  INPUT:
+//		vec1      - Pointer to the first vector
+//		vec2      - Pointer to the second vector
+//		shift     - right shift factor, 1 to 31
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		None
+//
+//	RETURN:
+//		The sum 
+//
+//-----------------------------------------------------------------------------
+Word32 L_v_mac_shr(const Word16 *vec1, const Word16 *vec2, Word16 shift, Word16 n)
+{
+	Word32 sum = 0;
+	Word16 i;
+
+	for(i = 0; i < n; i++)
+		sum += L_mult_s(vec1[i], vec2[i]) >> shift;
+	return sum;
+}
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Sum of mult(vec1[i], vec2[i]) without saturation, see L_v_mac_shr()
+//
+//  INPUT:
+//		vec1      - Pointer to the first vector
+//		vec2      - Pointer to the second vector
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		None
+//
+//	RETURN:
+//		The sum 
+//
+//-----------------------------------------------------------------------------
+Word32 L_v_mult_sum(const Word16 *vec1, const Word16 *vec2, Word16 n)
+{
+	Word32 sum = 0, tmp;
+	Word16 i;
+
+	for(i = 0; i < n; i++)
+	{
+		tmp = ((Word32)vec1[i] * vec2[i]) >> 15;
+		sum += (tmp > MAX_16) ? MAX_16 : tmp;
+	}
+	return sum;
+}
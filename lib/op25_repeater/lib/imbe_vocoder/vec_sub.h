@@ -0,0 +1,226 @@
+/*
+ * Project 25 IMBE Encoder/Decoder Fixed-Point implementation
+ * Developed by Pavel Yazev E-mail: pyazev@gmail.com
+ * Version 1.0 (c) Copyright 2009
+ * 
+ * This is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3, or (at your option)
+ * any later version.
+ * 
+ * The software is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this; see the file COPYING.  If not, write to the Free
+ * Software Foundation, Inc., 51 Franklin Street, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#ifndef _VEC_SUB
+#define _VEC_SUB
+
+//
+// Block versions of the basic_op.h operators used by the synthesis and
+// spectral amplitude decoding loops. Each routine gives exactly the same
+// result as the element by element expression shown for it, including
+// saturation, but works on whole vectors so the compiler can keep them in
+// SIMD registers (SSE2 where available, plain C elsewhere). None of them
+// touch the Overflow or Carry flags.
+//
+
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a constant amplitude harmonic into a 32 bit signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		amp       - Harmonic amplitude
+//		cos_vec   - Harmonic waveform, see v_cos_ph()
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i], L_shr(L_mult(amp, cos_vec[i]), 1))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_harm(Word32 *L_vec, Word16 amp, const Word16 *cos_vec, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a windowed harmonic into a 32 bit signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		win       - Pointer to the window
+//		amp       - Harmonic amplitude
+//		cos_vec   - Harmonic waveform, see v_cos_ph()
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i],
+//		                 L_shr(L_mpy_ls(L_mult(win[i], amp), cos_vec[i]), 1))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_harm_win(Word32 *L_vec, const Word16 *win, Word16 amp, const Word16 *cos_vec, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Add a harmonic with a per sample 32 bit amplitude into a 32 bit
+//      signal
+//
+//  INPUT:
+//		L_vec     - Pointer to the signal
+//		L_amp     - Pointer to the amplitudes
+//		cos_vec   - Harmonic waveform
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		L_vec[i] = L_add(L_vec[i], L_mpy_ls(L_amp[i], cos_vec[i]))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_add_mpy_ls(Word32 *L_vec, const Word32 *L_amp, const Word16 *cos_vec, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Fill a vector with a saturating 32 bit ramp
+//
+//  INPUT:
+//		L_start   - First value
+//		L_step    - Increment
+//      n         - size of L_vec
+//
+//	OUTPUT:
+//		L_vec[0] = L_start, L_vec[i] = L_add(L_vec[i - 1], L_step)
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void L_v_ramp(Word32 *L_vec, Word32 L_start, Word32 L_step, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Take the high words of a 32 bit vector
+//
+//  INPUT:
+//		L_vec     - Pointer to the source vector
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = extract_h(L_vec[i])
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_extract_h(Word16 *vec, const Word32 *L_vec, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Copy the real parts of a complex vector with a saturating left shift
+//
+//  INPUT:
+//		cvec      - Pointer to the complex source vector
+//		scale     - left shift factor, 0 to 15
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = shl(cvec[i].re, scale)
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_re_shl(Word16 *vec, const Cmplx16 *cvec, Word16 scale, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Weighted overlap add of two 16 bit vectors
+//
+//  INPUT:
+//		vec1, win1 - First signal and its window
+//		vec2, win2 - Second signal and its window
+//      n          - size of vectors
+//
+//	OUTPUT:
+//		vec[i] = extract_h(L_add(L_mult(vec1[i], win1[i]), L_mult(vec2[i], win2[i])))
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_wola(Word16 *vec, const Word16 *vec1, const Word16 *win1, const Word16 *vec2, const Word16 *win2, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Radix 2 butterflies of one FFT stage, in the fixed point form
+//      used by fft(): t = b[k] * w[k], b[k] = a[k] - t, a[k] = a[k] + t,
+//      with the products and sums halved and rounded back to 16 bit
+//
+//  INPUT:
+//		a, b      - Pointers to the two halves of a butterfly group
+//		wr, wi    - Pointers to the twiddle factors, Q1.15
+//      n         - number of butterflies
+//
+//	OUTPUT:
+//		a and b updated in place
+//
+//	RETURN:
+//		None 
+//
+//-----------------------------------------------------------------------------
+void v_fft_bfly(Cmplx16 *a, Cmplx16 *b, const Word16 *wr, const Word16 *wi, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Sum of L_shr(L_mult(vec1[i], vec2[i]), shift) without saturation.
+//      The caller guarantees the sum fits in 32 bits, which makes the
+//      result the same as accumulating with L_add().
+//
+//  INPUT:
+//		vec1      - Pointer to the first vector
+//		vec2      - Pointer to the second vector
+//		shift     - right shift factor, 1 to 31
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		None
+//
+//	RETURN:
+//		The sum 
+//
+//-----------------------------------------------------------------------------
+Word32 L_v_mac_shr(const Word16 *vec1, const Word16 *vec2, Word16 shift, Word16 n);
+
+//-----------------------------------------------------------------------------
+//	PURPOSE:
+//		Sum of mult(vec1[i], vec2[i]) without saturation, see L_v_mac_shr()
+//
+//  INPUT:
+//		vec1      - Pointer to the first vector
+//		vec2      - Pointer to the second vector
+//      n         - size of vectors
+//
+//	OUTPUT:
+//		None
+//
+//	RETURN:
+//		The sum 
+//
+//-----------------------------------------------------------------------------
+Word32 L_v_mult_sum(const Word16 *vec1, const Word16 *vec2, Word16 n);
+
+#endif
@@ -7,29 +7,31 @@
 static inline uint32_t
 golay_24_encode(uint32_t code_word_in)
 {
-   static const uint32_t encoding[12] = {
-      040006165,
-      020003073,
-      010007550,
-      04003664,
-      02001732,
-      01006631,
-      0403315,
-      0201547,
-      0106706,
-      045227,
-      024476,
-      014353
+   // the code is linear, so the codeword is the xor of the codewords of
+   // the upper and lower six data bits
+   static const uint32_t encoding_hi[64] = {
+      0x000000, 0x040d99, 0x0803da, 0x0c0e43, 0x1007b4, 0x140a2d, 0x18046e, 0x1c09f7,
+      0x200f68, 0x2402f1, 0x280cb2, 0x2c012b, 0x3008dc, 0x340545, 0x380b06, 0x3c069f,
+      0x40063b, 0x440ba2, 0x4805e1, 0x4c0878, 0x50018f, 0x540c16, 0x580255, 0x5c0fcc,
+      0x600953, 0x6404ca, 0x680a89, 0x6c0710, 0x700ee7, 0x74037e, 0x780d3d, 0x7c00a4,
+      0x800c75, 0x8401ec, 0x880faf, 0x8c0236, 0x900bc1, 0x940658, 0x98081b, 0x9c0582,
+      0xa0031d, 0xa40e84, 0xa800c7, 0xac0d5e, 0xb004a9, 0xb40930, 0xb80773, 0xbc0aea,
+      0xc00a4e, 0xc407d7, 0xc80994, 0xcc040d, 0xd00dfa, 0xd40063, 0xd80e20, 0xdc03b9,
+      0xe00526, 0xe408bf, 0xe806fc, 0xec0b65, 0xf00292, 0xf40f0b, 0xf80148, 0xfc0cd1
    };
 
-	uint32_t code_word_out = 0;
-	for(uint16_t i = 0; i < 12; i++) {
-		uint32_t temp_word = code_word_in & (1 << (11 - i));
-		if(temp_word >= 1) {
-			code_word_out = code_word_out ^ encoding[i];
-		}
-	}
-	return(code_word_out);
+   static const uint32_t encoding_lo[64] = {
+      0x000000, 0x0018eb, 0x00293e, 0x0031d5, 0x004a97, 0x00527c, 0x0063a9, 0x007b42,
+      0x008dc6, 0x00952d, 0x00a4f8, 0x00bc13, 0x00c751, 0x00dfba, 0x00ee6f, 0x00f684,
+      0x010367, 0x011b8c, 0x012a59, 0x0132b2, 0x0149f0, 0x01511b, 0x0160ce, 0x017825,
+      0x018ea1, 0x01964a, 0x01a79f, 0x01bf74, 0x01c436, 0x01dcdd, 0x01ed08, 0x01f5e3,
+      0x0206cd, 0x021e26, 0x022ff3, 0x023718, 0x024c5a, 0x0254b1, 0x026564, 0x027d8f,
+      0x028b0b, 0x0293e0, 0x02a235, 0x02bade, 0x02c19c, 0x02d977, 0x02e8a2, 0x02f049,
+      0x0305aa, 0x031d41, 0x032c94, 0x03347f, 0x034f3d, 0x0357d6, 0x036603, 0x037ee8,
+      0x03886c, 0x039087, 0x03a152, 0x03b9b9, 0x03c2fb, 0x03da10, 0x03ebc5, 0x03f32e
+   };
+
+   return encoding_hi[(code_word_in >> 6) & 0x3f] ^ encoding_lo[code_word_in & 0x3f];
 }
 
 /* APCO Golay(23,11,7) ecoder.
@@ -44,17 +46,39 @@ golay_23_encode(uint32_t code_word_in)
 	return golay_24_encode(code_word_in) >> 1;
 }
 
+/* Remainder of a pattern of up to 23 bits divided by the Golay generator
+ * polynomial 0xC75. The remainder is linear in the pattern, so the bits
+ * above the 11 bit remainder are reduced through two 64 entry tables
+ * instead of one polynomial division step per bit.
+ */
 static inline uint32_t
 golay_23_syndrome(uint32_t pattern)
 {
-   uint32_t aux = 0x400000;
-   while(pattern & 0xFFFFF800) {
-      while((aux & pattern) == 0) {
-         aux >>= 1;
-      }
-      pattern ^= (aux >> 11) * 0xC75;
-   }
-   return  pattern;
+   // (bits 11..16) * x^11 mod g(x)
+   static const uint16_t syndrome_lo[64] = {
+      0x000, 0x475, 0x49f, 0x0ea, 0x54b, 0x13e, 0x1d4, 0x5a1,
+      0x6e3, 0x296, 0x27c, 0x609, 0x3a8, 0x7dd, 0x737, 0x342,
+      0x1b3, 0x5c6, 0x52c, 0x159, 0x4f8, 0x08d, 0x067, 0x412,
+      0x750, 0x325, 0x3cf, 0x7ba, 0x21b, 0x66e, 0x684, 0x2f1,
+      0x366, 0x713, 0x7f9, 0x38c, 0x62d, 0x258, 0x2b2, 0x6c7,
+      0x585, 0x1f0, 0x11a, 0x56f, 0x0ce, 0x4bb, 0x451, 0x024,
+      0x2d5, 0x6a0, 0x64a, 0x23f, 0x79e, 0x3eb, 0x301, 0x774,
+      0x436, 0x043, 0x0a9, 0x4dc, 0x17d, 0x508, 0x5e2, 0x197
+   };
+
+   // (bits 17..22) * x^17 mod g(x)
+   static const uint16_t syndrome_hi[64] = {
+      0x000, 0x6cc, 0x1ed, 0x721, 0x3da, 0x516, 0x237, 0x4fb,
+      0x7b4, 0x178, 0x659, 0x095, 0x46e, 0x2a2, 0x583, 0x34f,
+      0x31d, 0x5d1, 0x2f0, 0x43c, 0x0c7, 0x60b, 0x12a, 0x7e6,
+      0x4a9, 0x265, 0x544, 0x388, 0x773, 0x1bf, 0x69e, 0x052,
+      0x63a, 0x0f6, 0x7d7, 0x11b, 0x5e0, 0x32c, 0x40d, 0x2c1,
+      0x18e, 0x742, 0x063, 0x6af, 0x254, 0x498, 0x3b9, 0x575,
+      0x527, 0x3eb, 0x4ca, 0x206, 0x6fd, 0x031, 0x710, 0x1dc,
+      0x293, 0x45f, 0x37e, 0x5b2, 0x149, 0x785, 0x0a4, 0x668
+   };
+
+   return (pattern & 0x7ff) ^ syndrome_lo[(pattern >> 11) & 0x3f] ^ syndrome_hi[(pattern >> 17) & 0x3f];
 }
 /* APCO Golay(23,11,7) decoder.
  *
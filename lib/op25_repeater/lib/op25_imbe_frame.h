@@ -1,6 +1,7 @@
 #ifndef INCLUDED_IMBE_FRAME_H
 #define INCLUDED_IMBE_FRAME_H
 
+#include "bit_array.h"
 #include "op25_yank.h"
 #include "op25_golay.h"
 #include "op25_hamming.h"
@@ -9,10 +10,7 @@
 #include <stdint.h>
 #include <vector>
 
-typedef std::vector<bool> voice_codeword;
 typedef std::vector<uint8_t> packed_codeword;
-typedef const std::vector<bool> const_bit_vector;
-typedef std::vector<bool> bit_vector;
 
 static const uint16_t hdu_codeword_bits[658] = {   // 329 symbols = 324 + 5 pad
  114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 
@@ -236,8 +234,8 @@ static const uint16_t voice_codeword_bits[nof_voice_codewords][voice_codeword_sz
 /*
  * Convert bit vector to hex dump format and print
  */
-static inline void
-dump_cw(const voice_codeword& cw, int len, FILE* fp)  // len in bytes
+template <class X> static inline void
+dump_cw(const X& cw, int len, FILE* fp)  // len in bytes
 {
         int i, j;
         for (i = 0; i < len; i++){
@@ -256,10 +254,7 @@ dump_cw(const voice_codeword& cw, int len, FILE* fp)  // len in bytes
 static inline void
 imbe_store_bits(voice_codeword& cw, int s, int l, uint32_t v)
 {
-	for (int i = l-1; i >= s; i--) {
-		cw[i] = v & 1;
-		v >>= 1;
-	}
+	cw.insert(s, l, v);
 }
 
 static inline uint32_t
@@ -426,18 +421,14 @@ imbe_header_encode(voice_codeword& cw, uint32_t u0, uint32_t u1, uint32_t u2, ui
 static inline void
 imbe_deinterleave (const_bit_vector& frame_body, voice_codeword& cw, uint32_t frame_nr)
 {
-      for(size_t j = 0; j < voice_codeword_sz; ++j) {
-         cw[j] = frame_body[voice_codeword_bits[frame_nr][j]];
-      }
+      cw.gather(frame_body, voice_codeword_bits[frame_nr], voice_codeword_sz);
 }
 
 
 static inline void
 imbe_interleave(bit_vector& frame_body, const voice_codeword& cw, uint32_t frame_nr)
 {
-      for(size_t j = 0; j < voice_codeword_sz; ++j) {
-         frame_body[voice_codeword_bits[frame_nr][j]] = cw[j];
-      }
+      cw.scatter(frame_body, voice_codeword_bits[frame_nr], voice_codeword_sz);
 }
 
 static inline void
@@ -469,7 +460,7 @@ imbe_frame_unpack(uint8_t *A, uint32_t& u0, uint32_t& u1, uint32_t& u2, uint32_t
  * 3. FIXME: track decoding error rates and stats
  */
 static inline void
-imbe_regenerate_frame(bit_vector& cw) {
+imbe_regenerate_frame(voice_codeword& cw) {
         unsigned int u0 = 0;
         unsigned int u1,u2,u3,u4,u5,u6,u7;
         unsigned int E0 = 0;
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <algorithm>
 
+#include "bit_array.h"
+
 /**
  * Yank in[bits[0]..bits[bits_sz]) to out[where,where+bits_sz).
  *
@@ -114,4 +116,39 @@ uint64_t extract(const X& in, const size_t bits[], size_t bits_sz)
    return x;
 }
 
+/**
+ * Extract a bit_array in[begin,end) to an octet buffer, a word at a time.
+ *
+ * \param in A const reference to the source.
+ * \param begin The offset of the first bit to extract (the MSB).
+ * \param end The offset of the end bit.
+ * \param out Address of the octet buffer to write into.
+ * \return The number of octets written.
+ */
+template<size_t N>
+size_t extract(const bit_array<N>& in, int begin, int end, uint8_t *out)
+{
+   const size_t out_sz = (7 + end - begin) / 8;
+   for(size_t j = 0; j < out_sz; ++j) {
+      const int b = begin + j * 8;
+      const int len = std::min(8, end - b);
+      out[j] = in.extract(b, b + len) << (8 - len);
+   }
+   return out_sz;
+}
+
+/**
+ * Extract value of bits from a bit_array in[begin,end), at most 64 bits.
+ *
+ * \param in The input bit_array.
+ * \param begin The offset of the first bit to extract (the MSB).
+ * \param end The offset of the end bit.
+ * \return A uint64_t containing the value
+ */
+template<size_t N>
+uint64_t extract(const bit_array<N>& in, int begin, int end)
+{
+   return in.extract(begin, end);
+}
+
 #endif // INCLUDED_SWAB_H
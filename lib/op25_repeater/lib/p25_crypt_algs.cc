@@ -205,6 +205,7 @@ void p25_crypt_algs::adp_keystream_gen() {
 
     i = j = 0;
 
+    adp_keystream.resize(469);
     for (k = 0; k < 469; ++k) {
         i = (i + 1) & 0xFF;
         j = (j + S[i]) & 0xFF;
@@ -51,7 +51,7 @@ class p25_crypt_algs
         uint8_t d_mi[9];
         std::unordered_map<uint16_t, key_info> d_keys;
         std::unordered_map<uint16_t, key_info>::const_iterator d_key_iter;
-        uint8_t adp_keystream[469];
+        std::vector<uint8_t> adp_keystream;    // only allocated once an ADP call is seen
         uint32_t d_adp_position;
 
         bool adp_process(packed_codeword& PCW, frame_type fr_type, int voice_subframe);
@@ -67,6 +67,7 @@ class p25_crypt_algs
         bool process(packed_codeword& PCW, frame_type fr_type, int voice_subframe);
         void reset(void);
         inline void set_debug(int debug) {d_debug = debug;}
+        inline size_t memory_usage() const {return sizeof(*this) + adp_keystream.capacity();}
 };
 
 #endif /* INCLUDED_OP25_REPEATER_P25_CRYPT_ALGS_H  */
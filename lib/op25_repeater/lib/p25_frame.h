@@ -21,10 +21,9 @@
 #ifndef INCLUDED_P25_FRAME_H
 #define INCLUDED_P25_FRAME_H 1
 
-#include <vector>
+#include "bit_array.h"
 #include "frame_sync_magics.h"
 
-typedef std::vector<bool> bit_vector;
 namespace gr {
   namespace op25_repeater {
 static const size_t P25_VOICE_FRAME_SIZE = 1728;
@@ -38,23 +37,11 @@ static const size_t P25_HEADER_BITS = P25_HEADER_SYMBOLS * 2;
  */
 static inline void
 p25_setup_frame_header(bit_vector& frame_body, uint64_t hw) {
-	uint64_t acc = P25_FRAME_SYNC_MAGIC;
-	for (int i=47; i>=0; i--) {
-		frame_body[ i ] = acc & 1;
-		acc >>= 1;
-	}
-	acc = hw;
-	for (int i=113; i>=72; i--) {
-		frame_body[ i ] = acc & 1;
-		acc >>= 1;
-	}
+	frame_body.insert(0, 48, P25_FRAME_SYNC_MAGIC);
+	frame_body.insert(72, 114, hw);
 	// FIXME: insert proper status dibit bits at 70, 71
-	frame_body[70] = 1;
-	frame_body[71] = 0;
-	for (int i=69; i>=48; i--) {
-		frame_body[ i ] = acc & 1;
-		acc >>= 1;
-	}
+	frame_body.insert(70, 72, 2);
+	frame_body.insert(48, 70, hw >> 42);
 }
 
   } // namespace op25_repeater
@@ -145,6 +145,46 @@ static const int MAX_IN = 1;	// maximum number of input streams
       p2tdma.set_voice_codec_callback(cb, user_data);
     }
 
+    void p25_frame_assembler_impl::set_defer_vocoding(bool defer) {
+      p1fdma.set_defer_vocoding(defer);
+    }
+
+    size_t p25_frame_assembler_impl::memory_usage(void) {
+      return sizeof(*this) - sizeof(p1fdma) - sizeof(p2tdma) + p1fdma.memory_usage() + p2tdma.memory_usage();
+    }
+
+    // Tags each deferred voice frame whose silent stand-in went out in this
+    // call, at the stand-in's first sample. popped is where the output queue
+    // stood before the call.
+    void p25_frame_assembler_impl::tag_deferred_frames(size_t popped, int amt_produce) {
+      std::deque<deferred_imbe_frame> &frames = p1fdma.get_deferred_frames();
+      while (!frames.empty()) {
+        const deferred_imbe_frame &f = frames.front();
+        const ptrdiff_t offset = (ptrdiff_t)(f.pos - popped);
+        if (offset >= amt_produce)
+          break;
+        if (offset >= 0) { // frames whose stand-in was dropped are discarded
+          const uint32_t params[10] = {f.u[0], f.u[1], f.u[2], f.u[3], f.u[4], f.u[5], f.u[6], f.u[7], f.E0, f.ET};
+          add_item_tag(0, nitems_written(0) + offset, pmt::intern("imbe"), pmt::init_u32vector(10, params), d_tag_src);
+        }
+        frames.pop_front();
+      }
+    }
+
+    // Remembers where in the output queue a TDU arrived, and the error
+    // counts up to it. The terminate tag goes out with the call that pops the
+    // last sample queued before the TDU.
+    void p25_frame_assembler_impl::queue_terminate(const std::pair<bool,long> &terminate_call) {
+      if (!d_do_audio_output)
+        return;
+      pending_terminate t;
+      t.pos = output_queue.popped() + terminate_call.second;
+      t.status = p1fdma.get_rx_status();
+      if (t.status.total_len > 0)
+        p1fdma.reset_rx_status();
+      d_terminates.push_back(t);
+    }
+
 void p25_frame_assembler_impl::send_grp_src_id() {
           long tdma_src_id = -1;
           long tdma_grp_id = -1;
@@ -192,14 +232,23 @@ p25_frame_assembler_impl::general_work (int noutput_items,
 
   const uint8_t *in = (const uint8_t *) input_items[0];
   std::pair<bool,long> terminate_call = std::make_pair(false, 0);
+  bool terminate = false;
+  Rx_Status status = {};
+
+  // decode no more than the audio queue has room for, the rest waits for the next call
+  const int nsyms = (d_do_audio_output) ? audio_queue_budget(output_queue, ninput_items[0]) : ninput_items[0];
 
-  p1fdma.rx_sym(in, ninput_items[0]);
   if(d_do_phase2_tdma) {
-    for (int i = 0; i < ninput_items[0]; i++) {
-      if(p2tdma.rx_sym(in[i])) {
+    for (int i = 0; i < nsyms; )
+      i += p1fdma.rx_sym(in + i, nsyms - i);
+    for (int i = 0; i < nsyms; ) {
+      bool frame;
+      i += p2tdma.rx_syms(in + i, nsyms - i, frame);
+      if (frame) {
         int rc = p2tdma.handle_frame();
         terminate_call = p2tdma.get_call_terminated();
         if (terminate_call.first) {
+          queue_terminate(terminate_call);
           p2tdma.reset_call_terminated();
         }
         
@@ -210,9 +259,14 @@ p25_frame_assembler_impl::general_work (int noutput_items,
       }
     }
   } else {
-    terminate_call = p1fdma.get_call_terminated();
-    if (terminate_call.first) {
-      p1fdma.reset_call_terminated();
+    // one TDU at a time, a frame decoded after it would clear it
+    for (int i = 0; i < nsyms; ) {
+      i += p1fdma.rx_sym(in + i, nsyms - i);
+      terminate_call = p1fdma.get_call_terminated();
+      if (terminate_call.first) {
+        queue_terminate(terminate_call);
+        p1fdma.reset_call_terminated();
+      }
     }
   }
 
@@ -220,23 +274,31 @@ p25_frame_assembler_impl::general_work (int noutput_items,
 
       // If this block is being used for Trunking, then you want to skip all of this.
       if (d_do_audio_output) {
-        amt_produce = output_queue.size();
         int16_t *out = (int16_t *)output_items[0];
 
         //BOOST_LOG_TRIVIAL(trace) << "P25 Frame Assembler -  output_queue: " << output_queue.size() << " noutput_items: " <<  noutput_items << " ninput_items: " << ninput_items[0];
 
-        if (amt_produce > 0) {
-            if (amt_produce >= 32768) {
-              BOOST_LOG_TRIVIAL(error) << "P25 Frame Assembler -  output_queue size: " << output_queue.size() << " max size: " << output_queue.max_size() << " limiting amt_produce to  32767 ";
-              
-              amt_produce = 32767; // buffer limit is 32768, see gnuradio/gnuradio-runtime/lib/../include/gnuradio/buffer.h:186
-            }
+        size_t dropped = output_queue.take_dropped();
+        if (dropped > 0) {
+          BOOST_LOG_TRIVIAL(error) << "P25 Frame Assembler -  output_queue full, dropped " << dropped << " samples";
+        }
 
-            for (int i = 0; i < amt_produce; i++) {
-              out[i] = output_queue[i];
-            }
-            output_queue.erase(output_queue.begin(), output_queue.begin() + amt_produce);
+        // anything that does not fit in this call stays queued for the next
+        // one, and a call stops short at a TDU so that it ends the
+        // transmission the TDU belongs to
+        const size_t popped = output_queue.popped();
+        int amt_pop = noutput_items;
+        if (!d_terminates.empty() && d_terminates.front().pos - popped < (size_t)amt_pop)
+          amt_pop = d_terminates.front().pos - popped;
+        amt_produce = output_queue.pop(out, amt_pop);
+        tag_deferred_frames(popped, amt_produce);
+        if (!d_terminates.empty() && d_terminates.front().pos == output_queue.popped()) {
+          status = d_terminates.front().status;
+          d_terminates.pop_front();
+          terminate = true;
+        }
 
+        if (amt_produce > 0) {
             send_grp_src_id();
 
             BOOST_LOG_TRIVIAL(trace) << "setting silence_frame_count " << silence_frame_count << " to d_silence_frames: " << d_silence_frames << std::endl;
@@ -249,36 +311,34 @@ p25_frame_assembler_impl::general_work (int noutput_items,
           }
         }
         
-        if (amt_produce == 0 && terminate_call.first) {
+        if (amt_produce == 0 && terminate) {
           std::fill(out, out + 1, 0);
           amt_produce = 1;
         }
 
-        if (terminate_call.first) {
-            BOOST_LOG_TRIVIAL(trace) << "P25 Frame Assembler: Applying TDU." << " Amount: " << amt_produce << " nitems_written(0): " << nitems_written(0);
-            if ((amt_produce != 1) && (terminate_call.second < amt_produce)) {
-              BOOST_LOG_TRIVIAL(info) << "P25 Frame Assembler: TDU was not at the end of the data. TDU: " << terminate_call.second << " Amount: " << amt_produce << " nitems_written(0): " << nitems_written(0);  
-            }
-            add_item_tag(0, nitems_written(0), pmt::intern("terminate"), pmt::from_long(1), d_tag_src );
-            
-            Rx_Status status = p1fdma.get_rx_status();
-            
-            // If something was recorded, send the number of Errors and Spikes that were counted during that period
-            if (status.total_len > 0 ) {
-              add_item_tag(0, nitems_written(0), pmt::intern("spike_count"), pmt::from_long(status.spike_count), d_tag_src);
-              add_item_tag(0, nitems_written(0), pmt::intern("error_count"), pmt::from_long(status.error_count), d_tag_src);
-              p1fdma.reset_rx_status();
-            }
+        if (terminate) {
             if (silence_frame_count > 0) {
               std::fill(out, out + noutput_items, 0);
               amt_produce = noutput_items;
               silence_frame_count--;
             }
+
+            // on the last sample of the transmission, so a sink handed this
+            // call's output together with the next one's can tell them apart
+            const uint64_t tdu_pos = nitems_written(0) + amt_produce - 1;
+            BOOST_LOG_TRIVIAL(trace) << "P25 Frame Assembler: Applying TDU." << " Amount: " << amt_produce << " nitems_written(0): " << nitems_written(0);
+            add_item_tag(0, tdu_pos, pmt::intern("terminate"), pmt::from_long(1), d_tag_src );
+            
+            // If something was recorded, send the number of Errors and Spikes that were counted during that period
+            if (status.total_len > 0 ) {
+              add_item_tag(0, tdu_pos, pmt::intern("spike_count"), pmt::from_long(status.spike_count), d_tag_src);
+              add_item_tag(0, tdu_pos, pmt::intern("error_count"), pmt::from_long(status.error_count), d_tag_src);
+            }
           }
         
         
       }
-  consume_each(ninput_items[0]);
+  consume_each(nsyms);
   // Tell runtime system how many output items we actually produced.
   return amt_produce;
 }
@@ -34,6 +34,7 @@
 #include "p25p1_fdma.h"
 #include "p25p2_tdma.h"
 #include "op25_audio.h"
+#include "ring_buffer.h"
 #include "log_ts.h"
 
 typedef std::deque<uint8_t> dibit_queue;
@@ -63,14 +64,22 @@ namespace gr {
   // internal functions
 
     void send_grp_src_id();
+    void tag_deferred_frames(size_t popped, int amt_produce);
+    void queue_terminate(const std::pair<bool,long> &terminate_call);
     void set_xormask(const char*p) ;
     void set_nac(int nac) ;
     void set_slotid(int slotid) ;
     void set_slotkey(int key) ;
     void set_debug(int debug) ;
     void reset_timer() ;
-	typedef std::vector<bool> bit_vector;
-	std::deque<int16_t> output_queue;
+	audio_queue output_queue;
+
+	// A TDU waiting for the audio queued ahead of it to go out
+	struct pending_terminate {
+		size_t pos;		// output_queue.pushed() at the TDU
+		Rx_Status status;	// errors and spikes counted up to the TDU
+	};
+	std::deque<pending_terminate> d_terminates;
 
   void p25p2_queue_msg(int duid);
   void set_phase2_tdma(bool p);
@@ -91,6 +100,8 @@ public:
       void clear_silence_frame_count();
       void clear();
       void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data);
+      void set_defer_vocoding(bool defer);
+      size_t memory_usage(void);
       log_ts logts;
     };
 
@@ -64,7 +64,7 @@ p25_framer::~p25_framer ()
  * Returns false if decode failure, else true
  */
 bool p25_framer::nid_codeword(uint64_t acc) {
-    bit_vector cw(64);
+    bch_codeword cw(64);
 
     // save the parity lsb, not used by BCH`
     int acc_parity = acc & 1;
@@ -174,8 +174,8 @@ bool p25_framer::rx_sym(uint8_t dibit) {
     }
 
     if (next_bit > 0) {
-        frame_body[next_bit++] = (dibit >> 1) & 1;
-        frame_body[next_bit++] =  dibit       & 1;
+        frame_body.insert(next_bit, next_bit + 2, dibit);
+        next_bit += 2;
     }
     // dispose of received frame (if exists) and:
     // 1. complete frame is received, or
@@ -204,17 +204,12 @@ uint32_t p25_framer::load_nid(const uint8_t *syms, int nsyms, const uint64_t fs)
     next_bit = 0;
     for (int i = 0; i < nsyms; i++) {
         dibit = syms[i] & 0x3;
-        frame_body[next_bit++] = (dibit >> 1) & 1;
-        frame_body[next_bit++] =  dibit       & 1;
+        frame_body.insert(next_bit, next_bit + 2, dibit);
+        next_bit += 2;
     }
 
-    uint64_t accum = 0;
-    for (int i = 48; i < 114; i++) {
-        if ((i == 70) || (i == 71))
-            continue;
-        accum <<= 1;
-        accum |= frame_body[i];
-    }
+    // NID, skipping the status dibit at 70, 71
+    uint64_t accum = (frame_body.extract(48, 70) << 42) | frame_body.extract(72, 114);
     bool bch_rc = nid_codeword(accum);
     if (!bch_rc) {
         if (d_debug >= 10)
@@ -237,8 +232,8 @@ bool p25_framer::load_body(const uint8_t * syms, int nsyms) {
     uint8_t dibit;
     for (int i = 0; i < nsyms; i++) {
         dibit = syms[i] & 0x3;
-        frame_body[next_bit++] = (dibit >> 1) & 1;
-        frame_body[next_bit++] =  dibit       & 1;
+        frame_body.insert(next_bit, next_bit + 2, dibit);
+        next_bit += 2;
     }
     frame_size = next_bit;
     return true;
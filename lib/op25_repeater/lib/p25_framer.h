@@ -12,12 +12,12 @@
 #ifndef INCLUDED_P25_FRAMER_H
 #define INCLUDED_P25_FRAMER_H
 
+#include "bit_array.h"
 #include "log_ts.h"
 
 class p25_framer
 {
     private:
-        typedef std::vector<bool> bit_vector;
         // internal functions
         bool nid_codeword(uint64_t acc);
         // internal instance variables and state
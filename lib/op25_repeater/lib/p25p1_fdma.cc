@@ -161,10 +161,8 @@ namespace gr {
             memset(buf, 0, 12);
 
             for (b=0; b < 98*2; b += 4) {
-                codeword = (bv[start+deinterleave_tb[b+0]] << 3) + 
-                    (bv[start+deinterleave_tb[b+1]] << 2) + 
-                    (bv[start+deinterleave_tb[b+2]] << 1) + 
-                    bv[start+deinterleave_tb[b+3]]     ;
+                // each group of four table entries is a run of adjacent bits
+                codeword = bv.extract(start+deinterleave_tb[b], start+deinterleave_tb[b]+4);
 
                 /* try each codeword in a row of the state transition table */
                 for (j = 0; j < 4; j++) {
@@ -206,7 +204,7 @@ namespace gr {
                 fprintf(stderr, "%s p25p1_fdma::set_nac: 0x%03x\n", logts.get(d_msgq_id), d_nac);
         }
 
-        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
+        p25p1_fdma::p25p1_fdma(const op25_audio& udp, log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, audio_queue &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id) :
             write_bufp(0),
             d_debug(debug),
             d_do_imbe(do_imbe),
@@ -217,6 +215,7 @@ namespace gr {
             d_nac(0),
             d_msg_queue(queue),
             d_soft_vocoder(soft_vocoder),
+            d_defer_vocoding(false),
             output_queue(output_queue),
             framer(new p25_framer(logger, debug, msgq_id)),
             qtimer(op25_timer(TIMEOUT_THRESHOLD)),
@@ -232,7 +231,6 @@ namespace gr {
             ess_algid(0x80),
             vf_tgid(0),
 			terminate_call(std::pair<bool,long>(false,0)),
-            p1voice_decode((debug > 0), udp, output_queue),
             voice_codec_cb_(NULL),
             voice_codec_cb_data_(NULL)
         {
@@ -277,7 +275,30 @@ namespace gr {
 			return addr;
 		}
 		void p25p1_fdma::clear() {
-			p1voice_decode.clear();
+			if (vocoder)
+				vocoder->clear();
+		}
+
+		software_imbe_decoder& p25p1_fdma::get_software_decoder() {
+			if (!software_decoder)
+				software_decoder.reset(new software_imbe_decoder());
+			return *software_decoder;
+		}
+
+		imbe_vocoder& p25p1_fdma::get_vocoder() {
+			if (!vocoder)
+				vocoder.reset(new imbe_vocoder());
+			return *vocoder;
+		}
+
+		// bytes held by the decoder, including the vocoder once allocated
+		size_t p25p1_fdma::memory_usage() const {
+			size_t bytes = sizeof(*this) - sizeof(crypt_algs) + crypt_algs.memory_usage() + sizeof(*framer);
+			if (software_decoder)
+				bytes += software_decoder->memory_usage();
+			if (vocoder)
+				bytes += vocoder->memory_usage();
+			return bytes;
 		}
 
         void p25p1_fdma::process_duid(uint32_t const duid, uint32_t const nac, const uint8_t* buf, const int len) {
@@ -804,12 +825,13 @@ namespace gr {
 
         int p25p1_fdma::process_blocks(const bit_vector& fr, uint32_t& fr_len, block_vector& dbuf) {
             bit_vector bv;
-            bv.reserve(fr_len >> 1);
-            for (unsigned int d=0; d < fr_len >> 1; d++) {	  // eliminate status bits from frame
-                if ((d+1) % 36 == 0)
-                    continue;
-                bv.push_back(fr[d*2]);
-                bv.push_back(fr[d*2+1]);
+            for (unsigned int d=0; d < fr_len >> 1; d += 36) {	  // eliminate status bits from frame
+                // copy the 35 dibits before each status dibit
+                unsigned int end = std::min(d + 35, fr_len >> 1) * 2;
+                for (unsigned int b = d*2; b < end; b += 64) {
+                    unsigned int n = std::min(end - b, 64u);
+                    bv.append(fr.extract(b, b + n), n);
+                }
             }
 
             int bl_cnt = 0;
@@ -830,7 +852,7 @@ namespace gr {
                     crypt_algs.prepare(ess_algid, ess_keyid, PT_P25_PHASE1, ess_mi);
 
                 for(size_t i = 0; i < nof_voice_codewords; ++i) {
-                    voice_codeword cw(voice_codeword_sz);
+                    voice_codeword cw;
                     uint32_t E0, ET;
                     uint32_t u[8];
                     char s[128];
@@ -903,10 +925,19 @@ namespace gr {
                     if (d_do_audio_output) {
                         if ( !encrypted()) {
                             // This is the Vocoder that OP25 currently uses.
-
-                            if (d_soft_vocoder) {
+                            const bool defer = d_defer_vocoding && !op25audio.enabled();
+                            deferred_imbe_frame f;
+
+                            if (defer) {
+                                // The recorder vocodes the frame later, a silent frame keeps its place
+                                f.pos = output_queue.pushed();
+                                memcpy(f.u, u, sizeof(f.u));
+                                f.E0 = E0;
+                                f.ET = ET;
+                                memset(snd, 0, sizeof(snd));
+                            } else if (d_soft_vocoder) {
                                 // This is vocoder that is for half-rate
-                                software_decoder.decode_fullrate(snd, u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], E0, ET);
+                                get_software_decoder().decode_fullrate(snd, u[0], u[1], u[2], u[3], u[4], u[5], u[6], u[7], E0, ET);
                             } else {
 
                                 // This is the older, fullrate vocoder
@@ -917,23 +948,24 @@ namespace gr {
                                     frame_vector[i] = u[i] & 0xFFFF;
                                 }
                                 frame_vector[7] >>= 1;
-                                vocoder.imbe_decode(frame_vector, snd);
+                                get_vocoder().imbe_decode(frame_vector, snd);
                             }
 
                             if (op25audio.enabled()) {      // decoded audio goes out via UDP (normal code path)
                                 op25audio.send_audio(snd, SND_FRAME * sizeof(int16_t));
                             } else {                        // decoded audio back to gnuradio (still supported?)
-                                for (int i = 0; i < SND_FRAME; i++) {
-                                    output_queue.push_back(snd[i]);
-                                }
+                                output_queue.push(snd, SND_FRAME);
                             }
+
+                            // a frame the queue had no room for has no place in the audio to be vocoded into
+                            if (defer && (output_queue.pushed() == f.pos + SND_FRAME))
+                                deferred_frames.push_back(f);
                         } else {
 		                    // For encrypted voice without a valid key, push silent audio frames
                             // If monitoring for metadata, this will allow tags to pass and preserve call flow
                             if (!op25audio.enabled()) {
-                                for (int i = 0; i < SND_FRAME; i++) {
-                                    output_queue.push_back(0);  // Silent frame
-                                }
+                                memset(snd, 0, sizeof(snd));  // Silent frame
+                                output_queue.push(snd, SND_FRAME);
                             }
                             std::string encr = "{\"encrypted\": " + std::to_string(1) + ", \"algid\": " + std::to_string(ess_algid) + ", \"keyid\": " + std::to_string(ess_keyid) + "}";
                             send_msg(encr, M_P25_JSON_DATA);
@@ -1009,20 +1041,8 @@ namespace gr {
 
             if (!d_do_imbe) { // send raw frame to wireshark
                 // pack the bits into bytes, MSB first
-                size_t obuf_ct = 0;
                 uint8_t obuf[P25_VOICE_FRAME_SIZE/2];
-                for (uint32_t i = 0; i < framer->frame_size; i += 8) {
-                    uint8_t b = 
-                        (framer->frame_body[i+0] << 7) +
-                        (framer->frame_body[i+1] << 6) +
-                        (framer->frame_body[i+2] << 5) +
-                        (framer->frame_body[i+3] << 4) +
-                        (framer->frame_body[i+4] << 3) +
-                        (framer->frame_body[i+5] << 2) +
-                        (framer->frame_body[i+6] << 1) +
-                        (framer->frame_body[i+7]     );
-                    obuf[obuf_ct++] = b;
-                }
+                size_t obuf_ct = extract(framer->frame_body, 0, (framer->frame_size + 7) & ~7, obuf);
                 op25audio.send_to(obuf, obuf_ct);
 
                 if (d_do_output) {
@@ -1034,9 +1054,12 @@ namespace gr {
         }
 
         // Construct a frame one symbol at a time (used by rx.py)
-        void p25p1_fdma::rx_sym (const uint8_t *syms, int nsyms) {
-            for (int i1 = 0; i1 < nsyms; i1++) {
-                if(framer->rx_sym(syms[i1])) {   // complete frame was detected
+        // Stops after a voice terminator, before the next frame clears it, and
+        // returns the number of symbols used
+        int p25p1_fdma::rx_sym (const uint8_t *syms, int nsyms) {
+            int i1 = 0;
+            while (i1 < nsyms) {
+                if(framer->rx_sym(syms[i1++])) {   // complete frame was detected
                     if (framer->nac == 0) {  // discard frame if NAC is invalid
                         continue;
                     }
@@ -1046,9 +1069,12 @@ namespace gr {
 					terminate_call = std::pair<bool,long>(false,0);
 
                     process_frame();
+                    if (terminate_call.first)
+                        break;
                 }  // end of complete frame
             }
             check_timeout();
+            return i1;
         }
 
         // Load a frame starting with NID block (used by multi_rx.py)
@@ -30,11 +30,11 @@
 #include "log_ts.h"
 #include "op25_timer.h"
 #include "op25_audio.h"
+#include "ring_buffer.h"
 #include "p25_framer.h"
 #include "software_imbe_decoder.h"
 #include "p25_crypt_algs.h"
 #include "p25p1_voice_encode.h"
-#include "p25p1_voice_decode.h"
 #include <boost/log/trivial.hpp>
 #include "../include/op25_repeater/rx_status.h"
 #include "imbe_vocoder/imbe_vocoder.h" // for the original full rate vocoder
@@ -44,10 +44,18 @@ namespace gr {
 
         static const int SND_FRAME = 160;   // pcm samples per frame
 
+        // A voice frame left for the recorder to vocode, pos is where the
+        // silent frame standing in for it went into the output queue
+        struct deferred_imbe_frame {
+            size_t pos;
+            uint32_t u[8];
+            uint32_t E0;
+            uint32_t ET;
+        };
+
         class p25p1_fdma
         {
             private:
-                typedef std::vector<bool> bit_vector;
                 typedef std::array<uint8_t, 12> block_array;
                 typedef std::vector<block_array> block_vector;
 
@@ -82,19 +90,19 @@ namespace gr {
                 int  d_msgq_id;
                 bool d_do_audio_output;
                 bool d_soft_vocoder;
+                bool d_defer_vocoding;
                 int d_nac;
                 gr::msg_queue::sptr d_msg_queue;
-                std::deque<int16_t> &output_queue;
+                audio_queue &output_queue;
+                std::deque<deferred_imbe_frame> deferred_frames;
                 p25_framer* framer;
                 op25_timer qtimer;
-				software_imbe_decoder software_decoder;
 				int16_t snd[SND_FRAME];
                 const op25_audio& op25audio;
                 log_ts& logts;
                 p25_crypt_algs crypt_algs;
 
                 Rx_Status rx_status;
-                p25p1_voice_decode p1voice_decode;
                 double error_history[20];
                 long curr_src_id;
                 long curr_grp_id;
@@ -116,7 +124,12 @@ namespace gr {
                 uint8_t  ess_mi[9] = {0};
                 uint16_t vf_tgid;
 
-                imbe_vocoder vocoder; // for original full rate vocoder
+                // Only the vocoder selected by d_soft_vocoder is ever used, it
+                // is allocated with the first voice frame
+                std::unique_ptr<software_imbe_decoder> software_decoder;
+                std::unique_ptr<imbe_vocoder> vocoder; // for original full rate vocoder
+                software_imbe_decoder& get_software_decoder();
+                imbe_vocoder& get_vocoder();
 
                 typedef void (*voice_codec_cb_t)(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
                 voice_codec_cb_t voice_codec_cb_;
@@ -124,14 +137,16 @@ namespace gr {
 
             public:
                 void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data) { voice_codec_cb_ = cb; voice_codec_cb_data_ = user_data; }
+                void set_defer_vocoding(bool defer) { d_defer_vocoding = defer; }
+                std::deque<deferred_imbe_frame>& get_deferred_frames() { return deferred_frames; }
                 void set_debug(int debug);
                 void set_nac(int nac);
                 void reset_timer();
                 void call_end();
                 void crypt_reset();
                 void crypt_key(uint16_t keyid, uint8_t algid, const std::vector<uint8_t> &key);
-                void rx_sym (const uint8_t *syms, int nsyms);
-                p25p1_fdma(const op25_audio& udp,  log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id = 0);
+                int rx_sym (const uint8_t *syms, int nsyms);
+                p25p1_fdma(const op25_audio& udp,  log_ts& logger, int debug, bool do_imbe, bool do_output, bool do_msgq, gr::msg_queue::sptr queue, audio_queue &output_queue, bool do_audio_output, bool soft_vocoder, int msgq_id = 0);
                 ~p25p1_fdma();
                 uint32_t load_nid(const uint8_t *syms, int nsyms, const uint64_t fs);
                 bool load_body(const uint8_t * syms, int nsyms);
@@ -151,6 +166,7 @@ namespace gr {
                 void reset_call_terminated();
                 Rx_Status get_rx_status();
                 void clear();
+                size_t memory_usage() const;
 
         };
     } // namespace
@@ -45,12 +45,12 @@ namespace gr {
   namespace op25_repeater {
 
 static void clear_bits(bit_vector& v) {
-	for (size_t i=0; i<v.size(); i++) {
-		v[i]=0;
-	}
+	const size_t n = v.size();
+	v.clear();
+	v.resize(n);
 }
 
-p25p1_voice_decode::p25p1_voice_decode(bool verbose_flag, const op25_audio& udp, std::deque<int16_t> &_output_queue) :
+p25p1_voice_decode::p25p1_voice_decode(bool verbose_flag, const op25_audio& udp, audio_queue &_output_queue) :
 	write_bufp(0),
 	rxbufp(0),
 	op25audio(udp),
@@ -96,9 +96,7 @@ void p25p1_voice_decode::rxframe(const voice_codeword& cw)
 		op25audio.send_audio(snd, FRAME * sizeof(int16_t));
 	} else {
 		// add generated samples to output queue
-		for (int i = 0; i < FRAME; i++) {
-			output_queue.push_back(snd[i]);
-		}
+		output_queue.push(snd, FRAME);
 	}
 }
 
@@ -123,9 +121,7 @@ void p25p1_voice_decode::rxframe(const uint32_t u[])
 		op25audio.send_audio(snd, FRAME * sizeof(int16_t));
 	} else {
 		// add generated samples to output queue
-		for (int i = 0; i < FRAME; i++) {
-			output_queue.push_back(snd[i]);
-		}
+		output_queue.push(snd, FRAME);
 	}
 }
 
@@ -27,6 +27,7 @@
 #include <deque>
 
 #include "op25_audio.h"
+#include "ring_buffer.h"
 #include "imbe_vocoder/imbe_vocoder.h"
 
 #include "imbe_decoder.h"
@@ -35,14 +36,13 @@
 namespace gr {
   namespace op25_repeater {
 
-    typedef std::vector<bool> bit_vector;
     class p25p1_voice_decode
     {
      private:
       // Nothing to declare in this block.
 
      public:
-      p25p1_voice_decode(bool verbose_flag, const op25_audio& udp, std::deque<int16_t> &_output_queue);
+      p25p1_voice_decode(bool verbose_flag, const op25_audio& udp, audio_queue &_output_queue);
       ~p25p1_voice_decode();
 	void rxframe(const voice_codeword& cw);
 	void rxframe(const uint32_t u[]);
@@ -62,7 +62,7 @@ namespace gr {
 	bool d_software_imbe_decoder;
         const op25_audio& op25audio;
 
-	std::deque<int16_t> &output_queue;
+	audio_queue &output_queue;
 
 	bool opt_verbose;
 	/* local methods */
@@ -145,9 +145,9 @@ static const bool ldu2_preset[] = {
 };
 
 static void clear_bits(bit_vector& v) {
-	for (size_t i=0; i<v.size(); i++) {
-		v[i]=0;
-	}
+	const size_t n = v.size();
+	v.clear();
+	v.resize(n);
 }
 
 p25p1_voice_encode::p25p1_voice_encode(bool verbose_flag, int stretch_amt, const op25_audio& udp, bool raw_vectors_flag, std::deque<uint8_t> &_output_queue) :
@@ -210,25 +210,11 @@ void p25p1_voice_encode::append_imbe_codeword(bit_vector& frame_body, int16_t fr
 		// finally, output the frame
 		if (op25audio.enabled()) {
 			// pack the bits into bytes, MSB first
-			size_t obuf_ct = 0;
-			for (uint32_t i = 0; i < P25_VOICE_FRAME_SIZE; i += 8) {
-				uint8_t b = 
-					(frame_body[i+0] << 7) +
-					(frame_body[i+1] << 6) +
-					(frame_body[i+2] << 5) +
-					(frame_body[i+3] << 4) +
-					(frame_body[i+4] << 3) +
-					(frame_body[i+5] << 2) +
-					(frame_body[i+6] << 1) +
-					(frame_body[i+7]     );
-				obuf[obuf_ct++] = b;
-			}
+			size_t obuf_ct = extract(frame_body, 0, (int) P25_VOICE_FRAME_SIZE, obuf);
 			op25audio.send_to(obuf, obuf_ct);
 		} else {
 			for (uint32_t i = 0; i < P25_VOICE_FRAME_SIZE; i += 2) {
-				uint8_t dibit = 
-					(frame_body[i+0] << 1) +
-					(frame_body[i+1]     );
+				uint8_t dibit = frame_body.extract(i, i+2);
 				output_queue.push_back(dibit);
 			}
 		}
@@ -26,6 +26,7 @@
 #include <vector>
 #include <deque>
 
+#include "bit_array.h"
 #include "op25_audio.h"
 #include "imbe_vocoder/imbe_vocoder.h"
 
@@ -35,7 +36,6 @@
 namespace gr {
   namespace op25_repeater {
 
-    typedef std::vector<bool> bit_vector;
     class p25p1_voice_encode
     {
      private:
@@ -28,6 +28,91 @@ p25p2_framer::~p25p2_framer ()
 {
 }
 
+/*
+ * sync_match: frame sync word found at the end of nid_accum, or 0 if none.
+ * Same patterns and thresholds, in the same order, as rx_sym()
+ */
+static inline uint64_t sync_match(uint64_t acc) {
+	const uint64_t x = acc & P25P2_FRAME_SYNC_MASK;
+	if (check_frame_sync(x ^ P25P2_FRAME_SYNC_MAGIC, 4, 40))
+		return P25P2_FRAME_SYNC_MAGIC;
+	if (x == P25P2_FRAME_SYNC_REV_P || x == P25P2_FRAME_SYNC_X2400 ||
+	    x == P25P2_FRAME_SYNC_N1200 || x == P25P2_FRAME_SYNC_P1200)
+		return x;
+	return 0;
+}
+
+/*
+ * load_dibits: appends n dibits to the frame body, up to 32 per insert()
+ */
+void p25p2_framer::load_dibits(const uint8_t *syms, size_t n) {
+	while (n > 0) {
+		const size_t k = n < 32 ? n : 32;
+		uint64_t v = 0;
+		for (size_t i = 0; i < k; i++)
+			v = (v << 2) | (syms[i] & 0x3);
+		d_frame_body.insert(d_next_bit, d_next_bit + 2 * k, v);
+		d_next_bit += 2 * k;
+		syms += k;
+		n -= k;
+	}
+}
+
+/*
+ * rx_syms: block version of rx_sym
+ * Scans the buffer for the next sync word with nothing but the shift
+ * register update per symbol, and loads the symbols in between into the
+ * frame body a word at a time.
+ *
+ * Stops after the symbol that completes a frame, setting frame, and
+ * returns the number of symbols consumed (nsyms if no frame completed).
+ */
+size_t p25p2_framer::rx_syms(const uint8_t *syms, size_t nsyms, bool &frame) {
+	size_t i = 0;
+
+	frame = false;
+	while (i < nsyms) {
+		size_t end = nsyms;
+		if (d_in_sync && (end - i) > (P25P2_BURST_SIZE - d_next_bit) / 2)
+			end = i + (P25P2_BURST_SIZE - d_next_bit) / 2;	// stop where the frame completes
+
+		uint64_t acc = nid_accum;
+		uint64_t fs = 0;
+		size_t j;
+		for (j = i; j < end; j++) {
+			acc = (acc << 2) | (syms[j] & 0x3);
+			if ((fs = sync_match(acc)) != 0)
+				break;
+		}
+		nid_accum = acc;
+
+		// symbols [i, j) carried no sync
+		symbols_received += j - i;
+		if (d_in_sync)
+			load_dibits(syms + i, j - i);
+		else if (j > i)
+			d_fs = 0;
+
+		if (fs) {
+			symbols_received++;
+			d_fs = fs;
+			d_frame_body.insert(0, 40, d_fs);
+			d_next_bit = 40;
+			d_in_sync = 10;  // renew allowance
+			i = j + 1;
+			continue;
+		}
+		i = j;
+		if (d_in_sync && d_next_bit >= P25P2_BURST_SIZE) {
+			frame = true;
+			d_in_sync--;	// each frame reduces allowance
+			d_next_bit = 0;
+			break;
+		}
+	}
+	return i;
+}
+
 /*
  * rx_sym: called once per received symbol
  * 1. looks for flags sequences
@@ -67,18 +152,14 @@ bool p25p2_framer::rx_sym(uint8_t dibit) {
 		found = 1;
 	}
 	if (found) {
-		uint64_t accum = d_fs;
-		for (int i=0; i < 40; i++) {
-			d_frame_body[39 - i] = accum & 1;
-			accum = accum >> 1;
-		}
+		d_frame_body.insert(0, 40, d_fs);
 		d_next_bit = 40;
 		d_in_sync = 10;  // renew allowance
 		return false;
 	}
 	if (d_in_sync) {
-		d_frame_body[d_next_bit++] = (dibit >> 1) & 1;
-		d_frame_body[d_next_bit++] =  dibit       & 1;
+		d_frame_body.insert(d_next_bit, d_next_bit + 2, dibit);
+		d_next_bit += 2;
 		// dispose of received frame (if exists) and complete frame is received
 		if (d_next_bit >= P25P2_BURST_SIZE) {
 			rc = true;	// set rc indicating frame available
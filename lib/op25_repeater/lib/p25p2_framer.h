@@ -6,11 +6,15 @@
  *
  * usage: after constructing, call rx_sym once per received dibit.
  * frame available when true is returned
+ *
+ * or call rx_syms with a block of dibits, it returns after the dibit that
+ * completes a frame (frame set to true) with the number consumed
  */
 
 #ifndef INCLUDED_P25P2_FRAMER_H
 #define INCLUDED_P25P2_FRAMER_H
 
+#include "bit_array.h"
 #include "frame_sync_magics.h"
 
 static const unsigned int P25P2_BURST_SIZE=360; /* in bits */
@@ -20,22 +24,24 @@ class p25p2_framer;
 class p25p2_framer
 {
 private:
-	typedef std::vector<bool> bit_vector;
   // internal instance variables and state
 	uint32_t d_next_bit;
 	uint32_t d_in_sync;
 	uint64_t d_fs;
 	uint64_t nid_accum;
 
+	void load_dibits(const uint8_t *syms, size_t n);
+
 public:
 	p25p2_framer();  	// constructor
 	~p25p2_framer ();	// destructor
 	bool rx_sym(uint8_t dibit) ;
+	size_t rx_syms(const uint8_t *syms, size_t nsyms, bool &frame);
     uint64_t get_fs() { return d_fs; }
 
 	uint32_t symbols_received;
 
-	bit_vector d_frame_body;	// all bits in frame
+	bit_array<P25P2_BURST_SIZE> d_frame_body;	// all bits in frame
 };
 
 #endif /* INCLUDED_P25P2_FRAMER_H */
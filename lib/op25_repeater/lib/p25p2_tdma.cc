@@ -97,7 +97,7 @@ static const uint8_t mac_msg_len[256] = {
 	28,  0,  0, 14, 17, 14,  0,  0, 16,  8, 11,  0, 13, 19,  0,  0, 
 	 0,  0, 16, 14,  0,  0, 12,  0, 22,  0, 11, 13, 11,  0, 15,  0 };
 
-p25p2_tdma::p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id) :	// constructor
+p25p2_tdma::p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, audio_queue &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id) :	// constructor
 	tdma_xormask(new uint8_t[SUPERFRAME_SIZE]),
 	symbols_received(0),
 	packets(0),
@@ -146,6 +146,13 @@ bool p25p2_tdma::rx_sym(uint8_t sym)
 	return p2framer.rx_sym(sym);
 }
 
+size_t p25p2_tdma::rx_syms(const uint8_t *syms, size_t nsyms, bool &frame)
+{
+	const size_t n = p2framer.rx_syms(syms, nsyms, frame);
+	symbols_received += n;
+	return n;
+}
+
 void p25p2_tdma::set_slotid(int slotid)
 {
 	assert (slotid == 0 || slotid == 1);
@@ -163,6 +170,28 @@ void p25p2_tdma::call_end() {
 	cached_id_timestamp = 0;
 }
 
+software_imbe_decoder& p25p2_tdma::get_software_decoder() {
+	if (!software_decoder)
+		software_decoder.reset(new software_imbe_decoder());
+	return *software_decoder;
+}
+
+imbe_vocoder& p25p2_tdma::get_vocoder() {
+	if (!vocoder)
+		vocoder.reset(new imbe_vocoder());
+	return *vocoder;
+}
+
+// bytes held by the decoder, including the vocoders once allocated
+size_t p25p2_tdma::memory_usage() const {
+	size_t bytes = sizeof(*this) - sizeof(crypt_algs) + crypt_algs.memory_usage();
+	if (software_decoder)
+		bytes += software_decoder->memory_usage();
+	if (vocoder)
+		bytes += vocoder->memory_usage();
+	return bytes;
+}
+
 void p25p2_tdma::crypt_reset() {
 	crypt_algs.reset();
 }
@@ -760,6 +789,9 @@ void p25p2_tdma::handle_voice_frame(const uint8_t dibits[], int slot, int voice_
 		                params, 4, (int)errs, voice_codec_cb_data_);
 	}
 
+	if (!d_do_audio_output)		// codewords only, nothing reads the audio
+		return;
+
 	// Only dequantize and synthesize if we have valid audio (decrypted or unencrypted)
 	if (audio_valid) {
 		rc = mbe_dequantizeAmbeTone(&tone_mp, &errs_mp, u);
@@ -791,23 +823,23 @@ void p25p2_tdma::handle_voice_frame(const uint8_t dibits[], int slot, int voice_
 		// Synthesize tones or speech as long as dequantization was successful and overall error rate is below threshold
 		if ((rc == 0) && (errs_mp.ER <= 0.096)) {
 			if (tone_frame) {
-				software_decoder.decode_tone(samples_buf, tone_mp.ID, tone_mp.AD, &tone_mp.n);
+				get_software_decoder().decode_tone(samples_buf, tone_mp.ID, tone_mp.AD, &tone_mp.n);
 			} else if(d_soft_vocoder) {
 				K = 12;
 				if (cur_mp.L <= 36)
 					K = int(float(cur_mp.L + 2.0) / 3.0);
-				software_decoder.decode_tap(samples_buf, cur_mp.L, K, cur_mp.w0, &cur_mp.Vl[1], &cur_mp.Ml[1]);
+				get_software_decoder().decode_tap(samples_buf, cur_mp.L, K, cur_mp.w0, &cur_mp.Vl[1], &cur_mp.Ml[1]);
 			} else {
-				vocoder.decode_tap(samples_buf, cur_mp.L, cur_mp.w0, &cur_mp.Vl[1], &cur_mp.Ml[1]);
+				get_vocoder().decode_tap(samples_buf, cur_mp.L, cur_mp.w0, &cur_mp.Vl[1], &cur_mp.Ml[1]);
 			}
 		}
 	}
 
 	// Populate output buffer with either audio samples or silence
+	output_queue_decode.push(samples_buf, IMBE_SAMPLES_PER_FRAME); // outputs the sound
 	write_bufp = 0;
 	for (int i=0; i < IMBE_SAMPLES_PER_FRAME; i++) {
 		snd = samples_buf[i];
-		output_queue_decode.push_back(snd); // outputs the sound
 		write_buf[write_bufp++] = snd & 0xFF ;
 		write_buf[write_bufp++] = snd >> 8;
 	}
@@ -825,7 +857,7 @@ int p25p2_tdma::handle_frame(void)
 	uint8_t dibits[180];
 	int rc;
 	for (size_t i=0; i<sizeof(dibits); i++)
-		dibits[i] = p2framer.d_frame_body[i*2+1] + (p2framer.d_frame_body[i*2] << 1);
+		dibits[i] = p2framer.d_frame_body.extract(i*2, i*2+2);
 	rc = handle_packet(dibits, p2framer.get_fs());
 	return rc;
 }
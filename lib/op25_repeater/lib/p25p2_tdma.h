@@ -34,6 +34,7 @@
 #include "p25p2_framer.h"
 #include "p25_crypt_algs.h"
 #include "op25_audio.h"
+#include "ring_buffer.h"
 #include "log_ts.h"
 #include "imbe_vocoder/imbe_vocoder.h"
 
@@ -43,7 +44,7 @@
 class p25p2_tdma
 {
 public:
-	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, std::deque<int16_t> &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id = 0) ;	// constructor
+	p25p2_tdma(const op25_audio& udp, log_ts& logger, int slotid, int debug, bool do_msgq, gr::msg_queue::sptr queue, audio_queue &qptr, bool do_audio_output, bool soft_vocoder, int msgq_id = 0) ;	// constructor
 	int handle_packet(uint8_t dibits[], const uint64_t fs) ;
 	void set_slotid(int slotid);
 	void call_end();
@@ -57,11 +58,13 @@ public:
 	inline void set_nac(int nac) { d_nac = nac; }
 	inline void set_debug(int debug) { d_debug = debug; }
 	bool rx_sym(uint8_t sym);
+	size_t rx_syms(const uint8_t *syms, size_t nsyms, bool &frame);
 	int handle_frame(void) ;
   	std::pair<bool,long> get_call_terminated();
 	void reset_call_terminated();
 	long get_ptt_src_id();
 	long get_ptt_grp_id();
+	size_t memory_usage() const;
 private:
 	p25p2_sync sync;
 	p25p2_duid duid;
@@ -77,10 +80,14 @@ private:
 	mbe_errs errs_mp;
 	int mbe_err_cnt;
 	bool tone_frame;
-	software_imbe_decoder software_decoder;
-	imbe_vocoder vocoder;
+	// Allocated with the first voice frame that needs them, tones always use
+	// the software decoder and speech the one selected by d_soft_vocoder
+	std::unique_ptr<software_imbe_decoder> software_decoder;
+	std::unique_ptr<imbe_vocoder> vocoder;
+	software_imbe_decoder& get_software_decoder();
+	imbe_vocoder& get_vocoder();
 	gr::msg_queue::sptr d_msg_queue;
-	std::deque<int16_t> &output_queue_decode;
+	audio_queue &output_queue_decode;
 	bool d_do_msgq;
 	int d_msgq_id;
 	bool d_do_audio_output;
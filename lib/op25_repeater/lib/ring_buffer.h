@@ -0,0 +1,122 @@
+//
+// This file is part of OP25
+//
+// OP25 is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 3, or (at your option)
+// any later version.
+//
+// OP25 is distributed in the hope that it will be useful, but WITHOUT
+// ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+// or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public
+// License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with OP25; see the file COPYING. If not, write to the Free
+// Software Foundation, Inc., 51 Franklin Street, Boston, MA
+// 02110-1301, USA.
+
+#ifndef INCLUDED_OP25_REPEATER_RING_BUFFER_H
+#define INCLUDED_OP25_REPEATER_RING_BUFFER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Fixed capacity FIFO of trivially copyable items, the queue the vocoders
+ * hand decoded audio to the frame assemblers through.
+ *
+ * Storage is one inline array of N items, N a power of two, so push() and
+ * pop() move a whole frame with at most two memcpy() calls, one on each
+ * side of the wrap point, and the buffer never touches the heap.
+ *
+ * A push() that does not fit stores what it can and counts the rest in
+ * dropped(), which the owner reports and clears with take_dropped().
+ */
+template <class T, size_t N>
+class ring_buffer {
+public:
+	ring_buffer() : d_head(0), d_tail(0), d_dropped(0) {
+		static_assert(N != 0 && (N & (N - 1)) == 0, "ring_buffer capacity must be a power of two");
+	}
+
+	size_t size() const { return d_tail - d_head; }
+	static size_t capacity() { return N; }
+	size_t space() const { return N - size(); }
+	bool empty() const { return d_head == d_tail; }
+	void clear() { d_head = d_tail = 0; }
+
+	/* Appends up to n items, returns how many fit */
+	size_t push(const T *src, size_t n) {
+		size_t avail = space();
+		if (n > avail) {
+			d_dropped += n - avail;
+			n = avail;
+		}
+		const size_t pos = d_tail & (N - 1);
+		const size_t first = (n < N - pos) ? n : N - pos;
+		memcpy(&d_buf[pos], src, first * sizeof(T));
+		memcpy(&d_buf[0], src + first, (n - first) * sizeof(T));
+		d_tail += n;
+		return n;
+	}
+
+	void push_back(const T &v) { push(&v, 1); }
+
+	/* Removes up to n items into dst, returns how many were copied */
+	size_t pop(T *dst, size_t n) {
+		if (n > size())
+			n = size();
+		const size_t pos = d_head & (N - 1);
+		const size_t first = (n < N - pos) ? n : N - pos;
+		memcpy(dst, &d_buf[pos], first * sizeof(T));
+		memcpy(dst + first, &d_buf[0], (n - first) * sizeof(T));
+		d_head += n;
+		return n;
+	}
+
+	/*
+	 * Running totals of items pushed and popped, for callers that tie side
+	 * data to a position in the stream. clear() resets both.
+	 */
+	size_t pushed() const { return d_tail; }
+	size_t popped() const { return d_head; }
+
+	/* Items refused by push() since the last take_dropped() */
+	size_t dropped() const { return d_dropped; }
+	size_t take_dropped() {
+		const size_t n = d_dropped;
+		d_dropped = 0;
+		return n;
+	}
+
+private:
+	T d_buf[N];
+	size_t d_head;		// free running, only ever masked for indexing
+	size_t d_tail;
+	size_t d_dropped;
+};
+
+/*
+ * 8 kHz audio between a vocoder and its frame assembler. The assemblers
+ * only decode as many symbols per work() call as there is room for (see
+ * audio_queue_budget()), so half a second, a few frames, is plenty.
+ */
+typedef ring_buffer<int16_t, 4096> audio_queue;
+
+/*
+ * How many of nsyms input symbols can be decoded without overrunning q. No
+ * mode makes more than two samples per symbol, plus the frame that was
+ * already in progress, at most one 1440 sample P25 LDU.
+ */
+static inline int audio_queue_budget(const audio_queue &q, int nsyms)
+{
+	const int slack = 1440;
+	const int room = ((int) q.space() - slack) / 2;
+	if (room <= 0)
+		return 0;
+	return (nsyms < room) ? nsyms : room;
+}
+
+#endif /* INCLUDED_OP25_REPEATER_RING_BUFFER_H */
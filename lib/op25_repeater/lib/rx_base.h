@@ -28,6 +28,7 @@ namespace gr{
         class rx_base {
             public:
                 virtual void rx_sym(const uint8_t sym) = 0;
+                virtual void rx_syms(const uint8_t *syms, int nsyms) { for (int i = 0; i < nsyms; i++) rx_sym(syms[i]); };
                 virtual void sync_reset(void) = 0;
                 virtual void call_end(void) = 0;
                 virtual void crypt_reset(void) = 0;
@@ -42,6 +43,7 @@ namespace gr{
                 virtual int get_dst_id(int slot) { return -1;};
                 virtual int get_cc(int slot) { return -1;};
 	            virtual std::pair<bool,long> get_terminated(int slot) { return std::pair<bool,long>(false,0);};
+                virtual size_t memory_usage(void) const { return 0; };
                 typedef void (*voice_codec_cb_t)(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
                 virtual void set_voice_codec_callback(voice_codec_cb_t cb, void *user_data) {};
                 rx_base(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue) { };
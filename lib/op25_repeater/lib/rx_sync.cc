@@ -59,6 +59,48 @@ void rx_sync::cbuf_insert(const uint8_t c) {
 	d_cbuf_idx = (d_cbuf_idx + 1) % CBUF_SIZE;
 }
 
+void rx_sync::cbuf_insert(const uint8_t *syms, int n) {
+	while (n > 0) {
+		const int k = std::min(n, CBUF_SIZE - (int) d_cbuf_idx);
+		memcpy(d_cbuf + d_cbuf_idx, syms, k);
+		memcpy(d_cbuf + d_cbuf_idx + CBUF_SIZE, syms, k);
+		d_cbuf_idx = (d_cbuf_idx + k) % CBUF_SIZE;
+		syms += k;
+		n -= k;
+	}
+}
+
+// Number of leading symbols in syms[0, nsyms) that complete none of the
+// sync patterns rx_sym() looks for, with sync_reg shifted past them. The
+// patterns matched exactly take a compare each, only those of the current
+// protocol (when d_threshold allows errors) need a bit count.
+int rx_sync::sync_scan(const uint8_t *syms, int nsyms, uint64_t &sync_reg) const {
+	uint64_t magic[KNOWN_MAGICS], mask[KNOWN_MAGICS];
+	int n_exact = 0, n_fuzzy = KNOWN_MAGICS;
+
+	for (int i = 0; i < KNOWN_MAGICS; i++) {
+		const int j = (SYNC_MAGIC[i].type == d_current_type && d_threshold > 0) ? --n_fuzzy : n_exact++;
+		magic[j] = SYNC_MAGIC[i].magic;
+		mask[j] = (1LL << MODE_DATA[SYNC_MAGIC[i].type].sync_len) - 1LL;
+	}
+
+	uint64_t reg = sync_reg;
+	int i;
+	for (i = 0; i < nsyms; i++) {
+		const uint64_t r = (reg << 2) | (syms[i] & 3);
+		bool hit = false;
+		for (int j = 0; j < n_exact; j++)
+			hit |= ((r ^ magic[j]) & mask[j]) == 0;
+		for (int j = n_fuzzy; j < KNOWN_MAGICS; j++)
+			hit |= check_frame_sync(r ^ magic[j], d_threshold, MODE_DATA[d_current_type].sync_len);
+		if (hit)
+			break;
+		reg = r;
+	}
+	sync_reg = reg;
+	return i;
+}
+
 void rx_sync::reset_timer(void) {
 	sync_timer.reset();
 	p25fdma.reset_timer();
@@ -220,7 +262,7 @@ void rx_sync::ysf_sync(const uint8_t dibitbuf[], bool& ysf_fullrate, bool& unmut
 		fprintf(stderr, "%s ysf_sync: muting audio: dt: %d, rc: %d\n", logts.get(d_msgq_id), d_shift_reg, rc);
 }
 
-rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<std::deque<int16_t>, 2> &output_queue, bool d_soft_vocoder) :	// constructor
+rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<audio_queue, 2> &output_queue, bool d_soft_vocoder) :	// constructor
 	sync_timer(op25_timer(1000000)),
 	d_symbol_count(0),
 	d_sync_reg(0),
@@ -232,8 +274,9 @@ rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, g
 	d_slot_mask(3),
 	d_slot_key(0),
 	output_queue(output_queue),
-	p25fdma(d_audio, logger, debug, true, false, true, queue, d_output_queue[0], true, d_soft_vocoder, msgq_id),
-	p25tdma(d_audio, logger, 0, debug, true, queue, d_output_queue[0], true, d_soft_vocoder, msgq_id),
+	// voice codewords only reach the codec callback, these make no audio
+	p25fdma(d_audio, logger, debug, true, false, true, queue, output_queue[0], false, d_soft_vocoder, msgq_id),
+	p25tdma(d_audio, logger, 0, debug, true, queue, output_queue[0], false, d_soft_vocoder, msgq_id),
 	d_soft_vocoder(d_soft_vocoder),
 	dmr(logger, debug, msgq_id, queue),
 	d_msgq_id(msgq_id),
@@ -256,6 +299,10 @@ rx_sync::rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, g
 	mbe_initToneParms (&tone_mp[1]);
 	mbe_err_cnt[0] = 0;
 	mbe_err_cnt[1] = 0;
+	// the first frame after sync may start before the first symbol received
+	memset(d_cbuf, 0, sizeof(d_cbuf));
+	d_unmute_until[0] = 0;
+	d_unmute_until[1] = 0;
 	sync_reset();
 }
 
@@ -454,12 +501,12 @@ void rx_sync::codeword(const uint8_t* cw, const enum codeword_types codeword_typ
 	int16_t samp_buf[IMBE_SAMPLES_PER_FRAME];
 
 	if (do_tone) {
-		d_software_decoder[slot_id].decode_tone(samp_buf, tone_mp[slot_id].ID, tone_mp[slot_id].AD, &tone_mp[slot_id].n);
+		get_software_decoder(slot_id).decode_tone(samp_buf, tone_mp[slot_id].ID, tone_mp[slot_id].AD, &tone_mp[slot_id].n);
 	} else {
 		mbe_moveMbeParms (&cur_mp[slot_id], &prev_mp[slot_id]);
 		if (do_fullrate) {
 			if (d_soft_vocoder) {
-				d_software_decoder[slot_id].decode(samp_buf, fullrate_cw);
+				get_software_decoder(slot_id).decode(samp_buf, fullrate_cw);
 			} else {
 				int16_t frame_vector[8];
 
@@ -467,27 +514,21 @@ void rx_sync::codeword(const uint8_t* cw, const enum codeword_types codeword_typ
                     frame_vector[i] = u[i];
                 }
                 frame_vector[7] >>= 1;
-                d_imbe_vocoder[slot_id].imbe_decode(frame_vector, samp_buf);
+                get_imbe_vocoder(slot_id).imbe_decode(frame_vector, samp_buf);
 			}
 		} else {	/* halfrate */
 			if (!do_silence) {
 				if (d_soft_vocoder) {
-					d_software_decoder[slot_id].decode_tap(samp_buf, cur_mp[slot_id].L, 0, cur_mp[slot_id].w0, &cur_mp[slot_id].Vl[1], &cur_mp[slot_id].Ml[1]);
+					get_software_decoder(slot_id).decode_tap(samp_buf, cur_mp[slot_id].L, 0, cur_mp[slot_id].w0, &cur_mp[slot_id].Vl[1], &cur_mp[slot_id].Ml[1]);
 				} else {
-					d_imbe_vocoder[slot_id].decode_tap(samp_buf, cur_mp[slot_id].L, cur_mp[slot_id].w0, &cur_mp[slot_id].Vl[1], &cur_mp[slot_id].Ml[1]);
+					get_imbe_vocoder(slot_id).decode_tap(samp_buf, cur_mp[slot_id].L, cur_mp[slot_id].w0, &cur_mp[slot_id].Vl[1], &cur_mp[slot_id].Ml[1]);
 				}
 			}
 		}
 	}
-	float snd;
-	for (int i=0; i < NSAMP_OUTPUT; i++) {
-		if (do_silence) {
-			snd = 0.0f;
-		} else {
-			snd = samp_buf[i];
-		}
-		output_queue[slot_id].push_back(snd);
-	}
+	if (do_silence)
+		memset(samp_buf, 0, sizeof(samp_buf));
+	output_queue[slot_id].push(samp_buf, NSAMP_OUTPUT);
 	//output(samp_buf, slot_id);
 }
 
@@ -498,6 +539,30 @@ void rx_sync::output(int16_t * samp_buf, const ssize_t slot_id) {
 		d_audio.send_audio(samp_buf, NSAMP_OUTPUT * sizeof(int16_t));
 }
 
+software_imbe_decoder& rx_sync::get_software_decoder(int slot_id) {
+	if (!d_software_decoder[slot_id])
+		d_software_decoder[slot_id].reset(new software_imbe_decoder());
+	return *d_software_decoder[slot_id];
+}
+
+imbe_vocoder& rx_sync::get_imbe_vocoder(int slot_id) {
+	if (!d_imbe_vocoder[slot_id])
+		d_imbe_vocoder[slot_id].reset(new imbe_vocoder());
+	return *d_imbe_vocoder[slot_id];
+}
+
+// bytes held by the decoder, including the vocoders once allocated
+size_t rx_sync::memory_usage(void) const {
+	size_t bytes = sizeof(*this) - sizeof(p25fdma) - sizeof(p25tdma) + p25fdma.memory_usage() + p25tdma.memory_usage();
+	for (int i = 0; i < 2; i++) {
+		if (d_software_decoder[i])
+			bytes += d_software_decoder[i]->memory_usage();
+		if (d_imbe_vocoder[i])
+			bytes += d_imbe_vocoder[i]->memory_usage();
+	}
+	return bytes;
+}
+
 std::pair<bool,long> rx_sync::get_terminated(int slot) {
 	if ((slot == 0) || (slot == 1)) {
 		return dmr.get_terminated(slot);
@@ -530,6 +595,37 @@ int rx_sync::get_cc(int slot) {
 	return -1;
 }
 
+// Block version of rx_sym(). Symbols that can neither complete a sync
+// pattern or a fragment nor expire the current sync only need shifting in,
+// so runs of them are consumed by sync_scan() and cbuf_insert() and just
+// the symbol ending each run goes through rx_sym().
+void rx_sync::rx_syms(const uint8_t *syms, int nsyms)
+{
+    if (d_slot_mask & 0x4) { // Setting bit 3 of slot mask disables framing for idle receiver 
+        return;
+    }
+
+	int i = 0;
+	while (i < nsyms) {
+		int run = nsyms - i;
+		if (d_current_type != RX_TYPE_NONE) {
+			run = std::min(run, d_fragment_len - d_rx_count - 1);
+			run = std::min(run, (d_expires > d_symbol_count) ? (int) (d_expires - d_symbol_count) - 1 : 0);
+			run = std::max(run, 0);
+		}
+		const int n = sync_scan(syms + i, run, d_sync_reg);
+		cbuf_insert(syms + i, n);
+		d_symbol_count += n;
+		if (d_current_type != RX_TYPE_NONE)
+			d_rx_count += n;
+		else if (n > 0 && sync_timer.expired())
+			sync_timeout(RX_TYPE_NONE);
+		i += n;
+		if (i < nsyms)
+			rx_sym(syms[i++]);
+	}
+}
+
 void rx_sync::rx_sym(const uint8_t sym)
 {
 	uint8_t bitbuf[864*2];
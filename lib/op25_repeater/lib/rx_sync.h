@@ -50,6 +50,7 @@
 #include "op25_imbe_frame.h"
 #include "software_imbe_decoder.h"
 #include "op25_audio.h"
+#include "ring_buffer.h"
 #include "log_ts.h"
 
 #include "rx_base.h"
@@ -114,6 +115,7 @@ enum codeword_types {
 class rx_sync : public rx_base {
 public:
 	void rx_sym(const uint8_t sym);
+	void rx_syms(const uint8_t *syms, int nsyms);
 	void sync_reset(void);
 	void reset_timer(void);
 	void call_end(void);
@@ -128,16 +130,21 @@ public:
 	int get_dst_id(int slot);
 	int get_cc(int slot);
 	std::pair<bool,long> get_terminated(int slot);
-	rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<std::deque<int16_t>, 2> &output_queue, bool d_soft_vocoder);
+	size_t memory_usage(void) const;
+	rx_sync(const char * options, log_ts& logger, int debug, int msgq_id, gr::msg_queue::sptr queue, std::array<audio_queue, 2> &output_queue, bool d_soft_vocoder);
 	~rx_sync();
 
 private:
 	void sync_timeout(rx_types proto);
 	void sync_established(rx_types proto);
 	void cbuf_insert(const uint8_t c);
+	void cbuf_insert(const uint8_t *syms, int n);
+	int sync_scan(const uint8_t *syms, int nsyms, uint64_t &sync_reg) const;
 	void ysf_sync(const uint8_t dibitbuf[], bool& ysf_fullrate, bool& unmute);
 	void codeword(const uint8_t* cw, const enum codeword_types codeword_type, int slot_id);
 	void output(int16_t * samp_buf, const ssize_t slot_id);
+	software_imbe_decoder& get_software_decoder(int slot_id);
+	imbe_vocoder& get_imbe_vocoder(int slot_id);
 	static const int CBUF_SIZE=864;
 	static const int NSAMP_OUTPUT = 160;
 
@@ -166,9 +173,9 @@ private:
 	mbe_tone tone_mp[2];
 	int mbe_err_cnt[2];
 	bool d_soft_vocoder;
-	software_imbe_decoder d_software_decoder[2];
-	imbe_vocoder d_imbe_vocoder[2];
-	std::deque<int16_t> d_output_queue[2];
+	// Per slot vocoders, allocated with the first voice frame that needs them
+	std::unique_ptr<software_imbe_decoder> d_software_decoder[2];
+	std::unique_ptr<imbe_vocoder> d_imbe_vocoder[2];
 	dmr_cai dmr;
 	int d_msgq_id;
 	gr::msg_queue::sptr d_msg_queue;
@@ -176,7 +183,7 @@ private:
 	int d_debug;
 	op25_audio d_audio;
 	log_ts& logts;
-	std::array<std::deque<int16_t>, 2> &output_queue;
+	std::array<audio_queue, 2> &output_queue;
 	int src_id[2];
 
 	typedef void (*voice_codec_cb_t)(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
@@ -35,6 +35,7 @@
 #include <fcntl.h>
 #include <math.h>
 #include <string.h>
+#include <volk/volk.h>
 
 static const int BMTn[3600] = {
 	3, 3, 4, 5, 6, 7, 8, 3, 4, 5, 6, 7, 8, 9, 3, 4,
@@ -729,7 +730,9 @@ static const float PhzNz[57] = {
 	0.068775, 0.520336, 2.339119, -0.808328, 1.332154, 2.929768, -0.338316, 0.022767, -1.063795
 };
 
-software_imbe_decoder::software_imbe_decoder()
+software_imbe_decoder::software_imbe_decoder() :
+   uw_fft(new gr::fft::fft_real_fwd(256)),
+   uw_ifft(new gr::fft::fft_real_rev(256))
 {
    int i,j;
 	//initialize
@@ -747,8 +750,14 @@ software_imbe_decoder::software_imbe_decoder()
    for(i=0; i < 57; i++) {
       for(j=0; j < 2; j++) {
          phi[i][j] = 0.0;
+         M[i][j] = 0.0;
+         Mu[i][j] = 0.0;
+         vee[i][j] = 0;
       }
    }
+   w0 = 0.0;
+   Oldw0 = 0.0;
+   Luv = 0.0;
    for(i=0; i < 256; i++) {
       Olduw[i] = 0.0;
    }
@@ -767,6 +776,13 @@ software_imbe_decoder::~software_imbe_decoder()
 {
 }
 
+size_t
+software_imbe_decoder::memory_usage() const
+{
+	// real input/output and the 129 bin half spectrum, both directions
+	return sizeof(*this) + 2 * (256 * sizeof(float) + 129 * sizeof(gr_complex));
+}
+
 void
 software_imbe_decoder::decode(int16_t samples[IMBE_SAMPLES_PER_FRAME], const voice_codeword& cw)
 {
@@ -815,51 +831,6 @@ software_imbe_decoder::adaptive_smoothing(float SE, float ET)
    }
 }
 
-void
-software_imbe_decoder::fft(float REX[], float IMX[])
-{
-   int I;
-   int J;
-   int K;
-   int H;
-   int KpH;
-   int Ht2;
-   float tmp_f;
-   float l_Ui, l_Uq, Theta, Si, Sq, Ti, Xi, Tq, Xq;
-
-   J = 64;
-   for(I = 1; I <= 126; I++) {
-#define SWAP(x,y) tmp_f=x;x=y;y=tmp_f
-      if(I < J) { SWAP(REX[J], REX[I]); SWAP(IMX[J], IMX[I]); }
-#undef SWAP
-      K = 64;
-      while(K <= J) { J = J - K; K = K / 2; }
-      J = J + K;
-   }
-
-   H = 1;
-   for(I = 1; I <= 7; I++) {
-      Ht2 = H * 2; l_Ui = 1; l_Uq = 0;
-      Theta = M_PI / H; Si = cos(Theta); Sq = -sin(Theta);
-      for(J = 1; J <= H; J++) {
-         for(K = J - 1; K <= 127; K+=Ht2) {
-            KpH = K + H;
-
-            Ti = REX[KpH] * l_Ui - IMX[KpH] * l_Uq; Xi = REX[K];
-            Tq = REX[KpH] * l_Uq + IMX[KpH] * l_Ui; Xq = IMX[K];
-
-            REX[KpH] = Xi - Ti; REX[K] = Xi + Ti;
-            IMX[KpH] = Xq - Tq; IMX[K] = Xq + Tq;
-         }
-         Ti = l_Ui;
-         l_Ui = Ti * Si - l_Uq * Sq;
-         l_Uq = Ti * Sq + l_Uq * Si;
-      }
-      H = Ht2;
-   }
-
-}
-
 void
 software_imbe_decoder::decode_fullrate(int16_t samples[IMBE_SAMPLES_PER_FRAME], uint32_t u0, uint32_t u1, uint32_t u2, uint32_t u3, uint32_t u4, uint32_t u5, uint32_t u6, uint32_t u7, uint32_t E0, uint32_t ET)
 {
@@ -1302,74 +1273,25 @@ software_imbe_decoder::enhance_spectral_amplitudes(float& SE)
 }
 
 void
-software_imbe_decoder::ifft(float FDi[], float FDq[], float TD[]) // ToDo: replace "real IFFT" with fftw3 IFFT proc!
+software_imbe_decoder::ifft(float FDi[], float FDq[], float TD[])
 {
 	//Inverse FFT:
 	//  transform 129-point freq domain(FDx) to 256-point time domain(TD)
-
-   float Ai[128];
-   float Aq[128];
-
-   int I;
-   int J;
-   int K;
-   int H;
-   float l_Ui, l_Uq, Si, Sq, Ti, Tq, Xi, Xq;
-
-   for(I = 0; I <= 63; I++) {
-      J = I + 64;    //64 to 127
-      K = I * 2;     //0 to 126(step 2)
-      H = 128 - K;   //128 to 2(step 2)
-      Ai[I] = FDi[K] + FDq[K];
-      Aq[I] = FDi[K + 1] + FDq[K + 1];
-      Ai[J] = FDi[H] - FDq[H];
-      Aq[J] = FDi[H - 1] - FDq[H - 1];
-   }
-
-   fft(Ai, Aq);
-
-   for(I = 1; I <= 63; I++) {
-      J = 128 - I;    //127 to 65
-      K = I + 128;    //129 to 191
-      H = J + 128;    //255 to 193
-      FDi[K] = (Aq[I] + Aq[J]) / 2;
-      FDi[H] = FDi[K]  ; //a
-      FDq[K] = -(Ai[I] - Ai[J]) / 2;
-      FDq[H] = -FDq[K] ; //b
-      FDi[I] = (Ai[I] + Ai[J]) / 2;
-      FDi[J] = FDi[I]  ; //c
-      FDq[I] = (Aq[I] - Aq[J]) / 2;
-      FDq[J] = -FDq[I] ; //d
+	//
+	//  TD(n) = sum over k of FDi(k) cos(2 pi k (n - 128) / 256) + FDq(k) sin(2 pi k (n - 128) / 256),
+	//  with both sides of the spectrum, which is a real inverse FFT of
+	//  (FDi(k) - j FDq(k)) * (-1)^k. The (-1)^k moves the origin to n = 128.
+
+   gr_complex *in = uw_ifft->get_inbuf();
+   in[0] = FDi[0] + FDq[0];
+   for(int k = 1; k <= 127; k++) {
+      const float sign = (k & 1) ? -1 : 1;
+      in[k] = gr_complex(sign * FDi[k], -sign * FDq[k]);
    }
+   in[128] = FDi[128] - FDq[128];
 
-   // I,J=64  K,H=192
-   FDi[192] = Aq[64]; //a
-   FDq[192] = 0     ; //b
-   FDi[64] = Ai[64] ; //c (new)
-   FDq[64] = 0      ; //d
-
-   //I=0  J,K=128  H=256  ( Ax(128) wraps to Ax(0))
-   FDi[128] = Aq[0] ; //a
-   FDq[128] = 0     ; //b
-   FDi[0] = Ai[0]   ; //c (new)
-   FDq[0] = 0       ; //d
-
-   l_Ui = 1; l_Uq = 0;
-   Si = cos(M_PI / 128); Sq = -sin(M_PI / 128);
-   for(I = 0; I <= 127; I++) {
-      J = I + 128  ;   //128 TO 255
-
-      Ti = FDi[J] * l_Ui - FDq[J] * l_Uq; Xi = FDi[I];
-      Tq = FDi[J] * l_Uq + FDq[J] * l_Ui; Xq = FDq[I];
-
-
-      TD[I + 128] =((Xi + Ti) -(Xq + Tq));
-      TD[I      ] =((Xi - Ti) -(Xq - Tq));
-
-      Ti = l_Ui;
-      l_Ui = Ti * Si - l_Uq * Sq;
-      l_Uq = Ti * Sq + l_Uq * Si;
-   }
+   uw_ifft->execute();
+   memcpy(TD, uw_ifft->get_outbuf(), 256 * sizeof(float));
 }
 
 uint16_t
@@ -1500,6 +1422,16 @@ software_imbe_decoder::synth_unvoiced()
       u[en] = next_u(u[en-1]);
    }
 
+   // Uw(m) = sum of u(n) ws(n) exp(-j 2 pi m (n - 105) / 256) for every m at
+   // once, with n - 105 wrapped into the transform
+   float *uws = uw_fft->get_inbuf();
+   memset(uws, 0, 256 * sizeof(float));
+   for (en = 0; en < 211; en++) {
+      uws[(en - 105) & 255] = u[en] * ws[en];
+   }
+   uw_fft->execute();
+   const gr_complex *Uw = uw_fft->get_outbuf();
+
    ell = 0; bl =(int) ceilf(128 / M_PI *(ell + .5) * w0);
    for(em = 0; em <= bl - 1; em++) {
       Uwi[em] = 0; Uwq[em] = 0;
@@ -1516,13 +1448,8 @@ software_imbe_decoder::synth_unvoiced()
       } else {
          Luv = Luv + 1;
          for(em = al; em <= bl - 1; em++) {
-            Uwi[em] = 0;
-            Uwq[em] = 0;
-            for (en = 0; en < 211; en++) {
-               float exp = -0.0078125 * M_PI * em * (en - 105);
-               Uwi[em] = Uwi[em] + u[en] * ws[en] * cos(exp);
-               Uwq[em] = Uwq[em] + u[en] * ws[en] * sin(exp);
-            }
+            Uwi[em] = Uw[em].real();
+            Uwq[em] = Uw[em].imag();
          }
          //precompute Tmp = <most of big hairy equation>
          Tmp = 0;
@@ -1602,6 +1529,12 @@ software_imbe_decoder::synth_voiced()
       sv[en] = 0;
    }
 
+   // Each harmonic is a gain and a phase per sample, summed into sv by
+   // add_harmonic(). The phases are the same expressions as before, only the
+   // cosine is vectorized.
+   float gain[160];
+   float phase[160];
+
    for(ell = 1; ell <= MaxL; ell++) {
 
       if(ell > L) { 
@@ -1625,32 +1558,57 @@ software_imbe_decoder::synth_voiced()
                THb = (w0 - Oldw0) * ell * .003125;
                Mb = .00625 *(MNew - MOld);
                for(en = 0; en <= 159; en++) {
-                  sv[en] = sv[en] +(MOld + en * Mb) * cos(phi[ell][ Old] +(THa + THb * en) * en);
+                  gain[en] = MOld + en * Mb;
+                  phase[en] = phi[ell][ Old] +(THa + THb * en) * en;
                }
+               add_harmonic(0, 159, gain, phase);
             } else { // (coarse transition)
-               for(en = 0; en <= 55; en++) {
-                  sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell] [ Old]);
-               }
-               for(en = 56; en <= 105; en++) {
-                  sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell][ Old]);
-                  sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
+               for(en = 0; en <= 105; en++) {
+                  gain[en] = ws[en+105] * MOld;
+                  phase[en] = Oldw0 * en * ell + phi[ell][ Old];
                }
-               for(en = 106; en <= 159; en++) {
-                  sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
+               add_harmonic(0, 105, gain, phase);
+               for(en = 56; en <= 159; en++) {
+                  gain[en] = ws[en-55] * MNew;
+                  phase[en] = w0 *(en - 160) * ell + phi[ell][ New];
                }
+               add_harmonic(56, 159, gain, phase);
             }
          } else {
             for(en = 56; en <= 159; en++) {
-               sv[en] = sv[en] + ws[en-55] * MNew * cos(w0 *(en - 160) * ell + phi[ell][ New]);
+               gain[en] = ws[en-55] * MNew;
+               phase[en] = w0 *(en - 160) * ell + phi[ell][ New];
             }
+            add_harmonic(56, 159, gain, phase);
          }
       } else {
          if( vee[ell][Old]) {
             for(en = 0; en <= 105; en++) {
-               sv[en] = sv[en] + ws[en+105] * MOld * cos(Oldw0 * en * ell + phi[ell][ Old]);
+               gain[en] = ws[en+105] * MOld;
+               phase[en] = Oldw0 * en * ell + phi[ell][ Old];
             }
+            add_harmonic(0, 105, gain, phase);
          }
       }
    }
 }
 
+// sv(n) += gain(n) * cos(phase(n)) for n = first to last, through the
+// VOLK kernels picked for this machine at run time. The phases run to a few
+// thousand radians, where the VOLK cosine loses accuracy, so they are first
+// brought into [-pi, pi] in double.
+void
+software_imbe_decoder::add_harmonic(int first, int last, const float gain[], const float phase[])
+{
+   float osc[160];
+   const unsigned int n = last - first + 1;
+
+   for(int en = first; en <= last; en++) {
+      osc[en] = remainder((double)phase[en], 2 * M_PI);
+   }
+   volk_32f_cos_32f(osc + first, osc + first, n);
+   volk_32f_x2_multiply_32f(osc + first, osc + first, gain + first, n);
+   volk_32f_x2_add_32f(sv + first, sv + first, osc + first, n);
+
+}
+
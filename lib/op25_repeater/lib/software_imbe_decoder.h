@@ -26,10 +26,17 @@
 
 #include "imbe_decoder.h"
 
+#include <gnuradio/fft/fft.h>
+#include <memory>
 #include <stdint.h>
 
 /**
  * A software implementation of the imbe_decoder interface.
+ *
+ * The unvoiced spectrum goes through planned gr::fft transforms and the
+ * voiced harmonics through VOLK, so the output can differ from a scalar
+ * build by one LSB on a small fraction of samples. imbe_bench checks this
+ * against software_imbe_decoder_scalar.
  */
 class software_imbe_decoder : public imbe_decoder {
 public:
@@ -54,6 +61,12 @@ public:
 	void decode_fullrate(int16_t samples[IMBE_SAMPLES_PER_FRAME], uint32_t u0, uint32_t u1, uint32_t u2, uint32_t u3, uint32_t u4, uint32_t u5, uint32_t u6, uint32_t u7, uint32_t E0, uint32_t ET);
 	void decode_tap(int16_t samples[IMBE_SAMPLES_PER_FRAME], int _L, int _K, float _w0, const int * _v, const float * _mu);
 	void decode_tone(int16_t samples[IMBE_SAMPLES_PER_FRAME], int _ID, int _AD, int * _n);
+
+	/**
+	 * Bytes held by this decoder, including the FFT buffers but not the
+	 * FFTW plans themselves.
+	 */
+	size_t memory_usage() const;
 private:
 
 	//NOTE: Single-letter variable names are upper case only; Lower
@@ -82,10 +95,9 @@ private:
 	float Oldw0;
 	float Luv;						//number of unvoiced spectral amplitudes
 
-	char sym_b[4096];
-	char RxData[4096];
-	int sym_bp;
-	int ErFlag;
+	// 256 point transforms for the unvoiced spectrum, planned with the decoder
+	std::unique_ptr<gr::fft::fft_real_fwd> uw_fft;
+	std::unique_ptr<gr::fft::fft_real_rev> uw_ifft;
 
 	uint32_t pngen15(uint32_t& pn);
 	uint32_t pngen23(uint32_t& pn);
@@ -93,12 +105,12 @@ private:
 	void decode_spectral_amplitudes(int, int );
 	void decode_vuv(int );
 	void adaptive_smoothing(float, float );
-	void fft(float i[], float q[]);
 	void enhance_spectral_amplitudes(float&);
 	void ifft(float i[], float q[], float[]);
 	uint16_t rearrange(uint32_t u0, uint32_t u1, uint32_t u2, uint32_t u3, uint32_t u4, uint32_t u5, uint32_t u6, uint32_t u7);
 	void synth_unvoiced();
 	void synth_voiced();
+	void add_harmonic(int first, int last, const float gain[], const float phase[]);
 	void unpack(uint8_t *buf, uint32_t& u0, uint32_t& u1, uint32_t& u2, uint32_t& u3, uint32_t& u4, uint32_t& u5, uint32_t& u6, uint32_t& u7, uint32_t& E0, uint32_t& ET);
 	int repeat_last();
 };
@@ -0,0 +1,306 @@
+/*
+ * Stand-alone check and benchmark for the block rx_syms() paths of
+ * p25p2_framer and rx_sync.
+ *
+ * A random stream of dibits carrying every sync pattern rx_sync knows,
+ * some of them corrupted, misaligned or followed by a short frame, is fed
+ * once a symbol at a time through rx_sym() and once in random sized blocks
+ * through rx_syms(). Both must give the same result: for p25p2_framer the
+ * same frames at the same positions, for rx_sync the same messages, voice
+ * codewords and audio. Then both paths are timed on the same stream and the
+ * rate is reported in symbols per second.
+ *
+ * usage: sync_bench [seconds per benchmark]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <array>
+#include <chrono>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "p25p2_framer.h"
+#include "rx_sync.h"
+#include "op25_msg_types.h"
+
+using namespace gr::op25_repeater;
+
+static const int STREAM_BURSTS = 20000;
+static const int MAX_BLOCK = 3000;
+static const char NO_AUDIO[] = "nowhere";	// neither udp:// nor file://
+
+static std::mt19937 rng(45);
+
+static int failures = 0;
+
+static void fail(const char *what)
+{
+	if (failures++ < 10)
+		printf("mismatch: %s\n", what);
+}
+
+/*
+ * Sync words followed by a frame's worth of random dibits, with some
+ * noise between bursts. One sync in four has bit errors and one frame in
+ * four is a few dibits short or long.
+ */
+static std::vector<uint8_t> make_stream(int bursts)
+{
+	std::vector<uint8_t> s;
+	for (int b = 0; b < bursts; b++) {
+		if (rng() % 8 == 0) {
+			const int n = rng() % 400;
+			for (int k = 0; k < n; k++)
+				s.push_back(rng() & 3);
+			continue;
+		}
+		const _sync_magic &m = SYNC_MAGIC[rng() % KNOWN_MAGICS];
+		const int sync_len = MODE_DATA[m.type].sync_len;
+		uint64_t p = m.magic;
+		if (rng() % 4 == 0) {
+			const int errs = 1 + rng() % 4;
+			for (int k = 0; k < errs; k++)
+				p ^= 1ULL << (rng() % sync_len);
+		}
+		for (int k = sync_len / 2 - 1; k >= 0; k--)
+			s.push_back((p >> (2 * k)) & 3);
+
+		int len = MODE_DATA[m.type].fragment_len - sync_len / 2;
+		if (rng() % 4 == 0)
+			len += (int) (rng() % 21) - 10;
+		for (int k = 0; k < len; k++)
+			s.push_back(rng() & 3);
+	}
+	return s;
+}
+
+static std::vector<size_t> make_blocks(size_t total)
+{
+	std::vector<size_t> blocks;
+	while (total > 0) {
+		size_t n = 1 + rng() % MAX_BLOCK;
+		if (n > total)
+			n = total;
+		blocks.push_back(n);
+		total -= n;
+	}
+	return blocks;
+}
+
+struct p2_frame {
+	size_t end;
+	uint64_t fs;
+	bit_array<P25P2_BURST_SIZE> body;
+	bool operator==(const p2_frame& o) const {
+		return end == o.end && fs == o.fs && body.size() == o.body.size() &&
+		       memcmp(body.words(), o.body.words(), sizeof(uint64_t) * body.WORDS) == 0;
+	}
+};
+
+static void check_p2_framer(const std::vector<uint8_t>& s, const std::vector<size_t>& blocks)
+{
+	std::vector<p2_frame> a, b;
+
+	p25p2_framer fa;
+	for (size_t i = 0; i < s.size(); i++)
+		if (fa.rx_sym(s[i]))
+			a.push_back(p2_frame{i, fa.get_fs(), fa.d_frame_body});
+
+	p25p2_framer fb;
+	size_t pos = 0;
+	for (size_t n : blocks) {
+		for (size_t off = 0; off < n; ) {
+			bool frame;
+			off += fb.rx_syms(&s[pos + off], n - off, frame);
+			if (frame)
+				b.push_back(p2_frame{pos + off - 1, fb.get_fs(), fb.d_frame_body});
+		}
+		pos += n;
+	}
+
+	printf("p25p2_framer: %zu frames\n", a.size());
+	if (a != b)
+		fail("p25p2_framer frames");
+	if (fa.symbols_received != fb.symbols_received)
+		fail("p25p2_framer symbols_received");
+}
+
+/* Everything an rx_sync hands to the rest of the receiver */
+struct sync_output {
+	std::vector<std::string> msgs;
+	std::vector<std::vector<long> > codewords;
+	std::vector<int16_t> audio[2];
+};
+
+static void on_codeword(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data)
+{
+	std::vector<long> cw = {codec_type, tgid, (long) src_id, errs};
+	cw.insert(cw.end(), params, params + param_count);
+	((sync_output *) user_data)->codewords.push_back(cw);
+}
+
+static void drain(std::array<audio_queue, 2>& q, gr::msg_queue::sptr msgq, sync_output& out)
+{
+	for (int slot = 0; slot < 2; slot++) {
+		if (q[slot].take_dropped())
+			fail("rx_sync audio queue overflow");
+		std::vector<int16_t> &audio = out.audio[slot];
+		const size_t n = q[slot].size();
+		audio.resize(audio.size() + n);
+		q[slot].pop(&audio[audio.size() - n], n);
+	}
+	for (gr::message::sptr msg = msgq->delete_head_nowait(); msg; msg = msgq->delete_head_nowait()) {
+		// timeouts come from a wall clock timer, not from the symbols
+		const int16_t type = msg->type() & 0xffff;
+		if ((type == M_P25_TIMEOUT) || (type == M_DMR_TIMEOUT))
+			continue;
+		out.msgs.push_back(std::to_string(msg->type()) + " " + std::to_string(msg->arg1()) + " " + msg->to_string());
+	}
+}
+
+static void check_rx_sync(const std::vector<uint8_t>& s, const std::vector<size_t>& blocks)
+{
+	log_ts logts;
+	sync_output a, b;
+
+	// Both use the software decoder: the noise generator in imbe_vocoder
+	// is shared by every instance, so its audio differs from run to run
+
+	{
+		gr::msg_queue::sptr msgq = gr::msg_queue::make(0);
+		std::array<audio_queue, 2> q;
+		rx_sync rx(NO_AUDIO, logts, 0, 0, msgq, q, true);
+		rx.set_voice_codec_callback(on_codeword, &a);
+		for (size_t i = 0; i < s.size(); i++) {
+			rx.rx_sym(s[i]);
+			if (i % 512 == 511)
+				drain(q, msgq, a);
+		}
+		drain(q, msgq, a);
+	}
+
+	{
+		gr::msg_queue::sptr msgq = gr::msg_queue::make(0);
+		std::array<audio_queue, 2> q;
+		rx_sync rx(NO_AUDIO, logts, 0, 0, msgq, q, true);
+		rx.set_voice_codec_callback(on_codeword, &b);
+		size_t pos = 0;
+		for (size_t n : blocks) {
+			// no more than the audio queues take, as frame_assembler does
+			for (size_t off = 0; off < n; ) {
+				const int k = audio_queue_budget(q[0], audio_queue_budget(q[1], n - off));
+				rx.rx_syms(&s[pos + off], k);
+				off += k;
+				drain(q, msgq, b);
+			}
+			pos += n;
+		}
+	}
+
+	printf("rx_sync: %zu messages, %zu voice codewords, %zu + %zu audio samples\n",
+	       a.msgs.size(), a.codewords.size(), a.audio[0].size(), a.audio[1].size());
+	if (a.msgs != b.msgs)
+		fail("rx_sync messages");
+	if (a.codewords != b.codewords)
+		fail("rx_sync voice codewords");
+	if (a.audio[0] != b.audio[0] || a.audio[1] != b.audio[1])
+		fail("rx_sync audio");
+}
+
+// Runs fn() over the stream until secs have passed, returns symbols/s
+template <typename F>
+static double run(double secs, size_t nsyms, F fn)
+{
+	typedef std::chrono::steady_clock clock;
+	long count = 0;
+	const clock::time_point start = clock::now();
+	double elapsed;
+
+	do {
+		fn();
+		count += nsyms;
+		elapsed = std::chrono::duration<double>(clock::now() - start).count();
+	} while (elapsed < secs);
+
+	return count / elapsed;
+}
+
+static void report(const char *name, double rate)
+{
+	printf("%-36s %12.0f sym/s\n", name, rate);
+}
+
+static void bench(double secs, const std::vector<uint8_t>& s)
+{
+	static const size_t BLOCK = 4096;
+	volatile long sink = 0;
+
+	report("p25p2_framer rx_sym", run(secs, s.size(), [&]() {
+		p25p2_framer f;
+		for (size_t i = 0; i < s.size(); i++)
+			sink += f.rx_sym(s[i]);
+	}));
+
+	report("p25p2_framer rx_syms", run(secs, s.size(), [&]() {
+		p25p2_framer f;
+		for (size_t i = 0; i < s.size(); ) {
+			bool frame;
+			i += f.rx_syms(&s[i], std::min(BLOCK, s.size() - i), frame);
+			sink += frame;
+		}
+	}));
+
+	// audio and messages are emptied after each block, as frame_assembler would
+	log_ts logts;
+	gr::msg_queue::sptr msgq = gr::msg_queue::make(0);
+	std::array<audio_queue, 2> q;
+	std::vector<int16_t> buf(audio_queue::capacity());
+	const size_t block = audio_queue_budget(q[0], BLOCK);
+	auto flush = [&]() {
+		sink += q[0].pop(&buf[0], buf.size()) + q[1].pop(&buf[0], buf.size());
+		while (msgq->delete_head_nowait())
+			sink++;
+	};
+
+	report("rx_sync rx_sym", run(secs, s.size(), [&]() {
+		rx_sync rx(NO_AUDIO, logts, 0, 0, msgq, q, false);
+		for (size_t i = 0; i < s.size(); i += block) {
+			const size_t e = std::min(i + block, s.size());
+			for (size_t j = i; j < e; j++)
+				rx.rx_sym(s[j]);
+			flush();
+		}
+	}));
+
+	report("rx_sync rx_syms", run(secs, s.size(), [&]() {
+		rx_sync rx(NO_AUDIO, logts, 0, 0, msgq, q, false);
+		for (size_t i = 0; i < s.size(); i += block) {
+			rx.rx_syms(&s[i], std::min(block, s.size() - i));
+			flush();
+		}
+	}));
+}
+
+int main(int argc, char **argv)
+{
+	double secs = (argc > 1) ? atof(argv[1]) : 1.0;
+
+	const std::vector<uint8_t> s = make_stream(STREAM_BURSTS);
+	const std::vector<size_t> blocks = make_blocks(s.size());
+	printf("%zu symbols in %zu blocks\n", s.size(), blocks.size());
+
+	check_p2_framer(s, blocks);
+	check_rx_sync(s, blocks);
+	if (failures) {
+		printf("%d mismatches between rx_sym() and rx_syms()\n", failures);
+		return 1;
+	}
+	printf("rx_syms() matches rx_sym()\n");
+
+	bench(secs, s);
+	return 0;
+}
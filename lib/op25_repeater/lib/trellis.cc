@@ -35,6 +35,24 @@ const unsigned char ENCODE_TABLE[] = {
 	2U, 10U, 6U, 14U, 0U,  8U, 4U, 12U,
 	6U, 14U, 0U,  8U, 4U, 12U, 2U, 10U};
 
+// Inverse of ENCODE_TABLE: DECODE_TABLE[state * 16 + point] is the tribit
+// that moves the encoder out of state with that point, or 9 if none does.
+const unsigned char DECODE_TABLE[] = {
+	0U, 9U, 4U, 9U, 2U, 9U, 6U, 9U, 1U, 9U, 5U, 9U, 3U, 9U, 7U, 9U,
+	6U, 9U, 2U, 9U, 0U, 9U, 4U, 9U, 7U, 9U, 3U, 9U, 1U, 9U, 5U, 9U,
+	9U, 0U, 9U, 4U, 9U, 2U, 9U, 6U, 9U, 1U, 9U, 5U, 9U, 3U, 9U, 7U,
+	9U, 6U, 9U, 2U, 9U, 0U, 9U, 4U, 9U, 7U, 9U, 3U, 9U, 1U, 9U, 5U,
+	9U, 4U, 9U, 0U, 9U, 6U, 9U, 2U, 9U, 5U, 9U, 1U, 9U, 7U, 9U, 3U,
+	9U, 2U, 9U, 6U, 9U, 4U, 9U, 0U, 9U, 3U, 9U, 7U, 9U, 5U, 9U, 1U,
+	4U, 9U, 0U, 9U, 6U, 9U, 2U, 9U, 5U, 9U, 1U, 9U, 7U, 9U, 3U, 9U,
+	2U, 9U, 6U, 9U, 4U, 9U, 0U, 9U, 3U, 9U, 7U, 9U, 5U, 9U, 1U, 9U};
+
+// Bit pair (b1, b2) to dibit
+const signed char DIBIT_TABLE[] = {+1, +3, -1, -3};
+
+// Dibit pair to constellation point, indexed by ((d0 + 3) / 2) * 4 + (d1 + 3) / 2
+const unsigned char POINT_TABLE[] = {3U, 4U, 15U, 8U, 6U, 1U, 10U, 13U, 7U, 0U, 11U, 12U, 2U, 5U, 14U, 9U};
+
 const unsigned char BIT_MASK_TABLE[] = {0x80U, 0x40U, 0x20U, 0x10U, 0x08U, 0x04U, 0x02U, 0x01U};
 
 #define READ_BIT(p,i)    (p[(i)>>3] & BIT_MASK_TABLE[(i)&7])
@@ -84,67 +102,26 @@ bool CDMRTrellis::decode(const unsigned char* data, unsigned char* payload)
 void CDMRTrellis::deinterleave(const unsigned char* data, signed char* dibits) const
 {
 	int n;
-	signed char dibit;
 
 	for (int i = 0; i < 98; i++) {
 		n = i * 2;
 		if (n >= 98) n += 68;
-		bool b1 = data[n] != 0x0;
+		unsigned int b1 = data[n] != 0x0;
 
 		n = i * 2 + 1;
 		if (n >= 98) n += 68;
-		bool b2 = data[n] != 0x0;
-
-		if (!b1 && b2)
-			dibit = +3;
-		else if (!b1 && !b2)
-			dibit = +1;
-		else if (b1 && !b2)
-			dibit = -1;
-		else
-			dibit = -3;
+		unsigned int b2 = data[n] != 0x0;
 
 		n = INTERLEAVE_TABLE[i];
-		dibits[n] = dibit;
+		dibits[n] = DIBIT_TABLE[b1 * 2U + b2];
 	}
 }
 
 void CDMRTrellis::dibitsToPoints(const signed char* dibits, unsigned char* points) const
 {
-	for (unsigned int i = 0U; i < 49U; i++) {
-		if (dibits[i * 2U + 0U] == +1 && dibits[i * 2U + 1U] == -1)
-			points[i] = 0U;
-		else if (dibits[i * 2U + 0U] == -1 && dibits[i * 2U + 1U] == -1)
-			points[i] = 1U;
-		else if (dibits[i * 2U + 0U] == +3 && dibits[i * 2U + 1U] == -3)
-			points[i] = 2U;
-		else if (dibits[i * 2U + 0U] == -3 && dibits[i * 2U + 1U] == -3)
-			points[i] = 3U;
-		else if (dibits[i * 2U + 0U] == -3 && dibits[i * 2U + 1U] == -1)
-			points[i] = 4U;
-		else if (dibits[i * 2U + 0U] == +3 && dibits[i * 2U + 1U] == -1)
-			points[i] = 5U;
-		else if (dibits[i * 2U + 0U] == -1 && dibits[i * 2U + 1U] == -3)
-			points[i] = 6U;
-		else if (dibits[i * 2U + 0U] == +1 && dibits[i * 2U + 1U] == -3)
-			points[i] = 7U;
-		else if (dibits[i * 2U + 0U] == -3 && dibits[i * 2U + 1U] == +3)
-			points[i] = 8U;
-		else if (dibits[i * 2U + 0U] == +3 && dibits[i * 2U + 1U] == +3)
-			points[i] = 9U;
-		else if (dibits[i * 2U + 0U] == -1 && dibits[i * 2U + 1U] == +1)
-			points[i] = 10U;
-		else if (dibits[i * 2U + 0U] == +1 && dibits[i * 2U + 1U] == +1)
-			points[i] = 11U;
-		else if (dibits[i * 2U + 0U] == +1 && dibits[i * 2U + 1U] == +3)
-			points[i] = 12U;
-		else if (dibits[i * 2U + 0U] == -1 && dibits[i * 2U + 1U] == +3)
-			points[i] = 13U;
-		else if (dibits[i * 2U + 0U] == +3 && dibits[i * 2U + 1U] == +1)
-			points[i] = 14U;
-		else if (dibits[i * 2U + 0U] == -3 && dibits[i * 2U + 1U] == +1)
-			points[i] = 15U;
-	}
+	// deinterleave() only produces -3, -1, +1 and +3
+	for (unsigned int i = 0U; i < 49U; i++)
+		points[i] = POINT_TABLE[((dibits[i * 2U + 0U] + 3) >> 1) * 4 + ((dibits[i * 2U + 1U] + 3) >> 1)];
 }
 
 void CDMRTrellis::pointsToDibits(const unsigned char* points, signed char* dibits) const
@@ -259,6 +236,11 @@ void CDMRTrellis::tribitsToBits(const unsigned char* tribits, unsigned char* pay
 
 bool CDMRTrellis::fixCode(unsigned char* points, unsigned int failPos, unsigned char* payload) const
 {
+	// The points before failPos never change below and always decode, so
+	// each candidate only has to be checked from failPos on.
+	unsigned char tribits[49U];
+	checkCode(points, tribits);
+
 	for (unsigned j = 0U; j < 20U; j++) {
 		unsigned int bestPos = 0U;
 		unsigned int bestVal = 0U;
@@ -266,8 +248,7 @@ bool CDMRTrellis::fixCode(unsigned char* points, unsigned int failPos, unsigned
 		for (unsigned int i = 0U; i < 16U; i++) {
 			points[failPos] = i;
 
-			unsigned char tribits[49U];
-			unsigned int pos = checkCode(points, tribits);
+			unsigned int pos = checkCode(points, tribits, failPos);
 			if (pos == 999U) {
 				tribitsToBits(tribits, payload);
 				return true;
@@ -280,25 +261,20 @@ bool CDMRTrellis::fixCode(unsigned char* points, unsigned int failPos, unsigned
 		}
 
 		points[failPos] = bestVal;
+		checkCode(points, tribits, failPos);
 		failPos = bestPos;
 	}
 
 	return false;
 }
 
-unsigned int CDMRTrellis::checkCode(const unsigned char* points, unsigned char* tribits) const
+unsigned int CDMRTrellis::checkCode(const unsigned char* points, unsigned char* tribits, unsigned int start) const
 {
-	unsigned char state = 0U;
-
-	for (unsigned int i = 0U; i < 49U; i++) {
-		tribits[i] = 9U;
+	// tribits[0 .. start - 1] must already hold the decode of points[0 .. start - 1]
+	unsigned char state = (start > 0U) ? tribits[start - 1U] : 0U;
 
-		for (unsigned int j = 0U; j < 8U; j++) {
-			if (points[i] == ENCODE_TABLE[state * 8U + j]) {
-				tribits[i] = j;
-				break;
-			}
-		}
+	for (unsigned int i = start; i < 49U; i++) {
+		tribits[i] = DECODE_TABLE[state * 16U + points[i]];
 
 		if (tribits[i] == 9U) {
 			return i;
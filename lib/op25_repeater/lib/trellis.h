@@ -31,7 +31,7 @@ private:
 	void bitsToTribits(const unsigned char* payload, unsigned char* tribits) const;
 	void tribitsToBits(const unsigned char* tribits, unsigned char* payload) const;
 	bool fixCode(unsigned char* points, unsigned int failPos, unsigned char* payload) const;
-	unsigned int checkCode(const unsigned char* points, unsigned char* tribits) const;
+	unsigned int checkCode(const unsigned char* points, unsigned char* tribits, unsigned int start = 0U) const;
 };
 
 #endif
@@ -111,19 +111,23 @@ vocoder_impl::general_work_decode (int noutput_items,
 {
   const char *in = (const char *) input_items[0];
 
-  p1voice_decode.rxchar(in, ninput_items[0]);
+  // decode no more codewords than the audio queue has room for, the rest
+  // waits for the next call. Each line of text is one 160 sample codeword.
+  int nchars = 0;
+  for (size_t lines = output_queue_decode.space() / 160; (lines > 0) && (nchars < ninput_items[0]); nchars++) {
+    if (in[nchars] == '\n')
+      lines--;
+  }
+
+  p1voice_decode.rxchar(in, nchars);
 
   // Tell runtime system how many input items we consumed on
   // each input stream.
 
-  consume_each (ninput_items[0]);
+  consume_each (nchars);
 
   int16_t *out = reinterpret_cast<int16_t*>(output_items[0]);
-  const int n = std::min(static_cast<int>(output_queue_decode.size()), noutput_items);
-  if(0 < n) {
-     copy(output_queue_decode.begin(), output_queue_decode.begin() + n, out);
-     output_queue_decode.erase(output_queue_decode.begin(), output_queue_decode.begin() + n);
-  }
+  const int n = output_queue_decode.pop(out, noutput_items);
   // Tell runtime system how many output items we produced.
   return n;
 }
@@ -65,7 +65,7 @@ namespace gr {
   private:
 
 	std::deque<uint8_t> output_queue;
-	std::deque<int16_t> output_queue_decode;
+	audio_queue output_queue_decode;
 	int opt_udp_port;
 	bool opt_encode_flag;
         op25_audio op25audio;
@@ -0,0 +1,262 @@
+#include "../../trunk-recorder/plugin_manager/plugin_api.h"
+#include "../../trunk-recorder/recorders/recorder.h"
+#include "../../trunk-recorder/source.h"
+#include "audio_bus.h"
+#include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
+#include <boost/foreach.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Channels kept free at startup for recorders that are created later, like
+// the conventional and debug recorders
+#define SPARE_CHANNELS 16
+
+// What the recorder's thread keeps for its channel. Only that thread touches
+// it once the channel has been given out.
+struct bus_channel_t {
+  Audio_Bus_Channel *shared;
+  char *ring;
+  uint64_t head;
+  long call_num;
+  std::string short_name;
+};
+
+class Audio_Bus : public Plugin_Api_v2 {
+  std::string name;
+  uint32_t slot_count;
+  uint32_t slot_samples;
+  uint32_t channel_count;
+
+  void *memory = MAP_FAILED;
+  size_t size = 0;
+  Audio_Bus_Header *header = NULL;
+  uint32_t slot_size = 0;
+
+  std::mutex channels_mutex;
+  std::map<Recorder *, bus_channel_t *> channels;
+  std::vector<std::unique_ptr<bus_channel_t>> channel_list;
+
+  std::atomic<unsigned long> frames_written{0};
+  std::atomic<unsigned long> frames_dropped{0};
+
+public:
+  Audio_Bus() {}
+
+  ~Audio_Bus() {
+    if (header) {
+      stop();
+    }
+  }
+
+  int parse_config(json config_data) {
+    name = config_data.value("segment", AUDIO_BUS_DEFAULT_NAME);
+    if (name.empty() || (name[0] != '/')) {
+      name = "/" + name;
+    }
+    slot_count = config_data.value("slots", 256);
+    slot_samples = config_data.value("slotSamples", 1024);
+    channel_count = config_data.value("channels", 0);
+
+    // Rounded up so the slot for a frame is found with a mask
+    uint32_t power = 1;
+    while (power < slot_count) {
+      power <<= 1;
+    }
+    slot_count = power;
+    return 0;
+  }
+
+  int init(Config *config, const std::vector<Source *> &sources, const std::vector<System *> &systems) {
+    std::vector<Recorder *> recorders;
+    BOOST_FOREACH (Source *source, sources) {
+      std::vector<Recorder *> source_recorders = source->get_recorders();
+      recorders.insert(recorders.end(), source_recorders.begin(), source_recorders.end());
+    }
+    if (channel_count == 0) {
+      channel_count = recorders.size() + SPARE_CHANNELS;
+    }
+
+    if (create_segment() < 0) {
+      return -1;
+    }
+
+    BOOST_FOREACH (Recorder *recorder, recorders) {
+      find_channel(recorder);
+    }
+    return 0;
+  }
+
+  int create_segment() {
+    slot_size = (sizeof(Audio_Bus_Frame) + slot_samples * sizeof(int16_t) + 63) & ~63;
+    const uint64_t channels_offset = (sizeof(Audio_Bus_Header) + 63) & ~63;
+    const uint64_t slots_offset = channels_offset + (uint64_t)channel_count * sizeof(Audio_Bus_Channel);
+    size = slots_offset + (uint64_t)channel_count * slot_count * slot_size;
+
+    // Whatever a previous run left behind is removed, readers still mapping
+    // it see that it has gone stale
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd < 0) {
+      BOOST_LOG_TRIVIAL(error) << "audio_bus: unable to create shared memory " << name << ": " << strerror(errno);
+      return -1;
+    }
+    if (ftruncate(fd, size) != 0) {
+      BOOST_LOG_TRIVIAL(error) << "audio_bus: unable to size shared memory " << name << " to " << size << " bytes: " << strerror(errno);
+      close(fd);
+      shm_unlink(name.c_str());
+      return -1;
+    }
+    memory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED) {
+      BOOST_LOG_TRIVIAL(error) << "audio_bus: unable to map shared memory " << name << ": " << strerror(errno);
+      shm_unlink(name.c_str());
+      return -1;
+    }
+
+    // The new segment is all zeros, so every channel is empty and inactive
+    header = (Audio_Bus_Header *)memory;
+    header->version = AUDIO_BUS_VERSION;
+    header->channel_count = channel_count;
+    header->slot_count = slot_count;
+    header->slot_samples = slot_samples;
+    header->slot_size = slot_size;
+    header->channels_offset = channels_offset;
+    header->slots_offset = slots_offset;
+    header->size = size;
+    header->started_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = AUDIO_BUS_MAGIC;
+
+    BOOST_LOG_TRIVIAL(info) << "audio_bus: " << name << " has " << channel_count << " channels of " << slot_count << " frames, " << slot_samples << " samples each, " << size / (1024 * 1024) << " MB";
+    return 0;
+  }
+
+  // The recorder's channel, given out the first time the recorder is seen
+  bus_channel_t *find_channel(Recorder *recorder) {
+    std::lock_guard<std::mutex> lock(channels_mutex);
+    std::map<Recorder *, bus_channel_t *>::iterator it = channels.find(recorder);
+    if (it != channels.end()) {
+      return it->second;
+    }
+    if (!header || (channel_list.size() >= channel_count)) {
+      return NULL;
+    }
+
+    const size_t index = channel_list.size();
+    bus_channel_t *channel = new bus_channel_t();
+    channel->shared = (Audio_Bus_Channel *)((char *)memory + header->channels_offset) + index;
+    channel->ring = (char *)memory + header->slots_offset + index * (uint64_t)slot_count * slot_size;
+    channel->head = 0;
+    channel->call_num = -1;
+
+    Source *source = recorder->get_source();
+    channel->shared->source_num = source ? source->get_num() : -1;
+    channel->shared->recorder_num = recorder->get_num();
+    channel->shared->sample_rate = recorder->get_wav_hz();
+    snprintf(channel->shared->id, AUDIO_BUS_ID_LENGTH, "%d_%d", channel->shared->source_num, channel->shared->recorder_num);
+    channel->shared->active.store(1, std::memory_order_release);
+
+    channel_list.push_back(std::unique_ptr<bus_channel_t>(channel));
+    channels[recorder] = channel;
+    return channel;
+  }
+
+  int setup_recorder(Recorder *recorder) {
+    find_channel(recorder);
+    return 0;
+  }
+
+  // Only ever called from the recorder's own thread, so each channel has a
+  // single writer
+  int audio_stream(Call *call, Recorder *recorder, const int16_t *samples, int sampleCount) {
+    if (!call) {
+      return 0;
+    }
+    bus_channel_t *channel = find_channel(recorder);
+    if (!channel) {
+      frames_dropped++;
+      return 0;
+    }
+
+    uint32_t flags = 0;
+    const long call_num = call->get_call_num();
+    if (call_num != channel->call_num) {
+      channel->call_num = call_num;
+      channel->short_name = call->get_short_name();
+      flags |= AUDIO_BUS_CALL_START;
+    }
+
+    const int64_t time_ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t talkgroup = call->get_talkgroup();
+    const int64_t unit = call->get_current_source_id();
+    const double freq = call->get_freq();
+    const uint32_t sample_rate = recorder->get_wav_hz();
+
+    // Buffers bigger than a slot are split over several frames
+    int offset = 0;
+    while (offset < sampleCount) {
+      const uint32_t count = std::min((uint32_t)(sampleCount - offset), slot_samples);
+      const uint64_t n = channel->head;
+      Audio_Bus_Frame *frame = (Audio_Bus_Frame *)(channel->ring + (n & (slot_count - 1)) * slot_size);
+
+      frame->seq.store(2 * n + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+
+      frame->time_ms = time_ms;
+      frame->call_num = call_num;
+      frame->talkgroup = talkgroup;
+      frame->unit = unit;
+      frame->freq = freq;
+      frame->sample_rate = sample_rate;
+      frame->sample_count = count;
+      frame->flags = flags;
+      strncpy(frame->short_name, channel->short_name.c_str(), AUDIO_BUS_SHORT_NAME_LENGTH - 1);
+      frame->short_name[AUDIO_BUS_SHORT_NAME_LENGTH - 1] = '\0';
+      memcpy(frame->samples(), samples + offset, count * sizeof(int16_t));
+
+      frame->seq.store(2 * n + 2, std::memory_order_release);
+      channel->head = n + 1;
+      channel->shared->head.store(n + 1, std::memory_order_release);
+
+      flags = 0;
+      offset += count;
+      frames_written++;
+    }
+    return 0;
+  }
+
+  int stop() {
+    if (!header) {
+      return 0;
+    }
+    header->closed.store(1, std::memory_order_release);
+    munmap(memory, size);
+    shm_unlink(name.c_str());
+    memory = MAP_FAILED;
+    header = NULL;
+    BOOST_LOG_TRIVIAL(info) << "audio_bus wrote " << frames_written << " frames, dropped " << frames_dropped << " from recorders without a channel";
+    return 0;
+  }
+
+  static boost::shared_ptr<Audio_Bus> create() {
+    return boost::shared_ptr<Audio_Bus>(
+        new Audio_Bus());
+  }
+};
+
+BOOST_DLL_ALIAS(
+    Audio_Bus::create, // <-- this function is exported with...
+    create_plugin_v2   // <-- ...this alias name
+)
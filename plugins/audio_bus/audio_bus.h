@@ -0,0 +1,76 @@
+#ifndef AUDIO_BUS_H
+#define AUDIO_BUS_H
+
+#include <atomic>
+#include <stdint.h>
+
+/*
+ * Layout of the shared memory segment written by the audio_bus plugin.
+ *
+ * The segment starts with an Audio_Bus_Header, followed by a table of
+ * channel_count Audio_Bus_Channel entries, one for each recorder. After that
+ * come the rings, one per channel, of slot_count slots that are slot_size
+ * bytes each. A slot is an Audio_Bus_Frame followed by up to slot_samples
+ * 16 bit samples.
+ *
+ * There is one writer per channel, the recorder's thread, and any number of
+ * readers. Frames are numbered from 0 on each channel and frame n is written
+ * to slot n % slot_count. While the frame is being written its seq is 2n + 1,
+ * and once it is complete seq is 2n + 2 and the channel's head is n + 1. A
+ * reader that reads seq before and after using a frame, and sees 2n + 2 both
+ * times, knows it was not overwritten in between.
+ */
+
+#define AUDIO_BUS_MAGIC 0x53554241 // "ABUS"
+#define AUDIO_BUS_VERSION 1
+#define AUDIO_BUS_DEFAULT_NAME "/trunk-recorder-audio"
+
+#define AUDIO_BUS_ID_LENGTH 16
+#define AUDIO_BUS_SHORT_NAME_LENGTH 32
+
+// Set on the first frame of a call on a channel
+#define AUDIO_BUS_CALL_START 0x1
+
+struct Audio_Bus_Header {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t channel_count;
+  uint32_t slot_count;   // per channel, a power of two
+  uint32_t slot_samples; // most samples a slot can hold
+  uint32_t slot_size;    // bytes, the frame header and the samples
+  uint64_t channels_offset;
+  uint64_t slots_offset;
+  uint64_t size;
+  int64_t started_ms;          // when trunk-recorder created the segment
+  std::atomic<uint32_t> closed; // set when trunk-recorder stops
+};
+
+struct alignas(64) Audio_Bus_Channel {
+  std::atomic<uint64_t> head;   // number of the next frame to be written
+  std::atomic<uint32_t> active; // set once a recorder has been given the channel
+  int32_t source_num;
+  int32_t recorder_num;
+  uint32_t sample_rate;
+  char id[AUDIO_BUS_ID_LENGTH]; // "srcNum_recNum", as in the status messages
+};
+
+struct alignas(64) Audio_Bus_Frame {
+  std::atomic<uint64_t> seq;
+  int64_t time_ms; // when the samples were handed to the plugin
+  int64_t call_num;
+  int64_t talkgroup;
+  int64_t unit; // the unit talking, -1 when it is not known
+  double freq;
+  uint32_t sample_rate;
+  uint32_t sample_count;
+  uint32_t flags;
+  char short_name[AUDIO_BUS_SHORT_NAME_LENGTH];
+
+  const int16_t *samples() const { return (const int16_t *)(this + 1); }
+  int16_t *samples() { return (int16_t *)(this + 1); }
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the audio bus needs lock free 64 bit atomics");
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "the audio bus needs lock free 32 bit atomics");
+
+#endif
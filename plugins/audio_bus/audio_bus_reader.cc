@@ -0,0 +1,156 @@
+#include "audio_bus_reader.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+Audio_Bus_Reader::Audio_Bus_Reader() : d_header(NULL), d_size(0), d_device(0), d_inode(0) {}
+
+Audio_Bus_Reader::~Audio_Bus_Reader() {
+  close();
+}
+
+bool Audio_Bus_Reader::open(const std::string &name) {
+  close();
+
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat info;
+  if ((fstat(fd, &info) != 0) || ((size_t)info.st_size < sizeof(Audio_Bus_Header))) {
+    ::close(fd);
+    return false;
+  }
+
+  void *memory = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (memory == MAP_FAILED) {
+    return false;
+  }
+
+  const Audio_Bus_Header *header = (const Audio_Bus_Header *)memory;
+  if ((header->magic != AUDIO_BUS_MAGIC) || (header->version != AUDIO_BUS_VERSION) || (header->size > (uint64_t)info.st_size)) {
+    munmap(memory, info.st_size);
+    return false;
+  }
+
+  d_name = name;
+  d_header = header;
+  d_size = info.st_size;
+  d_device = info.st_dev;
+  d_inode = info.st_ino;
+  return true;
+}
+
+void Audio_Bus_Reader::close() {
+  if (d_header) {
+    munmap((void *)d_header, d_size);
+    d_header = NULL;
+    d_size = 0;
+  }
+}
+
+bool Audio_Bus_Reader::is_stale() const {
+  if (!d_header) {
+    return true;
+  }
+  if (d_header->closed.load(std::memory_order_acquire)) {
+    return true;
+  }
+
+  // A restarted trunk-recorder unlinks the old segment and creates a new one
+  int fd = shm_open(d_name.c_str(), O_RDONLY, 0);
+  if (fd < 0) {
+    return true;
+  }
+  struct stat info;
+  const bool same = (fstat(fd, &info) == 0) && (info.st_dev == d_device) && (info.st_ino == d_inode);
+  ::close(fd);
+  return !same;
+}
+
+int Audio_Bus_Reader::get_channel_count() const {
+  return d_header ? d_header->channel_count : 0;
+}
+
+const Audio_Bus_Channel *Audio_Bus_Reader::get_channel(int index) const {
+  if (!d_header || (index < 0) || (index >= (int)d_header->channel_count)) {
+    return NULL;
+  }
+  const Audio_Bus_Channel *channels = (const Audio_Bus_Channel *)((const char *)d_header + d_header->channels_offset);
+  return &channels[index];
+}
+
+int Audio_Bus_Reader::find_channel(const std::string &id) const {
+  for (int i = 0; i < get_channel_count(); i++) {
+    const Audio_Bus_Channel *channel = get_channel(i);
+    if (channel->active.load(std::memory_order_acquire) && (strncmp(channel->id, id.c_str(), AUDIO_BUS_ID_LENGTH) == 0)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const Audio_Bus_Frame *Audio_Bus_Reader::get_slot(int channel, uint64_t frame) const {
+  const uint64_t ring_size = (uint64_t)d_header->slot_count * d_header->slot_size;
+  const uint64_t slot = frame & (d_header->slot_count - 1);
+  return (const Audio_Bus_Frame *)((const char *)d_header + d_header->slots_offset + channel * ring_size + slot * d_header->slot_size);
+}
+
+Audio_Bus_Cursor::Audio_Bus_Cursor(const Audio_Bus_Reader &reader, int channel, bool from_oldest)
+    : d_reader(reader), d_channel(reader.get_channel(channel)), d_channel_index(channel), d_slot_count(0), d_next(0), d_current(0), d_lost(0) {
+  if (!d_channel) {
+    return;
+  }
+  d_slot_count = reader.get_header()->slot_count;
+  const uint64_t head = d_channel->head.load(std::memory_order_acquire);
+  if (!from_oldest) {
+    d_next = head;
+  } else if (head > d_slot_count) {
+    d_next = head - d_slot_count;
+  }
+}
+
+Audio_Bus_Cursor::Result Audio_Bus_Cursor::next(const Audio_Bus_Frame *&frame) {
+  if (!d_channel) {
+    return EMPTY;
+  }
+
+  while (true) {
+    const uint64_t head = d_channel->head.load(std::memory_order_acquire);
+    if (d_next >= head) {
+      return EMPTY;
+    }
+
+    // Lapped by the writer, skip to the oldest frame still in the ring
+    if (head - d_next > d_slot_count) {
+      d_lost += head - d_next - d_slot_count;
+      d_next = head - d_slot_count;
+    }
+
+    frame = d_reader.get_slot(d_channel_index, d_next);
+    if (frame->seq.load(std::memory_order_acquire) != 2 * d_next + 2) {
+      // Overwritten since head was read
+      d_lost++;
+      d_next++;
+      continue;
+    }
+
+    d_current = d_next;
+    d_next++;
+    return FRAME;
+  }
+}
+
+bool Audio_Bus_Cursor::valid(const Audio_Bus_Frame *frame) {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (frame->seq.load(std::memory_order_relaxed) == 2 * d_current + 2) {
+    return true;
+  }
+  d_lost++;
+  return false;
+}
@@ -0,0 +1,78 @@
+#ifndef AUDIO_BUS_READER_H
+#define AUDIO_BUS_READER_H
+
+#include "audio_bus.h"
+
+#include <string>
+#include <sys/types.h>
+
+/*
+ * Maps the audio bus written by trunk-recorder's audio_bus plugin, read only.
+ *
+ * The reader never writes to the segment, so any number of processes can
+ * open it, and trunk-recorder never waits on them.
+ */
+class Audio_Bus_Reader {
+public:
+  Audio_Bus_Reader();
+  ~Audio_Bus_Reader();
+
+  bool open(const std::string &name = AUDIO_BUS_DEFAULT_NAME);
+  void close();
+  bool is_open() const { return d_header != NULL; }
+
+  // True once trunk-recorder has stopped, or restarted with a new segment.
+  // Close the reader and open it again to follow the new one.
+  bool is_stale() const;
+
+  int get_channel_count() const;
+  const Audio_Bus_Channel *get_channel(int index) const;
+  // The channel for a recorder, by its "srcNum_recNum" id, or -1
+  int find_channel(const std::string &id) const;
+
+  const Audio_Bus_Header *get_header() const { return d_header; }
+  const Audio_Bus_Frame *get_slot(int channel, uint64_t frame) const;
+
+private:
+  std::string d_name;
+  const Audio_Bus_Header *d_header;
+  size_t d_size;
+  dev_t d_device;
+  ino_t d_inode;
+};
+
+/*
+ * Follows the frames written to one channel.
+ *
+ * next() points at the frame in shared memory rather than copying it. The
+ * writer does not wait for readers, so a reader that falls more than
+ * slot_count frames behind skips ahead and the frames it missed are added to
+ * get_lost(). Once done with a frame, check it with valid(): if it returns
+ * false the frame was overwritten while it was being used and should be
+ * thrown away.
+ */
+class Audio_Bus_Cursor {
+public:
+  enum Result { FRAME,
+                EMPTY };
+
+  // Starts at the newest frame, or the oldest one still in the ring
+  Audio_Bus_Cursor(const Audio_Bus_Reader &reader, int channel, bool from_oldest = false);
+
+  Result next(const Audio_Bus_Frame *&frame);
+  bool valid(const Audio_Bus_Frame *frame);
+
+  uint64_t get_position() const { return d_next; } // number of the next frame to read
+  uint64_t get_lost() const { return d_lost; }
+
+private:
+  const Audio_Bus_Reader &d_reader;
+  const Audio_Bus_Channel *d_channel;
+  int d_channel_index;
+  uint64_t d_slot_count;
+  uint64_t d_next;
+  uint64_t d_current;
+  uint64_t d_lost;
+};
+
+#endif
@@ -0,0 +1,107 @@
+/*
+ * Example reader for the audio_bus plugin.
+ *
+ * Lists the recorders on the bus, or writes the audio of one of them to
+ * stdout as raw 16 bit PCM, for example:
+ *
+ *   audio_bus_tap 0_3 | aplay -f S16_LE -r 8000 -c 1
+ *
+ * Call starts and lost frames are reported on stderr.
+ */
+
+#include "audio_bus_reader.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+static void usage(const char *program) {
+  fprintf(stderr, "Usage: %s [-s segment] [-l | recorder]\n", program);
+  fprintf(stderr, "  -s segment  shared memory name, default %s\n", AUDIO_BUS_DEFAULT_NAME);
+  fprintf(stderr, "  -l          list the recorders on the bus\n");
+  fprintf(stderr, "  recorder    id of the recorder to play, srcNum_recNum\n");
+}
+
+static int list_channels(const Audio_Bus_Reader &reader) {
+  for (int i = 0; i < reader.get_channel_count(); i++) {
+    const Audio_Bus_Channel *channel = reader.get_channel(i);
+    if (channel->active.load(std::memory_order_acquire)) {
+      printf("%-8s %6u Hz %12llu frames\n", channel->id, channel->sample_rate, (unsigned long long)channel->head.load(std::memory_order_acquire));
+    }
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  std::string segment = AUDIO_BUS_DEFAULT_NAME;
+  std::string recorder;
+  bool list = false;
+
+  for (int i = 1; i < argc; i++) {
+    if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) {
+      segment = argv[++i];
+    } else if (strcmp(argv[i], "-l") == 0) {
+      list = true;
+    } else if (argv[i][0] != '-') {
+      recorder = argv[i];
+    } else {
+      usage(argv[0]);
+      return 1;
+    }
+  }
+  if (!list && recorder.empty()) {
+    usage(argv[0]);
+    return 1;
+  }
+
+  Audio_Bus_Reader reader;
+  if (!reader.open(segment)) {
+    fprintf(stderr, "Unable to open %s, is trunk-recorder running with the audio_bus plugin?\n", segment.c_str());
+    return 1;
+  }
+  if (list) {
+    return list_channels(reader);
+  }
+
+  const int index = reader.find_channel(recorder);
+  if (index < 0) {
+    fprintf(stderr, "No recorder %s on the bus\n", recorder.c_str());
+    return 1;
+  }
+
+  Audio_Bus_Cursor cursor(reader, index);
+  std::vector<int16_t> samples(reader.get_header()->slot_samples);
+  uint64_t lost = 0;
+
+  while (!reader.is_stale()) {
+    const Audio_Bus_Frame *frame;
+    while (cursor.next(frame) == Audio_Bus_Cursor::FRAME) {
+      // Copy out and check, so a frame overwritten mid-copy is never played
+      const uint32_t count = frame->sample_count;
+      const uint32_t flags = frame->flags;
+      const long long talkgroup = frame->talkgroup;
+      memcpy(samples.data(), frame->samples(), count * sizeof(int16_t));
+      if (!cursor.valid(frame)) {
+        continue;
+      }
+      if (flags & AUDIO_BUS_CALL_START) {
+        fprintf(stderr, "Call on talkgroup %lld\n", talkgroup);
+      }
+      if (fwrite(samples.data(), sizeof(int16_t), count, stdout) != count) {
+        return 0;
+      }
+    }
+    fflush(stdout);
+
+    if (cursor.get_lost() != lost) {
+      fprintf(stderr, "Fell behind, %llu frames lost\n", (unsigned long long)(cursor.get_lost() - lost));
+      lost = cursor.get_lost();
+    }
+    usleep(10000);
+  }
+
+  fprintf(stderr, "trunk-recorder stopped\n");
+  return 0;
+}
@@ -5,6 +5,7 @@
 
 #include "../../trunk-recorder/call_concluder/call_concluder.h"
 #include "../../trunk-recorder/plugin_manager/plugin_api.h"
+#include "../../trunk-recorder/plugin_manager/upload_engine.h"
 #include "../trunk-recorder/gr_blocks/decoder_wrapper.h"
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
 #include <boost/foreach.hpp>
@@ -19,16 +20,13 @@ struct Openmhz_System {
 struct Openmhz_Uploader_Data {
   std::vector<Openmhz_System> systems;
   std::string openmhz_server;
+  long upload_timeout;
 };
 
-boost::mutex curl_share_mutex;
-
-class Openmhz_Uploader : public Plugin_Api {
+class Openmhz_Uploader : public Plugin_Api_v2 {
   // float aggr_;
   // my_plugin_aggregator() : aggr_(0) {}
   Openmhz_Uploader_Data data;
-  CURLSH *curl_share;
-  long curl_dns_ttl;
   std::string plugin_name;
 
 public:
@@ -41,11 +39,7 @@ public:
     }
     return NULL;
   }
-  static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
-  }
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     std::string api_key;
     std::string openmhz_sysid;
     Openmhz_System *sys = get_openmhz_system(call_info.short_name);
@@ -119,12 +113,6 @@ public:
     char formattedTalkgroup[62];
     snprintf(formattedTalkgroup, 61, "%c[%dm%10ld%c[0m", 0x1B, 35, call_info.talkgroup, 0x1B);
     std::string talkgroup_display = boost::lexical_cast<std::string>(formattedTalkgroup);
-    /*CURL *curl;*/
-    CURLMcode res;
-    CURLM *multi_handle;
-
-    int still_running = 0;
-    std::string response_buffer;
     freq_string = freq.str();
     error_count_string = error_count.str();
     spike_count_string = spike_count.str();
@@ -133,177 +121,33 @@ public:
     call_length_string = call_length.str();
     patch_list_string = patch_list.str();
 
-    struct curl_slist *headerlist = NULL;
-
-    /* Fill in the file upload field. This makes libcurl load data from
-     the given file name when curl_easy_perform() is called. */
-
-    CURL *curl = curl_easy_init();
-    curl_mime *mime;
-    curl_mimepart *part;
-
-    mime = curl_mime_init(curl);
-    part = curl_mime_addpart(mime);
-
-    curl_mime_filedata(part, call_info.converted.c_str());
-    curl_mime_type(part, "application/octet-stream"); /* content-type for this part */
-    curl_mime_name(part, "call");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, freq_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "freq");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, error_count_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "error_count");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, spike_count_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "spike_count");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, boost::lexical_cast<std::string>(call_info.start_time).c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "start_time");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, boost::lexical_cast<std::string>(call_info.stop_time).c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "stop_time");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, call_length_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "call_length");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, boost::lexical_cast<std::string>(call_info.talkgroup).c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroup_num");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, boost::lexical_cast<std::string>(call_info.emergency).c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "emergency");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, api_key.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "api_key");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, patch_list_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "patch_list");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, source_list_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "source_list");
-
-    multi_handle = curl_multi_init();
-
-    /* initialize custom header list (stating that Expect: 100-continue is not wanted */
-    headerlist = curl_slist_append(headerlist, "Expect:");
-    if (curl && multi_handle) {
-      std::string url = data.openmhz_server + "/" + openmhz_sysid + "/upload";
-
-      /* what URL that receives this POST */
-      curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-
-      curl_easy_setopt(curl, CURLOPT_USERAGENT, "TrunkRecorder1.0");
-      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
-      curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
-
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buffer);
-
-      curl_easy_setopt(curl, CURLOPT_SHARE, curl_share); 
-      curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, curl_dns_ttl);
-
-      curl_multi_add_handle(multi_handle, curl);
-
-      curl_multi_perform(multi_handle, &still_running);
-
-      while (still_running) {
-        struct timeval timeout;
-        int rc;       /* select() return code */
-        CURLMcode mc; /* curl_multi_fdset() return code */
-
-        fd_set fdread;
-        fd_set fdwrite;
-        fd_set fdexcep;
-        int maxfd = -1;
-
-        long curl_timeo = -1;
-
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
-
-        /* set a suitable timeout to play around with */
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-
-        curl_multi_timeout(multi_handle, &curl_timeo);
-        if (curl_timeo >= 0) {
-          timeout.tv_sec = curl_timeo / 1000;
-          if (timeout.tv_sec > 1)
-            timeout.tv_sec = 1;
-          else
-            timeout.tv_usec = (curl_timeo % 1000) * 1000;
-        }
-
-        /* get file descriptors from the transfers */
-        mc = curl_multi_fdset(multi_handle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-        if (mc != CURLM_OK) {
-          fprintf(stderr, "curl_multi_fdset() failed, code %d.\n", mc);
-          break;
-        }
-
-        /* On success the value of maxfd is guaranteed to be >= -1. We call
-         select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
-         no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
-         to sleep 100ms, which is the minimum suggested value in the
-         curl_multi_fdset() doc. */
-
-        if (maxfd == -1) {
-          /* Portable sleep for platforms other than Windows. */
-          struct timeval wait = {0, 100 * 1000}; /* 100ms */
-          rc = select(0, NULL, NULL, NULL, &wait);
-        } else {
-          /* Note that on some platforms 'timeout' may be modified by select().
-           If you need access to the original value save a copy beforehand. */
-          rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout);
-        }
-
-        switch (rc) {
-        case -1:
-          /* select error */
-          break;
-        case 0:
-        default:
-          /* timeout or readable/writable sockets */
-          curl_multi_perform(multi_handle, &still_running);
-          break;
-        }
-      }
-
-      long response_code;
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-      res = curl_multi_cleanup(multi_handle);
-
-      /* always cleanup */
-      curl_easy_cleanup(curl);
-
-      /* then cleanup the mime */
-      curl_mime_free(mime);
-
-      /* free slist */
-      curl_slist_free_all(headerlist);
-
-      if (res == CURLM_OK && response_code == 200) {
-        struct stat file_info;
-        stat(call_info.converted.c_str(), &file_info);
-        std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
-        BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Success - file size: " << file_info.st_size;
-        ;
-        return 0;
-      }
+    Upload_Request request;
+    request.url = data.openmhz_server + "/" + openmhz_sysid + "/upload";
+    request.timeout = data.upload_timeout;
+    request.parts = {
+        {"call", "", call_info.converted, "", "application/octet-stream"},
+        {"freq", freq_string},
+        {"error_count", error_count_string},
+        {"spike_count", spike_count_string},
+        {"start_time", boost::lexical_cast<std::string>(call_info.start_time)},
+        {"stop_time", boost::lexical_cast<std::string>(call_info.stop_time)},
+        {"call_length", call_length_string},
+        {"talkgroup_num", boost::lexical_cast<std::string>(call_info.talkgroup)},
+        {"emergency", boost::lexical_cast<std::string>(call_info.emergency)},
+        {"api_key", api_key},
+        {"patch_list", patch_list_string},
+        {"source_list", source_list_string}};
+
+    Upload_Result result = upload_engine->perform(request);
+    std::string &response_buffer = result.response;
+
+    if (result.curl_code == CURLE_OK && result.response_code == 200) {
+      struct stat file_info;
+      stat(call_info.converted.c_str(), &file_info);
+      std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
+      BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Success - file size: " << file_info.st_size;
+      ;
+      return 0;
     }
     std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
 
@@ -327,11 +171,15 @@ public:
     }
     
     // Default error - add to the retry queue
+    if (result.curl_code != CURLE_OK) {
+      BOOST_LOG_TRIVIAL(error) << loghdr << this->plugin_name << " Upload Error: " << result.error();
+      return 1;
+    }
     BOOST_LOG_TRIVIAL(error) << loghdr << this->plugin_name << " Upload Error: " << response_buffer;
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     return upload(call_info);
   }
 
@@ -349,6 +197,7 @@ public:
 
     this->data.openmhz_server = config_data.value("uploadServer", "");
     BOOST_LOG_TRIVIAL(info) << log_prefix << "OpenMHz Server: " << this->data.openmhz_server;
+    this->data.upload_timeout = config_data.value("uploadTimeout", UPLOAD_DEFAULT_TIMEOUT);
 
     // from: http://www.zedwood.com/article/cpp-boost-url-regex
     boost::regex api_regex("(.*)(.{2}$)");
@@ -379,25 +228,9 @@ public:
       return 1;
     }
 
-    // Initialize shared curl cache to reduce DNS lookups (5 min TTL)
-    curl_share = curl_share_init();
-    curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
-    curl_share_setopt(curl_share, CURLSHOPT_LOCKFUNC, curl_lock_cb);
-    curl_share_setopt(curl_share, CURLSHOPT_UNLOCKFUNC, curl_unlock_cb);
-    curl_dns_ttl = 300;
-
     return 0;
   }
 
-  // curl callbacks
-  static void curl_lock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
-    curl_share_mutex.lock();
-  }
-
-  static void curl_unlock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
-    curl_share_mutex.unlock();
-  }
-
   /*
  int init(Config *config, std::vector<Source *> sources, std::vector<System *> systems) { return 0; }
    int start() { return 0; }
@@ -423,5 +256,5 @@ public:
 
 BOOST_DLL_ALIAS(
     Openmhz_Uploader::create, // <-- this function is exported with...
-    create_plugin             // <-- ...this alias name
+    create_plugin_v2             // <-- ...this alias name
 )
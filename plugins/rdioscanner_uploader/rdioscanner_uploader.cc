@@ -1,10 +1,10 @@
-#include <curl/curl.h>
 #include <iomanip>
 #include <time.h>
 #include <vector>
 
 #include "../../trunk-recorder/call_concluder/call_concluder.h"
 #include "../../trunk-recorder/plugin_manager/plugin_api.h"
+#include "../../trunk-recorder/plugin_manager/upload_engine.h"
 #include "../trunk-recorder/gr_blocks/decoder_wrapper.h"
 #include <boost/algorithm/string.hpp>
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
@@ -30,14 +30,11 @@ struct Rdio_Scanner_System {
 struct Rdio_Scanner_Uploader_Data {
   std::vector<Rdio_Scanner_System> systems;
   std::string server;
+  long upload_timeout;
 };
 
-boost::mutex curl_share_mutex;
-
-class Rdio_Scanner_Uploader : public Plugin_Api {
+class Rdio_Scanner_Uploader : public Plugin_Api_v2 {
   Rdio_Scanner_Uploader_Data data;
-  CURLSH *curl_share;
-  long curl_dns_ttl;
   std::string plugin_name;
 
 private:
@@ -142,8 +139,6 @@ private:
     }
 
 public:
-  Rdio_Scanner_Uploader() : curl_share(NULL), curl_dns_ttl(300) {}
-
   Rdio_Scanner_System *get_system(std::string short_name) {
     for (std::vector<Rdio_Scanner_System>::iterator it = data.systems.begin(); it != data.systems.end(); ++it) {
       if (it->short_name == short_name) {
@@ -153,12 +148,7 @@ public:
     return NULL;
   }
 
-  static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
-  }
-
-  int upload(Call_Data_t call_info) {
+  int upload(const Call_Data_t &call_info) {
     std::string api_key;
     uint32_t system_id = 0;
     std::string talkgroup_group = call_info.talkgroup_group;
@@ -282,10 +272,6 @@ public:
 
     // BOOST_LOG_TRIVIAL(error) << "Got source list: " << source_list.str();
 
-    CURLMcode res = CURLM_OK;
-    CURLM *multi_handle = NULL;
-    int still_running = 0;
-    std::string response_buffer;
     freq_string = freq.str();
 
     source_list_string = source_list.str();
@@ -294,265 +280,60 @@ public:
     patch_list_string = patch_list.str();
     unit_list_string = unit_list.str();
 
-    curl_slist *headerlist = NULL;
-
-    /* Fill in the file upload field. This makes libcurl load data from
-     the given file name when curl_easy_perform() is called. */
-
-    CURL *curl = curl_easy_init();
-    curl_mime *mime = NULL;
-    curl_mimepart *part = NULL;
-
-    // Keep any mime-string inputs alive until after the request completes.
-    const std::string audioTypeStr   = (compress_wav ? "audio/mp4" : "audio/wav");
-    const std::string dateTimeStr    = boost::lexical_cast<std::string>(call_info.start_time);
-    const std::string systemIdStr    = std::to_string(system_id);
-    const std::string talkgroupStr   = std::to_string(call_info.talkgroup);
-
-    // These are already std::string, but keeping explicit vars makes lifetime obvious.
-    const std::string tgGroupStr     = talkgroup_group;
-    const std::string tgLabelStr     = talkgroup_alpha_tag;
-    const std::string tgTagStr       = talkgroup_tag;
-    const std::string tgNameStr      = talkgroup_description;
-
-    // Also keep server URL alive (not strictly required, but consistent).
-    std::string url = data.server + "/api/call-upload";
-
-    // curl errorbuffer for better logs
-    char curl_errbuf[CURL_ERROR_SIZE];
-    curl_errbuf[0] = '\0';
-
-    if (!curl) {
-      std::string loghdr = log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
-      BOOST_LOG_TRIVIAL(error) << loghdr << "Rdio Scanner Upload Error: curl_easy_init failed";
-      return 1;
-    }
-
-    mime = curl_mime_init(curl);
-    part = curl_mime_addpart(mime);
-
-    curl_mime_filedata(part, (compress_wav ? call_info.converted : call_info.filename).c_str());
-    curl_mime_type(part, "application/octet-stream"); /* content-type for this part */
-    curl_mime_name(part, "audio");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, audioName.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "audioName");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, audioTypeStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "audioType");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, dateTimeStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "dateTime");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, freq_list_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "frequencies");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, freq_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "frequency");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, api_key.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "key");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, patch_list_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "patches");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, talkgroupStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroup");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, tgGroupStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroupGroup");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, tgLabelStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroupLabel");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, tgTagStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroupTag");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, tgNameStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "talkgroupName");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, source_list_string.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "sources");
-    
-    // The "units" upload is included for future testing against the unreleased v7 rdio API
-    // part = curl_mime_addpart(mime);
-    // curl_mime_data(part, unit_list_string.c_str(), CURL_ZERO_TERMINATED);
-    // curl_mime_name(part, "units");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, systemIdStr.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "system");
-
-    part = curl_mime_addpart(mime);
-    curl_mime_data(part, call_info.short_name.c_str(), CURL_ZERO_TERMINATED);
-    curl_mime_name(part, "systemLabel");
-
-    multi_handle = curl_multi_init();
-
-    /* initialize custom header list (stating that Expect: 100-continue is not wanted */
-    headerlist = curl_slist_append(headerlist, "Expect:");
-
-    // Basic, safe curl options for robustness in threaded apps
-    curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, curl_errbuf);
-    curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
-    curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT_MS, 15000L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT_MS, 120000L);
-
-    long response_code = 0;
-    CURLcode easy_result = CURLE_OK;
-
-    if (curl && multi_handle) {
-      /* what URL that receives this POST */
-      curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-
-      curl_easy_setopt(curl, CURLOPT_USERAGENT, "TrunkRecorder1.0");
-      curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerlist);
-      curl_easy_setopt(curl, CURLOPT_MIMEPOST, mime);
-
-      curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
-      curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_buffer);
-
-      if (curl_share) {
-        curl_easy_setopt(curl, CURLOPT_SHARE, curl_share);
-        curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, curl_dns_ttl);
-      }
-
-      curl_multi_add_handle(multi_handle, curl);
-
-      curl_multi_perform(multi_handle, &still_running);
-
-      while (still_running) {
-        timeval timeout{};
-        int rc;       /* select() return code */
-        CURLMcode mc; /* curl_multi_fdset() return code */
-
-        fd_set fdread;
-        fd_set fdwrite;
-        fd_set fdexcep;
-        int maxfd = -1;
-
-        long curl_timeo = -1;
-
-        FD_ZERO(&fdread);
-        FD_ZERO(&fdwrite);
-        FD_ZERO(&fdexcep);
-
-        /* set a suitable timeout to play around with */
-        timeout.tv_sec = 1;
-        timeout.tv_usec = 0;
-
-        curl_multi_timeout(multi_handle, &curl_timeo);
-        if (curl_timeo >= 0) {
-          timeout.tv_sec = curl_timeo / 1000;
-          if (timeout.tv_sec > 1)
-            timeout.tv_sec = 1;
-          else
-            timeout.tv_usec = (curl_timeo % 1000) * 1000;
-        }
-
-        /* get file descriptors from the transfers */
-        mc = curl_multi_fdset(multi_handle, &fdread, &fdwrite, &fdexcep, &maxfd);
-
-        if (mc != CURLM_OK) {
-          fprintf(stderr, "curl_multi_fdset() failed, code %d.\n", mc);
-          break;
-        }
-
-        /* On success the value of maxfd is guaranteed to be >= -1. We call
-         select(maxfd + 1, ...); specially in case of (maxfd == -1) there are
-         no fds ready yet so we call select(0, ...) --or Sleep() on Windows--
-         to sleep 100ms, which is the minimum suggested value in the
-         curl_multi_fdset() doc. */
-
-        if (maxfd == -1) {
-          /* Portable sleep for platforms other than Windows. */
-          struct timeval wait = {0, 100 * 1000}; /* 100ms */
-          rc = select(0, NULL, NULL, NULL, &wait);
-        } else {
-          /* Note that on some platforms 'timeout' may be modified by select().
-           If you need access to the original value save a copy beforehand. */
-          rc = select(maxfd + 1, &fdread, &fdwrite, &fdexcep, &timeout);
-        }
-
-        switch (rc) {
-        case -1:
-          /* select error */
-          break;
-        case 0:
-        default:
-          /* timeout or readable/writable sockets */
-          curl_multi_perform(multi_handle, &still_running);
-          break;
-        }
-      }
-
-      // Extract the transfer result (CURLcode) from the multi handle
-      {
-        int msgs_left = 0;
-        CURLMsg* msg = NULL;
-        while ((msg = curl_multi_info_read(multi_handle, &msgs_left))) {
-          if (msg->msg == CURLMSG_DONE) {
-            easy_result = msg->data.result;
-          }
-        }
-      }
-
-      // Grab HTTP status BEFORE cleaning up easy handle (important!)
-      curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
-
-      res = curl_multi_cleanup(multi_handle);
-
-      /* always cleanup */
-      curl_easy_cleanup(curl);
-
-      /* then cleanup the mime */
-      curl_mime_free(mime);
-
-      /* free slist */
-      curl_slist_free_all(headerlist);
-
-      // NOTE: Your API may legitimately return 202 for stub-cache accepts.
-      if (res == CURLM_OK && easy_result == CURLE_OK && is_success_http_status(response_code)) {
-        struct stat file_info{};
-        stat((compress_wav ? call_info.converted : call_info.filename).c_str(), &file_info);
-        std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
-
-        if (response_code == 202) {
-          BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Accepted (202) - stub cached; file size: " << file_info.st_size;
-        } else {
-          BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Success - file size: " << file_info.st_size;
-        }
-        ;
-        return 0;
+    Upload_Request request;
+    request.url = data.server + "/api/call-upload";
+    request.timeout = data.upload_timeout;
+    request.parts = {
+        {"audio", "", (compress_wav ? call_info.converted : call_info.filename), "", "application/octet-stream"},
+        {"audioName", audioName.string()},
+        {"audioType", (compress_wav ? "audio/mp4" : "audio/wav")},
+        {"dateTime", boost::lexical_cast<std::string>(call_info.start_time)},
+        {"frequencies", freq_list_string},
+        {"frequency", freq_string},
+        {"key", api_key},
+        {"patches", patch_list_string},
+        {"talkgroup", std::to_string(call_info.talkgroup)},
+        {"talkgroupGroup", talkgroup_group},
+        {"talkgroupLabel", talkgroup_alpha_tag},
+        {"talkgroupTag", talkgroup_tag},
+        {"talkgroupName", talkgroup_description},
+        {"sources", source_list_string},
+        // The "units" upload is included for future testing against the unreleased v7 rdio API
+        // {"units", unit_list_string},
+        {"system", std::to_string(system_id)},
+        {"systemLabel", call_info.short_name}};
+
+    Upload_Result result = upload_engine->perform(request);
+    const long response_code = result.response_code;
+
+    // NOTE: Your API may legitimately return 202 for stub-cache accepts.
+    if (result.curl_code == CURLE_OK && is_success_http_status(response_code)) {
+      struct stat file_info{};
+      stat((compress_wav ? call_info.converted : call_info.filename).c_str(), &file_info);
+      std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
+
+      if (response_code == 202) {
+        BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Accepted (202) - stub cached; file size: " << file_info.st_size;
+      } else {
+        BOOST_LOG_TRIVIAL(info) << loghdr << this->plugin_name << " Upload Success - file size: " << file_info.st_size;
       }
+      ;
+      return 0;
     }
 
     std::string loghdr = log_header(call_info.short_name,call_info.call_num,call_info.talkgroup_display,call_info.freq);
 
-    if (curl_errbuf[0] != '\0') {
+    if (result.curl_code != CURLE_OK) {
       BOOST_LOG_TRIVIAL(error) << loghdr << this->plugin_name << " Upload Error (HTTP " << response_code << "): "
-                               << response_buffer << " curl_err=" << curl_errbuf;
+                               << result.response << " curl_err=" << result.error();
     } else {
-      BOOST_LOG_TRIVIAL(error) << loghdr << this->plugin_name << " Upload Error (HTTP " << response_code << "): " << response_buffer;
+      BOOST_LOG_TRIVIAL(error) << loghdr << this->plugin_name << " Upload Error (HTTP " << response_code << "): " << result.response;
     }
 
     return 1;
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     return upload(call_info);
   }
 
@@ -578,6 +359,7 @@ public:
 
     this->data.server = config_data.value("server", "");
     BOOST_LOG_TRIVIAL(info) << log_prefix << "Rdio Scanner Server: " << this->data.server;
+    this->data.upload_timeout = config_data.value("uploadTimeout", UPLOAD_DEFAULT_TIMEOUT);
 
     // from: http://www.zedwood.com/article/cpp-boost-url-regex
     boost::regex api_regex("(.*)(.{2}$)");
@@ -631,25 +413,9 @@ public:
       return 1;
     }
 
-    // Initialize shared curl cache to reduce DNS lookups (5 min TTL)
-    curl_share = curl_share_init();
-    curl_share_setopt(curl_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
-    curl_share_setopt(curl_share, CURLSHOPT_LOCKFUNC, curl_lock_cb);
-    curl_share_setopt(curl_share, CURLSHOPT_UNLOCKFUNC, curl_unlock_cb);
-    curl_dns_ttl = 300;
-
     return 0;
   }
 
-  // curl callbacks
-  static void curl_lock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
-    curl_share_mutex.lock();
-  }
-
-  static void curl_unlock_cb(CURL *handle, curl_lock_data data, curl_lock_access access, void *userptr) {
-    curl_share_mutex.unlock();
-  }
-
   /*
     int start() { return 0; }
     int stop() { return 0; }
@@ -674,5 +440,5 @@ public:
 
 BOOST_DLL_ALIAS(
     Rdio_Scanner_Uploader::create, // <-- this function is exported with...
-    create_plugin                  // <-- ...this alias name
+    create_plugin_v2                  // <-- ...this alias name
 )
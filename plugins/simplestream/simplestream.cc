@@ -5,26 +5,149 @@
 #include <boost/asio.hpp>
 #include <boost/array.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <errno.h>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <thread>
+#include <time.h>
+
 using namespace boost::asio;
 
+#ifndef __linux__
+// sendmmsg() is Linux only, elsewhere send_udp() walks the batch with sendmsg()
+struct mmsghdr {
+  struct msghdr msg_hdr;
+  unsigned int msg_len;
+};
+#endif
+
 typedef struct plugin_t plugin_t;
 typedef struct stream_t stream_t;
-std::vector<stream_t> streams;
-io_service my_tcp_io_service;
-long max_tcp_index = 0;
+
+// Patches are dropped by the control channel once they have not been heard
+// for 10 seconds, so routes are checked against the system at least this often.
+#define ROUTE_REFRESH_SECONDS 10
+// Routes for calls that stopped sending audio are pruned after this long
+#define ROUTE_IDLE_SECONDS 60
+// Datagrams handed to the kernel with each sendmmsg()
+#define UDP_BATCH 16
 
 struct plugin_t {
   Config* config;
 };
 
+/*
+ * Writes a TCP stream from the plugin's io thread.
+ *
+ * Packets are appended to a queue and written in batches, so audio_stream()
+ * never waits on the network. When the receiver falls behind by more than
+ * max_backlog bytes, whole packets are dropped so the framing stays intact.
+ */
+class Tcp_Sender {
+public:
+  Tcp_Sender(io_service &io, size_t max_backlog)
+      : d_io(io), d_socket(io), d_max_backlog(max_backlog), d_writing_size(0), d_write_pending(false), d_connected(false), d_dropped(0) {}
+
+  bool connect(const ip::tcp::endpoint &endpoint) {
+    boost::system::error_code error;
+    d_socket.connect(endpoint, error);
+    if (error) {
+      BOOST_LOG_TRIVIAL(error) << "simplestreamer unable to connect to " << endpoint << ": " << error.message();
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_connected = true;
+    return true;
+  }
+
+  void close() {
+    boost::system::error_code error;
+    {
+      std::lock_guard<std::mutex> lock(d_mutex);
+      d_connected = false;
+    }
+    d_socket.shutdown(ip::tcp::socket::shutdown_both, error);
+    d_socket.close(error);
+  }
+
+  void send(const struct iovec *iov, int iovcnt) {
+    size_t length = 0;
+    for (int i = 0; i < iovcnt; i++) {
+      length += iov[i].iov_len;
+    }
+
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (!d_connected || (d_queue.size() + d_writing_size + length > d_max_backlog)) {
+      d_dropped++;
+      return;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+      const char *data = (const char *)iov[i].iov_base;
+      d_queue.insert(d_queue.end(), data, data + iov[i].iov_len);
+    }
+    if (!d_write_pending) {
+      d_write_pending = true;
+      d_io.post(std::bind(&Tcp_Sender::start_write, this));
+    }
+  }
+
+  unsigned long get_dropped() const { return d_dropped.load(); }
+
+private:
+  io_service &d_io;
+  ip::tcp::socket d_socket;
+  size_t d_max_backlog;
+
+  std::mutex d_mutex;
+  std::vector<char> d_queue;   // waiting for the current write to finish
+  std::vector<char> d_writing; // owned by the write in progress
+  size_t d_writing_size;
+  bool d_write_pending;
+  bool d_connected;
+  std::atomic<unsigned long> d_dropped;
+
+  // Runs on the io thread. Everything queued since the last write goes out
+  // in one async_write.
+  void start_write() {
+    {
+      std::lock_guard<std::mutex> lock(d_mutex);
+      d_writing.swap(d_queue);
+      d_writing_size = d_writing.size();
+    }
+    async_write(d_socket, buffer(d_writing), [this](const boost::system::error_code &error, std::size_t) {
+      std::lock_guard<std::mutex> lock(d_mutex);
+      d_writing.clear();
+      d_writing_size = 0;
+      if (error) {
+        if (d_connected) {
+          BOOST_LOG_TRIVIAL(error) << "simplestreamer TCP write failed: " << error.message();
+        }
+        d_connected = false;
+        d_queue.clear();
+        d_write_pending = false;
+      } else if (d_queue.empty()) {
+        d_write_pending = false;
+      } else {
+        d_io.post(std::bind(&Tcp_Sender::start_write, this));
+      }
+    });
+  }
+};
+
 struct stream_t {
   long TGID;
-  long tcp_index;
   std::string address;
   std::string short_name;
   long port;
   ip::udp::endpoint remote_endpoint;
-  ip::tcp::socket *tcp_socket;
+  std::shared_ptr<Tcp_Sender> tcp_sender;
+  size_t tcp_max_backlog;
   bool sendTGID = false;
   bool sendJSON = false;
   bool sendCallStart = false;
@@ -32,15 +155,59 @@ struct stream_t {
   bool tcp = false;
 };
 
-class Simple_Stream : public Plugin_Api {
+// One packet to send for each audio buffer: the stream, and the metadata
+// that goes in front of the samples
+struct stream_destination_t {
+  size_t stream;
+  uint32_t json_length;
+  std::string header; // JSON metadata, or the TGID when only sendTGID is set
+};
+
+// Everything audio_stream() needs for a call, rebuilt when a new unit starts
+// talking or the talkgroup's patches change
+struct call_route_t {
+  Recorder *recorder;
+  long current_source_id;
+  std::vector<long> patched_talkgroups;
+  unsigned long patch_generation;
+  time_t built;
+  std::atomic<time_t> last_used;
+  std::vector<stream_destination_t> destinations;
+};
+
+class Simple_Stream : public Plugin_Api_v2 {
   typedef boost::asio::io_service io_service;
   io_service my_io_service;
-  ip::udp::endpoint remote_endpoint;
   ip::udp::socket my_socket{my_io_service};
+
+  // Declared ahead of streams, so the sockets go before their io_service
+  io_service my_tcp_io_service;
+  std::unique_ptr<io_service::work> tcp_work;
+  std::thread tcp_thread;
+
+  std::vector<stream_t> streams;
+  // Indexes into streams, keyed by (shortName, TGID). An empty shortName or
+  // a TGID of 0 is a wildcard, and is stored as such.
+  std::map<std::pair<std::string, long>, std::vector<size_t>> routing_table;
+
+  std::mutex routes_mutex;
+  std::map<long, std::shared_ptr<call_route_t>> routes; // by call number
+  std::atomic<unsigned long> patch_generation{0};
+  time_t last_prune = 0;
+
+  std::atomic<unsigned long> udp_sent{0};
+  std::atomic<unsigned long> udp_dropped{0};
+
   public:
-  
+
   Simple_Stream(){
-      
+
+  }
+
+  ~Simple_Stream(){
+    if (tcp_thread.joinable()) {
+      stop();
+    }
   }
 
  int parse_config(json config_data) {
@@ -55,28 +222,47 @@ class Simple_Stream : public Plugin_Api {
       stream.sendCallStart = element.value("sendCallStart",false);
       stream.sendCallEnd = element.value("sendCallEnd",false);
       stream.tcp = element.value("useTCP",false);
+      stream.tcp_max_backlog = element.value("tcpMaxBacklog", 262144);
       stream.short_name = element.value("shortName", "");
       BOOST_LOG_TRIVIAL(info) << "simplestreamer will stream audio from TGID " <<stream.TGID << " on System " <<stream.short_name << " to " << stream.address <<" on port " << stream.port << " tcp is "<<stream.tcp;
+      routing_table[std::make_pair(stream.short_name, stream.TGID)].push_back(streams.size());
       streams.push_back(stream);
     }
     return 0;
   }
-  
-  int audio_stream(Call *call, Recorder *recorder, int16_t *samples, int sampleCount){
-    //Call local_call = *call;
-    System *call_system = call->get_system();
-    int32_t call_tgid = call->get_talkgroup();
-    int32_t call_src = call->get_current_source_id();
-    uint32_t call_freq = call->get_freq();
-    std::string call_short_name = call->get_short_name();
-    std::string call_src_tag = call_system->find_unit_tag(call_src);
+
+  // Streams that want audio for this talkgroup, in the order they were configured
+  void find_streams(const std::string &short_name, long TGID, std::vector<size_t> &matches) {
+    const std::pair<std::string, long> keys[] = {std::make_pair(short_name, TGID),
+                                                 std::make_pair(short_name, 0L),
+                                                 std::make_pair(std::string(""), TGID),
+                                                 std::make_pair(std::string(""), 0L)};
+    matches.clear();
+    for (int i = 0; i < 4; i++) {
+      if ((i > 0) && (keys[i] == keys[i - 1])) {
+        continue;
+      }
+      std::map<std::pair<std::string, long>, std::vector<size_t>>::const_iterator it = routing_table.find(keys[i]);
+      if (it != routing_table.end()) {
+        matches.insert(matches.end(), it->second.begin(), it->second.end());
+      }
+    }
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end()), matches.end());
+  }
+
+  std::vector<long> get_patched_talkgroups(System *call_system, long call_tgid) {
     std::vector<unsigned long> unsigned_patched_talkgroups = call_system->get_talkgroup_patch(call_tgid);
     std::vector<long> patched_talkgroups;
     // Convert unsigned long to signed long, preserving negative values
     for (auto tgid : unsigned_patched_talkgroups) {
       patched_talkgroups.push_back(static_cast<long>(tgid));
     }
+    return patched_talkgroups;
+  }
 
+  long get_source(Call *call) {
+    long call_src = call->get_current_source_id();
     if(call_src == -1){
       if(call->get_transmissions().size() > 0){
         // Get the source from the most recent transmission
@@ -88,83 +274,286 @@ class Simple_Stream : public Plugin_Api {
         BOOST_LOG_TRIVIAL(debug) << "no source found for call - leaving src as -1";
       }
     }
+    return call_src;
+  }
 
-    Recorder& local_recorder = *recorder;
-    int recorder_id = local_recorder.get_num();
-    long wav_hz = local_recorder.get_wav_hz();
-    boost::system::error_code error;
-    BOOST_FOREACH (auto stream, streams){
-      if (0==stream.short_name.compare(call_short_name) || (0==stream.short_name.compare(""))){ //Check if shortName matches or is not specified
-        if (patched_talkgroups.size() == 0){
-          patched_talkgroups.push_back(call_tgid);  //call_info.talkgroup may be negative - we cast stream.TGID to signed for comparison
+  // Works out where audio for the call goes and renders the metadata for each
+  // destination, so audio_stream() only has to send it
+  std::shared_ptr<call_route_t> build_route(Call *call, Recorder *recorder, const std::vector<long> &patches, unsigned long generation) {
+    std::shared_ptr<call_route_t> route = std::make_shared<call_route_t>();
+    System *call_system = call->get_system();
+    int32_t call_tgid = call->get_talkgroup();
+    long call_src = get_source(call);
+    uint32_t call_freq = call->get_freq();
+    std::string call_short_name = call->get_short_name();
+    std::string call_src_tag = call_system->find_unit_tag(call_src);
+    long wav_hz = recorder->get_wav_hz();
+
+    route->recorder = recorder;
+    route->current_source_id = call->get_current_source_id();
+    route->patched_talkgroups = patches;
+    route->patch_generation = generation;
+    route->built = time(NULL);
+    route->last_used = route->built;
+
+    std::vector<long> patched_talkgroups = patches;
+    if (patched_talkgroups.size() == 0){
+      patched_talkgroups.push_back(call_tgid);  //call_info.talkgroup may be negative - we cast stream.TGID to signed for comparison
+    }
+
+    std::vector<size_t> matches;
+    BOOST_FOREACH (auto TGID, patched_talkgroups){
+      find_streams(call_short_name, TGID, matches);
+      BOOST_FOREACH (size_t index, matches){
+        const stream_t &stream = streams[index];
+        stream_destination_t destination;
+        destination.stream = index;
+        destination.json_length = 0;
+        if (stream.sendJSON==true){
+          //create JSON metadata
+          json json_object = {
+             {"src", call_src},
+             {"src_tag",call_src_tag},
+             {"talkgroup", TGID},
+             {"patched_talkgroups",patched_talkgroups},
+             {"freq", call_freq},
+             {"short_name", call_short_name},
+             {"audio_sample_rate",wav_hz},
+             {"event","audio"},
+          };
+          destination.header = json_object.dump();
+          destination.json_length = destination.header.length();  //determine length in bytes
         }
-        BOOST_FOREACH (auto TGID, patched_talkgroups){
-          if ((TGID==static_cast<long>(stream.TGID)) || stream.TGID==0){  //setting TGID to 0 in the config file will stream everything
-            BOOST_LOG_TRIVIAL(debug) << "got " <<sampleCount <<" samples - " <<sampleCount*2<<" bytes from recorder "<<recorder_id<<" for TGID "<<TGID;
-            json json_object;
-            std::string json_string;
-            std::vector<boost::asio::const_buffer> send_buffer;
-            if (stream.sendJSON==true){
-              //create JSON metadata
-              json_object = {
-                 {"src", call_src},
-                 {"src_tag",call_src_tag},
-                 {"talkgroup", TGID},
-                 {"patched_talkgroups",patched_talkgroups},
-                 {"freq", call_freq},
-                 {"short_name", call_short_name},
-                 {"audio_sample_rate",wav_hz},
-                 {"event","audio"},
-              };
-              json_string = json_object.dump();
-              uint32_t json_length = json_string.length();  //determine length in bytes
-              //BOOST_LOG_TRIVIAL(debug) << "json_length is " <<json_length <<" bytes";
-              send_buffer.push_back(buffer(&json_length,4));  //prepend length of the json data
-              send_buffer.push_back(buffer(json_string));  //prepend json data
-              //BOOST_LOG_TRIVIAL(debug) << "json_string is " <<json_string;
-            }
-            else if (stream.sendTGID==true){
-              send_buffer.push_back(buffer(&TGID,4));  //prepend 4 byte long tgid to the audio data
-            }
-            send_buffer.push_back(buffer(samples, sampleCount*2));
-            if(stream.tcp == true){
-              stream.tcp_socket->send(send_buffer);
-            }
-            else{
-              my_socket.send_to(send_buffer, stream.remote_endpoint, 0, error);
-            }
-          }
+        else if (stream.sendTGID==true){
+          uint32_t tgid = (uint32_t)TGID;
+          destination.header.assign((const char *)&tgid, 4);  //prepend 4 byte long tgid to the audio data
         }
+        route->destinations.push_back(destination);
+      }
+    }
+    // Streams in the order they were configured, then talkgroups in patch order
+    std::stable_sort(route->destinations.begin(), route->destinations.end(), [](const stream_destination_t &a, const stream_destination_t &b) { return a.stream < b.stream; });
+    return route;
+  }
+
+  // Returns the route for the call, rebuilding it if it is out of date
+  std::shared_ptr<call_route_t> get_route(Call *call, Recorder *recorder) {
+    const long call_num = call->get_call_num();
+    const unsigned long generation = patch_generation.load();
+    const time_t now = time(NULL);
+
+    std::shared_ptr<call_route_t> route;
+    {
+      std::lock_guard<std::mutex> lock(routes_mutex);
+      std::map<long, std::shared_ptr<call_route_t>>::iterator it = routes.find(call_num);
+      if (it != routes.end()) {
+        route = it->second;
+      }
+    }
+
+    // Every ROUTE_REFRESH_SECONDS the route is built again, which looks up
+    // the source, its tag and the frequency afresh
+    if (route && (route->recorder == recorder) && (route->current_source_id == call->get_current_source_id()) && (now - route->built < ROUTE_REFRESH_SECONDS)) {
+      if (route->patch_generation == generation) {
+        route->last_used = now;
+        return route;
+      }
+      // Patch messages repeat every few seconds, only rebuild if this
+      // talkgroup's patch actually changed. The copy keeps the build time,
+      // so it does not put off the next refresh.
+      std::vector<long> patches = get_patched_talkgroups(call->get_system(), call->get_talkgroup());
+      if (patches == route->patched_talkgroups) {
+        std::shared_ptr<call_route_t> refreshed = std::make_shared<call_route_t>();
+        refreshed->recorder = route->recorder;
+        refreshed->current_source_id = route->current_source_id;
+        refreshed->patched_talkgroups = route->patched_talkgroups;
+        refreshed->patch_generation = generation;
+        refreshed->built = route->built;
+        refreshed->last_used = now;
+        refreshed->destinations = route->destinations;
+        route = refreshed;
+      } else {
+        route = build_route(call, recorder, patches, generation);
+      }
+    } else {
+      route = build_route(call, recorder, get_patched_talkgroups(call->get_system(), call->get_talkgroup()), generation);
+    }
+
+    std::lock_guard<std::mutex> lock(routes_mutex);
+    routes[call_num] = route;
+    return route;
+  }
+
+  // Sends one packet to each stream. UDP packets are handed to the kernel
+  // in batches without blocking; TCP packets go on the stream's write queue.
+  void send_packets(const size_t *stream_indexes, struct iovec (*iovs)[3], const int *iovcnts, size_t count) {
+    struct mmsghdr msgs[UDP_BATCH];
+    size_t batched = 0;
+
+    for (size_t i = 0; i < count; i++) {
+      stream_t &stream = streams[stream_indexes[i]];
+      if (stream.tcp == true){
+        if (stream.tcp_sender) {
+          stream.tcp_sender->send(iovs[i], iovcnts[i]);
+        }
+        continue;
+      }
+
+      struct msghdr &hdr = msgs[batched].msg_hdr;
+      memset(&msgs[batched], 0, sizeof(struct mmsghdr));
+      hdr.msg_name = stream.remote_endpoint.data();
+      hdr.msg_namelen = stream.remote_endpoint.size();
+      hdr.msg_iov = iovs[i];
+      hdr.msg_iovlen = iovcnts[i];
+      batched++;
+
+      if (batched == UDP_BATCH) {
+        send_udp(msgs, batched);
+        batched = 0;
+      }
+    }
+    if (batched > 0) {
+      send_udp(msgs, batched);
+    }
+  }
+
+  void send_udp(struct mmsghdr *msgs, size_t count) {
+    const int fd = my_socket.native_handle();
+#ifdef __linux__
+    size_t sent = 0;
+    while (sent < count) {
+      int ret = sendmmsg(fd, msgs + sent, count - sent, MSG_DONTWAIT);
+      if (ret < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        // Socket buffer is full or the destination is unreachable, skip the
+        // datagram that failed rather than waiting
+        udp_dropped++;
+        sent++;
+        continue;
+      }
+      sent += ret;
+      udp_sent += ret;
+    }
+#else
+    for (size_t i = 0; i < count; i++) {
+      if (sendmsg(fd, &msgs[i].msg_hdr, MSG_DONTWAIT) < 0) {
+        udp_dropped++;
+      } else {
+        udp_sent++;
+      }
+    }
+#endif
+  }
+
+  // Sends a JSON event with no audio to one stream
+  void send_event(size_t stream_index, const std::string &json_string) {
+    uint32_t json_length = json_string.length();  //determine length in bytes
+    struct iovec iov[1][3];
+    iov[0][0].iov_base = &json_length;  //prepend length of the json data
+    iov[0][0].iov_len = 4;
+    iov[0][1].iov_base = (void *)json_string.data();
+    iov[0][1].iov_len = json_string.length();
+    int iovcnt = 2;
+    send_packets(&stream_index, iov, &iovcnt, 1);
+  }
+
+  int audio_stream(Call *call, Recorder *recorder, const int16_t *samples, int sampleCount){
+    std::shared_ptr<call_route_t> route = get_route(call, recorder);
+    const size_t count = route->destinations.size();
+    if (count == 0) {
+      return 0;
+    }
+
+    size_t stream_indexes[UDP_BATCH];
+    struct iovec iovs[UDP_BATCH][3];
+    int iovcnts[UDP_BATCH];
+    size_t batched = 0;
+
+    for (size_t i = 0; i < count; i++) {
+      const stream_destination_t &destination = route->destinations[i];
+      int iovcnt = 0;
+      if (destination.json_length > 0) {
+        iovs[batched][iovcnt].iov_base = (void *)&destination.json_length;  //prepend length of the json data
+        iovs[batched][iovcnt].iov_len = 4;
+        iovcnt++;
+      }
+      if (!destination.header.empty()) {
+        iovs[batched][iovcnt].iov_base = (void *)destination.header.data();
+        iovs[batched][iovcnt].iov_len = destination.header.length();
+        iovcnt++;
+      }
+      iovs[batched][iovcnt].iov_base = (void *)samples;
+      iovs[batched][iovcnt].iov_len = sampleCount * 2;
+      iovcnt++;
+
+      stream_indexes[batched] = destination.stream;
+      iovcnts[batched] = iovcnt;
+      batched++;
+
+      if (batched == UDP_BATCH) {
+        send_packets(stream_indexes, iovs, iovcnts, batched);
+        batched = 0;
+      }
+    }
+    if (batched > 0) {
+      send_packets(stream_indexes, iovs, iovcnts, batched);
+    }
+    return 0;
+  }
+
+  int trunk_message(const std::vector<TrunkMessage> &messages, System *system) {
+    BOOST_FOREACH (const TrunkMessage &message, messages){
+      if ((message.message_type == PATCH_ADD) || (message.message_type == PATCH_DELETE)) {
+        patch_generation++;
+        break;
+      }
+    }
+    return 0;
+  }
+
+  int poll_one() {
+    // Drop routes for calls that have not sent audio in a while, in case
+    // audio arrived after call_end() already removed them
+    const time_t now = time(NULL);
+    if (now - last_prune < ROUTE_IDLE_SECONDS) {
+      return 0;
+    }
+    last_prune = now;
+
+    std::lock_guard<std::mutex> lock(routes_mutex);
+    for (std::map<long, std::shared_ptr<call_route_t>>::iterator it = routes.begin(); it != routes.end();) {
+      if (now - it->second->last_used >= ROUTE_IDLE_SECONDS) {
+        it = routes.erase(it);
+      } else {
+        ++it;
       }
     }
     return 0;
   }
 
   int call_start(Call *call){
-    boost::system::error_code error;
     System *call_system = call->get_system();
     int32_t call_tgid = call->get_talkgroup();
-    int32_t call_src = call->get_current_source_id();
+    std::vector<long> patched_talkgroups = get_patched_talkgroups(call_system, call_tgid);
+
+    // A new call, or a new unit talking on it: build the route here, off the audio path
+    Recorder *recorder = call->get_recorder();
+    if (recorder != NULL) {
+      std::shared_ptr<call_route_t> route = build_route(call, recorder, patched_talkgroups, patch_generation.load());
+      std::lock_guard<std::mutex> lock(routes_mutex);
+      routes[call->get_call_num()] = route;
+    }
+
+    long call_src = get_source(call);
     uint32_t call_freq = call->get_freq();
     std::string call_short_name = call->get_short_name();
     std::string call_src_tag = call_system->find_unit_tag(call_src);
     std::string call_tgid_tag = call->get_talkgroup_tag();
-    std::vector<unsigned long> unsigned_patched_talkgroups = call_system->get_talkgroup_patch(call_tgid);
-    std::vector<long> patched_talkgroups;
-    // Convert unsigned long to signed long, preserving negative values
-    for (auto tgid : unsigned_patched_talkgroups) {
-      patched_talkgroups.push_back(static_cast<long>(tgid));
-    }
 
-    if(call_src == -1){
-      if(call->get_transmissions().size() > 0){
-        // Get the source from the most recent transmission
-        auto transmissions = call->get_transmissions();
-        call_src = transmissions.back().source;
-      }
-    }
-    
-    BOOST_FOREACH (auto stream, streams){
+    for (size_t index = 0; index < streams.size(); index++){
+      const stream_t &stream = streams[index];
       if (stream.sendJSON == true && stream.sendCallStart == true){
         if (0==stream.short_name.compare(call_short_name) || (0==stream.short_name.compare(""))){ //Check if shortName matches or is not specified
           if (patched_talkgroups.size() == 0){
@@ -177,33 +566,19 @@ class Simple_Stream : public Plugin_Api {
               patched_talkgroup_tags.push_back(this_tg->alpha_tag);
             }
             if ((TGID==static_cast<long>(stream.TGID)) || stream.TGID==0){  //setting TGID to 0 in the config file will stream everything
-              json json_object;
-              std::string json_string;
-              std::vector<boost::asio::const_buffer> send_buffer;
-              if (stream.sendJSON==true){
-                //create JSON metadata
-                json_object = {
-                   {"src", call_src},
-                   {"src_tag", call_src_tag},
-                   {"talkgroup", call_tgid},
-                   {"talkgroup_tag",call_tgid_tag},
-                   {"patched_talkgroups",patched_talkgroups},
-                   {"patched_talkgroup_tags",patched_talkgroup_tags},
-                   {"freq", call_freq},
-                   {"short_name", call_short_name},
-                   {"event","call_start"},
-                };
-                json_string = json_object.dump();
-                uint32_t json_length = json_string.length();  //determine length in bytes
-                send_buffer.push_back(buffer(&json_length,4));  //prepend length of the json data
-                send_buffer.push_back(buffer(json_string));  //prepend json data
-              }
-              if(stream.tcp == true){
-                stream.tcp_socket->send(send_buffer);
-              }
-              else{
-                my_socket.send_to(send_buffer, stream.remote_endpoint, 0, error);
-              }
+              //create JSON metadata
+              json json_object = {
+                 {"src", call_src},
+                 {"src_tag", call_src_tag},
+                 {"talkgroup", call_tgid},
+                 {"talkgroup_tag",call_tgid_tag},
+                 {"patched_talkgroups",patched_talkgroups},
+                 {"patched_talkgroup_tags",patched_talkgroup_tags},
+                 {"freq", call_freq},
+                 {"short_name", call_short_name},
+                 {"event","call_start"},
+              };
+              send_event(index, json_object.dump());
             }
           }
         }
@@ -212,9 +587,14 @@ class Simple_Stream : public Plugin_Api {
     return 0;
   }
 
-  int call_end(Call_Data_t call_info) {
-    boost::system::error_code error;
-    BOOST_FOREACH (auto stream, streams){
+  int call_end(const Call_Data_t &call_info) {
+    {
+      std::lock_guard<std::mutex> lock(routes_mutex);
+      routes.erase(call_info.call_num);
+    }
+
+    for (size_t index = 0; index < streams.size(); index++){
+      const stream_t &stream = streams[index];
       if (stream.sendJSON == true && stream.sendCallEnd == true){
         if (0==stream.short_name.compare(call_info.short_name) || (0==stream.short_name.compare(""))){ //Check if shortName matches or is not specified
           std::vector<long> patched_talkgroups;
@@ -228,29 +608,15 @@ class Simple_Stream : public Plugin_Api {
           }
           BOOST_FOREACH (auto TGID, patched_talkgroups){
             if ((TGID == static_cast<long>(stream.TGID)) || stream.TGID==0){  //setting TGID to 0 in the config file will stream everything
-              json json_object;
-              std::string json_string;
-              std::vector<boost::asio::const_buffer> send_buffer;
-              if (stream.sendJSON==true){
-                //create JSON metadata
-                json_object = {
-                   {"talkgroup", call_info.talkgroup},
-                   {"patched_talkgroups",patched_talkgroups},
-                   {"freq", call_info.freq},
-                   {"short_name", call_info.short_name},
-                   {"event","call_end"},
-                };
-                json_string = json_object.dump();
-                uint32_t json_length = json_string.length();  //determine length in bytes
-                send_buffer.push_back(buffer(&json_length,4));  //prepend length of the json data
-                send_buffer.push_back(buffer(json_string));  //prepend json data
-              }
-              if(stream.tcp == true){
-                stream.tcp_socket->send(send_buffer);
-              }
-              else{
-                my_socket.send_to(send_buffer, stream.remote_endpoint, 0, error);
-              }
+              //create JSON metadata
+              json json_object = {
+                 {"talkgroup", call_info.talkgroup},
+                 {"patched_talkgroups",patched_talkgroups},
+                 {"freq", call_info.freq},
+                 {"short_name", call_info.short_name},
+                 {"event","call_end"},
+              };
+              send_event(index, json_object.dump());
             }
           }
         }
@@ -260,25 +626,38 @@ class Simple_Stream : public Plugin_Api {
   }
 
   int start(){
+    tcp_work.reset(new io_service::work(my_tcp_io_service));
+    tcp_thread = std::thread([this]() { my_tcp_io_service.run(); });
+
     BOOST_FOREACH (auto& stream, streams){
       if (stream.tcp == true){
-        ip::tcp::socket *my_tcp_socket = new ip::tcp::socket{my_tcp_io_service};
-        stream.tcp_socket = my_tcp_socket;
-        stream.tcp_socket->connect(ip::tcp::endpoint( boost::asio::ip::address::from_string(stream.address), stream.port ));
+        stream.tcp_sender = std::make_shared<Tcp_Sender>(my_tcp_io_service, stream.tcp_max_backlog);
+        stream.tcp_sender->connect(ip::tcp::endpoint( boost::asio::ip::address::from_string(stream.address), stream.port ));
       }
     }
     my_socket.open(ip::udp::v4());
+    my_socket.non_blocking(true);
     return 0;
   }
-  
+
   int stop(){
+    unsigned long tcp_dropped = 0;
     BOOST_FOREACH (auto& stream, streams){
-      if (stream.tcp == true){
-        stream.tcp_socket->shutdown(boost::asio::ip::tcp::socket::shutdown_both);
-        stream.tcp_socket->close();
+      if (stream.tcp_sender){
+        tcp_dropped += stream.tcp_sender->get_dropped();
+        stream.tcp_sender->close();
       }
     }
+    tcp_work.reset();
+    my_tcp_io_service.stop();
+    if (tcp_thread.joinable()) {
+      tcp_thread.join();
+    }
+    BOOST_FOREACH (auto& stream, streams){
+      stream.tcp_sender.reset();
+    }
     my_socket.close();
+    BOOST_LOG_TRIVIAL(info) << "simplestreamer sent " << udp_sent << " UDP packets, dropped " << udp_dropped << " UDP and " << tcp_dropped << " TCP packets";
     return 0;
   }
 
@@ -290,5 +669,5 @@ class Simple_Stream : public Plugin_Api {
 
 BOOST_DLL_ALIAS(
     Simple_Stream::create, // <-- this function is exported with...
-    create_plugin             // <-- ...this alias name
+    create_plugin_v2             // <-- ...this alias name
 )
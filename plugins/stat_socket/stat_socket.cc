@@ -1,3 +1,7 @@
+#include <chrono>
+#include <map>
+#include <set>
+#include <stdio.h>
 #include <time.h>
 #include <vector>
 #include <websocketpp/client.hpp>
@@ -15,6 +19,116 @@
 
 typedef struct stat_plugin_t stat_plugin_t;
 
+/*
+ * Appends JSON to a string as it goes, instead of building a property_tree
+ * and serializing it afterwards.
+ *
+ * Values are written as strings, formatted and escaped the way
+ * boost::property_tree::write_json does, and an empty array is written as ""
+ * like write_json writes an empty node, so the messages read the same as
+ * they always have.
+ */
+class Json_Writer {
+public:
+  Json_Writer(std::string &out) : d_out(out), d_first(true) {}
+
+  void begin_object() { separator(); d_out += '{'; d_first = true; }
+  void begin_object(const char *key) { write_key(key); d_out += '{'; d_first = true; }
+  void end_object() { d_out += '}'; d_first = false; }
+  void begin_array() { separator(); d_out += '['; d_first = true; }
+  void begin_array(const char *key) { write_key(key); d_out += '['; d_first = true; }
+  void end_array() {
+    if (d_first && !d_out.empty() && (d_out.back() == '[')) {
+      d_out.back() = '"';
+      d_out += '"';
+    } else {
+      d_out += ']';
+    }
+    d_first = false;
+  }
+
+  // The key for the object or array that is written next
+  void key(const char *key) { write_key(key); d_first = true; }
+  // An element that has already been serialized
+  void raw(const std::string &json) { separator(); d_out += json; }
+
+  void value(const std::string &v) { separator(); write_string(v); }
+  void value(double v) { separator(); write_double(v); }
+
+  void value(const char *key, const std::string &v) { write_key(key); write_string(v); }
+  void value(const char *key, const char *v) { write_key(key); write_string(v); }
+  void value(const char *key, bool v) { write_key(key); d_out += v ? "\"true\"" : "\"false\""; }
+  void value(const char *key, int v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, long v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, long long v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, unsigned int v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, unsigned long v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, unsigned long long v) { write_number(key, std::to_string(v)); }
+  void value(const char *key, double v) { write_key(key); write_double(v); }
+  void value(const char *key, float v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.9g", v);
+    write_number(key, buf);
+  }
+
+private:
+  std::string &d_out;
+  bool d_first;
+
+  void separator() {
+    if (!d_first) {
+      d_out += ',';
+    }
+    d_first = false;
+  }
+
+  void write_key(const char *key) {
+    separator();
+    write_string(key);
+    d_out += ':';
+  }
+
+  void write_number(const char *key, const std::string &v) {
+    write_key(key);
+    d_out += '"';
+    d_out += v;
+    d_out += '"';
+  }
+
+  void write_double(double v) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "\"%.17g\"", v);
+    d_out += buf;
+  }
+
+  void write_string(const std::string &v) {
+    static const char *hexdigits = "0123456789ABCDEF";
+    d_out += '"';
+    for (std::string::const_iterator it = v.begin(); it != v.end(); ++it) {
+      const unsigned char c = *it;
+      switch (c) {
+      case '\b': d_out += "\\b"; break;
+      case '\f': d_out += "\\f"; break;
+      case '\n': d_out += "\\n"; break;
+      case '\r': d_out += "\\r"; break;
+      case '\t': d_out += "\\t"; break;
+      case '/': d_out += "\\/"; break;
+      case '"': d_out += "\\\""; break;
+      case '\\': d_out += "\\\\"; break;
+      default:
+        if (c < 0x20) {
+          d_out += "\\u00";
+          d_out += hexdigits[c >> 4];
+          d_out += hexdigits[c & 0xF];
+        } else {
+          d_out += (char)c;
+        }
+      }
+    }
+    d_out += '"';
+  }
+};
+
 struct stat_plugin_t {
   std::vector<Source *> sources;
   std::vector<System *> systems;
@@ -23,7 +137,7 @@ struct stat_plugin_t {
 };
 
 
-class Stat_Socket : public Plugin_Api {
+class Stat_Socket : public Plugin_Api_v2 {
 
   typedef websocketpp::client<websocketpp::config::asio_client> client;
   //typedef websocketpp::retry_client_endpoint<websocketpp::retry_config<websocketpp::config::asio_client>> client;
@@ -43,6 +157,29 @@ class Stat_Socket : public Plugin_Api {
   std::vector<Call *> calls;
   Config* config;
 
+  // Cached model of what the server has been sent. Recorders and calls are
+  // kept serialized, so a change is found by comparing strings and the
+  // snapshot on connect does not have to touch the recorders or calls.
+  struct cached_call_t {
+    std::string signature; // everything except the timing fields
+    std::string json;
+    long elapsed;
+    double length;
+  };
+  struct call_times_t {
+    long elapsed;
+    double length;
+  };
+  bool send_diffs;
+  double update_interval;
+  double last_update;
+  std::map<std::string, std::string> recorder_cache;
+  std::map<std::string, cached_call_t> call_cache;
+  std::map<std::string, std::string> changed_recorders;
+  std::map<std::string, std::string> changed_calls;
+  std::map<std::string, call_times_t> changed_times;
+  std::map<std::string, double> ended_calls; // length when last seen active
+
 public:
   /**
  * The telemetry client connects to a WebSocket server and sends a message every
@@ -50,21 +187,27 @@ public:
  * programs where a client connects and pushes data for logging, stress/load
  * testing, etc.
  */
-  int system_rates(std::vector<System *> systems, float timeDiff) {
+  int system_rates(const std::vector<System *> &systems, float timeDiff) {
     this->systems = systems;
     if (m_open == false)
       return 0;
-      
-    boost::property_tree::ptree nodes;
 
-    for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("rates");
+    for (std::vector<System *>::const_iterator it = systems.begin(); it != systems.end(); it++) {
       System *system = *it;
-      nodes.push_back(std::make_pair("", system->get_stats_current(timeDiff)));
+      writer.begin_object();
+      writer.value("id", system->get_sys_num());
+      writer.value("decoderate", system->get_message_count() / timeDiff);
+      writer.end_object();
     }
-    return send_object(nodes, "rates", "rates");
+    writer.end_array();
+    return send_message(message, writer, "rates");
   }
 
-  Stat_Socket() : m_open(false), m_done(false), m_config_sent(false) {
+  Stat_Socket() : m_open(false), m_done(false), m_config_sent(false), send_diffs(false), update_interval(1.0), last_update(0) {
     // set up access channels to only log interesting things
     m_client.clear_access_channels(websocketpp::log::alevel::all);
     m_client.set_access_channels(websocketpp::log::alevel::connect);
@@ -85,6 +228,100 @@ public:
     m_client.set_message_handler(bind(&Stat_Socket::on_message, this, _1, _2));
   }
 
+  static double now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  static void write_system(Json_Writer &writer, System *system) {
+    writer.begin_object();
+    writer.value("id", system->get_sys_num());
+    writer.value("name", system->get_short_name());
+    writer.value("type", system->get_system_type());
+    writer.value("sysid", system->get_sys_id());
+    writer.value("wacn", system->get_wacn());
+    writer.value("nac", system->get_nac());
+    writer.end_object();
+  }
+
+  static std::string recorder_id(Recorder *recorder) {
+    return std::to_string(recorder->get_source()->get_num()) + "_" + std::to_string(recorder->get_num());
+  }
+
+  static void write_recorder(Json_Writer &writer, Recorder *recorder) {
+    writer.begin_object();
+    writer.value("id", recorder_id(recorder));
+    writer.value("type", recorder->get_type_string());
+    writer.value("srcNum", recorder->get_source()->get_num());
+    writer.value("recNum", recorder->get_num());
+    writer.value("count", recorder->get_recording_count());
+    writer.value("duration", recorder->get_recording_duration());
+    writer.value("state", (int)recorder->get_state());
+    writer.end_object();
+  }
+
+  static std::string call_id(Call *call) {
+    return std::to_string(call->get_sys_num()) + "_" + std::to_string(call->get_talkgroup()) + "_" + std::to_string((long)call->get_start_time());
+  }
+
+  static double call_length(Call *call) {
+    return (call->get_state() == RECORDING) ? call->get_current_length() : call->get_final_length();
+  }
+
+  // elapsed and length change every second, so they are left out of the
+  // signature used to spot calls that have changed
+  static void write_call(Json_Writer &writer, Call *call, bool timing) {
+    writer.begin_object();
+    writer.value("id", call_id(call));
+    writer.value("callNum", call->get_call_num());
+    writer.value("freq", call->get_freq());
+    writer.value("sysNum", call->get_sys_num());
+    writer.value("shortName", call->get_short_name());
+    writer.value("talkgroup", call->get_talkgroup());
+    writer.value("talkgrouptag", call->get_talkgroup_tag());
+    if (timing) {
+      writer.value("elapsed", call->elapsed());
+      writer.value("length", call_length(call));
+    }
+    writer.value("state", (int)call->get_state());
+    writer.value("monState", (int)call->get_monitoring_state());
+    writer.value("phase2", call->get_phase2_tdma());
+    writer.value("conventional", call->is_conventional());
+    writer.value("encrypted", call->get_encrypted());
+    writer.value("emergency", call->get_emergency());
+    writer.value("priority", call->get_priority());
+    writer.value("mode", call->get_mode());
+    writer.value("duplex", call->get_duplex());
+    writer.value("startTime", (long)call->get_start_time());
+    writer.value("stopTime", call->get_stop_time());
+    writer.value("startTimeMs", (long long)call->get_start_time_ms());
+    writer.value("stopTimeMs", (long long)call->get_stop_time_ms());
+    writer.value("srcId", call->get_current_source_id());
+
+    Recorder *recorder = call->get_recorder();
+
+    if (recorder) {
+      writer.value("recNum", recorder->get_num());
+      writer.value("srcNum", recorder->get_source()->get_num());
+      writer.value("recState", (int)recorder->get_state());
+      writer.value("analog", recorder->is_analog());
+    }
+    writer.end_object();
+  }
+
+  static std::string serialize_call(Call *call, bool timing) {
+    std::string json;
+    Json_Writer writer(json);
+    write_call(writer, call, timing);
+    return json;
+  }
+
+  static std::string serialize_recorder(Recorder *recorder) {
+    std::string json;
+    Json_Writer writer(json);
+    write_recorder(writer, recorder);
+    return json;
+  }
+
   void send_config(std::vector<Source *> sources, std::vector<System *> systems) {
 
     if (m_open == false)
@@ -93,56 +330,57 @@ public:
     if (config_sent())
       return;
 
-    boost::property_tree::ptree root;
-    boost::property_tree::ptree systems_node;
-    boost::property_tree::ptree sources_node;
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("sources");
 
     for (std::vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
       Source *source = *it;
       std::vector<Gain_Stage_t> gain_stages;
-      boost::property_tree::ptree source_node;
-      source_node.put("source_num", source->get_num());
-      source_node.put("antenna", source->get_antenna());
-
-      source_node.put("silence_frames", source->get_silence_frames());
-
-      source_node.put("min_hz", source->get_min_hz());
-      source_node.put("max_hz", source->get_max_hz());
-      source_node.put("center", source->get_center());
-      source_node.put("rate", source->get_rate());
-      source_node.put("driver", source->get_driver());
-      source_node.put("device", source->get_device());
-      source_node.put("error", source->get_error());
-      source_node.put("gain", source->get_gain());
+      writer.begin_object();
+      writer.value("source_num", source->get_num());
+      writer.value("antenna", source->get_antenna());
+
+      writer.value("silence_frames", source->get_silence_frames());
+
+      writer.value("min_hz", source->get_min_hz());
+      writer.value("max_hz", source->get_max_hz());
+      writer.value("center", source->get_center());
+      writer.value("rate", source->get_rate());
+      writer.value("driver", source->get_driver());
+      writer.value("device", source->get_device());
+      writer.value("error", source->get_error());
+      writer.value("gain", source->get_gain());
       gain_stages = source->get_gain_stages();
       for (std::vector<Gain_Stage_t>::iterator gain_it = gain_stages.begin(); gain_it != gain_stages.end(); gain_it++) {
-        source_node.put(gain_it->stage_name + "_gain", gain_it->value);
+        writer.value((gain_it->stage_name + "_gain").c_str(), gain_it->value);
       }
-      source_node.put("antenna", source->get_antenna());
-      source_node.put("analog_recorders", source->analog_recorder_count());
-      source_node.put("digital_recorders", source->digital_recorder_count());
-      source_node.put("debug_recorders", source->debug_recorder_count());
-      source_node.put("sigmf_recorders", source->sigmf_recorder_count());
-      sources_node.push_back(std::make_pair("", source_node));
+      writer.value("analog_recorders", source->analog_recorder_count());
+      writer.value("digital_recorders", source->digital_recorder_count());
+      writer.value("debug_recorders", source->debug_recorder_count());
+      writer.value("sigmf_recorders", source->sigmf_recorder_count());
+      writer.end_object();
     }
+    writer.end_array();
 
+    writer.begin_array("systems");
     for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
       System *sys = (System *)*it;
 
-      boost::property_tree::ptree sys_node;
-      boost::property_tree::ptree channels_node;
-      sys_node.put("audioArchive", sys->get_audio_archive());
-      sys_node.put("systemType", sys->get_system_type());
-      sys_node.put("shortName", sys->get_short_name());
-      sys_node.put("sysNum", sys->get_sys_num());
-      sys_node.put("uploadScript", sys->get_upload_script());
-      sys_node.put("recordUnkown", sys->get_record_unknown());
-      sys_node.put("callLog", sys->get_call_log());
-      sys_node.put("talkgroupsFile", sys->get_talkgroups_file());
-      sys_node.put("analog_levels", sys->get_analog_levels());
-      sys_node.put("digital_levels", sys->get_digital_levels());
-      sys_node.put("qpsk", sys->get_qpsk_mod());
-      sys_node.put("squelch_db", sys->get_squelch_db());
+      writer.begin_object();
+      writer.value("audioArchive", sys->get_audio_archive());
+      writer.value("systemType", sys->get_system_type());
+      writer.value("shortName", sys->get_short_name());
+      writer.value("sysNum", sys->get_sys_num());
+      writer.value("uploadScript", sys->get_upload_script());
+      writer.value("recordUnkown", sys->get_record_unknown());
+      writer.value("callLog", sys->get_call_log());
+      writer.value("talkgroupsFile", sys->get_talkgroups_file());
+      writer.value("analog_levels", sys->get_analog_levels());
+      writer.value("digital_levels", sys->get_digital_levels());
+      writer.value("qpsk", sys->get_qpsk_mod());
+      writer.value("squelch_db", sys->get_squelch_db());
       std::vector<double> channels;
 
       if ((sys->get_system_type() == "conventional") || (sys->get_system_type() == "conventionalP25") || (sys->get_system_type() == "conventionalDMR") || (sys->get_system_type() == "conventionalSIGMF") ) {
@@ -151,112 +389,180 @@ public:
         channels = sys->get_control_channels();
       }
 
-      //std::cout << "starts: " << std::endl;
-
+      writer.begin_array("channels");
       for (std::vector<double>::iterator chan_it = channels.begin(); chan_it != channels.end(); chan_it++) {
-        double channel = *chan_it;
-        boost::property_tree::ptree channel_node;
-        //std::cout << "Hello: " << channel << std::endl;
-        channel_node.put("", channel);
-
-        // Add this node to the list.
-        channels_node.push_back(std::make_pair("", channel_node));
+        writer.value(*chan_it);
       }
-      sys_node.add_child("channels", channels_node);
+      writer.end_array();
 
       if (sys->get_system_type() == "smartnet") {
-        sys_node.put("bandplan", sys->get_bandplan());
-        sys_node.put("bandfreq", sys->get_bandfreq());
-        sys_node.put("bandplan_base", sys->get_bandplan_base());
-        sys_node.put("bandplan_high", sys->get_bandplan_high());
-        sys_node.put("bandplan_spacing", sys->get_bandplan_spacing());
-        sys_node.put("bandplan_offset", sys->get_bandplan_offset());
+        writer.value("bandplan", sys->get_bandplan());
+        writer.value("bandfreq", sys->get_bandfreq());
+        writer.value("bandplan_base", sys->get_bandplan_base());
+        writer.value("bandplan_high", sys->get_bandplan_high());
+        writer.value("bandplan_spacing", sys->get_bandplan_spacing());
+        writer.value("bandplan_offset", sys->get_bandplan_offset());
       }
-      systems_node.push_back(std::make_pair("", sys_node));
+      writer.end_object();
     }
-    root.add_child("sources", sources_node);
-    root.add_child("systems", systems_node);
-    root.put("captureDir", this->config->capture_dir);
-    root.put("uploadServer", this->config->upload_server);
+    writer.end_array();
+    writer.value("captureDir", this->config->capture_dir);
+    writer.value("uploadServer", this->config->upload_server);
 
-    // root.put("defaultMode", default_mode);
-    root.put("callTimeout", this->config->call_timeout);
-    root.put("logFile", this->config->log_file);
-    root.put("instanceId", this->config->instance_id);
-    root.put("instanceKey", this->config->instance_key);
-    root.put("logFile", this->config->log_file);
-    root.put("type", "config");
+    // writer.value("defaultMode", default_mode);
+    writer.value("callTimeout", this->config->call_timeout);
+    writer.value("logFile", this->config->log_file);
+    writer.value("instanceId", this->config->instance_id);
+    writer.value("instanceKey", this->config->instance_key);
+    writer.value("type", "config");
 
     if (this->config->broadcast_signals == true) {
-      root.put("broadcast_signals", this->config->broadcast_signals);
+      writer.value("broadcast_signals", this->config->broadcast_signals);
     }
+    writer.end_object();
 
-    std::stringstream stats_str;
-    boost::property_tree::write_json(stats_str, root);
-
-    // std::cout << stats_str;
-    send_stat(stats_str.str());
+    send_stat(message);
     m_config_sent = true;
   }
 
   int send_systems(std::vector<System *> systems) {
     if (m_open == false)
       return 0;
-    boost::property_tree::ptree node;
 
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("systems");
     for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); it++) {
-      System *system = *it;
-      node.push_back(std::make_pair("", system->get_stats()));
+      write_system(writer, *it);
     }
-    return send_object(node, "systems", "systems");
+    writer.end_array();
+    return send_message(message, writer, "systems");
   }
 
   int send_system(System *system) {
     if (m_open == false)
       return 0;
 
-    return send_object(system->get_stats(), "system", "system");
-
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.key("system");
+    write_system(writer, system);
+    return send_message(message, writer, "system");
   }
 
-  int calls_active(std::vector<Call *> calls) {
-    if (m_open == false)
-      return 0;
-    boost::property_tree::ptree node;
+  int calls_active(const std::vector<Call *> &calls) {
+    if (!send_diffs) {
+      if (m_open == false)
+        return 0;
+
+      std::string message;
+      Json_Writer writer(message);
+      writer.begin_object();
+      writer.begin_array("calls");
+      for (std::vector<Call *>::const_iterator it = calls.begin(); it != calls.end(); it++) {
+        write_call(writer, *it, true);
+      }
+      writer.end_array();
+      return send_message(message, writer, "calls_active");
+    }
 
-    for (std::vector<Call *>::iterator it = calls.begin(); it != calls.end(); it++) {
-      Call *call = *it;
-      //if (call->get_state() == RECORDING) {
-        node.push_back(std::make_pair("", call->get_stats()));
-      //}
+    // Only calls that are new or have changed go into the next update, and
+    // calls that are no longer active are reported as ended
+    std::set<std::string> active;
+    for (std::vector<Call *>::const_iterator it = calls.begin(); it != calls.end(); it++) {
+      update_call(*it);
+      active.insert(call_id(*it));
     }
+    for (std::map<std::string, cached_call_t>::iterator it = call_cache.begin(); it != call_cache.end();) {
+      if (active.find(it->first) == active.end()) {
+        ended_calls[it->first] = it->second.length;
+        changed_calls.erase(it->first);
+        changed_times.erase(it->first);
+        it = call_cache.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    return 0;
+  }
 
-    return send_object(node, "calls", "calls_active");
+  // A call whose other fields changed is sent whole; one where only elapsed
+  // and length moved just gets those in the update's call_times.
+  void update_call(Call *call) {
+    const std::string id = call_id(call);
+    std::string signature = serialize_call(call, false);
+    const long elapsed = call->elapsed();
+    const double length = call_length(call);
+    cached_call_t &cached = call_cache[id];
+    if (cached.signature != signature) {
+      cached.signature.swap(signature);
+      cached.json = serialize_call(call, true);
+      changed_calls[id] = cached.json;
+      changed_times.erase(id);
+      ended_calls.erase(id);
+    } else if ((cached.elapsed != elapsed) || (cached.length != length)) {
+      cached.json = serialize_call(call, true);
+      if (changed_calls.count(id)) {
+        changed_calls[id] = cached.json;
+      } else {
+        changed_times[id] = call_times_t{elapsed, length};
+      }
+    }
+    cached.elapsed = elapsed;
+    cached.length = length;
   }
 
   int send_recorders(std::vector<Recorder *> recorders) {
 
     if (m_open == false)
       return 0;
-    boost::property_tree::ptree node;
 
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("recorders");
     for (std::vector<Recorder *>::iterator it = recorders.begin(); it != recorders.end(); it++) {
       Recorder *recorder = *it;
-      node.push_back(std::make_pair("", recorder->get_stats()));
+      std::string json = serialize_recorder(recorder);
+      writer.raw(json);
+      recorder_cache[recorder_id(recorder)].swap(json);
     }
+    writer.end_array();
+    return send_message(message, writer, "recorders");
+  }
 
-    return send_object(node, "recorders", "recorders");
+  int send_calls(const std::map<std::string, cached_call_t> &calls) {
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("calls");
+    for (std::map<std::string, cached_call_t>::const_iterator it = calls.begin(); it != calls.end(); it++) {
+      writer.raw(it->second.json);
+    }
+    writer.end_array();
+    return send_message(message, writer, "calls_active");
   }
 
   int call_start(Call *call) {
-    if (m_open == false)
+    if (send_diffs) {
+      update_call(call);
       return 0;
+    }
 
-    return send_object(call->get_stats(), "call", "call_start");
+    if (m_open == false)
+      return 0;
 
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.key("call");
+    write_call(writer, call, true);
+    return send_message(message, writer, "call_start");
   }
 
-  int call_end(Call_Data_t call_info) {
+  int call_end(const Call_Data_t &call_info) {
     if (m_open == false)
       return 0;
     return 0;
@@ -264,29 +570,85 @@ public:
   }
 
   int send_recorder(Recorder *recorder) {
+    if (send_diffs) {
+      const std::string id = recorder_id(recorder);
+      std::string json = serialize_recorder(recorder);
+      std::string &cached = recorder_cache[id];
+      if (cached != json) {
+        cached = json;
+        changed_recorders[id].swap(json);
+      }
+      return 0;
+    }
+
     if (m_open == false)
       return 0;
 
-    return send_object(recorder->get_stats(), "recorder", "recorder");
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.key("recorder");
+    write_recorder(writer, recorder);
+    return send_message(message, writer, "recorder");
   }
 
-  int send_object(boost::property_tree::ptree data, std::string name, std::string type) {
-    if (m_open == false)
+  // Sends everything that changed since the last update as one message
+  int send_update() {
+    if (changed_recorders.empty() && changed_calls.empty() && changed_times.empty() && ended_calls.empty())
       return 0;
-    boost::property_tree::ptree root;
 
-    root.add_child(name, data);
-    root.put("type", type);
-    root.put("instanceId", this->config->instance_id);
-    root.put("instanceKey", this->config->instance_key);
-    std::stringstream stats_str;
-    boost::property_tree::write_json(stats_str, root);
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_array("recorders");
+    for (std::map<std::string, std::string>::iterator it = changed_recorders.begin(); it != changed_recorders.end(); it++) {
+      writer.raw(it->second);
+    }
+    writer.end_array();
+    writer.begin_array("calls");
+    for (std::map<std::string, std::string>::iterator it = changed_calls.begin(); it != changed_calls.end(); it++) {
+      writer.raw(it->second);
+    }
+    writer.end_array();
+    writer.begin_array("call_times");
+    for (std::map<std::string, call_times_t>::iterator it = changed_times.begin(); it != changed_times.end(); it++) {
+      writer.begin_object();
+      writer.value("id", it->first);
+      writer.value("elapsed", it->second.elapsed);
+      writer.value("length", it->second.length);
+      writer.end_object();
+    }
+    writer.end_array();
+    writer.begin_array("ended_calls");
+    for (std::map<std::string, double>::iterator it = ended_calls.begin(); it != ended_calls.end(); it++) {
+      writer.begin_object();
+      writer.value("id", it->first);
+      writer.value("length", it->second);
+      writer.end_object();
+    }
+    writer.end_array();
+    clear_update();
+    return send_message(message, writer, "update");
+  }
 
-    // std::cout << stats_str;
-    return send_stat(stats_str.str());
+  void clear_update() {
+    changed_recorders.clear();
+    changed_calls.clear();
+    changed_times.clear();
+    ended_calls.clear();
   }
 
+  // Finishes a message started with writer.begin_object() and the payload
+  int send_message(std::string &message, Json_Writer &writer, const char *type) {
+    if (m_open == false)
+      return 0;
+    writer.value("type", type);
+    writer.value("instanceId", this->config->instance_id);
+    writer.value("instanceKey", this->config->instance_key);
+    writer.end_object();
 
+    return send_stat(message);
+  }
 
   void reopen_stat() {
     m_client.reset();
@@ -332,6 +694,15 @@ public:
       reopen_stat();
     }
     m_client.poll_one();
+
+    // Bursts of call and recorder changes go out together, at most once per interval
+    if (send_diffs && m_open) {
+      const double current = now();
+      if (current - last_update >= update_interval) {
+        last_update = current;
+        send_update();
+      }
+    }
     return 0;
   }
 
@@ -370,6 +741,13 @@ public:
     }
 
     send_recorders(recorders);
+
+    // The snapshot covers anything that changed while disconnected
+    if (send_diffs) {
+      send_calls(call_cache);
+      clear_update();
+      last_update = now();
+    }
   }
 
   // The close handler will signal that we should stop sending telemetry
@@ -441,27 +819,34 @@ public:
     if (m_open == false || this->config->broadcast_signals == false)
       return 1;
 
-    boost::property_tree::ptree signal;
-    signal.put("unit_id", unitId);
-    //signal.put("signal_system_type", signaling_type);
-    //signal.put("signal_type", sig_type);
+    std::string message;
+    Json_Writer writer(message);
+    writer.begin_object();
+    writer.begin_object("signal");
+    writer.value("unit_id", unitId);
+    //writer.value("signal_system_type", signaling_type);
+    //writer.value("signal_type", sig_type);
 
     if (call != NULL) {
-      signal.add_child("call", call->get_stats());
+      writer.key("call");
+      write_call(writer, call, true);
     }
 
     if (recorder != NULL) {
-      signal.add_child("recorder", recorder->get_stats());
+      writer.key("recorder");
+      write_recorder(writer, recorder);
     }
 
     if (system != NULL) {
-      signal.add_child("system", system->get_stats());
+      writer.key("system");
+      write_system(writer, system);
     }
+    writer.end_object();
 
-    return send_object(signal, "signal", "signaling");
+    return send_message(message, writer, "signaling");
   }
 
-  int init(Config *config, std::vector<Source *> sources, std::vector<System *> systems) {
+  int init(Config *config, const std::vector<Source *> &sources, const std::vector<System *> &systems) {
 
     this->sources = sources;
     this->systems = systems;
@@ -485,14 +870,14 @@ public:
     return 0;
   }
 
-  int setup_systems( std::vector<System *> systems) {
+  int setup_systems(const std::vector<System *> &systems) {
     this->systems = systems;
 
     this->send_systems(systems);
     return 0;
   }
 
-  int setup_config( std::vector<Source *> sources, std::vector<System *> systems) {
+  int setup_config(const std::vector<Source *> &sources, const std::vector<System *> &systems) {
 
     this->sources = sources;
     this->systems = systems;
@@ -509,13 +894,18 @@ public:
         );
     }
 
- int parse_config(json config_data ){ return 0; }
+ int parse_config(json config_data ){
+   send_diffs = config_data.value("sendDiffs", false);
+   update_interval = config_data.value("updateInterval", 1.0);
+   BOOST_LOG_TRIVIAL(info) << "Stat Socket - Send Diffs: " << send_diffs << "\tUpdate Interval: " << update_interval << " sec";
+   return 0;
+ }
    int stop() { return 0; }
-   int setup_sources(std::vector<Source *> sources) { return 0; }
+   int setup_sources(const std::vector<Source *> &sources) { return 0; }
 
 };
 
 BOOST_DLL_ALIAS(
    Stat_Socket::create, // <-- this function is exported with...
-    create_plugin                               // <-- ...this alias name
+    create_plugin_v2                               // <-- ...this alias name
 )
@@ -1,161 +1,170 @@
 #include "../../trunk-recorder/plugin_manager/plugin_api.h"
 #include "../../trunk-recorder/systems/system.h"
+#include "unit_script_worker.h"
 #include <boost/dll/alias.hpp> // for BOOST_DLL_ALIAS
 #include <boost/foreach.hpp>
 
+#include <chrono>
+#include <memory>
 
 struct Unit_Script_System_Script {
   std::string script;
   std::string short_name;
+  Unit_Script_Worker *worker; // NULL when the script is run for each event
 };
 
-class Unit_Script : public Plugin_Api {
-    std::vector<Unit_Script_System_Script> system_scripts;
-std::map<long, long> unit_affiliations;
+class Unit_Script : public Plugin_Api_v2 {
+  std::vector<Unit_Script_System_Script> system_scripts;
+  std::vector<std::unique_ptr<Unit_Script_Worker>> workers;
+  std::map<long, long> unit_affiliations;
+
 public:
-  std::string get_system_script(std::string short_name) {
+  const Unit_Script_System_Script *get_system_script(const std::string &short_name) {
     for (std::vector<Unit_Script_System_Script>::iterator it = system_scripts.begin(); it != system_scripts.end(); ++it) {
-      Unit_Script_System_Script system_script = *it;
-      if (system_script.short_name == short_name){
-        return system_script.script;
+      if (it->short_name == short_name) {
+        return &(*it);
       }
     }
-    return "";
+    return NULL;
   }
 
-int unit_registration(System *sys, long source_id) {
-    unit_affiliations[source_id] = 0;
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
+  // Runs the script for one event, or hands the event to the script's
+  // worker. The talkgroup is only passed when has_talkgroup is set, and the
+  // patches only when with_patches is.
+  int unit_event(System *sys, long source_id, const char *event, bool has_talkgroup, long talkgroup_num, bool with_patches) {
+    const Unit_Script_System_Script *system_script = get_system_script(sys->get_short_name());
+    if (!system_script || (source_id == 0)) {
+      return 1;
+    }
+
+    std::vector<unsigned long> talkgroup_patches;
+    if (with_patches) {
+      talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
+    }
+
+    if (system_script->worker) {
+      json event_json = {
+          {"event", event},
+          {"short_name", sys->get_short_name()},
+          {"unit", source_id},
+          {"time", std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count()}};
+      if (has_talkgroup) {
+        event_json["talkgroup"] = talkgroup_num;
+      }
+      if (with_patches) {
+        event_json["patched_talkgroups"] = talkgroup_patches;
+      }
+      system_script->worker->post(event_json.dump());
+      return 0;
+    }
+
+    std::string patch_string;
+    bool first = true;
+    BOOST_FOREACH (auto &TGID, talkgroup_patches) {
+      if (!first) {
+        patch_string += ",";
+      }
+      first = false;
+      patch_string += std::to_string(TGID);
+    }
+
     char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li on &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
+    if (with_patches) {
+      snprintf(shell_command, 200, "%s %s %li %s %li %s &", system_script->script.c_str(), sys->get_short_name().c_str(), source_id, event, talkgroup_num, patch_string.c_str());
+    } else if (has_talkgroup) {
+      snprintf(shell_command, 200, "%s %s %li %s %li &", system_script->script.c_str(), sys->get_short_name().c_str(), source_id, event, talkgroup_num);
+    } else {
+      snprintf(shell_command, 200, "%s %s %li %s &", system_script->script.c_str(), sys->get_short_name().c_str(), source_id, event);
+    }
+    int rc __attribute__((unused)) = system(shell_command);
     return 0;
   }
-    return 1;
-}
 
-int unit_deregistration(System *sys, long source_id) { 
+  int unit_registration(System *sys, long source_id) {
+    unit_affiliations[source_id] = 0;
+    return unit_event(sys, source_id, "on", false, 0, false);
+  }
+
+  int unit_deregistration(System *sys, long source_id) {
     unit_affiliations[source_id] = -1;
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li off &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+    return unit_event(sys, source_id, "off", false, 0, false);
   }
-    return 1;
-}  
-int unit_acknowledge_response(System *sys, long source_id) { 
-  std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command,200, "%s %s %li ackresp &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+
+  int unit_acknowledge_response(System *sys, long source_id) {
+    return unit_event(sys, source_id, "ackresp", false, 0, false);
   }
-    return 1;
-}
 
-int unit_group_affiliation(System *sys, long source_id, long talkgroup_num) {
+  int unit_group_affiliation(System *sys, long source_id, long talkgroup_num) {
     unit_affiliations[source_id] = talkgroup_num;
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li join %li %s &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+    return unit_event(sys, source_id, "join", true, talkgroup_num, true);
   }
-    return 1;
-}
 
-int unit_data_grant(System *sys, long source_id) {
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li data &", system_script.c_str(), sys->get_short_name().c_str(), source_id);
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+  int unit_data_grant(System *sys, long source_id) {
+    return unit_event(sys, source_id, "data", false, 0, false);
   }
-    return 1;
-}
 
-int unit_answer_request(System *sys, long source_id, long talkgroup) {
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    snprintf(shell_command, 200, "%s %s %li ans_req %li &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup);
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+  int unit_answer_request(System *sys, long source_id, long talkgroup) {
+    return unit_event(sys, source_id, "ans_req", true, talkgroup, false);
   }
-    return 1;
-}
 
-int unit_location(System *sys, long source_id, long talkgroup_num) {
+  int unit_location(System *sys, long source_id, long talkgroup_num) {
     unit_affiliations[source_id] = talkgroup_num;
-    std::string system_script = get_system_script(sys->get_short_name());
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = sys->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li location %li %s &", system_script.c_str(), sys->get_short_name().c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+    return unit_event(sys, source_id, "location", true, talkgroup_num, true);
   }
-    return 1;
-}
-
-int call_start(Call *call) {
-    long talkgroup_num = call->get_talkgroup();
-    long source_id = call->get_current_source_id();
-    std::string short_name = call->get_short_name();
-    std::string system_script = get_system_script(short_name);
-  if ((system_script != "") && (source_id != 0)) {
-    char shell_command[200];
-    std::vector<unsigned long> talkgroup_patches = call->get_system()->get_talkgroup_patch(talkgroup_num);
-    std::string patch_string;
-    bool first = true;
-    BOOST_FOREACH (auto& TGID, talkgroup_patches) {
-      if (!first) { patch_string += ","; }
-      first = false;
-      patch_string += std::to_string(TGID);
-    }
-    snprintf(shell_command, 200, "%s %s %li call %li %s &", system_script.c_str(), short_name.c_str(), source_id, talkgroup_num, patch_string.c_str());
-    int rc __attribute__((unused)) =  system(shell_command);
-    return 0;
+
+  int call_start(Call *call) {
+    return unit_event(call->get_system(), call->get_current_source_id(), "call", true, call->get_talkgroup(), true);
   }
-    return 1;
-}
 
   int parse_config(json config_data) {
-
     for (json element : config_data["systems"]) {
       Unit_Script_System_Script system_script;
       system_script.script = element.value("unitScript", "");
       system_script.short_name = element.value("shortName", "");
-      if (system_script.script != "") {
-        BOOST_LOG_TRIVIAL(info) << "\t- [" << system_script.short_name << "]: " << system_script.script ;
-        this->system_scripts.push_back(system_script);
+      system_script.worker = NULL;
+      if (system_script.script == "") {
+        continue;
+      }
+
+      const std::string mode = element.value("unitScriptMode", "exec");
+      if (mode == "persistent") {
+        // Systems that share a script share its process
+        for (std::vector<std::unique_ptr<Unit_Script_Worker>>::iterator it = workers.begin(); it != workers.end(); ++it) {
+          if ((*it)->get_script() == system_script.script) {
+            system_script.worker = it->get();
+          }
+        }
+        if (!system_script.worker) {
+          workers.push_back(std::unique_ptr<Unit_Script_Worker>(new Unit_Script_Worker(system_script.script, element.value("unitScriptQueueSize", 4096))));
+          system_script.worker = workers.back().get();
+        }
+      } else if (mode != "exec") {
+        BOOST_LOG_TRIVIAL(error) << "\t- [" << system_script.short_name << "]: unknown unitScriptMode " << mode << ", running the script for each event";
       }
+
+      BOOST_LOG_TRIVIAL(info) << "\t- [" << system_script.short_name << "]: " << system_script.script << (system_script.worker ? " (persistent)" : "");
+      this->system_scripts.push_back(system_script);
     }
 
     return 0;
   }
 
+  int start() {
+    for (std::vector<std::unique_ptr<Unit_Script_Worker>>::iterator it = workers.begin(); it != workers.end(); ++it) {
+      (*it)->start();
+    }
+    return 0;
+  }
+
+  int stop() {
+    for (std::vector<std::unique_ptr<Unit_Script_Worker>>::iterator it = workers.begin(); it != workers.end(); ++it) {
+      Unit_Script_Worker *worker = it->get();
+      worker->stop();
+      BOOST_LOG_TRIVIAL(info) << "unit_script: " << worker->get_script() << " - Delivered: " << worker->get_delivered() << "\tDropped: " << worker->get_dropped() << "\tRestarts: " << worker->get_restarts();
+    }
+    return 0;
+  }
+
   static boost::shared_ptr<Unit_Script> create() {
     return boost::shared_ptr<Unit_Script>(
         new Unit_Script());
@@ -164,5 +173,5 @@ int call_start(Call *call) {
 
 BOOST_DLL_ALIAS(
     Unit_Script::create, // <-- this function is exported with...
-    create_plugin             // <-- ...this alias name
+    create_plugin_v2     // <-- ...this alias name
 )
@@ -0,0 +1,249 @@
+#include "unit_script_worker.h"
+
+#include <boost/log/trivial.hpp>
+#include <chrono>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+// How long the writer waits for more events once one has arrived, so a burst
+// of affiliations goes out in a single write
+#define BATCH_LINGER_MS 50
+#define BATCH_EVENTS 256
+
+// Seconds between starts of a script that keeps exiting
+#define RESTART_DELAY 5
+
+// How long a script gets to finish reading and exit when trunk-recorder stops
+#define STOP_TIMEOUT_MS 2000
+
+Unit_Script_Worker::Unit_Script_Worker(const std::string &script, size_t max_queue)
+    : d_script(script), d_max_queue(max_queue), d_stopping(false), d_pid(-1), d_fd(-1), d_last_spawn(0), d_delivered(0), d_dropped(0), d_restarts(0) {}
+
+Unit_Script_Worker::~Unit_Script_Worker() {
+  stop();
+}
+
+void Unit_Script_Worker::start() {
+  d_thread = std::thread(&Unit_Script_Worker::run, this);
+}
+
+void Unit_Script_Worker::stop() {
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    d_stopping = true;
+  }
+  d_cv.notify_one();
+  if (d_thread.joinable()) {
+    d_thread.join();
+  }
+}
+
+void Unit_Script_Worker::post(std::string line) {
+  size_t queued;
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (d_stopping || (d_queue.size() >= d_max_queue)) {
+      d_dropped++;
+      return;
+    }
+    d_queue.push_back(std::move(line));
+    queued = d_queue.size();
+  }
+  if ((queued == 1) || (queued == BATCH_EVENTS)) {
+    d_cv.notify_one();
+  }
+}
+
+void Unit_Script_Worker::run() {
+  std::vector<std::string> batch;
+  std::unique_lock<std::mutex> lock(d_mutex);
+
+  while (true) {
+    // Wakes up once a second when idle, so a script that exits is reaped
+    d_cv.wait_for(lock, std::chrono::seconds(1), [this] { return d_stopping || !d_queue.empty(); });
+    if (!d_stopping && !d_queue.empty()) {
+      d_cv.wait_for(lock, std::chrono::milliseconds(BATCH_LINGER_MS), [this] { return d_stopping || (d_queue.size() >= BATCH_EVENTS); });
+    }
+    batch.swap(d_queue);
+    const bool stopping = d_stopping;
+    lock.unlock();
+
+    check_child();
+    if (!batch.empty()) {
+      if ((d_pid < 0) && !spawn()) {
+        d_dropped += batch.size();
+      } else {
+        d_buffer.clear();
+        for (std::vector<std::string>::iterator it = batch.begin(); it != batch.end(); ++it) {
+          d_buffer += *it;
+          d_buffer += '\n';
+        }
+        if (write_all(d_buffer.data(), d_buffer.size())) {
+          d_delivered += batch.size();
+        } else {
+          d_dropped += batch.size();
+          close_child(false);
+        }
+      }
+      batch.clear();
+    }
+
+    if (stopping) {
+      break;
+    }
+    lock.lock();
+  }
+
+  close_child(true);
+}
+
+bool Unit_Script_Worker::spawn() {
+  const time_t now = time(NULL);
+  if ((d_last_spawn != 0) && (now - d_last_spawn < RESTART_DELAY)) {
+    return false;
+  }
+  const bool restart = (d_last_spawn != 0);
+  d_last_spawn = now;
+
+  // The socket is used like a pipe, but send() can be told not to raise
+  // SIGPIPE when the script has gone away
+  int fds[2];
+  if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0) {
+    BOOST_LOG_TRIVIAL(error) << "unit_script: unable to create a socket for " << d_script << ": " << strerror(errno);
+    return false;
+  }
+
+  // Run through the shell, like the per event mode, so the script can be
+  // given arguments. Built before the fork, the child must not allocate.
+  const std::string command = "exec " + d_script;
+
+  const pid_t pid = fork();
+  if (pid < 0) {
+    BOOST_LOG_TRIVIAL(error) << "unit_script: unable to fork for " << d_script << ": " << strerror(errno);
+    close(fds[0]);
+    close(fds[1]);
+    return false;
+  }
+  if (pid == 0) {
+    if (dup2(fds[1], STDIN_FILENO) < 0) {
+      _exit(127);
+    }
+    execl("/bin/sh", "sh", "-c", command.c_str(), (char *)NULL);
+    _exit(127);
+  }
+
+  close(fds[1]);
+  shutdown(fds[0], SHUT_RD);
+  fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+  d_fd = fds[0];
+  d_pid = pid;
+
+  if (restart) {
+    d_restarts++;
+    BOOST_LOG_TRIVIAL(info) << "unit_script: restarted " << d_script << ", pid " << pid;
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "unit_script: started " << d_script << ", pid " << pid;
+  }
+  return true;
+}
+
+// Reaps the script if it has exited. Returns whether it is still running.
+bool Unit_Script_Worker::check_child() {
+  if (d_pid < 0) {
+    return false;
+  }
+
+  int status = 0;
+  if (waitpid(d_pid, &status, WNOHANG) != d_pid) {
+    return true;
+  }
+  if (WIFSIGNALED(status)) {
+    BOOST_LOG_TRIVIAL(error) << "unit_script: " << d_script << " was terminated by signal " << WTERMSIG(status);
+  } else {
+    BOOST_LOG_TRIVIAL(error) << "unit_script: " << d_script << " exited with status " << WEXITSTATUS(status);
+  }
+  d_pid = -1;
+  close(d_fd);
+  d_fd = -1;
+  return false;
+}
+
+bool Unit_Script_Worker::write_all(const char *data, size_t length) {
+  int waited_ms = 0;
+  while (length > 0) {
+    const ssize_t sent = send(d_fd, data, length, MSG_NOSIGNAL);
+    if (sent > 0) {
+      data += sent;
+      length -= sent;
+      waited_ms = 0;
+      continue;
+    }
+    if ((sent < 0) && (errno == EINTR)) {
+      continue;
+    }
+    if ((sent < 0) && (errno != EAGAIN) && (errno != EWOULDBLOCK)) {
+      BOOST_LOG_TRIVIAL(error) << "unit_script: unable to write to " << d_script << ": " << strerror(errno);
+      return false;
+    }
+
+    // The script is behind. Waiting here is what makes the queue fill up and
+    // drop events, rather than trunk-recorder slowing down.
+    struct pollfd pfd;
+    pfd.fd = d_fd;
+    pfd.events = POLLOUT;
+    pfd.revents = 0;
+    poll(&pfd, 1, 100);
+    waited_ms += 100;
+
+    if (waited_ms >= STOP_TIMEOUT_MS) {
+      std::lock_guard<std::mutex> lock(d_mutex);
+      if (d_stopping) {
+        BOOST_LOG_TRIVIAL(error) << "unit_script: " << d_script << " is not reading its events";
+        return false;
+      }
+    }
+    if (!check_child()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Unit_Script_Worker::close_child(bool wait) {
+  if (d_fd >= 0) {
+    // The script sees the end of its input
+    close(d_fd);
+    d_fd = -1;
+  }
+  if (d_pid < 0) {
+    return;
+  }
+
+  int status;
+  for (int waited_ms = 0; wait && (waited_ms < STOP_TIMEOUT_MS); waited_ms += 100) {
+    if (waitpid(d_pid, &status, WNOHANG) == d_pid) {
+      d_pid = -1;
+      return;
+    }
+    usleep(100 * 1000);
+  }
+
+  kill(d_pid, SIGTERM);
+  for (int waited_ms = 0; waited_ms < 1000; waited_ms += 100) {
+    if (waitpid(d_pid, &status, WNOHANG) == d_pid) {
+      d_pid = -1;
+      return;
+    }
+    usleep(100 * 1000);
+  }
+  kill(d_pid, SIGKILL);
+  waitpid(d_pid, &status, 0);
+  d_pid = -1;
+}
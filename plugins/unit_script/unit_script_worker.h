@@ -0,0 +1,65 @@
+#ifndef UNIT_SCRIPT_WORKER_H
+#define UNIT_SCRIPT_WORKER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <sys/types.h>
+#include <thread>
+#include <vector>
+
+/*
+ * Runs a unit script once, as a long lived co-process, and writes events to
+ * its stdin as newline delimited JSON.
+ *
+ * post() only appends to a bounded queue, so the main loop never waits on
+ * the script. A writer thread sends everything that has queued up in one
+ * write. When the queue is full, or the script is not running, events are
+ * dropped and counted. A script that exits is started again, at most once
+ * every RESTART_DELAY seconds.
+ */
+class Unit_Script_Worker {
+public:
+  Unit_Script_Worker(const std::string &script, size_t max_queue);
+  ~Unit_Script_Worker();
+
+  void start();
+  void stop();
+
+  // line is one JSON object, without the newline
+  void post(std::string line);
+
+  const std::string &get_script() const { return d_script; }
+  unsigned long get_delivered() const { return d_delivered.load(); }
+  unsigned long get_dropped() const { return d_dropped.load(); }
+  unsigned long get_restarts() const { return d_restarts.load(); }
+
+private:
+  const std::string d_script;
+  const size_t d_max_queue;
+
+  std::mutex d_mutex;
+  std::condition_variable d_cv;
+  std::vector<std::string> d_queue;
+  bool d_stopping;
+  std::thread d_thread;
+
+  // Only used by the writer thread
+  pid_t d_pid;
+  int d_fd;
+  time_t d_last_spawn;
+  std::string d_buffer;
+
+  std::atomic<unsigned long> d_delivered;
+  std::atomic<unsigned long> d_dropped;
+  std::atomic<unsigned long> d_restarts;
+
+  void run();
+  bool spawn();
+  bool check_child();
+  bool write_all(const char *data, size_t length);
+  void close_child(bool wait);
+};
+
+#endif
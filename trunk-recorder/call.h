@@ -93,6 +93,10 @@ public:
   virtual bool get_conversation_mode() = 0;
   virtual System *get_system() = 0;
   virtual std::vector<Transmission> get_transmissions() = 0;
+
+  // Plugins built against older headers call through this vtable, so new
+  // methods go after the ones above.
+  virtual std::int64_t get_stop_time_ms() = 0;
 };
 
 #endif
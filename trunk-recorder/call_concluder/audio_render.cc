@@ -0,0 +1,500 @@
+#include "audio_render.h"
+
+#include <boost/log/trivial.hpp>
+
+#ifdef HAVE_LIBAV
+
+#include "../gr_blocks/wavfile_gr3.8.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/opt.h>
+}
+
+// Samples pushed into the filter graph per frame
+static const int RENDER_FRAME_SAMPLES = 1024;
+
+// ---------------------------------------------------------------------------
+// Logging
+// ---------------------------------------------------------------------------
+
+// When set, info level messages logged by libav on this thread are appended
+// here instead of being printed. Used to pick up the loudnorm JSON summary.
+static thread_local std::string *tl_log_capture = nullptr;
+
+static void libav_log_callback(void *avcl, int level, const char *fmt, va_list vl) {
+  if (tl_log_capture && level <= AV_LOG_INFO) {
+    char line[4096];
+    int print_prefix = 0;
+    av_log_format_line(avcl, level, fmt, vl, line, sizeof(line), &print_prefix);
+    tl_log_capture->append(line);
+    return;
+  }
+
+  // Match the "-loglevel error" the ffmpeg CLI path runs with
+  if (level <= AV_LOG_ERROR) {
+    av_log_default_callback(avcl, level, fmt, vl);
+  }
+}
+
+static void install_log_callback() {
+  static std::once_flag once;
+  std::call_once(once, []() { av_log_set_callback(libav_log_callback); });
+}
+
+static std::string av_error_string(int err) {
+  char buf[AV_ERROR_MAX_STRING_SIZE] = {0};
+  av_strerror(err, buf, sizeof(buf));
+  return buf;
+}
+
+// ---------------------------------------------------------------------------
+// Filter graph
+// ---------------------------------------------------------------------------
+
+struct Render_Output {
+  std::string label;
+  std::string format; // aformat arguments applied before the sink
+  AVFilterContext *sink = nullptr;
+
+  // Encoder side, unused when only analysing
+  AVFormatContext *fmt = nullptr;
+  AVCodecContext *enc = nullptr;
+  AVStream *st = nullptr;
+  std::int64_t next_pts = 0;
+};
+
+struct Render_Graph {
+  AVFilterGraph *graph = nullptr;
+  AVFilterContext *src = nullptr;
+  std::vector<Render_Output> outputs;
+
+  ~Render_Graph() {
+    for (auto &out : outputs) {
+      avcodec_free_context(&out.enc);
+      if (out.fmt) {
+        if (out.fmt->pb) {
+          avio_closep(&out.fmt->pb);
+        }
+        avformat_free_context(out.fmt);
+      }
+    }
+    avfilter_graph_free(&graph);
+  }
+};
+
+static int build_graph(Render_Graph &rg, unsigned int sample_rate, int nchans, const std::string &filter) {
+  rg.graph = avfilter_graph_alloc();
+  if (!rg.graph) {
+    return AVERROR(ENOMEM);
+  }
+
+  char args[256];
+  snprintf(args, sizeof(args), "time_base=1/%u:sample_rate=%u:sample_fmt=s16:channel_layout=%s",
+           sample_rate, sample_rate, nchans == 1 ? "mono" : "stereo");
+  int ret = avfilter_graph_create_filter(&rg.src, avfilter_get_by_name("abuffer"), "in", args, nullptr, rg.graph);
+  if (ret < 0) {
+    return ret;
+  }
+
+  const std::string chain = filter.empty() ? "anull" : filter;
+  std::string desc;
+  if (rg.outputs.size() == 1) {
+    desc = "[in]" + chain + ",aformat=" + rg.outputs[0].format + "[" + rg.outputs[0].label + "]";
+  } else {
+    desc = "[in]" + chain + ",asplit=" + std::to_string(rg.outputs.size());
+    for (size_t i = 0; i < rg.outputs.size(); i++) {
+      desc += "[s" + std::to_string(i) + "]";
+    }
+    for (size_t i = 0; i < rg.outputs.size(); i++) {
+      desc += ";[s" + std::to_string(i) + "]aformat=" + rg.outputs[i].format + "[" + rg.outputs[i].label + "]";
+    }
+  }
+
+  AVFilterInOut *graph_outputs = avfilter_inout_alloc();
+  AVFilterInOut *graph_inputs = nullptr;
+  if (!graph_outputs) {
+    return AVERROR(ENOMEM);
+  }
+  graph_outputs->name = av_strdup("in");
+  graph_outputs->filter_ctx = rg.src;
+  graph_outputs->pad_idx = 0;
+  graph_outputs->next = nullptr;
+
+  for (auto it = rg.outputs.rbegin(); it != rg.outputs.rend(); ++it) {
+    ret = avfilter_graph_create_filter(&it->sink, avfilter_get_by_name("abuffersink"), it->label.c_str(), nullptr, nullptr, rg.graph);
+    if (ret < 0) {
+      avfilter_inout_free(&graph_outputs);
+      avfilter_inout_free(&graph_inputs);
+      return ret;
+    }
+    AVFilterInOut *inout = avfilter_inout_alloc();
+    if (!inout) {
+      avfilter_inout_free(&graph_outputs);
+      avfilter_inout_free(&graph_inputs);
+      return AVERROR(ENOMEM);
+    }
+    inout->name = av_strdup(it->label.c_str());
+    inout->filter_ctx = it->sink;
+    inout->pad_idx = 0;
+    inout->next = graph_inputs;
+    graph_inputs = inout;
+  }
+
+  ret = avfilter_graph_parse_ptr(rg.graph, desc.c_str(), &graph_inputs, &graph_outputs, nullptr);
+  avfilter_inout_free(&graph_inputs);
+  avfilter_inout_free(&graph_outputs);
+  if (ret < 0) {
+    return ret;
+  }
+
+  return avfilter_graph_config(rg.graph, nullptr);
+}
+
+// ---------------------------------------------------------------------------
+// Encoding
+// ---------------------------------------------------------------------------
+
+static int open_output(Render_Output &out, const Audio_Render_Job &job, const std::string &filename, bool compressed) {
+  int ret = avformat_alloc_output_context2(&out.fmt, nullptr, nullptr, filename.c_str());
+  if (ret < 0) {
+    return ret;
+  }
+
+  const AVCodec *codec = avcodec_find_encoder(compressed ? AV_CODEC_ID_AAC : AV_CODEC_ID_PCM_S16LE);
+  if (!codec) {
+    return AVERROR_ENCODER_NOT_FOUND;
+  }
+  out.enc = avcodec_alloc_context3(codec);
+  if (!out.enc) {
+    return AVERROR(ENOMEM);
+  }
+
+  out.enc->sample_fmt = (AVSampleFormat)av_buffersink_get_format(out.sink);
+  out.enc->sample_rate = av_buffersink_get_sample_rate(out.sink);
+  ret = av_buffersink_get_ch_layout(out.sink, &out.enc->ch_layout);
+  if (ret < 0) {
+    return ret;
+  }
+  out.enc->time_base = AVRational{1, out.enc->sample_rate};
+  if (compressed) {
+    out.enc->bit_rate = 32000;
+  }
+  if (out.fmt->oformat->flags & AVFMT_GLOBALHEADER) {
+    out.enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+  }
+
+  ret = avcodec_open2(out.enc, codec, nullptr);
+  if (ret < 0) {
+    return ret;
+  }
+
+  out.st = avformat_new_stream(out.fmt, nullptr);
+  if (!out.st) {
+    return AVERROR(ENOMEM);
+  }
+  ret = avcodec_parameters_from_context(out.st->codecpar, out.enc);
+  if (ret < 0) {
+    return ret;
+  }
+  out.st->time_base = out.enc->time_base;
+
+  av_dict_set(&out.fmt->metadata, "date", job.date.c_str(), 0);
+  av_dict_set(&out.fmt->metadata, "artist", job.artist.c_str(), 0);
+  av_dict_set(&out.fmt->metadata, "title", job.title.c_str(), 0);
+
+  ret = avio_open(&out.fmt->pb, filename.c_str(), AVIO_FLAG_WRITE);
+  if (ret < 0) {
+    return ret;
+  }
+
+  AVDictionary *opts = nullptr;
+  if (compressed) {
+    av_dict_set(&opts, "movflags", "+faststart", 0);
+  }
+  ret = avformat_write_header(out.fmt, &opts);
+  av_dict_free(&opts);
+  if (ret < 0) {
+    return ret;
+  }
+
+  // The AAC encoder only accepts full frames
+  if (out.enc->frame_size > 0 && !(codec->capabilities & AV_CODEC_CAP_VARIABLE_FRAME_SIZE)) {
+    av_buffersink_set_frame_size(out.sink, out.enc->frame_size);
+  }
+
+  return 0;
+}
+
+// Send a frame (or nullptr to flush) to the encoder and write out every
+// packet it produces.
+static int encode_write(Render_Output &out, AVFrame *frame, AVPacket *pkt) {
+  int ret = avcodec_send_frame(out.enc, frame);
+  if (ret < 0) {
+    return ret;
+  }
+
+  while ((ret = avcodec_receive_packet(out.enc, pkt)) >= 0) {
+    av_packet_rescale_ts(pkt, out.enc->time_base, out.st->time_base);
+    pkt->stream_index = out.st->index;
+    ret = av_interleaved_write_frame(out.fmt, pkt);
+    if (ret < 0) {
+      return ret;
+    }
+  }
+
+  return (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) ? 0 : ret;
+}
+
+// Pull everything currently available from the sinks. Outputs without an
+// encoder are drained and discarded.
+static int drain_outputs(Render_Graph &rg, AVFrame *frame, AVPacket *pkt) {
+  for (auto &out : rg.outputs) {
+    while (true) {
+      int ret = av_buffersink_get_frame(out.sink, frame);
+      if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) {
+        break;
+      }
+      if (ret < 0) {
+        return ret;
+      }
+
+      if (out.enc) {
+        frame->pts = out.next_pts;
+        out.next_pts += frame->nb_samples;
+        ret = encode_write(out, frame, pkt);
+      }
+      av_frame_unref(frame);
+      if (ret < 0) {
+        return ret;
+      }
+    }
+  }
+  return 0;
+}
+
+// ---------------------------------------------------------------------------
+// Input
+// ---------------------------------------------------------------------------
+
+static bool read_input_header(const std::string &filename, FILE *&fp, unsigned int &sample_rate, int &nchans, unsigned int &samples_per_chan) {
+  int bytes_per_sample = 0;
+  int first_sample_pos = 0;
+
+  fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    return false;
+  }
+  if (!gr::blocks::wavheader_parse(fp, sample_rate, nchans, bytes_per_sample, first_sample_pos, samples_per_chan) || bytes_per_sample != 2) {
+    fclose(fp);
+    fp = nullptr;
+    return false;
+  }
+  return true;
+}
+
+// Stream every input file through the graph, then flush it.
+static int run_graph(Render_Graph &rg, const std::vector<std::string> &input_files, unsigned int sample_rate, int nchans, const std::string &loghdr) {
+  AVFrame *in_frame = av_frame_alloc();
+  AVFrame *out_frame = av_frame_alloc();
+  AVPacket *pkt = av_packet_alloc();
+  std::int64_t pts = 0;
+  int ret = (in_frame && out_frame && pkt) ? 0 : AVERROR(ENOMEM);
+
+  for (const auto &filename : input_files) {
+    if (ret < 0) {
+      break;
+    }
+
+    FILE *fp = nullptr;
+    unsigned int file_rate = 0;
+    unsigned int samples_per_chan = 0;
+    int file_nchans = 0;
+    if (!read_input_header(filename, fp, file_rate, file_nchans, samples_per_chan)) {
+      BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to read transmission: " << filename << "\033[0m";
+      ret = AVERROR_INVALIDDATA;
+      break;
+    }
+    if (file_rate != sample_rate || file_nchans != nchans) {
+      BOOST_LOG_TRIVIAL(warning) << loghdr << "\033[0;33mTransmission format differs from the rest of the call: " << filename << "\033[0m";
+      fclose(fp);
+      ret = AVERROR_INVALIDDATA;
+      break;
+    }
+
+    unsigned int remaining = samples_per_chan;
+    while (remaining > 0 && ret >= 0) {
+      const int n = (int)std::min<unsigned int>(remaining, RENDER_FRAME_SAMPLES);
+
+      in_frame->format = AV_SAMPLE_FMT_S16;
+      in_frame->sample_rate = sample_rate;
+      in_frame->nb_samples = n;
+      av_channel_layout_default(&in_frame->ch_layout, nchans);
+      ret = av_frame_get_buffer(in_frame, 0);
+      if (ret < 0) {
+        break;
+      }
+
+      const size_t got = fread(in_frame->data[0], sizeof(int16_t) * nchans, n, fp);
+      if (got == 0) {
+        av_frame_unref(in_frame);
+        break;
+      }
+      in_frame->nb_samples = (int)got;
+      in_frame->pts = pts;
+      pts += got;
+      remaining -= got;
+
+      ret = av_buffersrc_add_frame(rg.src, in_frame); // takes the frame's references
+      if (ret >= 0) {
+        ret = drain_outputs(rg, out_frame, pkt);
+      }
+    }
+    fclose(fp);
+  }
+
+  if (ret >= 0) {
+    ret = av_buffersrc_add_frame(rg.src, nullptr);
+  }
+  if (ret >= 0) {
+    ret = drain_outputs(rg, out_frame, pkt);
+  }
+  for (auto &out : rg.outputs) {
+    if (ret >= 0 && out.enc) {
+      ret = encode_write(out, nullptr, pkt);
+    }
+    if (ret >= 0 && out.fmt) {
+      ret = av_write_trailer(out.fmt);
+    }
+  }
+
+  av_packet_free(&pkt);
+  av_frame_free(&out_frame);
+  av_frame_free(&in_frame);
+  return ret;
+}
+
+static bool probe_inputs(const std::vector<std::string> &input_files, unsigned int &sample_rate, int &nchans) {
+  if (input_files.empty()) {
+    return false;
+  }
+  FILE *fp = nullptr;
+  unsigned int samples_per_chan = 0;
+  if (!read_input_header(input_files.front(), fp, sample_rate, nchans, samples_per_chan)) {
+    return false;
+  }
+  fclose(fp);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Public interface
+// ---------------------------------------------------------------------------
+
+bool audio_render_available() {
+  return true;
+}
+
+int audio_render_call(const Audio_Render_Job &job, const std::string &loghdr) {
+  install_log_callback();
+
+  unsigned int sample_rate = 0;
+  int nchans = 0;
+  if (!probe_inputs(job.input_files, sample_rate, nchans)) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to read transmission header for in-process render\033[0m";
+    return -1;
+  }
+
+  const bool compressed = !job.m4a_filename.empty();
+  Render_Graph rg;
+  rg.outputs.push_back({"wav", "sample_fmts=s16"});
+  if (compressed) {
+    rg.outputs.push_back({"aac", "sample_fmts=fltp:sample_rates=8000:channel_layouts=mono"});
+  }
+
+  int ret = build_graph(rg, sample_rate, nchans, job.filter);
+  if (ret < 0) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to build audio filter graph: " << av_error_string(ret) << "\033[0m";
+    return -1;
+  }
+
+  ret = open_output(rg.outputs[0], job, job.wav_filename, false);
+  if (ret >= 0 && compressed) {
+    ret = open_output(rg.outputs[1], job, job.m4a_filename, true);
+  }
+  if (ret < 0) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to open audio encoder: " << av_error_string(ret) << "\033[0m";
+    return -1;
+  }
+
+  ret = run_graph(rg, job.input_files, sample_rate, nchans, loghdr);
+  if (ret < 0) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mIn-process audio render failed: " << av_error_string(ret) << "\033[0m";
+    return -1;
+  }
+  return 0;
+}
+
+int audio_render_analyze(const std::vector<std::string> &input_files,
+                         const std::string &filter,
+                         std::string &log_output,
+                         const std::string &loghdr) {
+  install_log_callback();
+  log_output.clear();
+
+  unsigned int sample_rate = 0;
+  int nchans = 0;
+  if (!probe_inputs(input_files, sample_rate, nchans)) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to read transmission header for in-process analysis\033[0m";
+    return -1;
+  }
+
+  int ret;
+  tl_log_capture = &log_output;
+  {
+    Render_Graph rg;
+    rg.outputs.push_back({"out", "sample_fmts=s16"});
+    ret = build_graph(rg, sample_rate, nchans, filter);
+    if (ret >= 0) {
+      ret = run_graph(rg, input_files, sample_rate, nchans, loghdr);
+    }
+    // loudnorm prints its summary when the graph is torn down
+  }
+  tl_log_capture = nullptr;
+
+  if (ret < 0) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mIn-process audio analysis failed: " << av_error_string(ret) << "\033[0m";
+    return -1;
+  }
+  return 0;
+}
+
+#else // HAVE_LIBAV
+
+bool audio_render_available() {
+  return false;
+}
+
+int audio_render_call(const Audio_Render_Job &job, const std::string &loghdr) {
+  return -1;
+}
+
+int audio_render_analyze(const std::vector<std::string> &input_files,
+                         const std::string &filter,
+                         std::string &log_output,
+                         const std::string &loghdr) {
+  return -1;
+}
+
+#endif // HAVE_LIBAV
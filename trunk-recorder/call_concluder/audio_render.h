@@ -0,0 +1,39 @@
+#ifndef AUDIO_RENDER_H
+#define AUDIO_RENDER_H
+
+#include <string>
+#include <vector>
+
+// In-process call audio rendering built on libavfilter / libavcodec.
+//
+// The transmission WAV files written by transmission_sink are read directly,
+// pushed through the same filter chain the ffmpeg CLI path uses and encoded
+// to the final WAV and (optionally) M4A files. This avoids a fork/exec and a
+// concat demux for every concluded call. When trunk-recorder is built
+// without libav, audio_render_available() returns false and every call falls
+// back to the ffmpeg CLI.
+
+struct Audio_Render_Job {
+  std::vector<std::string> input_files;
+  std::string filter;        // ffmpeg filter chain, may be empty
+  std::string wav_filename;  // always written
+  std::string m4a_filename;  // written when non-empty
+  std::string date;
+  std::string artist;
+  std::string title;
+};
+
+bool audio_render_available();
+
+// Render the call audio artifacts. Returns 0 on success.
+int audio_render_call(const Audio_Render_Job &job, const std::string &loghdr);
+
+// Run the filter chain over the inputs, discarding the audio, and collect
+// whatever the filters log at info level (e.g. loudnorm print_format=json).
+// Returns 0 on success.
+int audio_render_analyze(const std::vector<std::string> &input_files,
+                         const std::string &filter,
+                         std::string &log_output,
+                         const std::string &loghdr);
+
+#endif
@@ -1,4 +1,10 @@
 #include "call_concluder.h"
+#include "audio_render.h"
+#include "call_data_store.h"
+#include "deferred_vocoder.h"
+#include "../gr_blocks/codec_file.h"
+#include "../gr_blocks/loudness_meter.h"
+#include "../metrics.h"
 #include "../plugin_manager/plugin_manager.h"
 
 #include <boost/filesystem.hpp>
@@ -9,7 +15,9 @@
 #include <cstdio>
 #include <cstring>
 #include <fstream>
+#include <functional>
 #include <iomanip>
+#include <limits>
 #include <random>
 #include <sstream>
 #include <string>
@@ -28,8 +36,33 @@ namespace fs = std::filesystem;
 // Call_Concluder static storage
 // ---------------------------------------------------------------------------
 const int Call_Concluder::MAX_RETRY = 2;
-std::list<std::future<Call_Data_t>> Call_Concluder::call_data_workers = {};
-std::list<Call_Data_t> Call_Concluder::retry_call_list = {};
+
+std::mutex                       Call_Concluder::queue_mutex;
+std::condition_variable          Call_Concluder::queue_cv;
+std::map<Call_Concluder::Queue_Key, Call_Concluder::Queued_Call> Call_Concluder::call_queue = {};
+std::list<Call_Data_Ext_t>       Call_Concluder::finished_calls = {};
+std::vector<std::thread>         Call_Concluder::workers = {};
+unsigned long                    Call_Concluder::queue_seq = 0;
+size_t                           Call_Concluder::running_count = 0;
+bool                             Call_Concluder::stopping = false;
+std::atomic<bool>                Call_Concluder::abandon(false);
+unsigned long                    Call_Concluder::completed_count = 0;
+unsigned long                    Call_Concluder::dropped_count = 0;
+unsigned long                    Call_Concluder::spilled_count = 0;
+double                           Call_Concluder::total_wait = 0.0;
+double                           Call_Concluder::max_wait = 0.0;
+
+std::priority_queue<Call_Data_Ext_t, std::vector<Call_Data_Ext_t>, Call_Concluder::Retry_Later> Call_Concluder::retry_queue;
+size_t                  Call_Concluder::max_queue_size = 1;
+Call_Concluder_Overflow Call_Concluder::overflow_policy = DROP_OLDEST;
+std::string             Call_Concluder::spill_dir = "";
+size_t                  Call_Concluder::spilled_on_disk = 0;
+
+// Shared with upload_call_worker(), which records when a call is rendered
+static Call_Journal call_journal;
+
+// Seconds a call waits in the queue before a worker picks it up
+static Metric_Histogram *queue_wait_metric = NULL;
 
 // ---------------------------------------------------------------------------
 // String utilities
@@ -273,7 +306,7 @@ static std::string format_time_custom(const std::string &fmt, const struct tm *t
 // localtime / gmtime, which return a pointer to a shared static buffer and
 // are not thread-safe. upload_call_worker runs concurrently.
 static std::string expand_filename_format(const std::string &format,
-                                          const Call_Data_t &call_info,
+                                          const Call_Data_Ext_t &call_info,
                                           time_t start_time) {
   std::string result;
   result.reserve(format.size() * 2);
@@ -415,6 +448,49 @@ struct LoudnormMeasured {
   bool valid = false;
 };
 
+// Use the loudness transmission_sink measured while recording in place of
+// loudnorm's first pass. The measurement is of the unfiltered audio, so it
+// is not used when any cleanup filter runs ahead of loudnorm.
+//
+// Only the case where loudnorm will run in linear mode is handled here: it
+// then applies target_i - measured_I as a flat gain, the output lands on the
+// target and the first-pass target_offset is 0. When the peak or range rule
+// linear mode out, loudnorm goes dynamic and needs the target_offset only
+// its own first pass reports, so the analysis pass is run instead.
+static bool loudnorm_from_recording(const Call_Data_Ext_t &call_info, LoudnormMeasured &measured) {
+  const Audio_Postprocess_Config &cfg = call_info.audio_postprocess;
+  const Loudness_Measurement &l       = call_info.loudness;
+
+  if (!l.valid) return false;
+  if (!build_cleanup_filter(cfg).empty()) return false;
+
+  // loudnorm parses the values as printed here, so decide on those
+  auto round2 = [](double v) { return std::round(v * 100.0) / 100.0; };
+  const double input_i      = round2(l.integrated);
+  const double input_tp     = round2(l.true_peak);
+  const double input_lra    = round2(l.lra);
+  const double input_thresh = round2(l.threshold);
+
+  // loudnorm treats these as "not measured" and goes dynamic
+  if (input_i == 0.0 || input_lra == 0.0 || input_thresh <= -70.0) return false;
+
+  const double gain = cfg.loudnorm_i - input_i;
+  if (input_tp + gain > cfg.loudnorm_tp || input_lra > cfg.loudnorm_lra) return false;
+
+  auto fmt = [](double v) {
+    std::ostringstream o;
+    o << std::fixed << std::setprecision(2) << v;
+    return o.str();
+  };
+  measured.input_i       = fmt(input_i);
+  measured.input_tp      = fmt(input_tp);
+  measured.input_lra     = fmt(input_lra);
+  measured.input_thresh  = fmt(input_thresh);
+  measured.target_offset = fmt(0.0);
+  measured.valid         = true;
+  return true;
+}
+
 static std::string build_loudnorm_analysis_filter(const Audio_Postprocess_Config &cfg) {
   std::ostringstream f;
   f << std::fixed << std::setprecision(1)
@@ -425,7 +501,9 @@ static std::string build_loudnorm_analysis_filter(const Audio_Postprocess_Config
   return f.str();
 }
 
-static bool analyze_loudnorm_from_concat(const Call_Data_t &call_info,
+static bool analyze_loudnorm_from_concat(const Call_Data_Ext_t &call_info,
+                                         const std::vector<std::string> &input_files,
+                                         const std::function<bool()> &ensure_concat_list,
                                          const std::string &list_filename,
                                          const std::string &cleanup_filter,
                                          LoudnormMeasured &measured) {
@@ -436,22 +514,34 @@ static bool analyze_loudnorm_from_concat(const Call_Data_t &call_info,
   const std::string full_filter =
       cleanup_filter.empty() ? analysis_filter : cleanup_filter + "," + analysis_filter;
 
-  const std::vector<std::string> args = {
-      "ffmpeg", "-y", "-hide_banner", "-nostats",
-      "-loglevel", "info",
-      "-f", "concat", "-safe", "0", "-i", list_filename,
-      "-af", full_filter, "-vn", "-f", "null", "-"
-  };
-
   std::string output;
-  int exit_code = -1;
-  if (!run_process_capture_combined_output(args, loghdr, "ffmpeg loudnorm analysis", output, exit_code)) {
-    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mFailed to start ffmpeg loudnorm analysis pass\033[0m";
-    return false;
+  bool analyzed = false;
+  if (audio_render_available()) {
+    analyzed = (audio_render_analyze(input_files, full_filter, output, loghdr) == 0);
+    if (!analyzed)
+      BOOST_LOG_TRIVIAL(warning) << loghdr
+          << "\033[0;33mIn-process loudnorm analysis failed; falling back to ffmpeg\033[0m";
+  }
+
+  if (!analyzed) {
+    if (!ensure_concat_list()) return false;
+
+    const std::vector<std::string> args = {
+        "ffmpeg", "-y", "-hide_banner", "-nostats",
+        "-loglevel", "info",
+        "-f", "concat", "-safe", "0", "-i", list_filename,
+        "-af", full_filter, "-vn", "-f", "null", "-"
+    };
+
+    int exit_code = -1;
+    if (!run_process_capture_combined_output(args, loghdr, "ffmpeg loudnorm analysis", output, exit_code)) {
+      BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mFailed to start ffmpeg loudnorm analysis pass\033[0m";
+      return false;
+    }
+    if (exit_code != 0)
+      BOOST_LOG_TRIVIAL(warning) << loghdr
+          << "\033[0;33mffmpeg loudnorm first pass returned non-zero exit status: " << exit_code << "\033[0m";
   }
-  if (exit_code != 0)
-    BOOST_LOG_TRIVIAL(warning) << loghdr
-        << "\033[0;33mffmpeg loudnorm first pass returned non-zero exit status: " << exit_code << "\033[0m";
 
   // Extract the last complete JSON object from ffmpeg's combined output.
   const std::size_t json_end   = output.rfind('}');
@@ -562,7 +652,7 @@ static void append_common_metadata_args(std::vector<std::string> &args,
   });
 }
 
-static int render_call_audio_artifacts(const Call_Data_t &call_info,
+static int render_call_audio_artifacts(const Call_Data_Ext_t &call_info,
                                        const std::vector<std::string> &input_files,
                                        const std::string &date,
                                        const std::string &short_name,
@@ -575,7 +665,14 @@ static int render_call_audio_artifacts(const Call_Data_t &call_info,
   const std::string list_filename = call_info.raw_filename.empty()
                                         ? (call_info.filename     + ".concat.txt")
                                         : (call_info.raw_filename + ".concat.txt");
-  if (!write_concat_list(input_files, list_filename)) return -1;
+
+  // The concat list is only needed by the ffmpeg CLI path, so it is written
+  // the first time that path is taken.
+  bool have_concat_list = false;
+  const std::function<bool()> ensure_concat_list = [&]() {
+    if (!have_concat_list) have_concat_list = write_concat_list(input_files, list_filename);
+    return have_concat_list;
+  };
 
   const std::string loghdr =
       log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
@@ -596,7 +693,12 @@ static int render_call_audio_artifacts(const Call_Data_t &call_info,
           << "Call too short for reliable loudnorm first pass (" << call_info.length
           << "s); using single-pass loudnorm";
       loudnorm_single_pass = true;
-    } else if (analyze_loudnorm_from_concat(call_info, list_filename, cleanup_filter, measured) &&
+    } else if (loudnorm_from_recording(call_info, measured)) {
+      BOOST_LOG_TRIVIAL(debug) << loghdr << "Using loudness measured during recording: I="
+          << measured.input_i << " TP=" << measured.input_tp << " LRA=" << measured.input_lra;
+      loudnorm_two_pass = true;
+    } else if (analyze_loudnorm_from_concat(call_info, input_files, ensure_concat_list,
+                                            list_filename, cleanup_filter, measured) &&
                measured.valid) {
       loudnorm_two_pass = true;
                } else {
@@ -623,6 +725,29 @@ static int render_call_audio_artifacts(const Call_Data_t &call_info,
 
   // Pre-reserve: compressed path ~36 args, uncompressed ~22.
   auto run_render = [&](const std::string &filter) -> int {
+    if (audio_render_available()) {
+      Audio_Render_Job job;
+      job.input_files  = input_files;
+      job.filter       = filter;
+      job.wav_filename = call_info.filename;
+      job.m4a_filename = do_compress ? call_info.converted : "";
+      job.date         = date;
+      job.artist       = short_name;
+      job.title        = talkgroup;
+
+      const auto render_start = std::chrono::steady_clock::now();
+      if (audio_render_call(job, loghdr) == 0) {
+        BOOST_LOG_TRIVIAL(debug) << loghdr << "Rendered call audio in-process in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - render_start).count() << " ms";
+        return 0;
+      }
+      BOOST_LOG_TRIVIAL(warning) << loghdr
+          << "\033[0;33mIn-process audio render failed; falling back to ffmpeg\033[0m";
+    }
+
+    if (!ensure_concat_list()) return -1;
+
     std::vector<std::string> args;
     args.reserve(do_compress ? 36 : 22);
     args.insert(args.end(), {
@@ -661,7 +786,7 @@ static int render_call_audio_artifacts(const Call_Data_t &call_info,
     rc = run_render("");
   }
 
-  std::remove(list_filename.c_str());
+  if (have_concat_list) std::remove(list_filename.c_str());
 
   if (rc != 0) {
     BOOST_LOG_TRIVIAL(error) << loghdr
@@ -702,7 +827,7 @@ static bool parse_command_arguments(const std::string &command,
   return true;
 }
 
-static int run_upload_script_argv(const Call_Data_t &call_info) {
+static int run_upload_script_argv(const Call_Data_Ext_t &call_info) {
   const std::string script_spec = trim_whitespace(call_info.upload_script);
   if (script_spec.empty()) return 0;
 
@@ -827,6 +952,12 @@ bool checkIfFile(const std::string &filePath) {
 
 // BUG FIX: const reference — Call_Data_t contains vectors and a JSON object;
 // the original by-value signature made a full deep copy on every call.
+static void remove_transmission_files(const Transmission &t) {
+  const std::string codec_filename = codec_file_name(t.filename);
+  if (checkIfFile(t.filename)) std::remove(t.filename.c_str());
+  if (checkIfFile(codec_filename)) std::remove(codec_filename.c_str());
+}
+
 void remove_call_files(const Call_Data_t &call_info, bool plugin_failure) {
   const std::string loghdr =
       log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
@@ -855,17 +986,27 @@ void remove_call_files(const Call_Data_t &call_info, bool plugin_failure) {
           BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mFailed to copy transmission file: "
                                    << e.what() << "\033[0m";
         }
+        // keep the vocoder frames with the archived transmission so it can be vocoded again
+        const std::string codec_filename = codec_file_name(t.filename);
+        if (!checkIfFile(codec_filename)) continue;
+        try {
+          boost::filesystem::copy_file(codec_filename,
+              fs::path(call_info.filename).replace_filename(fs::path(codec_filename).filename()).string());
+        } catch (const boost::filesystem::filesystem_error &e) {
+          BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mFailed to copy codec file: "
+                                   << e.what() << "\033[0m";
+        }
       }
     }
     for (const auto &t : call_info.transmission_list)
-      if (checkIfFile(t.filename)) std::remove(t.filename.c_str());
+      remove_transmission_files(t);
     if (checkIfFile(call_info.raw_filename))
       std::remove(call_info.raw_filename.c_str());
   } else {
     for (const std::string &f : {call_info.raw_filename, call_info.filename, call_info.converted})
       if (checkIfFile(f)) std::remove(f.c_str());
     for (const auto &t : call_info.transmission_list)
-      if (checkIfFile(t.filename)) std::remove(t.filename.c_str());
+      remove_transmission_files(t);
   }
 
   const bool keep_json = call_info.call_log || (plugin_failure && call_info.archive_files_on_failure);
@@ -877,11 +1018,34 @@ void remove_call_files(const Call_Data_t &call_info, bool plugin_failure) {
 // Worker
 // ---------------------------------------------------------------------------
 
-Call_Data_t upload_call_worker(Call_Data_t call_info) {
-  if (call_info.status == INITIAL) {
+// A call the journal saw rendered before a restart only goes back to the
+// plugins, as long as its rendered audio is still on disk.
+static bool resume_rendered_call(const Call_Data_Ext_t &call_info) {
+  if (call_info.call_json.is_null() || !checkIfFile(call_info.filename))
+    return false;
+  if (call_info.compress_wav && !checkIfFile(call_info.converted))
+    return false;
+  return true;
+}
+
+Call_Data_Ext_t upload_call_worker(Call_Data_Ext_t call_info, bool rendered) {
+  if (call_info.status == INITIAL && !(rendered && resume_rendered_call(call_info))) {
     std::vector<std::string> input_files;
     input_files.reserve(call_info.transmission_list.size());
 
+    // Deferred vocoding: the transmission files hold placeholder silence until
+    // the frames saved alongside them are vocoded into them here.
+    gr::op25_repeater::imbe_synth::sptr synth;
+    for (const auto &t : call_info.transmission_list) {
+      const std::string codec_filename = codec_file_name(t.filename);
+      if (!checkIfFile(codec_filename)) continue;
+      const std::string loghdr =
+          log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
+      if (vocode_deferred_transmission(t, synth, call_info.soft_vocoder, loghdr) != 0)
+        BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to vocode " << codec_filename
+                                 << "; transmission will be silent\033[0m";
+    }
+
     struct stat statbuf;
     for (const auto &t : call_info.transmission_list) {
       if (stat(t.filename.c_str(), &statbuf) == 0)
@@ -933,6 +1097,8 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
         return call_info;
       }
     }
+
+    call_journal.record_rendered(call_info);
   }
 
   if (!plugman_call_end(call_info)) {
@@ -952,10 +1118,10 @@ Call_Data_t upload_call_worker(Call_Data_t call_info) {
 // BUG FIX: Config taken by const reference throughout — the original passed by
 // value, causing up to 3 deep copies of the full config per call conclusion
 // (conclude_call → create_call_data → create_base_filename).
-Call_Data_t Call_Concluder::create_base_filename(Call *call,
-                                                  Call_Data_t call_info,
-                                                  System *sys,
-                                                  const Config &config) {
+Call_Data_Ext_t Call_Concluder::create_base_filename(Call *call,
+                                                     Call_Data_Ext_t call_info,
+                                                     System *sys,
+                                                     const Config &config) {
   const std::int64_t start_ms        = call->get_start_time_ms();
   const time_t       work_start_time = static_cast<time_t>(start_ms / 1000);
   const std::string  capture_dir     = call->get_capture_dir();
@@ -1008,8 +1174,8 @@ Call_Data_t Call_Concluder::create_base_filename(Call *call,
   return call_info;
 }
 
-Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Config &config) {
-  Call_Data_t call_info;
+Call_Data_Ext_t Call_Concluder::create_call_data(Call *call, System *sys, const Config &config) {
+  Call_Data_Ext_t call_info;
 
   call_info.status               = INITIAL;
   call_info.process_call_time    = time(nullptr);
@@ -1025,6 +1191,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
   call_info.encrypted            = call->get_encrypted();
   call_info.emergency            = call->get_emergency();
   call_info.priority             = call->get_priority();
+  call_info.talkgroup_priority   = std::numeric_limits<int>::max();
   call_info.mode                 = call->get_mode();
   call_info.duplex               = call->get_duplex();
   call_info.tdma_slot            = call->get_tdma_slot();
@@ -1038,6 +1205,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
   call_info.call_log             = sys->get_call_log();
   call_info.call_num             = call->get_call_num();
   call_info.compress_wav         = sys->get_compress_wav();
+  call_info.soft_vocoder         = config.soft_vocoder;
 
   call_info.audio_postprocess.enabled             = sys->get_audio_postprocess_enabled();
   call_info.audio_postprocess.highpass_hz         = sys->get_audio_highpass_hz();
@@ -1064,6 +1232,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
     call_info.talkgroup_alpha_tag   = tg->alpha_tag;
     call_info.talkgroup_description = tg->description;
     call_info.talkgroup_group       = tg->group;
+    call_info.talkgroup_priority    = tg->priority;
   }
   // else: string members are value-initialized to "".
 
@@ -1081,9 +1250,12 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
   bool         have_any       = false;
   std::int64_t min_start_ms   = 0;
   std::int64_t max_stop_ms    = 0;
+  std::vector<Loudness_Blocks> loudness_blocks;
+  loudness_blocks.reserve(call_info.transmission_list.size());
 
   for (auto it = call_info.transmission_list.begin(); it != call_info.transmission_list.end(); ) {
     const Transmission &t = *it;
+    Loudness_Blocks blocks = take_transmission_loudness(t.filename);
     const std::int64_t seg_ms    = std::max<std::int64_t>(0, t.stop_time_ms - t.start_time_ms);
     const double       seg_len_s = seg_ms / 1000.0;
 
@@ -1094,7 +1266,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
       if (!call_info.transmission_archive) {
         BOOST_LOG_TRIVIAL(info) << loghdr << "Removing transmission shorter than "
                                  << min_tx_s << "s (actual: " << seg_len_s << "s).";
-        if (checkIfFile(t.filename)) std::remove(t.filename.c_str());
+        remove_transmission_files(t);
       }
       it = call_info.transmission_list.erase(it);
       continue;
@@ -1150,9 +1322,17 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
     call_info.spike_count += t.spike_count;
     playable_pos_s += seg_len_s;
     audio_sum_ms   += seg_ms;
+    loudness_blocks.push_back(std::move(blocks));
     ++it;
   }
 
+  // Deferred transmissions were metered while they were still silence, leave
+  // those calls to the analysis pass over the vocoded files.
+  const bool deferred = std::any_of(call_info.transmission_list.begin(), call_info.transmission_list.end(),
+                                    [](const Transmission &t) { return checkIfFile(codec_file_name(t.filename)); });
+  if (call_info.audio_postprocess.enabled && call_info.audio_postprocess.loudnorm && !deferred)
+    call_info.loudness = measure_loudness(loudness_blocks);
+
   if (have_any) {
     call_info.start_time_ms  = min_start_ms;
     call_info.stop_time_ms   = max_stop_ms;
@@ -1173,7 +1353,7 @@ Call_Data_t Call_Concluder::create_call_data(Call *call, System *sys, const Conf
 }
 
 void Call_Concluder::conclude_call(Call *call, System *sys, const Config &config) {
-  Call_Data_t call_info = create_call_data(call, sys, config);
+  Call_Data_Ext_t call_info = create_call_data(call, sys, config);
   const std::string loghdr =
       log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
 
@@ -1211,86 +1391,333 @@ void Call_Concluder::conclude_call(Call *call, System *sys, const Config &config
     return;
   }
 
-  call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+  call_journal.record_queued(call_info);
+  enqueue_call(std::move(call_info));
 }
 
-void Call_Concluder::manage_call_data_workers() {
-  for (auto it = call_data_workers.begin(); it != call_data_workers.end(); ) {
-    if (it->wait_for(std::chrono::seconds(0)) != std::future_status::ready) { ++it; continue; }
+// ---------------------------------------------------------------------------
+// Worker pool
+//
+// A fixed set of threads drains a bounded queue ordered by talkgroup priority.
+// Finished calls are handed back to the main loop, which owns retries and the
+// overflow spill so that file removal and logging happen in one place.
+// ---------------------------------------------------------------------------
+
+static int queue_priority(const Call_Data_Ext_t &call_info) {
+  // Emergency traffic goes ahead of everything else
+  return call_info.emergency ? 0 : call_info.talkgroup_priority;
+}
 
-    Call_Data_t call_info = it->get();
-    it = call_data_workers.erase(it);
+void Call_Concluder::start_call_data_workers(const Config &config, const Config_Ext &config_ext) {
+  int worker_count = config_ext.call_concluder_workers;
+  if (worker_count <= 0) {
+    worker_count = std::max(2, (int)std::thread::hardware_concurrency());
+  }
+  max_queue_size = std::max(1, config_ext.call_concluder_queue_size);
 
-    if (call_info.status != RETRY) continue;
+  if (lowercase_copy(config_ext.call_concluder_overflow) == "spill") {
+    overflow_policy = SPILL_TO_DISK;
+    spill_dir = config_ext.call_concluder_spill_dir;
+    spilled_on_disk = list_spilled_calls(spill_dir).size();
+  } else {
+    overflow_policy = DROP_OLDEST;
+  }
 
-    ++call_info.retry_attempt;
-    const time_t      start_time = call_info.start_time;
-    const std::string loghdr =
-        log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
+  BOOST_LOG_TRIVIAL(info) << "Call Concluder: " << worker_count << " workers, queue size " << max_queue_size
+                          << ", overflow: " << (overflow_policy == SPILL_TO_DISK ? "spill to " + spill_dir : "drop oldest");
+  if (spilled_on_disk > 0) {
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder: " << spilled_on_disk << " spilled calls from a previous run will be processed";
+  }
 
-    if (call_info.retry_attempt > Call_Concluder::MAX_RETRY) {
-      remove_call_files(call_info, true);
-      BOOST_LOG_TRIVIAL(error) << loghdr << "Failed to conclude call - "
-                                << std::put_time(std::localtime(&start_time), "%c %Z");
-    } else {
-      const long backoff = (1L << call_info.retry_attempt) * 60 + random_jitter(10);
-      call_info.process_call_time = time(nullptr) + backoff;
-      retry_call_list.push_back(call_info);
-      BOOST_LOG_TRIVIAL(error) << loghdr
-          << std::put_time(std::localtime(&start_time), "%c %Z")
-          << " retry attempt " << call_info.retry_attempt
-          << " in " << backoff << "s\t retry queue: " << retry_call_list.size() << " calls";
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    stopping = false;
+    abandon = false;
+    for (int i = 0; i < worker_count; i++) {
+      workers.emplace_back(worker_loop);
     }
   }
 
-  for (auto it = retry_call_list.begin(); it != retry_call_list.end(); ) {
-    if (it->process_call_time <= time(nullptr)) {
-      call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, *it));
-      it = retry_call_list.erase(it);
-    } else {
-      ++it;
+  if (!queue_wait_metric) {
+    queue_wait_metric = Metrics::histogram("trunk_recorder_concluder_queue_wait_seconds", "Time calls wait for a call concluder worker", {0.01, 0.1, 0.5, 1, 2.5, 5, 10, 30, 60, 300});
+    Metrics::add_collector(write_metrics);
+  }
+
+  if (config_ext.call_journal) {
+    const std::string journal_file = config.capture_dir + "/.call_journal";
+    if (call_journal.open(journal_file)) {
+      std::vector<Call_Journal::Replayed_Call> pending = call_journal.replay();
+      if (!pending.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "Call Concluder: resuming " << pending.size() << " calls from " << journal_file;
+      }
+      for (auto &replayed : pending) {
+        if (replayed.call_info.status == RETRY) {
+          retry_queue.push(std::move(replayed.call_info));
+        } else {
+          enqueue_call(std::move(replayed.call_info), replayed.rendered);
+        }
+      }
     }
   }
 }
 
+void Call_Concluder::worker_loop() {
+  std::unique_lock<std::mutex> lock(queue_mutex);
+  while (true) {
+    queue_cv.wait(lock, [] { return stopping || abandon || !call_queue.empty(); });
+    if (abandon || call_queue.empty()) {
+      return;
+    }
+
+    auto next = call_queue.begin();
+    Queued_Call job = std::move(next->second);
+    call_queue.erase(next);
+
+    const double wait = std::chrono::duration<double>(std::chrono::steady_clock::now() - job.enqueued).count();
+    total_wait += wait;
+    max_wait = std::max(max_wait, wait);
+    running_count++;
+    queue_wait_metric->observe(wait);
+
+    lock.unlock();
+    Call_Data_Ext_t result = upload_call_worker(std::move(job.call_info), job.rendered);
+    lock.lock();
+
+    running_count--;
+    completed_count++;
+    finished_calls.push_back(std::move(result));
+  }
+}
+
+// The counters are kept under queue_mutex for the status output already, so
+// they are read from there rather than counted twice
+void Call_Concluder::write_metrics(Metrics_Writer &writer) {
+  std::lock_guard<std::mutex> lock(queue_mutex);
+  writer.family("trunk_recorder_concluder_queued", "gauge", "Calls waiting for a call concluder worker");
+  writer.sample("trunk_recorder_concluder_queued", "", call_queue.size());
+  writer.family("trunk_recorder_concluder_running", "gauge", "Calls being processed by a call concluder worker");
+  writer.sample("trunk_recorder_concluder_running", "", running_count);
+  writer.family("trunk_recorder_concluder_calls", "counter", "Calls that left the call concluder queue");
+  writer.sample("trunk_recorder_concluder_calls_total", Metric_Labels{{"outcome", "completed"}}, completed_count);
+  writer.sample("trunk_recorder_concluder_calls_total", Metric_Labels{{"outcome", "dropped"}}, dropped_count);
+  writer.sample("trunk_recorder_concluder_calls_total", Metric_Labels{{"outcome", "spilled"}}, spilled_count);
+}
+
+void Call_Concluder::enqueue_call(Call_Data_Ext_t call_info, bool rendered) {
+  Call_Data_Ext_t overflow;
+  bool have_overflow = false;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    const Queue_Key key(queue_priority(call_info), queue_seq++);
+    bool accept = true;
+
+    if (call_queue.size() >= max_queue_size) {
+      // Give up the oldest call in the lowest priority class, unless the new
+      // call is of an even lower priority.
+      const int lowest = call_queue.rbegin()->first.first;
+      if (key.first > lowest) {
+        overflow = std::move(call_info);
+        accept = false;
+      } else {
+        auto victim = call_queue.lower_bound(Queue_Key(lowest, 0));
+        overflow = std::move(victim->second.call_info);
+        call_queue.erase(victim);
+      }
+      have_overflow = true;
+    }
+
+    if (accept) {
+      call_queue.emplace(key, Queued_Call{std::move(call_info), std::chrono::steady_clock::now(), rendered});
+    }
+  }
+  queue_cv.notify_one();
+
+  if (!have_overflow) {
+    return;
+  }
+
+  const std::string loghdr = log_header(overflow.short_name, overflow.call_num, overflow.talkgroup_display, overflow.freq);
+  if ((overflow_policy == SPILL_TO_DISK) && spill_call_data(spill_dir, overflow)) {
+    call_journal.record_spilled(overflow);
+    spilled_on_disk++;
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    spilled_count++;
+    BOOST_LOG_TRIVIAL(info) << loghdr << "Call concluder queue full, spilled call to disk";
+  } else {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mCall concluder queue full, dropping call\033[0m";
+    call_journal.record_failed(overflow);
+    remove_call_files(overflow, true);
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    dropped_count++;
+  }
+}
+
+void Call_Concluder::load_spilled_calls() {
+  if (spilled_on_disk == 0) {
+    return;
+  }
+
+  size_t room;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    room = max_queue_size - std::min(max_queue_size, call_queue.size());
+  }
+  if (room == 0) {
+    return;
+  }
+
+  std::vector<std::string> files = list_spilled_calls(spill_dir);
+  spilled_on_disk = files.size();
+  for (size_t i = 0; i < files.size() && i < room; i++) {
+    Call_Data_Ext_t call_info;
+    spilled_on_disk--;
+    if (load_spilled_call(files[i], call_info)) {
+      call_journal.record_queued(call_info);
+      enqueue_call(std::move(call_info));
+    }
+  }
+}
+
+void Call_Concluder::handle_finished_call(Call_Data_Ext_t call_info, bool shutting_down) {
+  if (call_info.status == SUCCESS) {
+    call_journal.record_uploaded(call_info);
+    return;
+  }
+  if (call_info.status != RETRY) {
+    call_journal.record_failed(call_info);
+    return;
+  }
+
+  ++call_info.retry_attempt;
+  const time_t      start_time = call_info.start_time;
+  const std::string loghdr =
+      log_header(call_info.short_name, call_info.call_num, call_info.talkgroup_display, call_info.freq);
+
+  if (call_info.retry_attempt > Call_Concluder::MAX_RETRY) {
+    call_journal.record_failed(call_info);
+    remove_call_files(call_info, true);
+    BOOST_LOG_TRIVIAL(error) << loghdr << "Failed to conclude call - "
+                              << std::put_time(std::localtime(&start_time), "%c %Z");
+  } else if (shutting_down) {
+    // During shutdown retry immediately rather than waiting for backoff.
+    call_journal.record_retry(call_info);
+    enqueue_call(std::move(call_info));
+  } else {
+    const long backoff = (1L << call_info.retry_attempt) * 60 + random_jitter(10);
+    const int  attempt = call_info.retry_attempt;
+    call_info.process_call_time = time(nullptr) + backoff;
+    call_journal.record_retry(call_info);
+    retry_queue.push(std::move(call_info));
+    BOOST_LOG_TRIVIAL(error) << loghdr
+        << std::put_time(std::localtime(&start_time), "%c %Z")
+        << " retry attempt " << attempt << " in " << backoff
+        << "s\t retry queue: " << retry_queue.size() << " calls";
+  }
+}
+
+void Call_Concluder::manage_call_data_workers() {
+  std::list<Call_Data_Ext_t> finished;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    finished.swap(finished_calls);
+  }
+  for (auto &call_info : finished) {
+    handle_finished_call(std::move(call_info), false);
+  }
+
+  const time_t now = time(nullptr);
+  while (!retry_queue.empty() && retry_queue.top().process_call_time <= now) {
+    Call_Data_Ext_t call_info = retry_queue.top();
+    retry_queue.pop();
+    enqueue_call(std::move(call_info));
+  }
+
+  load_spilled_calls();
+  call_journal.flush();
+}
+
 bool Call_Concluder::shutdown_call_data_workers(std::chrono::seconds timeout) {
   const auto deadline = std::chrono::steady_clock::now() + timeout;
 
+  while (!retry_queue.empty()) {
+    Call_Data_Ext_t call_info = retry_queue.top();
+    retry_queue.pop();
+    enqueue_call(std::move(call_info));
+  }
+
   while (std::chrono::steady_clock::now() < deadline) {
-    for (auto it = call_data_workers.begin(); it != call_data_workers.end(); ) {
-      if (it->wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) { ++it; continue; }
+    std::list<Call_Data_Ext_t> finished;
+    bool idle;
+    {
+      std::lock_guard<std::mutex> lock(queue_mutex);
+      finished.swap(finished_calls);
+      idle = call_queue.empty() && (running_count == 0);
+    }
+    for (auto &call_info : finished) {
+      handle_finished_call(std::move(call_info), true);
+    }
 
-      Call_Data_t call_info = it->get();
-      it = call_data_workers.erase(it);
+    if (idle && finished.empty()) {
+      {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        stopping = true;
+      }
+      queue_cv.notify_all();
+      for (auto &worker : workers) worker.join();
+      workers.clear();
 
-      if (call_info.status == RETRY) {
-        if (++call_info.retry_attempt > Call_Concluder::MAX_RETRY)
-          remove_call_files(call_info, true);
-        else
-          call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, call_info));
+      if (spilled_on_disk > 0) {
+        BOOST_LOG_TRIVIAL(info) << "Call Concluder: " << spilled_on_disk << " spilled calls left in " << spill_dir << " for the next run";
       }
+      call_journal.compact();
+      call_journal.close();
+      return true;
     }
-
-    // During shutdown fire queued retries immediately rather than waiting for backoff.
-    for (auto &pending : retry_call_list)
-      call_data_workers.push_back(std::async(std::launch::async, upload_call_worker, pending));
-    retry_call_list.clear();
-
-    if (call_data_workers.empty()) return true;
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
   }
 
-  for (auto &pending : retry_call_list) remove_call_files(pending, true);
-  retry_call_list.clear();
-
-  if (!call_data_workers.empty()) {
-    BOOST_LOG_TRIVIAL(error) << "\033[0;31mCall concluder shutdown timed out after "
-                              << timeout.count() << "s; force exiting with "
-                              << call_data_workers.size() << " worker(s) still running.\033[0m";
-    // Intentional leak: splice futures aside so destructors don't block exit.
-    auto *abandoned = new std::list<std::future<Call_Data_t>>();
-    abandoned->splice(abandoned->end(), call_data_workers);
+  std::map<Queue_Key, Queued_Call> abandoned_queue;
+  size_t still_running;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex);
+    abandoned_queue.swap(call_queue);
+    still_running = running_count;
+    abandon = true;
+  }
+  queue_cv.notify_all();
+
+  BOOST_LOG_TRIVIAL(error) << "\033[0;31mCall concluder shutdown timed out after "
+                            << timeout.count() << "s; force exiting with "
+                            << still_running << " worker(s) still running.\033[0m";
+
+  if (call_journal.is_open()) {
+    // Queued, running and retrying calls are all in the journal, so keep
+    // their files and pick them up again on the next start.
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder: " << call_journal.pending_calls() << " unfinished calls saved to the call journal";
+    call_journal.compact();
+    call_journal.close();
+  } else {
+    for (auto &pending : abandoned_queue) remove_call_files(pending.second.call_info, true);
   }
+  // Workers that are stuck in a plugin or ffmpeg are left to die with the process
+  for (auto &worker : workers) worker.detach();
+  workers.clear();
 
   return false;
-}
\ No newline at end of file
+}
+
+Call_Concluder_Stats Call_Concluder::get_stats() {
+  Call_Concluder_Stats stats;
+  std::lock_guard<std::mutex> lock(queue_mutex);
+  stats.queued = call_queue.size();
+  stats.running = running_count;
+  stats.retry_waiting = retry_queue.size();
+  stats.spilled = spilled_on_disk;
+  stats.workers = (int)workers.size();
+  stats.completed = completed_count;
+  stats.dropped = dropped_count;
+  stats.spilled_total = spilled_count;
+  stats.avg_wait = (completed_count + running_count) ? total_wait / (completed_count + running_count) : 0.0;
+  stats.max_wait = max_wait;
+  return stats;
+}
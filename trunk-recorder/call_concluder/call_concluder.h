@@ -3,14 +3,17 @@
 
 #include <boost/regex.hpp>
 #include <sys/stat.h>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <ctime>
-#include <future>
 #include <list>
+#include <map>
 #include <mutex>
 #include <queue>
 #include <random>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "../call.h"
@@ -19,25 +22,84 @@
 #include "../systems/system.h"
 #include "../systems/system_impl.h"
 
-Call_Data_t upload_call_worker(Call_Data_t call_info);
-int         create_call_json(Call_Data_t &call_info);
-bool        checkIfFile(const std::string &filePath);
-void        remove_call_files(const Call_Data_t &call_info, bool plugin_failure = false);
+class Metrics_Writer;
+
+Call_Data_Ext_t upload_call_worker(Call_Data_Ext_t call_info, bool rendered = false);
+int             create_call_json(Call_Data_t &call_info);
+bool            checkIfFile(const std::string &filePath);
+void            remove_call_files(const Call_Data_t &call_info, bool plugin_failure = false);
+
+enum Call_Concluder_Overflow { DROP_OLDEST,
+                               SPILL_TO_DISK };
+
+struct Call_Concluder_Stats {
+  size_t queued;
+  size_t running;
+  size_t retry_waiting;
+  size_t spilled;
+  int workers;
+  unsigned long completed;
+  unsigned long dropped;
+  unsigned long spilled_total;
+  double avg_wait;
+  double max_wait;
+};
 
 class Call_Concluder {
 public:
   static const int MAX_RETRY;
-  static std::list<Call_Data_t>              retry_call_list;
-  static std::list<std::future<Call_Data_t>> call_data_workers;
 
-  static Call_Data_t create_call_data(Call *call, System *sys, const Config &config);
-  static void        conclude_call(Call *call, System *sys, const Config &config);
-  static void        manage_call_data_workers();
-  static bool        shutdown_call_data_workers(std::chrono::seconds timeout);
+  static void                 start_call_data_workers(const Config &config, const Config_Ext &config_ext);
+  static Call_Data_Ext_t      create_call_data(Call *call, System *sys, const Config &config);
+  static void                 conclude_call(Call *call, System *sys, const Config &config);
+  static void                 manage_call_data_workers();
+  static bool                 shutdown_call_data_workers(std::chrono::seconds timeout);
+  static Call_Concluder_Stats get_stats();
 
 private:
-  static Call_Data_t create_base_filename(Call *call, Call_Data_t call_info,
-                                          System *sys, const Config &config);
+  // Calls are run highest talkgroup priority first (1 is highest), oldest
+  // first within a priority.
+  typedef std::pair<int, unsigned long> Queue_Key;
+  struct Queued_Call {
+    Call_Data_Ext_t call_info;
+    std::chrono::steady_clock::time_point enqueued;
+    bool rendered;
+  };
+  struct Retry_Later {
+    bool operator()(const Call_Data_Ext_t &a, const Call_Data_Ext_t &b) const {
+      return a.process_call_time > b.process_call_time;
+    }
+  };
+
+  static std::mutex                          queue_mutex;
+  static std::condition_variable             queue_cv;
+  static std::map<Queue_Key, Queued_Call>    call_queue;
+  static std::list<Call_Data_Ext_t>          finished_calls;
+  static std::vector<std::thread>            workers;
+  static unsigned long                       queue_seq;
+  static size_t                              running_count;
+  static bool                                stopping;
+  static std::atomic<bool>                   abandon;
+  static unsigned long                       completed_count;
+  static unsigned long                       dropped_count;
+  static unsigned long                       spilled_count;
+  static double                              total_wait;
+  static double                              max_wait;
+
+  // Only touched from the main loop
+  static std::priority_queue<Call_Data_Ext_t, std::vector<Call_Data_Ext_t>, Retry_Later> retry_queue;
+  static size_t                  max_queue_size;
+  static Call_Concluder_Overflow overflow_policy;
+  static std::string             spill_dir;
+  static size_t                  spilled_on_disk;
+
+  static void            worker_loop();
+  static void            enqueue_call(Call_Data_Ext_t call_info, bool rendered = false);
+  static void            handle_finished_call(Call_Data_Ext_t call_info, bool shutting_down);
+  static void            load_spilled_calls();
+  static void            write_metrics(Metrics_Writer &writer);
+  static Call_Data_Ext_t create_base_filename(Call *call, Call_Data_Ext_t call_info,
+                                              System *sys, const Config &config);
 };
 
 #endif
\ No newline at end of file
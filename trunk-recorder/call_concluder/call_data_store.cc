@@ -0,0 +1,584 @@
+#include "call_data_store.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+// ---------------------------------------------------------------------------
+// Call_Data_Ext_t <-> JSON
+// ---------------------------------------------------------------------------
+
+static nlohmann::json transmission_to_json(const Transmission &t) {
+  return {
+      {"source",        t.source},
+      {"talkgroup",     t.talkgroup},
+      {"slot",          t.slot},
+      {"color_code",    t.color_code},
+      {"start_time",    t.start_time},
+      {"stop_time",     t.stop_time},
+      {"start_time_ms", t.start_time_ms},
+      {"stop_time_ms",  t.stop_time_ms},
+      {"sample_count",  t.sample_count},
+      {"spike_count",   t.spike_count},
+      {"error_count",   t.error_count},
+      {"freq",          t.freq},
+      {"length",        t.length},
+      {"filename",      t.filename}
+  };
+}
+
+static Transmission transmission_from_json(const nlohmann::json &j) {
+  Transmission t;
+  t.source        = j.at("source").get<long>();
+  t.talkgroup     = j.at("talkgroup").get<long>();
+  t.slot          = j.at("slot").get<unsigned int>();
+  t.color_code    = j.at("color_code").get<unsigned int>();
+  t.start_time    = j.at("start_time").get<long>();
+  t.stop_time     = j.at("stop_time").get<long>();
+  t.start_time_ms = j.at("start_time_ms").get<std::int64_t>();
+  t.stop_time_ms  = j.at("stop_time_ms").get<std::int64_t>();
+  t.sample_count  = j.at("sample_count").get<long>();
+  t.spike_count   = j.at("spike_count").get<long>();
+  t.error_count   = j.at("error_count").get<long>();
+  t.freq          = j.at("freq").get<double>();
+  t.length        = j.at("length").get<double>();
+  t.filename      = j.at("filename").get<std::string>();
+  return t;
+}
+
+nlohmann::json call_data_to_json(const Call_Data_Ext_t &c) {
+  nlohmann::json j = {
+      {"talkgroup",                 c.talkgroup},
+      {"color_code",                c.color_code},
+      {"patched_talkgroups",        c.patched_talkgroups},
+      {"talkgroup_tag",             c.talkgroup_tag},
+      {"talkgroup_alpha_tag",       c.talkgroup_alpha_tag},
+      {"talkgroup_description",     c.talkgroup_description},
+      {"talkgroup_display",         c.talkgroup_display},
+      {"talkgroup_group",           c.talkgroup_group},
+      {"call_num",                  c.call_num},
+      {"freq",                      c.freq},
+      {"freq_error",                c.freq_error},
+      {"source_num",                c.source_num},
+      {"recorder_num",              c.recorder_num},
+      {"signal",                    c.signal},
+      {"noise",                     c.noise},
+      {"start_time",                c.start_time},
+      {"stop_time",                 c.stop_time},
+      {"start_time_ms",             c.start_time_ms},
+      {"stop_time_ms",              c.stop_time_ms},
+      {"error_count",               c.error_count},
+      {"spike_count",               c.spike_count},
+      {"encrypted",                 c.encrypted},
+      {"emergency",                 c.emergency},
+      {"priority",                  c.priority},
+      {"talkgroup_priority",        c.talkgroup_priority},
+      {"mode",                      c.mode},
+      {"duplex",                    c.duplex},
+      {"audio_archive",             c.audio_archive},
+      {"transmission_archive",      c.transmission_archive},
+      {"archive_files_on_failure",  c.archive_files_on_failure},
+      {"call_log",                  c.call_log},
+      {"compress_wav",              c.compress_wav},
+      {"soft_vocoder",              c.soft_vocoder},
+      {"raw_filename",              c.raw_filename},
+      {"filename",                  c.filename},
+      {"status_filename",           c.status_filename},
+      {"converted",                 c.converted},
+      {"min_transmissions_removed", c.min_transmissions_removed},
+      {"sys_num",                   c.sys_num},
+      {"short_name",                c.short_name},
+      {"upload_script",             c.upload_script},
+      {"audio_type",                c.audio_type},
+      {"tdma_slot",                 c.tdma_slot},
+      {"length",                    c.length},
+      {"call_length_ms",            c.call_length_ms},
+      {"phase2_tdma",               c.phase2_tdma},
+      {"status",                    int(c.status)},
+      {"process_call_time",         static_cast<long long>(c.process_call_time)},
+      {"retry_attempt",             c.retry_attempt},
+      {"plugin_retry_list",         c.plugin_retry_list},
+      {"call_json",                 c.call_json}
+  };
+
+  const Audio_Postprocess_Config &ap = c.audio_postprocess;
+  j["audio_postprocess"] = {
+      {"enabled",             ap.enabled},
+      {"highpass_hz",         ap.highpass_hz},
+      {"lowpass_hz",          ap.lowpass_hz},
+      {"bandreject_hz",       ap.bandreject_hz},
+      {"bandreject_width_hz", ap.bandreject_width_hz},
+      {"loudnorm",            ap.loudnorm},
+      {"loudnorm_i",          ap.loudnorm_i},
+      {"loudnorm_tp",         ap.loudnorm_tp},
+      {"loudnorm_lra",        ap.loudnorm_lra},
+      {"ffmpeg_filter",       ap.ffmpeg_filter}
+  };
+
+  j["loudness"] = {
+      {"valid",      c.loudness.valid},
+      {"integrated", c.loudness.integrated},
+      {"true_peak",  c.loudness.true_peak},
+      {"lra",        c.loudness.lra},
+      {"threshold",  c.loudness.threshold}
+  };
+
+  j["transmission_list"] = nlohmann::json::array();
+  for (const auto &t : c.transmission_list)
+    j["transmission_list"].push_back(transmission_to_json(t));
+
+  j["transmission_source_list"] = nlohmann::json::array();
+  for (const auto &s : c.transmission_source_list) {
+    j["transmission_source_list"].push_back({
+        {"source",        s.source},
+        {"time",          s.time},
+        {"position",      s.position},
+        {"emergency",     s.emergency},
+        {"signal_system", s.signal_system},
+        {"tag",           s.tag},
+        {"tag_ota",       s.tag_ota}
+    });
+  }
+
+  j["transmission_error_list"] = nlohmann::json::array();
+  for (const auto &e : c.transmission_error_list) {
+    j["transmission_error_list"].push_back({
+        {"time",        e.time},
+        {"position",    e.position},
+        {"total_len",   e.total_len},
+        {"error_count", e.error_count},
+        {"spike_count", e.spike_count}
+    });
+  }
+
+  return j;
+}
+
+bool call_data_from_json(const nlohmann::json &j, Call_Data_Ext_t &c) {
+  try {
+    c.talkgroup                 = j.at("talkgroup").get<long>();
+    c.color_code                = j.at("color_code").get<long>();
+    c.patched_talkgroups        = j.at("patched_talkgroups").get<std::vector<unsigned long>>();
+    c.talkgroup_tag             = j.at("talkgroup_tag").get<std::string>();
+    c.talkgroup_alpha_tag       = j.at("talkgroup_alpha_tag").get<std::string>();
+    c.talkgroup_description     = j.at("talkgroup_description").get<std::string>();
+    c.talkgroup_display         = j.at("talkgroup_display").get<std::string>();
+    c.talkgroup_group           = j.at("talkgroup_group").get<std::string>();
+    c.call_num                  = j.at("call_num").get<long>();
+    c.freq                      = j.at("freq").get<double>();
+    c.freq_error                = j.at("freq_error").get<int>();
+    c.source_num                = j.at("source_num").get<int>();
+    c.recorder_num              = j.at("recorder_num").get<int>();
+    c.signal                    = j.at("signal").get<double>();
+    c.noise                     = j.at("noise").get<double>();
+    c.start_time                = j.at("start_time").get<long>();
+    c.stop_time                 = j.at("stop_time").get<long>();
+    c.start_time_ms             = j.at("start_time_ms").get<std::int64_t>();
+    c.stop_time_ms              = j.at("stop_time_ms").get<std::int64_t>();
+    c.error_count               = j.at("error_count").get<long>();
+    c.spike_count               = j.at("spike_count").get<long>();
+    c.encrypted                 = j.at("encrypted").get<bool>();
+    c.emergency                 = j.at("emergency").get<bool>();
+    c.priority                  = j.at("priority").get<int>();
+    c.talkgroup_priority        = j.at("talkgroup_priority").get<int>();
+    c.mode                      = j.at("mode").get<bool>();
+    c.duplex                    = j.at("duplex").get<bool>();
+    c.audio_archive             = j.at("audio_archive").get<bool>();
+    c.transmission_archive      = j.at("transmission_archive").get<bool>();
+    c.archive_files_on_failure  = j.at("archive_files_on_failure").get<bool>();
+    c.call_log                  = j.at("call_log").get<bool>();
+    c.compress_wav              = j.at("compress_wav").get<bool>();
+    c.soft_vocoder              = j.value("soft_vocoder", false);
+    c.raw_filename              = j.at("raw_filename").get<std::string>();
+    c.filename                  = j.at("filename").get<std::string>();
+    c.status_filename           = j.at("status_filename").get<std::string>();
+    c.converted                 = j.at("converted").get<std::string>();
+    c.min_transmissions_removed = j.at("min_transmissions_removed").get<int>();
+    c.sys_num                   = j.at("sys_num").get<int>();
+    c.short_name                = j.at("short_name").get<std::string>();
+    c.upload_script             = j.at("upload_script").get<std::string>();
+    c.audio_type                = j.at("audio_type").get<std::string>();
+    c.tdma_slot                 = j.at("tdma_slot").get<int>();
+    c.length                    = j.at("length").get<double>();
+    c.call_length_ms            = j.at("call_length_ms").get<std::int64_t>();
+    c.phase2_tdma               = j.at("phase2_tdma").get<bool>();
+    c.status                    = static_cast<Call_Data_Status>(j.at("status").get<int>());
+    c.process_call_time         = static_cast<time_t>(j.at("process_call_time").get<long long>());
+    c.retry_attempt             = j.at("retry_attempt").get<int>();
+    c.plugin_retry_list         = j.at("plugin_retry_list").get<std::vector<int>>();
+    c.call_json                 = j.at("call_json");
+
+    const nlohmann::json &ap = j.at("audio_postprocess");
+    c.audio_postprocess.enabled             = ap.at("enabled").get<bool>();
+    c.audio_postprocess.highpass_hz         = ap.at("highpass_hz").get<int>();
+    c.audio_postprocess.lowpass_hz          = ap.at("lowpass_hz").get<int>();
+    c.audio_postprocess.bandreject_hz       = ap.at("bandreject_hz").get<int>();
+    c.audio_postprocess.bandreject_width_hz = ap.at("bandreject_width_hz").get<int>();
+    c.audio_postprocess.loudnorm            = ap.at("loudnorm").get<bool>();
+    c.audio_postprocess.loudnorm_i          = ap.at("loudnorm_i").get<double>();
+    c.audio_postprocess.loudnorm_tp         = ap.at("loudnorm_tp").get<double>();
+    c.audio_postprocess.loudnorm_lra        = ap.at("loudnorm_lra").get<double>();
+    c.audio_postprocess.ffmpeg_filter       = ap.at("ffmpeg_filter").get<std::string>();
+
+    const nlohmann::json &ld = j.at("loudness");
+    c.loudness.valid      = ld.at("valid").get<bool>();
+    c.loudness.integrated = ld.at("integrated").get<double>();
+    c.loudness.true_peak  = ld.at("true_peak").get<double>();
+    c.loudness.lra        = ld.at("lra").get<double>();
+    c.loudness.threshold  = ld.at("threshold").get<double>();
+
+    c.transmission_list.clear();
+    for (const auto &t : j.at("transmission_list"))
+      c.transmission_list.push_back(transmission_from_json(t));
+
+    c.transmission_source_list.clear();
+    for (const auto &s : j.at("transmission_source_list")) {
+      c.transmission_source_list.push_back({
+          s.at("source").get<long>(),
+          s.at("time").get<long>(),
+          s.at("position").get<double>(),
+          s.at("emergency").get<bool>(),
+          s.at("signal_system").get<std::string>(),
+          s.at("tag").get<std::string>(),
+          s.at("tag_ota").get<std::string>()
+      });
+    }
+
+    c.transmission_error_list.clear();
+    for (const auto &e : j.at("transmission_error_list")) {
+      c.transmission_error_list.push_back({
+          e.at("time").get<long>(),
+          e.at("position").get<double>(),
+          e.at("total_len").get<double>(),
+          e.at("error_count").get<double>(),
+          e.at("spike_count").get<double>()
+      });
+    }
+  } catch (const std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to decode stored call data: " << e.what() << "\033[0m";
+    return false;
+  }
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Spill files
+// ---------------------------------------------------------------------------
+
+bool spill_call_data(const std::string &spill_dir, const Call_Data_Ext_t &call_info) {
+  boost::system::error_code ec;
+  boost::filesystem::create_directories(spill_dir, ec);
+  if (ec) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to create spill directory " << spill_dir
+                             << ": " << ec.message() << "\033[0m";
+    return false;
+  }
+
+  // <start_time_ms>-<sys_num>-<call_num>.json sorts oldest first
+  std::ostringstream name;
+  name << std::setw(15) << std::setfill('0') << call_info.start_time_ms << '-'
+       << call_info.sys_num << '-' << call_info.call_num << ".json";
+  const boost::filesystem::path target = boost::filesystem::path(spill_dir) / name.str();
+  const std::string tmp = target.string() + ".tmp";
+
+  {
+    std::ofstream out(tmp);
+    if (!out.is_open()) {
+      BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to write spill file " << tmp << "\033[0m";
+      return false;
+    }
+    out << call_data_to_json(call_info).dump();
+    out.flush();
+    if (!out.good()) {
+      BOOST_LOG_TRIVIAL(error) << "\033[0;31mFailed to write spill file " << tmp << " (disk full?)\033[0m";
+      out.close();
+      std::remove(tmp.c_str());
+      return false;
+    }
+  }
+
+  // Rename so a crash never leaves a half written spill file behind
+  boost::filesystem::rename(tmp, target, ec);
+  if (ec) {
+    std::remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+std::vector<std::string> list_spilled_calls(const std::string &spill_dir) {
+  std::vector<std::string> files;
+  boost::system::error_code ec;
+  if (!boost::filesystem::is_directory(spill_dir, ec)) return files;
+
+  for (boost::filesystem::directory_iterator it(spill_dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->path().extension() == ".json") files.push_back(it->path().string());
+  }
+  std::sort(files.begin(), files.end());
+  return files;
+}
+
+bool load_spilled_call(const std::string &filename, Call_Data_Ext_t &call_info) {
+  std::ifstream in(filename);
+  if (!in.is_open()) return false;
+
+  bool ok = false;
+  try {
+    ok = call_data_from_json(nlohmann::json::parse(in), call_info);
+  } catch (const std::exception &e) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to parse spill file " << filename << ": " << e.what() << "\033[0m";
+  }
+  in.close();
+  std::remove(filename.c_str());
+  return ok;
+}
+
+// ---------------------------------------------------------------------------
+// Call_Journal
+// ---------------------------------------------------------------------------
+
+static bool write_all(int fd, const char *data, size_t len) {
+  while (len > 0) {
+    ssize_t n = ::write(fd, data, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+Call_Journal::Call_Journal() : d_fd(-1), d_records_since_compact(0) {}
+
+Call_Journal::~Call_Journal() {
+  close();
+}
+
+bool Call_Journal::is_open() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  return d_fd >= 0;
+}
+
+bool Call_Journal::open(const std::string &filename) {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  d_filename = filename;
+  d_fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (d_fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to open call journal " << filename << ": " << strerror(errno) << "\033[0m";
+    return false;
+  }
+  return true;
+}
+
+void Call_Journal::close() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (d_fd < 0) return;
+  write_buffer();
+  ::fdatasync(d_fd);
+  ::close(d_fd);
+  d_fd = -1;
+}
+
+std::vector<Call_Journal::Replayed_Call> Call_Journal::replay() {
+  std::vector<Replayed_Call> calls;
+  std::lock_guard<std::mutex> lock(d_mutex);
+  d_live.clear();
+
+  std::ifstream in(d_filename);
+  std::string line;
+  unsigned long records = 0;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    try {
+      apply(nlohmann::json::parse(line));
+      records++;
+    } catch (const std::exception &e) {
+      // A torn record is expected at the end of the file after a crash
+      BOOST_LOG_TRIVIAL(info) << "Call journal: ignoring unreadable record after " << records << " records";
+      break;
+    }
+  }
+
+  for (auto it = d_live.begin(); it != d_live.end();) {
+    Call_Data_Ext_t call_info;
+    if (!call_data_from_json(it->second.call, call_info)) {
+      it = d_live.erase(it);
+      continue;
+    }
+    if (it->second.state == "retry") {
+      call_info.status = RETRY;
+    } else {
+      // Queued calls are concluded again from the start; rendered calls are
+      // flagged so the concluder only hands them to the plugins again
+      call_info.status = INITIAL;
+      call_info.plugin_retry_list.clear();
+    }
+    calls.push_back(Replayed_Call{call_info, it->second.state == "rendered"});
+    ++it;
+  }
+
+  compact_locked();
+  return calls;
+}
+
+void Call_Journal::apply(const nlohmann::json &record) {
+  const std::string op = record.at("op").get<std::string>();
+  const std::string id = record.at("id").get<std::string>();
+
+  if (op == "queued") {
+    d_live[id] = Live_Call{record.at("call"), record.value("state", "queued")};
+    return;
+  }
+
+  auto it = d_live.find(id);
+  if (it == d_live.end()) return;
+
+  if (op == "rendered") {
+    it->second.state = "rendered";
+    if (record.contains("call_json"))
+      it->second.call["call_json"] = record.at("call_json");
+  } else if (op == "retry") {
+    it->second.state = "retry";
+    it->second.call["retry_attempt"] = record.at("retry_attempt");
+    it->second.call["process_call_time"] = record.at("process_call_time");
+    it->second.call["plugin_retry_list"] = record.at("plugin_retry_list");
+  } else {
+    // uploaded, failed and spilled calls are no longer the journal's concern
+    d_live.erase(it);
+  }
+}
+
+void Call_Journal::append(const nlohmann::json &record) {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (d_fd < 0) return;
+
+  apply(record);
+  d_buffer += record.dump();
+  d_buffer += '\n';
+  d_records_since_compact++;
+
+  if (d_buffer.size() >= MAX_BUFFERED_BYTES) {
+    write_buffer();
+  }
+}
+
+void Call_Journal::record_queued(const Call_Data_Ext_t &call_info) {
+  append({{"op", "queued"}, {"id", call_info.filename}, {"call", call_data_to_json(call_info)}});
+}
+
+void Call_Journal::record_rendered(const Call_Data_Ext_t &call_info) {
+  append({{"op", "rendered"}, {"id", call_info.filename}, {"call_json", call_info.call_json}});
+}
+
+void Call_Journal::record_retry(const Call_Data_Ext_t &call_info) {
+  append({{"op", "retry"},
+          {"id", call_info.filename},
+          {"retry_attempt", call_info.retry_attempt},
+          {"process_call_time", static_cast<long long>(call_info.process_call_time)},
+          {"plugin_retry_list", call_info.plugin_retry_list}});
+}
+
+void Call_Journal::record_uploaded(const Call_Data_Ext_t &call_info) {
+  append({{"op", "uploaded"}, {"id", call_info.filename}});
+}
+
+void Call_Journal::record_failed(const Call_Data_Ext_t &call_info) {
+  append({{"op", "failed"}, {"id", call_info.filename}});
+}
+
+void Call_Journal::record_spilled(const Call_Data_Ext_t &call_info) {
+  append({{"op", "spilled"}, {"id", call_info.filename}});
+}
+
+bool Call_Journal::write_buffer() {
+  if (d_buffer.empty()) return true;
+  if (!write_all(d_fd, d_buffer.data(), d_buffer.size())) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to write call journal " << d_filename << ": " << strerror(errno) << "\033[0m";
+    return false;
+  }
+  d_buffer.clear();
+  return true;
+}
+
+void Call_Journal::flush() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (d_fd < 0) return;
+
+  if (d_records_since_compact >= COMPACT_RECORDS) {
+    compact_locked();
+    return;
+  }
+  if (!d_buffer.empty() && write_buffer()) {
+    ::fdatasync(d_fd);
+  }
+}
+
+void Call_Journal::compact() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  compact_locked();
+}
+
+void Call_Journal::compact_locked() {
+  if (d_fd < 0) return;
+
+  const std::string tmp = d_filename + ".tmp";
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to compact call journal " << d_filename << ": " << strerror(errno) << "\033[0m";
+    write_buffer();
+    return;
+  }
+
+  std::string snapshot;
+  for (const auto &live : d_live) {
+    nlohmann::json record = {{"op", "queued"}, {"id", live.first}, {"state", live.second.state}, {"call", live.second.call}};
+    snapshot += record.dump();
+    snapshot += '\n';
+  }
+
+  if (!write_all(fd, snapshot.data(), snapshot.size()) || ::fsync(fd) != 0) {
+    BOOST_LOG_TRIVIAL(error) << "\033[0;31mUnable to compact call journal " << d_filename << ": " << strerror(errno) << "\033[0m";
+    ::close(fd);
+    std::remove(tmp.c_str());
+    write_buffer();
+    return;
+  }
+
+  if (std::rename(tmp.c_str(), d_filename.c_str()) != 0) {
+    ::close(fd);
+    std::remove(tmp.c_str());
+    write_buffer();
+    return;
+  }
+
+  // Make the rename itself durable
+  const std::string dir = boost::filesystem::path(d_filename).parent_path().string();
+  int dir_fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (dir_fd >= 0) {
+    ::fsync(dir_fd);
+    ::close(dir_fd);
+  }
+
+  // The snapshot already holds everything that was buffered
+  ::close(d_fd);
+  d_fd = fd;
+  ::lseek(d_fd, 0, SEEK_END);
+  d_buffer.clear();
+  d_records_since_compact = 0;
+}
+
+size_t Call_Journal::pending_calls() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  return d_live.size();
+}
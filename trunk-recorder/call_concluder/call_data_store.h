@@ -0,0 +1,83 @@
+#ifndef CALL_DATA_STORE_H
+#define CALL_DATA_STORE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <json.hpp>
+
+#include "../global_structs.h"
+
+// Serialization of Call_Data_Ext_t so that pending calls can be kept on disk
+// while they wait for a concluder worker.
+nlohmann::json call_data_to_json(const Call_Data_Ext_t &call_info);
+bool           call_data_from_json(const nlohmann::json &j, Call_Data_Ext_t &call_info);
+
+// Spill files hold one serialized call each. They are named so that a plain
+// sort returns them oldest first.
+bool                     spill_call_data(const std::string &spill_dir, const Call_Data_Ext_t &call_info);
+std::vector<std::string> list_spilled_calls(const std::string &spill_dir);
+bool                     load_spilled_call(const std::string &filename, Call_Data_Ext_t &call_info);
+
+/*
+ * Append-only journal of the calls the concluder still has to finish.
+ *
+ * Every state change (queued, rendered, waiting for a plugin retry, uploaded,
+ * failed) is appended as one JSON line. Records are buffered and written with
+ * a single fdatasync per flush(), so a crash loses at most the changes since
+ * the last flush. Calls are keyed by their audio filename. compact() rewrites
+ * the file with one snapshot per live call; replay() returns those calls after
+ * a restart.
+ */
+class Call_Journal {
+public:
+  struct Replayed_Call {
+    Call_Data_Ext_t call_info;
+    bool rendered; // audio and call JSON were written before the restart
+  };
+
+  Call_Journal();
+  ~Call_Journal();
+
+  bool is_open();
+  bool open(const std::string &filename);
+  void close();
+
+  std::vector<Replayed_Call> replay();
+
+  void record_queued(const Call_Data_Ext_t &call_info);
+  void record_rendered(const Call_Data_Ext_t &call_info);
+  void record_retry(const Call_Data_Ext_t &call_info);
+  void record_uploaded(const Call_Data_Ext_t &call_info);
+  void record_failed(const Call_Data_Ext_t &call_info);
+  void record_spilled(const Call_Data_Ext_t &call_info);
+
+  void flush();
+  void compact();
+  size_t pending_calls();
+
+private:
+  struct Live_Call {
+    nlohmann::json call;
+    std::string state;
+  };
+
+  static const size_t MAX_BUFFERED_BYTES = 256 * 1024;
+  static const unsigned long COMPACT_RECORDS = 2048;
+
+  std::mutex d_mutex;
+  std::string d_filename;
+  int d_fd;
+  std::string d_buffer;
+  unsigned long d_records_since_compact;
+  std::map<std::string, Live_Call> d_live;
+
+  void append(const nlohmann::json &record);
+  void apply(const nlohmann::json &record);
+  bool write_buffer();
+  void compact_locked();
+};
+
+#endif
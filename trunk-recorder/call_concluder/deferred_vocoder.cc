@@ -0,0 +1,69 @@
+#include "deferred_vocoder.h"
+#include "../gr_blocks/codec_file.h"
+#include "../gr_blocks/wavfile_gr3.8.h"
+
+#include <boost/log/trivial.hpp>
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+
+int vocode_deferred_transmission(const Transmission &t, gr::op25_repeater::imbe_synth::sptr &synth, bool soft_vocoder, const std::string &loghdr) {
+  Codec_File_Type type;
+  int param_count = 0;
+  std::vector<Codec_File_Frame> frames;
+  const std::string codec_filename = codec_file_name(t.filename);
+
+  if (!codec_file_read(codec_filename, type, param_count, frames)) {
+    return -1;
+  }
+  if ((type != CODEC_FILE_P25_IMBE) || (param_count != 10)) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnsupported codec file: " << codec_filename << "\033[0m";
+    return -1;
+  }
+  if (t.sample_count <= 0) {
+    return -1;
+  }
+
+  // The placeholder WAV holds silence wherever the vocoder did not run, so
+  // starting from zeros reproduces it exactly apart from the voice frames.
+  const int frame_len = gr::op25_repeater::imbe_synth::SAMPLES_PER_FRAME;
+  std::vector<int16_t> samples(t.sample_count, 0);
+  int16_t frame_samples[frame_len];
+  if (!synth) {
+    synth = gr::op25_repeater::imbe_synth::make(soft_vocoder);
+  }
+
+  for (const Codec_File_Frame &frame : frames) {
+    // every frame runs through the vocoder, even past the end of the file, so
+    // its state stays in step with what the real-time decoder would have had
+    synth->decode(frame_samples, frame.params, frame.params[8], frame.params[9]);
+    for (int i = 0; i < frame_len; i++) {
+      const size_t pos = (size_t)frame.pos + i;
+      if (pos >= samples.size()) {
+        break;
+      }
+      samples[pos] = frame_samples[i];
+    }
+  }
+
+  // Write next to the WAV and rename over it once everything is on disk, so a
+  // failure part way leaves the placeholder in place rather than a short file
+  const std::string tmp_filename = t.filename + ".tmp";
+  FILE *fp = fopen(tmp_filename.c_str(), "wb");
+  if (!fp) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mUnable to rewrite transmission file: " << tmp_filename << "\033[0m";
+    return -1;
+  }
+  bool ok = gr::blocks::wavheader_write(fp, 8000, 1, 2);
+  ok = ok && (gr::blocks::wav_write_samples(fp, samples.data(), samples.size(), 2) == samples.size());
+  ok = ok && gr::blocks::wavheader_complete(fp, samples.size() * 2);
+  ok = (fclose(fp) == 0) && ok;
+  ok = ok && (rename(tmp_filename.c_str(), t.filename.c_str()) == 0);
+
+  if (!ok) {
+    BOOST_LOG_TRIVIAL(error) << loghdr << "\033[0;31mFailed to write vocoded transmission: " << t.filename << "\033[0m";
+    unlink(tmp_filename.c_str());
+    return -1;
+  }
+  return 0;
+}
@@ -0,0 +1,18 @@
+#ifndef DEFERRED_VOCODER_H
+#define DEFERRED_VOCODER_H
+
+#include "../global_structs.h"
+
+#include <op25_repeater/include/op25_repeater/imbe_synth.h>
+
+#include <string>
+
+// Vocode the frames a transmission_sink saved in a transmission's codec file
+// and write the audio over the placeholder silence in its WAV file. Returns 0
+// on success; on failure the WAV file is left as it was.
+//
+// Pass the same synth for every transmission of a call: it is made with the
+// first one that has frames and carries the vocoder state between them.
+int vocode_deferred_transmission(const Transmission &t, gr::op25_repeater::imbe_synth::sptr &synth, bool soft_vocoder, const std::string &loghdr);
+
+#endif
@@ -17,6 +17,8 @@ using namespace std;
 // Global log sink for SIGHUP rotation support
 boost::shared_ptr<sinks::synchronous_sink<sinks::text_file_backend>> global_log_sink;
 
+Config_Ext config_ext;
+
 void set_logging_level(std::string log_level) {
   boost::log::trivial::severity_level sev_level = boost::log::trivial::info;
 
@@ -182,6 +184,12 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
 
     config.archive_files_on_failure = data.value("archiveFilesOnFailure", false);
     BOOST_LOG_TRIVIAL(info) << "Archive Files on Failure: " << config.archive_files_on_failure;
+    config_ext.call_concluder_workers = data.value("callConcluderWorkers", 0);
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Workers: " << (config_ext.call_concluder_workers > 0 ? std::to_string(config_ext.call_concluder_workers) : "(auto)");
+    config_ext.call_concluder_queue_size = data.value("callConcluderQueueSize", 200);
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Queue Size: " << config_ext.call_concluder_queue_size;
+    config_ext.call_concluder_overflow = data.value("callConcluderOverflow", "dropOldest");
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Overflow: " << config_ext.call_concluder_overflow;
 
     config.capture_dir = data.value("captureDir", boost::filesystem::current_path().string());
     pos = config.capture_dir.find_last_of("/");
@@ -191,12 +199,25 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
     }
 
     BOOST_LOG_TRIVIAL(info) << "Capture Directory: " << config.capture_dir;
+    config_ext.call_concluder_spill_dir = data.value("callConcluderSpillDir", config.capture_dir + "/.concluder_spill");
+    BOOST_LOG_TRIVIAL(info) << "Call Concluder Spill Directory: " << config_ext.call_concluder_spill_dir;
+    config_ext.call_journal = data.value("callJournal", true);
+    BOOST_LOG_TRIVIAL(info) << "Call Journal: " << config_ext.call_journal;
+    config_ext.upload_max_host_connections = data.value("uploadMaxHostConnections", 4);
+    BOOST_LOG_TRIVIAL(info) << "Upload Max Connections per Host: " << config_ext.upload_max_host_connections;
+    config_ext.upload_max_connections = data.value("uploadMaxConnections", 16);
+    BOOST_LOG_TRIVIAL(info) << "Upload Max Connections: " << config_ext.upload_max_connections;
     config.upload_server = data.value("uploadServer", "");
     BOOST_LOG_TRIVIAL(info) << "Upload Server: " << config.upload_server;
     config.bcfy_calls_server = data.value("broadcastifyCallsServer", "");
     BOOST_LOG_TRIVIAL(info) << "Broadcastify Calls Server: " << config.bcfy_calls_server;
     config.status_server = data.value("statusServer", "");
     BOOST_LOG_TRIVIAL(info) << "Status Server: " << config.status_server;
+    config_ext.metrics_port = data.value("metricsPort", 0);
+    config_ext.metrics_address = data.value("metricsAddress", "127.0.0.1");
+    if (config_ext.metrics_port > 0) {
+      BOOST_LOG_TRIVIAL(info) << "Metrics Endpoint: http://" << config_ext.metrics_address << ":" << config_ext.metrics_port << "/metrics";
+    }
     config.instance_key = data.value("instanceKey", "");
     BOOST_LOG_TRIVIAL(info) << "Instance Key: " << config.instance_key;
     config.instance_id = data.value("instanceId", "");
@@ -213,6 +234,8 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
     BOOST_LOG_TRIVIAL(info) << "Control channel retune limit: " << config.control_retune_limit;
     config.soft_vocoder = data.value("softVocoder", false);
     BOOST_LOG_TRIVIAL(info) << "Phase 1 Software Vocoder: " << config.soft_vocoder;
+    config_ext.deferred_vocoding = data.value("deferredVocoding", false);
+    BOOST_LOG_TRIVIAL(info) << "Phase 1 Deferred Vocoding: " << config_ext.deferred_vocoding;
     config.enable_audio_streaming = data.value("audioStreaming", false);
     BOOST_LOG_TRIVIAL(info) << "Enable Audio Streaming: " << config.enable_audio_streaming;
     config.record_uu_v_calls = data.value("recordUUVCalls", true);
@@ -735,7 +758,7 @@ bool load_config(string config_file, Config &config, gr::top_block_sptr &tb, std
     add_internal_plugin("openmhz_uploader", "libopenmhz_uploader.so", data);
     add_internal_plugin("broadcastify_uploader", "libbroadcastify_uploader.so", data);
     add_internal_plugin("unit_script", "libunit_script.so", data);
-    initialize_plugins(data, &config, sources, systems);
+    initialize_plugins(data, &config, config_ext, sources, systems);
   } catch (std::exception const &e) {
     BOOST_LOG_TRIVIAL(error) << "Failed parsing Config: " << e.what();
     return false;
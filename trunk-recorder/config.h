@@ -33,6 +33,8 @@
 
 #include <json.hpp>
 
+extern Config_Ext config_ext;
+
 bool load_config(std::string config_file, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<System *> &systems);
 
 #endif
\ No newline at end of file
@@ -8,6 +8,27 @@
 
 const int DB_UNSET = 999;
 
+// Transmission, Config and Call_Data_t are handed to plugins, and plugins
+// built against the v1 headers still load, so their layout is frozen. Data
+// added since lives in Config_Ext and Call_Data_Ext_t, which plugins never
+// see.
+
+// K-weighted mean square of each EBU R128 measurement window, collected
+// while a transmission is being recorded.
+struct Loudness_Blocks {
+  std::vector<float> momentary;  // 400 ms gating blocks, 100 ms apart
+  std::vector<float> short_term; // 3 s windows, 100 ms apart
+  double true_peak = 0.0;        // linear, 1.0 = full scale
+};
+
+struct Loudness_Measurement {
+  bool valid = false;
+  double integrated = 0.0; // LUFS
+  double true_peak = 0.0;  // dBTP
+  double lra = 0.0;        // LU
+  double threshold = 0.0;  // LUFS, relative gating threshold
+};
+
 struct Transmission {
   long source;
   long talkgroup;
@@ -57,6 +78,21 @@ struct Config {
   std::string filename_format;
 };
 
+// Settings read by trunk-recorder itself, filled in by load_config() along
+// with Config.
+struct Config_Ext {
+  bool deferred_vocoding;
+  int call_concluder_workers;
+  int call_concluder_queue_size;
+  std::string call_concluder_overflow;
+  std::string call_concluder_spill_dir;
+  bool call_journal;
+  int upload_max_host_connections;
+  int upload_max_connections;
+  int metrics_port;
+  std::string metrics_address;
+};
+
 struct Audio_Postprocess_Config {
   bool enabled = false;
 
@@ -178,4 +214,12 @@ struct Call_Data_t {
   nlohmann::ordered_json call_json;
 };
 
+// What the call concluder keeps about a call. Plugins are handed the
+// Call_Data_t part.
+struct Call_Data_Ext_t : Call_Data_t {
+  int talkgroup_priority;
+  bool soft_vocoder; // which IMBE vocoder plays back deferred transmissions
+  Loudness_Measurement loudness;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "codec_file.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/log/trivial.hpp>
+#include <cstdio>
+
+static const uint32_t CODEC_FILE_MAGIC = 0x43445254; // "TRDC"
+static const uint32_t CODEC_FILE_VERSION = 1;
+
+static bool write_u32(FILE *fp, uint32_t v) {
+  unsigned char buf[4] = {(unsigned char)v, (unsigned char)(v >> 8), (unsigned char)(v >> 16), (unsigned char)(v >> 24)};
+  return fwrite(buf, 1, 4, fp) == 4;
+}
+
+static bool read_u32(FILE *fp, uint32_t &v) {
+  unsigned char buf[4];
+  if (fread(buf, 1, 4, fp) != 4) {
+    return false;
+  }
+  v = (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+  return true;
+}
+
+std::string codec_file_name(const std::string &wav_filename) {
+  return boost::filesystem::path(wav_filename).replace_extension(".codec").string();
+}
+
+bool codec_file_write(const std::string &filename, Codec_File_Type type, int param_count, const std::vector<Codec_File_Frame> &frames) {
+  if ((param_count < 1) || (param_count > CODEC_FILE_MAX_PARAMS)) {
+    return false;
+  }
+  FILE *fp = fopen(filename.c_str(), "wb");
+  if (!fp) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to create codec file: " << filename;
+    return false;
+  }
+  bool ok = write_u32(fp, CODEC_FILE_MAGIC) && write_u32(fp, CODEC_FILE_VERSION) && write_u32(fp, type) && write_u32(fp, param_count);
+  for (size_t i = 0; ok && (i < frames.size()); i++) {
+    ok = write_u32(fp, frames[i].pos);
+    for (int j = 0; ok && (j < param_count); j++) {
+      ok = write_u32(fp, frames[i].params[j]);
+    }
+  }
+  if (fclose(fp) != 0) {
+    ok = false;
+  }
+  if (!ok) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to write codec file: " << filename;
+  }
+  return ok;
+}
+
+bool codec_file_read(const std::string &filename, Codec_File_Type &type, int &param_count, std::vector<Codec_File_Frame> &frames) {
+  FILE *fp = fopen(filename.c_str(), "rb");
+  if (!fp) {
+    BOOST_LOG_TRIVIAL(error) << "Unable to open codec file: " << filename;
+    return false;
+  }
+  uint32_t magic, version, file_type, count;
+  if (!read_u32(fp, magic) || !read_u32(fp, version) || !read_u32(fp, file_type) || !read_u32(fp, count) ||
+      (magic != CODEC_FILE_MAGIC) || (version != CODEC_FILE_VERSION) || (count < 1) || (count > CODEC_FILE_MAX_PARAMS)) {
+    BOOST_LOG_TRIVIAL(error) << "Invalid codec file header: " << filename;
+    fclose(fp);
+    return false;
+  }
+  type = (Codec_File_Type)file_type;
+  param_count = count;
+  frames.clear();
+
+  Codec_File_Frame frame = {};
+  while (read_u32(fp, frame.pos)) {
+    for (uint32_t j = 0; j < count; j++) {
+      if (!read_u32(fp, frame.params[j])) {
+        BOOST_LOG_TRIVIAL(error) << "Truncated codec file: " << filename;
+        fclose(fp);
+        return false;
+      }
+    }
+    frames.push_back(frame);
+  }
+  fclose(fp);
+  return true;
+}
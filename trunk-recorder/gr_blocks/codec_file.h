@@ -0,0 +1,34 @@
+#ifndef CODEC_FILE_H
+#define CODEC_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * Container for the vocoder parameters of a transmission, written when
+ * vocoding is deferred until the call is concluded.
+ *
+ * The file is a fixed header followed by one record per voice frame. Each
+ * record holds the sample position of the frame in the transmission's WAV
+ * file and the codec's parameter words. All fields are little endian uint32.
+ */
+enum Codec_File_Type {
+  CODEC_FILE_P25_IMBE = 0 // u0..u7, E0, ET
+};
+
+static const int CODEC_FILE_MAX_PARAMS = 10;
+
+struct Codec_File_Frame {
+  uint32_t pos; // sample offset of the frame in the WAV file
+  uint32_t params[CODEC_FILE_MAX_PARAMS];
+};
+
+// The codec file kept next to a transmission's WAV file. A transmission is
+// vocoded when its call is concluded if this file exists.
+std::string codec_file_name(const std::string &wav_filename);
+
+bool codec_file_write(const std::string &filename, Codec_File_Type type, int param_count, const std::vector<Codec_File_Frame> &frames);
+bool codec_file_read(const std::string &filename, Codec_File_Type &type, int &param_count, std::vector<Codec_File_Frame> &frames);
+
+#endif
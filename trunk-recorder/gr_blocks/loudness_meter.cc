@@ -0,0 +1,249 @@
+#include "loudness_meter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+// Absolute and relative gates from EBU R128 / EBU Tech 3342
+static const double ABSOLUTE_GATE_LUFS = -70.0;
+static const double INTEGRATED_RELATIVE_GATE_LU = -10.0;
+static const double LRA_RELATIVE_GATE_LU = -20.0;
+
+static double energy_to_lufs(double energy) {
+  return -0.691 + 10.0 * std::log10(energy);
+}
+
+static double lufs_to_energy(double lufs) {
+  return std::pow(10.0, (lufs + 0.691) / 10.0);
+}
+
+// Polyphase windowed-sinc interpolator used for the true peak measurement.
+// Phase p uses taps p, p + OVERSAMPLE, p + 2 * OVERSAMPLE, ...
+static const std::array<float, Loudness_Meter::OVERSAMPLE * Loudness_Meter::TAPS_PER_PHASE> &interpolator_taps() {
+  static const auto taps = []() {
+    const int len = Loudness_Meter::OVERSAMPLE * Loudness_Meter::TAPS_PER_PHASE;
+    const double center = (len - 1) / 2.0;
+    std::array<float, Loudness_Meter::OVERSAMPLE * Loudness_Meter::TAPS_PER_PHASE> t;
+    for (int n = 0; n < len; n++) {
+      const double x = (n - center) / Loudness_Meter::OVERSAMPLE;
+      const double sinc = (x == 0.0) ? 1.0 : std::sin(M_PI * x) / (M_PI * x);
+      const double window = 0.42 - 0.5 * std::cos(2.0 * M_PI * n / (len - 1)) + 0.08 * std::cos(4.0 * M_PI * n / (len - 1));
+      t[n] = (float)(sinc * window);
+    }
+    return t;
+  }();
+  return taps;
+}
+
+Loudness_Meter::Loudness_Meter() {
+  reset(8000, 1);
+}
+
+void Loudness_Meter::reset(unsigned int sample_rate, int nchans) {
+  const double rate = (double)sample_rate;
+
+  // BS.1770 pre-filter (high shelf) and RLB weighting (high pass), derived
+  // for the actual sample rate from the analog prototypes.
+  double f0 = 1681.974450955533;
+  double gain_db = 3.999843853973347;
+  double q = 0.7071752369554196;
+  double k = std::tan(M_PI * f0 / rate);
+  const double vh = std::pow(10.0, gain_db / 20.0);
+  const double vb = std::pow(vh, 0.4996667741545416);
+  double a0 = 1.0 + k / q + k * k;
+  d_stage[0].b0 = (vh + vb * k / q + k * k) / a0;
+  d_stage[0].b1 = 2.0 * (k * k - vh) / a0;
+  d_stage[0].b2 = (vh - vb * k / q + k * k) / a0;
+  d_stage[0].a1 = 2.0 * (k * k - 1.0) / a0;
+  d_stage[0].a2 = (1.0 - k / q + k * k) / a0;
+
+  f0 = 38.13547087602444;
+  q = 0.5003270373238773;
+  k = std::tan(M_PI * f0 / rate);
+  a0 = 1.0 + k / q + k * k;
+  d_stage[1].b0 = 1.0;
+  d_stage[1].b1 = -2.0;
+  d_stage[1].b2 = 1.0;
+  d_stage[1].a1 = 2.0 * (k * k - 1.0) / a0;
+  d_stage[1].a2 = (1.0 - k / q + k * k) / a0;
+
+  d_nchans = std::max(nchans, 1);
+  d_channels.assign(d_nchans, Channel_State());
+  for (auto &ch : d_channels) {
+    ch.z1[0] = ch.z1[1] = 0.0;
+    ch.z2[0] = ch.z2[1] = 0.0;
+    ch.history.fill(0.0f);
+    ch.history_pos = 0;
+  }
+
+  d_sub_block_len = std::max<int>(1, sample_rate / 10);
+  d_sub_block_count = 0;
+  d_sub_block_energy = 0.0;
+  d_sub_blocks.fill(0.0);
+  d_sub_blocks_seen = 0;
+  d_blocks = Loudness_Blocks();
+}
+
+double Loudness_Meter::true_peak(Channel_State &ch, float x) {
+  const auto &taps = interpolator_taps();
+
+  ch.history[ch.history_pos] = x;
+  double peak = 0.0;
+  for (int phase = 0; phase < OVERSAMPLE; phase++) {
+    float acc = 0.0f;
+    int pos = ch.history_pos;
+    for (int j = 0; j < TAPS_PER_PHASE; j++) {
+      acc += taps[phase + j * OVERSAMPLE] * ch.history[pos];
+      pos = (pos == 0) ? TAPS_PER_PHASE - 1 : pos - 1;
+    }
+    peak = std::max(peak, (double)std::fabs(acc));
+  }
+  ch.history_pos = (ch.history_pos + 1) % TAPS_PER_PHASE;
+  return peak;
+}
+
+void Loudness_Meter::process(const int16_t *samples, int frames) {
+  for (int i = 0; i < frames; i++) {
+    for (int c = 0; c < d_nchans; c++) {
+      Channel_State &ch = d_channels[c];
+      const double x = samples[i * d_nchans + c] / 32768.0;
+
+      // Two direct form II transposed biquads
+      double y = x;
+      for (int s = 0; s < 2; s++) {
+        const Biquad &bq = d_stage[s];
+        const double out = bq.b0 * y + ch.z1[s];
+        ch.z1[s] = bq.b1 * y - bq.a1 * out + ch.z2[s];
+        ch.z2[s] = bq.b2 * y - bq.a2 * out;
+        y = out;
+      }
+      d_sub_block_energy += y * y;
+
+      d_blocks.true_peak = std::max(d_blocks.true_peak, true_peak(ch, (float)x));
+    }
+
+    if (++d_sub_block_count == d_sub_block_len) {
+      end_sub_block();
+    }
+  }
+}
+
+void Loudness_Meter::end_sub_block() {
+  d_sub_blocks[d_sub_blocks_seen % SHORT_TERM_SUB_BLOCKS] = d_sub_block_energy;
+  d_sub_blocks_seen++;
+  d_sub_block_energy = 0.0;
+  d_sub_block_count = 0;
+
+  auto window_energy = [this](int sub_blocks) {
+    double sum = 0.0;
+    for (int i = 1; i <= sub_blocks; i++) {
+      sum += d_sub_blocks[(d_sub_blocks_seen - i) % SHORT_TERM_SUB_BLOCKS];
+    }
+    return sum / ((double)sub_blocks * d_sub_block_len);
+  };
+
+  if (d_sub_blocks_seen >= MOMENTARY_SUB_BLOCKS) {
+    d_blocks.momentary.push_back((float)window_energy(MOMENTARY_SUB_BLOCKS));
+  }
+  if (d_sub_blocks_seen >= SHORT_TERM_SUB_BLOCKS) {
+    d_blocks.short_term.push_back((float)window_energy(SHORT_TERM_SUB_BLOCKS));
+  }
+}
+
+Loudness_Blocks Loudness_Meter::take_blocks() {
+  Loudness_Blocks blocks = std::move(d_blocks);
+  d_blocks = Loudness_Blocks();
+  return blocks;
+}
+
+static std::mutex pending_mutex;
+static std::map<std::string, Loudness_Blocks> pending_blocks;
+
+void store_transmission_loudness(const std::string &filename, Loudness_Blocks blocks) {
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  pending_blocks[filename] = std::move(blocks);
+}
+
+Loudness_Blocks take_transmission_loudness(const std::string &filename) {
+  std::lock_guard<std::mutex> lock(pending_mutex);
+  Loudness_Blocks blocks;
+  std::map<std::string, Loudness_Blocks>::iterator it = pending_blocks.find(filename);
+  if (it != pending_blocks.end()) {
+    blocks = std::move(it->second);
+    pending_blocks.erase(it);
+  }
+  return blocks;
+}
+
+Loudness_Measurement measure_loudness(const std::vector<Loudness_Blocks> &transmissions) {
+  Loudness_Measurement m;
+  const double abs_gate = lufs_to_energy(ABSOLUTE_GATE_LUFS);
+
+  // Integrated loudness: absolute gate, then relative gate
+  double sum = 0.0;
+  long count = 0;
+  double peak = 0.0;
+  for (const auto &t : transmissions) {
+    peak = std::max(peak, t.true_peak);
+    for (float e : t.momentary) {
+      if (e > abs_gate) {
+        sum += e;
+        count++;
+      }
+    }
+  }
+  if (count == 0) {
+    return m;
+  }
+
+  const double rel_gate = (sum / count) * std::pow(10.0, INTEGRATED_RELATIVE_GATE_LU / 10.0);
+  const double gate = std::max(abs_gate, rel_gate);
+  sum = 0.0;
+  count = 0;
+  for (const auto &t : transmissions) {
+    for (float e : t.momentary) {
+      if (e > gate) {
+        sum += e;
+        count++;
+      }
+    }
+  }
+  if (count == 0) {
+    return m;
+  }
+  m.integrated = energy_to_lufs(sum / count);
+  m.threshold = energy_to_lufs(rel_gate);
+  m.true_peak = 20.0 * std::log10(std::max(peak, 1e-10));
+
+  // Loudness range: 10th to 95th percentile of the gated short-term values
+  std::vector<double> short_term;
+  double st_sum = 0.0;
+  for (const auto &t : transmissions) {
+    for (float e : t.short_term) {
+      if (e > abs_gate) {
+        short_term.push_back(e);
+        st_sum += e;
+      }
+    }
+  }
+  if (!short_term.empty()) {
+    const double st_gate = (st_sum / short_term.size()) * std::pow(10.0, LRA_RELATIVE_GATE_LU / 10.0);
+    std::vector<double> gated;
+    gated.reserve(short_term.size());
+    for (double e : short_term) {
+      if (e > st_gate) {
+        gated.push_back(energy_to_lufs(e));
+      }
+    }
+    if (gated.size() > 1) {
+      std::sort(gated.begin(), gated.end());
+      const size_t low = (size_t)std::lround(0.10 * (gated.size() - 1));
+      const size_t high = (size_t)std::lround(0.95 * (gated.size() - 1));
+      m.lra = gated[high] - gated[low];
+    }
+  }
+
+  m.valid = std::isfinite(m.integrated) && std::isfinite(m.true_peak);
+  return m;
+}
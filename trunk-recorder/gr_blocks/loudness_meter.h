@@ -0,0 +1,67 @@
+#ifndef LOUDNESS_METER_H
+#define LOUDNESS_METER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../global_structs.h"
+
+/*
+ * Incremental EBU R128 / ITU-R BS.1770 loudness meter.
+ *
+ * Samples are K-weighted as they are written and folded into 100 ms
+ * sub-blocks. Every completed sub-block emits a 400 ms momentary block and a
+ * 3 s short-term block, so gating can be done later over a whole call without
+ * keeping the audio around. True peak is measured with 4x oversampling.
+ */
+class Loudness_Meter {
+public:
+  static const int OVERSAMPLE = 4;
+  static const int TAPS_PER_PHASE = 12;
+
+  Loudness_Meter();
+  void reset(unsigned int sample_rate, int nchans);
+  void process(const int16_t *samples, int frames); // interleaved
+  Loudness_Blocks take_blocks();
+
+private:
+  struct Biquad {
+    double b0, b1, b2, a1, a2;
+  };
+  struct Channel_State {
+    double z1[2];
+    double z2[2];
+    std::array<float, TAPS_PER_PHASE> history;
+    int history_pos;
+  };
+
+  static const int SHORT_TERM_SUB_BLOCKS = 30;
+  static const int MOMENTARY_SUB_BLOCKS = 4;
+
+  Biquad d_stage[2];
+  std::vector<Channel_State> d_channels;
+  int d_nchans;
+  int d_sub_block_len;
+  int d_sub_block_count;
+  double d_sub_block_energy;
+  std::array<double, SHORT_TERM_SUB_BLOCKS> d_sub_blocks;
+  long d_sub_blocks_seen;
+  Loudness_Blocks d_blocks;
+
+  void end_sub_block();
+  double true_peak(Channel_State &ch, float x);
+};
+
+// Blocks of recorded transmissions that have not been concluded yet, keyed
+// by the transmission's filename. Transmission keeps the layout plugins were
+// built against, so the blocks reach the call concluder through here.
+void            store_transmission_loudness(const std::string &filename, Loudness_Blocks blocks);
+Loudness_Blocks take_transmission_loudness(const std::string &filename);
+
+// Gate the blocks of every transmission in a call and compute the integrated
+// loudness, loudness range and true peak.
+Loudness_Measurement measure_loudness(const std::vector<Loudness_Blocks> &transmissions);
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "transmission_sink.h"
 #include "../../trunk-recorder/call.h"
+#include "../../trunk-recorder/systems/system.h"
 #include <boost/filesystem.hpp>
 #include <boost/math/special_functions/round.hpp>
 #include <climits>
@@ -53,6 +54,9 @@
 #define OUR_O_LARGEFILE 0
 #endif // ifdef O_LARGEFILE
 
+// Size of the stdio buffer attached to each WAV file
+#define WAV_FILE_BUF_SIZE 1000000
+
 namespace gr {
 namespace blocks {
 transmission_sink::sptr
@@ -67,6 +71,7 @@ transmission_sink::transmission_sink(int n_channels, unsigned int sample_rate, i
       d_sample_rate(sample_rate),
       d_nchans(n_channels),
       d_current_call(NULL),
+      d_file_buf(WAV_FILE_BUF_SIZE),
       d_fp(0) {
 
   if ((bits_per_sample != 8) && (bits_per_sample != 16)) {
@@ -76,9 +81,16 @@ transmission_sink::transmission_sink(int n_channels, unsigned int sample_rate, i
   d_sample_count = 0;
   d_slot = -1;
   d_termination_flag = false;
+  d_measure_loudness = false;
+  d_bytes_metric = Metrics::counter("trunk_recorder_audio_bytes_written", "Bytes of audio written to WAV files");
+  d_transmissions_metric = Metrics::counter("trunk_recorder_transmissions", "Transmissions recorded");
   state = AVAILABLE;
 }
 
+std::string transmission_sink::call_log_header() {
+  return log_header(d_current_call_short_name, d_current_call_num, d_current_call_talkgroup_display, d_current_call_freq);
+}
+
 void transmission_sink::create_filename() {
   using std::ostringstream;
   using std::setw;
@@ -158,6 +170,10 @@ bool transmission_sink::start_recording(Call *call) {
   }
   d_current_call_short_name = call->get_short_name();
   d_current_call_temp_dir = call->get_temp_dir();
+
+  // Loudness is measured while recording so the concluder can normalize in a single pass
+  System *sys = call->get_system();
+  d_measure_loudness = sys && sys->get_audio_postprocess_enabled() && sys->get_audio_loudnorm();
   d_prior_transmission_length = 0;
   d_error_count = 0;
   d_spike_count = 0;
@@ -174,8 +190,7 @@ bool transmission_sink::start_recording(Call *call) {
   // when a wav_sink first gets associated with a call, set its lifecycle to idle;
   state = IDLE;
   /* Should reset more variables here */
-  std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
-  BOOST_LOG_TRIVIAL(trace) << loghdr << "Starting wavfile sink SRC ID: " << curr_src_id << " Conventional: " << d_conventional;
+  BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Starting wavfile sink SRC ID: " << curr_src_id << " Conventional: " << d_conventional;
 
   return true;
 }
@@ -196,8 +211,8 @@ bool transmission_sink::open_internal(const char *filename) {
   if (d_fp) { // if we've already got a new one open, close it
     BOOST_LOG_TRIVIAL(trace) << "File pointer already open, closing " << d_fp << " more" << current_filename << " for " << filename << std::endl;
 
-    // fclose(d_fp);
-    // d_fp = NULL;
+    // the stdio buffer is shared between files, so the old one has to be closed first
+    close_wav(false);
   }
 
   if ((d_fp = fdopen(fd, "rb+")) == NULL) {
@@ -206,10 +221,14 @@ bool transmission_sink::open_internal(const char *filename) {
     BOOST_LOG_TRIVIAL(error) << "wav open failed" << std::endl;
     return false;
   }
-  if (std::setvbuf(d_fp, nullptr, _IOFBF, 1000000) != 0) {
+  if (std::setvbuf(d_fp, d_file_buf.data(), _IOFBF, d_file_buf.size()) != 0) {
     BOOST_LOG_TRIVIAL(error) << "setvbuf failed"; // POSIX version sets errno
   }
   d_sample_count = 0;
+  d_codec_frames.clear();
+  if (d_measure_loudness) {
+    d_loudness_meter.reset(d_sample_rate, d_nchans);
+  }
 
   if (!wavheader_write(d_fp, d_sample_rate, d_nchans, d_bytes_per_sample)) {
     fprintf(stderr, "[%s] could not write to WAV file\n", __FILE__);
@@ -232,17 +251,16 @@ bool transmission_sink::open_internal(const char *filename) {
 }
 
 void transmission_sink::set_source(long src) {
-  std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
   if (curr_src_id == -1) {
 
-    BOOST_LOG_TRIVIAL(info) << loghdr << "Unit ID set via Control Channel, ext: " << src << "\tcurrent: " << curr_src_id << "\t samples: " << d_sample_count;
+    BOOST_LOG_TRIVIAL(info) << call_log_header() << "Unit ID set via Control Channel, ext: " << src << "\tcurrent: " << curr_src_id << "\t samples: " << d_sample_count;
 
     curr_src_id = src;
   } else  if (src != curr_src_id) {
     if (d_conventional) {
       if ((state == RECORDING) && (d_sample_count > 0)) {
           gr::thread::scoped_lock guard(d_mutex);
-          BOOST_LOG_TRIVIAL(error) << loghdr << "Unit ID externally set, ext: " << src << "\tcurrent: " << curr_src_id << "\t samples: " << d_sample_count;
+          BOOST_LOG_TRIVIAL(error) << call_log_header() << "Unit ID externally set, ext: " << src << "\tcurrent: " << curr_src_id << "\t samples: " << d_sample_count;
           end_transmission();
           state = IDLE;
           curr_src_id = src;
@@ -250,20 +268,19 @@ void transmission_sink::set_source(long src) {
 
     } else {
       // this is a trunked system, where the existing source ID does not match the ID that just came in as a GRANT message
-      BOOST_LOG_TRIVIAL(error) << loghdr << "Unit ID externally set from GRANT: " << src << "\t caching, doesn't match current: " << curr_src_id << "\t samples: " << d_sample_count << "\t state: " << format_state(state);
+      BOOST_LOG_TRIVIAL(error) << call_log_header() << "Unit ID externally set from GRANT: " << src << "\t caching, doesn't match current: " << curr_src_id << "\t samples: " << d_sample_count << "\t state: " << format_state(state);
       cached_src_id = src;      
     }
   }
 }
 
 void transmission_sink::end_transmission() {
-  std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
   
   if (d_sample_count > 0) {
     if (d_fp) {
       close_wav(false);
     } else {
-      BOOST_LOG_TRIVIAL(error) << loghdr <<  "Ending transmission, sample_count is greater than 0 but d_fp is null" << std::endl;
+      BOOST_LOG_TRIVIAL(error) << call_log_header() <<  "Ending transmission, sample_count is greater than 0 but d_fp is null" << std::endl;
     }
 
     const std::int64_t dur_ms = (d_nchans > 0)
@@ -277,11 +294,12 @@ void transmission_sink::end_transmission() {
 
     // Build Transmission using the canonical fields
     Transmission transmission;
+    d_transmissions_metric->inc();
 
     // if we don't have a curr_src_id and we cached one in the previous transmission, use it
     if ((curr_src_id == -1) && (cached_src_id != -1 )) {
       transmission.source = cached_src_id;
-      BOOST_LOG_TRIVIAL(info) << loghdr << "Using cached ID: " << cached_src_id << " for Transmission: " << sizeof(transmission_list);
+      BOOST_LOG_TRIVIAL(info) << call_log_header() << "Using cached ID: " << cached_src_id << " for Transmission: " << sizeof(transmission_list);
       cached_src_id = -1;
       
     } else {
@@ -304,6 +322,14 @@ void transmission_sink::end_transmission() {
     d_prior_transmission_length = d_prior_transmission_length + transmission.length;
     transmission.filename = current_filename;
     transmission.talkgroup = d_current_call_talkgroup;
+    if (d_measure_loudness) {
+      store_transmission_loudness(current_filename, d_loudness_meter.take_blocks());
+    }
+    if (!d_codec_frames.empty()) {
+      // the WAV file only holds placeholder silence, the call concluder vocodes these frames into it
+      codec_file_write(codec_file_name(current_filename), CODEC_FILE_P25_IMBE, 10, d_codec_frames);
+      d_codec_frames.clear();
+    }
 
     BOOST_LOG_TRIVIAL(debug) << "Adding transmission: " << transmission.filename << " Slot: " << transmission.slot << " Talkgroup: " << transmission.talkgroup << " Length: " << transmission.length << " Samples: " << d_sample_count;
     this->add_transmission(transmission);
@@ -360,8 +386,7 @@ State transmission_sink::get_state() {
 int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
 
   gr::thread::scoped_lock guard(d_mutex); // hold mutex for duration of this function
-  std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
-  
+
   // it is possible that we could get part of a transmission after a call has stopped. We shouldn't do any recording if this happens.... this could mean that we miss part of the recording though
   if (!d_current_call) {
     time_t now = time(NULL);
@@ -370,9 +395,9 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
     // It is possible the P25 Frame Assembler passes a TDU after the call has timed out.
     // In this case, the termination tag will be transferred on a blank sample and can safely be ignored.
     if (noutput_items == 1) {
-      BOOST_LOG_TRIVIAL(trace) << loghdr << "Dropping " << noutput_items << " samples - current_call is null\t Rec State: " << format_state(this->state) << "\tSince close: " << its_been;
+      BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Dropping " << noutput_items << " samples - current_call is null\t Rec State: " << format_state(this->state) << "\tSince close: " << its_been;
     } else {
-      BOOST_LOG_TRIVIAL(error) << loghdr << "Dropping " << noutput_items << " samples - current_call is null\t Rec State: " << format_state(this->state) << "\tSince close: " << its_been;
+      BOOST_LOG_TRIVIAL(error) << call_log_header() << "Dropping " << noutput_items << " samples - current_call is null\t Rec State: " << format_state(this->state) << "\tSince close: " << its_been;
     }
 
     return noutput_items;
@@ -382,7 +407,7 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
   if ((state == STOPPED) || (state == AVAILABLE)) {
     if (noutput_items > 1) {
 
-      BOOST_LOG_TRIVIAL(error) << loghdr << "Dropping " << noutput_items << " samples - Recorder state is: " << format_state(this->state);
+      BOOST_LOG_TRIVIAL(error) << call_log_header() << "Dropping " << noutput_items << " samples - Recorder state is: " << format_state(this->state);
 
       // BOOST_LOG_TRIVIAL(info) << "WAV - state is: " << format_state(this->state) << "\t Dropping samples: " << noutput_items << " Since close: " << its_been << std::endl;
     }
@@ -390,18 +415,20 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
   }
 
   std::vector<gr::tag_t> tags;
-  pmt::pmt_t src_id_key(pmt::intern("src_id")); // This is the src id from Phase 1, Phase 2 and DMR
-  pmt::pmt_t grp_id_key(pmt::intern("grp_id")); // This is the talkgroup id from Phase 1, Phase 2 and DMR
-  pmt::pmt_t cc_key(pmt::intern("cc"));         // This is the channel color code from DMR
-  pmt::pmt_t terminate_key(pmt::intern("terminate"));
-  pmt::pmt_t spike_count_key(pmt::intern("spike_count"));
-  pmt::pmt_t error_count_key(pmt::intern("error_count"));
+  static const pmt::pmt_t src_id_key(pmt::intern("src_id")); // This is the src id from Phase 1, Phase 2 and DMR
+  static const pmt::pmt_t grp_id_key(pmt::intern("grp_id")); // This is the talkgroup id from Phase 1, Phase 2 and DMR
+  static const pmt::pmt_t cc_key(pmt::intern("cc"));         // This is the channel color code from DMR
+  static const pmt::pmt_t terminate_key(pmt::intern("terminate"));
+  static const pmt::pmt_t spike_count_key(pmt::intern("spike_count"));
+  static const pmt::pmt_t error_count_key(pmt::intern("error_count"));
+  static const pmt::pmt_t imbe_key(pmt::intern("imbe")); // Deferred Phase 1 voice frame: u0..u7, E0, ET
 
   // pmt::pmt_t squelch_key(pmt::intern("squelch_eob"));
   // get_tags_in_range(tags, 0, nitems_read(0), nitems_read(0) + noutput_items);
   get_tags_in_window(tags, 0, 0, noutput_items);
   unsigned pos = 0;
   // long curr_src_id = 0;
+  d_codec_pending.clear();
 
   for (unsigned int i = 0; i < tags.size(); i++) {
     // BOOST_LOG_TRIVIAL(info) << "TAG! " << tags[i].key;
@@ -411,19 +438,19 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
       if ((state == RECORDING) || (state == IDLE)) {
         if (d_current_call_talkgroup_encoded != grp_id) {
           if (!d_conventional) {
-            BOOST_LOG_TRIVIAL(info) << loghdr << "GROUP MISMATCH -  Recorder TG: " << d_current_call_talkgroup_encoded << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
+            BOOST_LOG_TRIVIAL(info) << call_log_header() << "GROUP MISMATCH -  Recorder TG: " << d_current_call_talkgroup_encoded << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
             if (d_sample_count > 0) {
-              BOOST_LOG_TRIVIAL(info) << loghdr << "Ending Transmission and IGNORING Rest - count: " << d_sample_count;
+              BOOST_LOG_TRIVIAL(info) << call_log_header() << "Ending Transmission and IGNORING Rest - count: " << d_sample_count;
               end_transmission();
             }
             state = IGNORE;
           } else {
             if (d_current_call_talkgroup != grp_id) {
               if (d_current_call_talkgroup != 0) {
-                BOOST_LOG_TRIVIAL(debug) << loghdr << "Conventional Call - TALKGROUP MISMATCH - Talkgroup already set - Recorder TG: " << d_current_call_talkgroup << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
+                BOOST_LOG_TRIVIAL(debug) << call_log_header() << "Conventional Call - TALKGROUP MISMATCH - Talkgroup already set - Recorder TG: " << d_current_call_talkgroup << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
                 // this is where we would conclude the current call and start a new one.
               }
-              BOOST_LOG_TRIVIAL(debug) << loghdr << "Conventional Call - TALKGROUP set via Control Channel - Recorder TG: " << d_current_call_talkgroup << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
+              BOOST_LOG_TRIVIAL(debug) << call_log_header() << "Conventional Call - TALKGROUP set via Control Channel - Recorder TG: " << d_current_call_talkgroup << " Received TG: " << grp_id << " Recorder state: " << format_state(state) << " incoming: " << noutput_items;
               // Retain the OTA talkgroup for conventional systems, only apply it for DMR
               d_current_call_talkgroup_encoded = grp_id;
               if (d_current_call->get_system_type() == "conventionalDMR") {
@@ -442,7 +469,7 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
         if (cc != d_current_color_code) {
           if (d_current_call->get_system_type() == "conventionalDMR") {
             d_current_color_code = cc;
-            BOOST_LOG_TRIVIAL(info) << loghdr << "DMR Color Code set to: " << d_current_color_code << " Recorder state: " << format_state(state);
+            BOOST_LOG_TRIVIAL(info) << call_log_header() << "DMR Color Code set to: " << d_current_color_code << " Recorder state: " << format_state(state);
           } 
         }
       }
@@ -486,17 +513,28 @@ int transmission_sink::work(int noutput_items, gr_vector_const_void_star &input_
       // BOOST_LOG_TRIVIAL(info) << "TERMINATOR!!";
     }
 
+    if (pmt::eq(imbe_key, tags[i].key)) {
+      // positioned once dowork() knows which transmission the samples land in
+      Codec_File_Frame frame = {};
+      size_t n = 0;
+      const uint32_t *params = pmt::u32vector_elements(tags[i].value, n);
+      frame.pos = tags[i].offset - nitems_read(0);
+      for (size_t j = 0; (j < n) && (j < CODEC_FILE_MAX_PARAMS); j++) {
+        frame.params[j] = params[j];
+      }
+      d_codec_pending.push_back(frame);
+    }
     // Only process Spike and Error Count tags if the sink is currently recording
     if (state == RECORDING) {
       if (pmt::eq(spike_count_key, tags[i].key)) {
         d_spike_count = pmt::to_long(tags[i].value);
 
-        BOOST_LOG_TRIVIAL(trace) << loghdr << "Spike Count: " << d_spike_count << " pos: " << pos << " offset: " << tags[i].offset;
+        BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Spike Count: " << d_spike_count << " pos: " << pos << " offset: " << tags[i].offset;
       }
       if (pmt::eq(error_count_key, tags[i].key)) {
         d_error_count = pmt::to_long(tags[i].value);
 
-        BOOST_LOG_TRIVIAL(trace) << loghdr << "Error Count: " << d_error_count << " pos: " << pos << " offset: " << tags[i].offset;
+        BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Error Count: " << d_error_count << " pos: " << pos << " offset: " << tags[i].offset;
       }
     }
   }
@@ -536,10 +574,8 @@ std::vector<Transmission> transmission_sink::get_transmission_list() {
 int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items) {
   // block
   int n_in_chans = input_items.size();
-  int16_t sample_buf_s;
   int nwritten = 0;
   bool terminate_after_write = false;
-  std::string loghdr = log_header(d_current_call_short_name,d_current_call_num,d_current_call_talkgroup_display,d_current_call_freq);
 
   if (state == STOPPED) {
     return noutput_items;
@@ -557,7 +593,7 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
     }
 
     if (state == IGNORE) {
-      BOOST_LOG_TRIVIAL(trace) << loghdr << "Resetting state from IGNORE to IDLE: " << noutput_items;
+      BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Resetting state from IGNORE to IDLE: " << noutput_items;
       state = IDLE;
 
       return noutput_items;
@@ -565,26 +601,26 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
 
     // The TDU can come in with voice samples. Write the voice samples and then end the transmission.
     if (d_sample_count > 0 && noutput_items > 1) {
-      BOOST_LOG_TRIVIAL(trace) << loghdr << "Terminator received with items. Ending transmission after writing. Sample Count: " << d_sample_count << " Noutput Items: " << noutput_items;
+      BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Terminator received with items. Ending transmission after writing. Sample Count: " << d_sample_count << " Noutput Items: " << noutput_items;
       terminate_after_write = true;
       // Handle the case of a terminator coming in without voice samples. End the transmission immediately.
     } else if (d_sample_count > 0) {
-      BOOST_LOG_TRIVIAL(trace) << loghdr << "Terminator received without items. Ending transmission immediately. " << d_sample_count << " Noutput Items: " << noutput_items;
+      BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Terminator received without items. Ending transmission immediately. " << d_sample_count << " Noutput Items: " << noutput_items;
       end_transmission();
       return noutput_items;
     } else {
-      BOOST_LOG_TRIVIAL(trace) << loghdr << "TERM - skipped....   - count: " << d_sample_count;
+      BOOST_LOG_TRIVIAL(trace) << call_log_header() << "TERM - skipped....   - count: " << d_sample_count;
       return noutput_items;
     }
   }
 
   if (state == IGNORE) {
-    BOOST_LOG_TRIVIAL(trace) << loghdr << "IGNORE missing count: " << noutput_items;
+    BOOST_LOG_TRIVIAL(trace) << call_log_header() << "IGNORE missing count: " << noutput_items;
     return noutput_items;
   }
 
   if (state == IDLE) {
-    // BOOST_LOG_TRIVIAL(info) << loghdr << "IDLE but haven't seen Group ID yet, missing count: " << noutput_items;
+    // BOOST_LOG_TRIVIAL(info) << call_log_header() << "IDLE but haven't seen Group ID yet, missing count: " << noutput_items;
     // return noutput_items;
     if (d_fp) {
       // if we are already recording a file for this call, close it before starting a new one.
@@ -605,7 +641,7 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
       return noutput_items;
     }
 
-    BOOST_LOG_TRIVIAL(trace) << loghdr << "Starting new Transmission \tSrc ID:  " << curr_src_id;
+    BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Starting new Transmission \tSrc ID:  " << curr_src_id;
 
     // curr_src_id = d_current_call->get_current_source_id();
     state = RECORDING;
@@ -618,21 +654,43 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
   }
 
   if (state == RECORDING) {
-    for (nwritten = 0; nwritten < noutput_items; nwritten++) {
+    const int16_t **in = (const int16_t **)&input_items[0];
+    const int16_t *samples = in[0];
+    size_t sample_total = (size_t)noutput_items * d_nchans;
+
+    if ((d_nchans > 1) || (n_in_chans < 1)) {
+      // Interleave the channels. Write zeros to channels which are in the
+      // WAV file but don't have any inputs here
+      d_sample_buf.resize(sample_total);
       for (int chan = 0; chan < d_nchans; chan++) {
-        // Write zeros to channels which are in the WAV file
-        // but don't have any inputs here
+        int16_t *out = d_sample_buf.data() + chan;
         if (chan < n_in_chans) {
-          int16_t **in = (int16_t **)&input_items[0];
-          sample_buf_s = in[chan][nwritten];
+          for (int i = 0; i < noutput_items; i++) {
+            out[i * d_nchans] = in[chan][i];
+          }
         } else {
-          sample_buf_s = 0;
+          for (int i = 0; i < noutput_items; i++) {
+            out[i * d_nchans] = 0;
+          }
         }
+      }
+      samples = d_sample_buf.data();
+    }
+
+    for (size_t i = 0; i < d_codec_pending.size(); i++) {
+      Codec_File_Frame frame = d_codec_pending[i];
+      frame.pos += d_sample_count / d_nchans;
+      d_codec_frames.push_back(frame);
+    }
+    d_codec_pending.clear();
 
-        wav_write_sample(d_fp, sample_buf_s, d_bytes_per_sample);
+    size_t samples_written = wav_write_samples(d_fp, samples, sample_total, d_bytes_per_sample);
+    d_sample_count += samples_written;
+    d_bytes_metric->inc(samples_written * d_bytes_per_sample);
+    nwritten = (d_nchans > 0) ? samples_written / d_nchans : 0;
 
-        d_sample_count++;
-      }
+    if (d_measure_loudness) {
+      d_loudness_meter.process(samples, nwritten);
     }
 
     if (terminate_after_write) {
@@ -643,9 +701,9 @@ int transmission_sink::dowork(int noutput_items, gr_vector_const_void_star &inpu
   d_last_write_time = std::chrono::steady_clock::now();
 
   if (nwritten < noutput_items) {
-    BOOST_LOG_TRIVIAL(error) << loghdr << "Failed to Write! Wrote: " << nwritten << " of " << noutput_items;
+    BOOST_LOG_TRIVIAL(error) << call_log_header() << "Failed to Write! Wrote: " << nwritten << " of " << noutput_items;
   } else {
-    BOOST_LOG_TRIVIAL(trace) << loghdr << "Wrote: " << nwritten << " of " << noutput_items;
+    BOOST_LOG_TRIVIAL(trace) << call_log_header() << "Wrote: " << nwritten << " of " << noutput_items;
   }
   return noutput_items;
 }
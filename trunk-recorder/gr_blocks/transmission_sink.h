@@ -23,16 +23,20 @@
 #ifndef INCLUDED_TRANSMISSION_SINK_H
 #define INCLUDED_TRANSMISSION_SINK_H
 
+#include "codec_file.h"
+#include "loudness_meter.h"
 #include "wavfile_gr3.8.h"
 #include <sys/time.h>
 
 #include "../../trunk-recorder/formatter.h"
 #include "../../trunk-recorder/global_structs.h"
+#include "../../trunk-recorder/metrics.h"
 
 #include <boost/log/trivial.hpp>
 #include <gnuradio/blocks/api.h>
 #include <gnuradio/sync_block.h>
 #include <chrono>
+#include <vector>
 
 class Call;
 struct Transmission;
@@ -71,10 +75,20 @@ private:
   long d_current_call_talkgroup;
   long d_current_call_talkgroup_encoded;
   std::string d_current_call_talkgroup_display;
+  std::vector<char> d_file_buf;       // stdio buffer, reused for every file this sink opens
+  std::vector<int16_t> d_sample_buf;  // interleaved samples for multi-channel writes
+  bool d_measure_loudness;
+  Loudness_Meter d_loudness_meter;
+  std::vector<Codec_File_Frame> d_codec_pending; // deferred frames tagged in the current work() call, pos relative to it
+  std::vector<Codec_File_Frame> d_codec_frames;  // deferred frames of the open transmission
+
+  std::string call_log_header();
 
 protected:
   unsigned d_sample_count;
   int d_bytes_per_sample;
+  Metric_Counter *d_bytes_metric;
+  Metric_Counter *d_transmissions_metric;
   FILE *d_fp;
   boost::mutex d_mutex;
   virtual int dowork(int noutput_items, gr_vector_const_void_star &input_items, gr_vector_void_star &output_items);
@@ -25,6 +25,7 @@
 #endif
 
 #include "wavfile_gr3.8.h"
+#include <algorithm>
 #include <cstring>
 #include <stdint.h>
 
@@ -229,6 +230,47 @@ void wav_write_sample(FILE *fp, short int sample, int bytes_per_sample) {
   fwrite(data_ptr, 1, bytes_per_sample, fp);
 }
 
+size_t wav_write_samples(FILE *fp, const int16_t *samples, size_t count, int bytes_per_sample) {
+#ifndef GR_IS_BIG_ENDIAN
+  // Host order already matches the file, hand the whole block to stdio.
+  if (bytes_per_sample == 2) {
+    return fwrite(samples, sizeof(int16_t), count, fp);
+  }
+#endif
+
+  // Convert in fixed size chunks on the stack. The loops are simple enough
+  // for the compiler to vectorize them.
+  const size_t chunk_len = 4096;
+  size_t written = 0;
+
+  while (written < count) {
+    size_t n = std::min(chunk_len, count - written);
+    const int16_t *src = samples + written;
+    size_t ret;
+
+    if (bytes_per_sample == 1) {
+      unsigned char buf_8bit[chunk_len];
+      for (size_t i = 0; i < n; i++) {
+        buf_8bit[i] = (unsigned char)src[i];
+      }
+      ret = fwrite(buf_8bit, 1, n, fp);
+    } else {
+      uint16_t buf_16bit[chunk_len];
+      for (size_t i = 0; i < n; i++) {
+        buf_16bit[i] = host_to_wav((uint16_t)src[i]);
+      }
+      ret = fwrite(buf_16bit, sizeof(uint16_t), n, fp);
+    }
+
+    written += ret;
+    if (ret < n) {
+      break;
+    }
+  }
+
+  return written;
+}
+
 bool wavheader_complete(FILE *fp, unsigned int byte_count) {
   uint32_t chunk_size = (uint32_t)byte_count;
   chunk_size = host_to_wav(chunk_size);
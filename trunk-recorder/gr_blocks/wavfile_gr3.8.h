@@ -26,6 +26,7 @@
 #ifndef _GR_WAVFILE_GR_3_8_H_
 #define _GR_WAVFILE_GR_3_8_H_
 
+#include <cstdint>
 #include <cstdio>
 #include <gnuradio/blocks/api.h>
 
@@ -80,6 +81,18 @@ wavheader_write(FILE *fp, unsigned int sample_rate, int nchans, int bytes_per_sa
  */
 BLOCKS_API void wav_write_sample(FILE *fp, short int sample, int bytes_per_sample);
 
+/*!
+ * \brief Write a block of interleaved samples to an open WAV file at the
+ * current position.
+ *
+ * \details
+ * Takes care of endianness. On little-endian hosts 16 bit samples are
+ * written with a single fwrite() call.
+ *
+ * \return Number of samples written.
+ */
+BLOCKS_API size_t wav_write_samples(FILE *fp, const int16_t *samples, size_t count, int bytes_per_sample);
+
 /*!
  * \brief Complete a WAV header
  *
@@ -65,6 +65,8 @@
 #include <gnuradio/top_block.h>
 #include <gnuradio/uhd/usrp_source.h>
 
+#include "call_concluder/call_concluder.h"
+#include "metrics_server.h"
 #include "plugin_manager/plugin_manager.h"
 
 #include "cmake.h"
@@ -123,11 +125,19 @@ int main(int argc, char **argv) {
 
   start_plugins(sources, systems);
 
+  Metrics_Server metrics_server;
+  if (config_ext.metrics_port > 0) {
+    metrics_server.start(config_ext.metrics_address, config_ext.metrics_port);
+  }
+
   if (setup_systems(config, tb, sources, systems, calls)) {
 
+    Call_Concluder::start_call_data_workers(config, config_ext);
+
     tb->start();
 
     exit_code = monitor_messages(config, tb, sources, systems, calls);
+    metrics_server.stop();
 
     // ------------------------------------------------------------------
     // -- stop flow graph execution
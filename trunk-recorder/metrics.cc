@@ -0,0 +1,242 @@
+#include "metrics.h"
+
+#include <cmath>
+#include <mutex>
+#include <stdexcept>
+#include <stdio.h>
+
+void Metric_Gauge::add(double delta) {
+  double value = d_value.load(std::memory_order_relaxed);
+  while (!d_value.compare_exchange_weak(value, value + delta, std::memory_order_relaxed)) {
+  }
+}
+
+Metric_Histogram::Metric_Histogram(const std::vector<double> &bounds)
+    : d_bounds(bounds), d_buckets(new std::atomic<uint64_t>[bounds.size() + 1]) {
+  for (size_t i = 0; i <= d_bounds.size(); i++) {
+    d_buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+void Metric_Histogram::observe(double value) {
+  // Histograms have a dozen or so buckets, a linear search is quickest
+  size_t index = 0;
+  while ((index < d_bounds.size()) && (value > d_bounds[index])) {
+    index++;
+  }
+  d_buckets[index].fetch_add(1, std::memory_order_relaxed);
+  d_count.fetch_add(1, std::memory_order_relaxed);
+
+  double sum = d_sum.load(std::memory_order_relaxed);
+  while (!d_sum.compare_exchange_weak(sum, sum + value, std::memory_order_relaxed)) {
+  }
+}
+
+static std::string escape(const std::string &text, bool quotes) {
+  std::string escaped;
+  escaped.reserve(text.size());
+  for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+    if (*it == '\\') {
+      escaped += "\\\\";
+    } else if (*it == '\n') {
+      escaped += "\\n";
+    } else if ((*it == '"') && quotes) {
+      escaped += "\\\"";
+    } else {
+      escaped += *it;
+    }
+  }
+  return escaped;
+}
+
+std::string Metrics_Writer::format_labels(const Metric_Labels &labels) {
+  std::string formatted;
+  for (Metric_Labels::const_iterator it = labels.begin(); it != labels.end(); ++it) {
+    if (!formatted.empty()) {
+      formatted += ",";
+    }
+    formatted += it->first + "=\"" + escape(it->second, true) + "\"";
+  }
+  return formatted;
+}
+
+std::string Metrics_Writer::format_value(double value) {
+  if (std::isnan(value)) {
+    return "NaN";
+  }
+  if (std::isinf(value)) {
+    return value > 0 ? "+Inf" : "-Inf";
+  }
+
+  char buffer[32];
+  if ((value == std::floor(value)) && (std::fabs(value) < 9007199254740992.0)) {
+    snprintf(buffer, sizeof(buffer), "%.0f", value);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%.15g", value);
+  }
+  return buffer;
+}
+
+void Metrics_Writer::family(const std::string &name, const char *type, const std::string &help) {
+  d_out += "# TYPE " + name + " " + type + "\n";
+  d_out += "# HELP " + name + " " + escape(help, true) + "\n";
+}
+
+void Metrics_Writer::sample(const std::string &name, const std::string &labels, double value) {
+  d_out += name;
+  if (!labels.empty()) {
+    d_out += "{" + labels + "}";
+  }
+  d_out += " " + format_value(value) + "\n";
+}
+
+void Metrics_Writer::sample(const std::string &name, const Metric_Labels &labels, double value) {
+  sample(name, format_labels(labels), value);
+}
+
+void Metrics_Writer::histogram(const std::string &name, const std::string &labels, const std::vector<double> &bounds, const std::vector<uint64_t> &buckets, double sum) {
+  const std::string prefix = labels.empty() ? "" : labels + ",";
+  uint64_t cumulative = 0;
+  for (size_t i = 0; i < bounds.size(); i++) {
+    cumulative += buckets[i];
+    sample(name + "_bucket", prefix + "le=\"" + format_value(bounds[i]) + "\"", cumulative);
+  }
+  cumulative += buckets[bounds.size()];
+  sample(name + "_bucket", prefix + "le=\"+Inf\"", cumulative);
+  sample(name + "_count", labels, cumulative);
+  sample(name + "_sum", labels, sum);
+}
+
+namespace {
+
+enum Metric_Type { COUNTER,
+                   GAUGE,
+                   HISTOGRAM };
+
+struct Series {
+  std::string labels;
+  std::unique_ptr<Metric_Counter> counter;
+  std::unique_ptr<Metric_Gauge> gauge;
+  std::unique_ptr<Metric_Histogram> histogram;
+};
+
+struct Family {
+  std::string name;
+  Metric_Type type;
+  std::string help;
+  std::vector<std::unique_ptr<Series>> series;
+};
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<Family>> families;
+std::vector<std::function<void(Metrics_Writer &)>> collectors;
+
+// Called with registry_mutex held
+Series &find_series(const std::string &name, Metric_Type type, const std::string &help, const Metric_Labels &labels) {
+  Family *family = NULL;
+  for (size_t i = 0; i < families.size(); i++) {
+    if (families[i]->name == name) {
+      family = families[i].get();
+      break;
+    }
+  }
+  if (!family) {
+    families.push_back(std::unique_ptr<Family>(new Family()));
+    family = families.back().get();
+    family->name = name;
+    family->type = type;
+    family->help = help;
+  } else if (family->type != type) {
+    throw std::logic_error("Metric " + name + " registered again with a different type");
+  }
+
+  const std::string formatted = Metrics_Writer::format_labels(labels);
+  for (size_t i = 0; i < family->series.size(); i++) {
+    if (family->series[i]->labels == formatted) {
+      return *family->series[i];
+    }
+  }
+  family->series.push_back(std::unique_ptr<Series>(new Series()));
+  family->series.back()->labels = formatted;
+  return *family->series.back();
+}
+
+} // namespace
+
+namespace Metrics {
+
+Metric_Counter *counter(const std::string &name, const std::string &help, const Metric_Labels &labels) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  Series &series = find_series(name, COUNTER, help, labels);
+  if (!series.counter) {
+    series.counter.reset(new Metric_Counter());
+  }
+  return series.counter.get();
+}
+
+Metric_Gauge *gauge(const std::string &name, const std::string &help, const Metric_Labels &labels) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  Series &series = find_series(name, GAUGE, help, labels);
+  if (!series.gauge) {
+    series.gauge.reset(new Metric_Gauge());
+  }
+  return series.gauge.get();
+}
+
+Metric_Histogram *histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const Metric_Labels &labels) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  Series &series = find_series(name, HISTOGRAM, help, labels);
+  if (!series.histogram) {
+    series.histogram.reset(new Metric_Histogram(bounds));
+  }
+  return series.histogram.get();
+}
+
+void add_collector(std::function<void(Metrics_Writer &)> collector) {
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  collectors.push_back(collector);
+}
+
+std::string render() {
+  std::string out;
+  Metrics_Writer writer(out);
+  std::vector<uint64_t> buckets;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (size_t i = 0; i < families.size(); i++) {
+    const Family &family = *families[i];
+    switch (family.type) {
+    case COUNTER:
+      writer.family(family.name, "counter", family.help);
+      for (size_t j = 0; j < family.series.size(); j++) {
+        writer.sample(family.name + "_total", family.series[j]->labels, family.series[j]->counter->get());
+      }
+      break;
+    case GAUGE:
+      writer.family(family.name, "gauge", family.help);
+      for (size_t j = 0; j < family.series.size(); j++) {
+        writer.sample(family.name, family.series[j]->labels, family.series[j]->gauge->get());
+      }
+      break;
+    case HISTOGRAM:
+      writer.family(family.name, "histogram", family.help);
+      for (size_t j = 0; j < family.series.size(); j++) {
+        const Metric_Histogram &histogram = *family.series[j]->histogram;
+        buckets.resize(histogram.get_bounds().size() + 1);
+        for (size_t k = 0; k < buckets.size(); k++) {
+          buckets[k] = histogram.get_bucket(k);
+        }
+        writer.histogram(family.name, family.series[j]->labels, histogram.get_bounds(), buckets, histogram.get_sum());
+      }
+      break;
+    }
+  }
+
+  for (size_t i = 0; i < collectors.size(); i++) {
+    collectors[i](writer);
+  }
+  out += "# EOF\n";
+  return out;
+}
+
+} // namespace Metrics
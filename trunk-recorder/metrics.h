@@ -0,0 +1,92 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+/*
+ * Counters, gauges and histograms for the OpenMetrics endpoint.
+ *
+ * Metrics are registered once, usually at startup, and the caller keeps the
+ * pointer it gets back. Registering takes a lock and allocates; updating a
+ * metric through the pointer is a relaxed atomic operation that does
+ * neither, so it is safe on the recorder threads and in the main loop.
+ * Registering the same name and labels again returns the same metric.
+ */
+
+typedef std::vector<std::pair<std::string, std::string>> Metric_Labels;
+
+class Metric_Counter {
+public:
+  void inc(uint64_t n = 1) { d_value.fetch_add(n, std::memory_order_relaxed); }
+  uint64_t get() const { return d_value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<uint64_t> d_value{0};
+};
+
+class Metric_Gauge {
+public:
+  void set(double value) { d_value.store(value, std::memory_order_relaxed); }
+  void add(double delta);
+  double get() const { return d_value.load(std::memory_order_relaxed); }
+
+private:
+  std::atomic<double> d_value{0};
+};
+
+class Metric_Histogram {
+public:
+  // bounds are the upper edges of the buckets, in increasing order
+  explicit Metric_Histogram(const std::vector<double> &bounds);
+
+  void observe(double value);
+
+  const std::vector<double> &get_bounds() const { return d_bounds; }
+  uint64_t get_bucket(size_t index) const { return d_buckets[index].load(std::memory_order_relaxed); } // not cumulative
+  uint64_t get_count() const { return d_count.load(std::memory_order_relaxed); }
+  double get_sum() const { return d_sum.load(std::memory_order_relaxed); }
+
+private:
+  const std::vector<double> d_bounds;
+  std::unique_ptr<std::atomic<uint64_t>[]> d_buckets; // one more than bounds, for +Inf
+  std::atomic<uint64_t> d_count{0};
+  std::atomic<double> d_sum{0};
+};
+
+// Writes metric families in OpenMetrics text format
+class Metrics_Writer {
+public:
+  explicit Metrics_Writer(std::string &out) : d_out(out) {}
+
+  void family(const std::string &name, const char *type, const std::string &help);
+  void sample(const std::string &name, const Metric_Labels &labels, double value);
+  void sample(const std::string &name, const std::string &labels, double value);
+  void histogram(const std::string &name, const std::string &labels, const std::vector<double> &bounds, const std::vector<uint64_t> &buckets, double sum);
+
+  static std::string format_labels(const Metric_Labels &labels);
+  static std::string format_value(double value);
+
+private:
+  std::string &d_out;
+};
+
+namespace Metrics {
+Metric_Counter *counter(const std::string &name, const std::string &help, const Metric_Labels &labels = Metric_Labels());
+Metric_Gauge *gauge(const std::string &name, const std::string &help, const Metric_Labels &labels = Metric_Labels());
+Metric_Histogram *histogram(const std::string &name, const std::string &help, const std::vector<double> &bounds, const Metric_Labels &labels = Metric_Labels());
+
+// For state that is kept elsewhere, the collector writes its own families
+// each time the metrics are read. It runs on the metrics server's thread.
+void add_collector(std::function<void(Metrics_Writer &)> collector);
+
+// Every metric, followed by the collectors' families
+std::string render();
+} // namespace Metrics
+
+#endif
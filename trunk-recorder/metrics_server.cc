@@ -0,0 +1,124 @@
+#include "metrics_server.h"
+#include "metrics.h"
+
+#include <boost/log/trivial.hpp>
+#include <sstream>
+
+using boost::asio::ip::tcp;
+
+// Requests are a request line and a few headers, anything bigger is not a scrape
+#define MAX_REQUEST_SIZE 8192
+
+class Metrics_Server::Connection : public std::enable_shared_from_this<Metrics_Server::Connection> {
+public:
+  explicit Connection(boost::asio::io_service &io) : d_socket(io), d_request(MAX_REQUEST_SIZE) {}
+
+  tcp::socket &socket() { return d_socket; }
+
+  void start() {
+    std::shared_ptr<Connection> self = shared_from_this();
+    boost::asio::async_read_until(d_socket, d_request, "\r\n\r\n", [self](const boost::system::error_code &error, std::size_t) {
+      if (!error) {
+        self->respond();
+      }
+    });
+  }
+
+private:
+  tcp::socket d_socket;
+  boost::asio::streambuf d_request;
+  std::string d_response;
+
+  void respond() {
+    std::istream request(&d_request);
+    std::string method;
+    std::string target;
+    request >> method >> target;
+
+    // The query string is ignored
+    target = target.substr(0, target.find('?'));
+
+    if (method != "GET") {
+      reply("405 Method Not Allowed", "text/plain; charset=utf-8", "Only GET is supported\n");
+    } else if ((target == "/metrics") || (target == "/")) {
+      reply("200 OK", "application/openmetrics-text; version=1.0.0; charset=utf-8", Metrics::render());
+    } else {
+      reply("404 Not Found", "text/plain; charset=utf-8", "Metrics are at /metrics\n");
+    }
+  }
+
+  void reply(const char *status, const char *content_type, const std::string &body) {
+    std::ostringstream response;
+    response << "HTTP/1.1 " << status << "\r\n"
+             << "Content-Type: " << content_type << "\r\n"
+             << "Content-Length: " << body.size() << "\r\n"
+             << "Connection: close\r\n\r\n"
+             << body;
+    d_response = response.str();
+
+    std::shared_ptr<Connection> self = shared_from_this();
+    boost::asio::async_write(d_socket, boost::asio::buffer(d_response), [self](const boost::system::error_code &, std::size_t) {
+      boost::system::error_code ignored;
+      self->d_socket.shutdown(tcp::socket::shutdown_both, ignored);
+      self->d_socket.close(ignored);
+    });
+  }
+};
+
+Metrics_Server::Metrics_Server() : d_acceptor(d_io) {}
+
+Metrics_Server::~Metrics_Server() {
+  stop();
+}
+
+bool Metrics_Server::start(const std::string &address, int port) {
+  boost::system::error_code error;
+  tcp::endpoint endpoint(boost::asio::ip::address::from_string(address, error), port);
+  if (error) {
+    BOOST_LOG_TRIVIAL(error) << "Metrics: invalid address " << address << ": " << error.message();
+    return false;
+  }
+
+  d_acceptor.open(endpoint.protocol(), error);
+  if (!error) {
+    d_acceptor.set_option(tcp::acceptor::reuse_address(true), error);
+  }
+  if (!error) {
+    d_acceptor.bind(endpoint, error);
+  }
+  if (!error) {
+    d_acceptor.listen(boost::asio::socket_base::max_connections, error);
+  }
+  if (error) {
+    BOOST_LOG_TRIVIAL(error) << "Metrics: unable to listen on " << endpoint << ": " << error.message();
+    d_acceptor.close(error);
+    return false;
+  }
+
+  start_accept();
+  d_thread = std::thread([this]() { d_io.run(); });
+  BOOST_LOG_TRIVIAL(info) << "Metrics: serving http://" << endpoint << "/metrics";
+  return true;
+}
+
+void Metrics_Server::stop() {
+  if (!d_thread.joinable()) {
+    return;
+  }
+  d_io.stop();
+  d_thread.join();
+  boost::system::error_code ignored;
+  d_acceptor.close(ignored);
+}
+
+void Metrics_Server::start_accept() {
+  std::shared_ptr<Connection> connection = std::make_shared<Connection>(d_io);
+  d_acceptor.async_accept(connection->socket(), [this, connection](const boost::system::error_code &error) {
+    if (!error) {
+      connection->start();
+    }
+    if (d_acceptor.is_open()) {
+      start_accept();
+    }
+  });
+}
@@ -0,0 +1,34 @@
+#ifndef METRICS_SERVER_H
+#define METRICS_SERVER_H
+
+#include <boost/asio.hpp>
+#include <memory>
+#include <string>
+#include <thread>
+
+/*
+ * A small HTTP server for Prometheus to scrape.
+ *
+ * GET /metrics returns Metrics::render() in OpenMetrics text format. It runs
+ * on its own thread and answers one request per connection, which is all a
+ * scraper needs.
+ */
+class Metrics_Server {
+public:
+  Metrics_Server();
+  ~Metrics_Server();
+
+  bool start(const std::string &address, int port);
+  void stop();
+
+private:
+  class Connection;
+
+  void start_accept();
+
+  boost::asio::io_service d_io;
+  boost::asio::ip::tcp::acceptor d_acceptor;
+  std::thread d_thread;
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include "monitor_systems.h"
+#include "metrics.h"
 #include "recorders/p25_recorder.h"
 #include <chrono>
 #include <boost/log/sinks/text_file_backend.hpp>
@@ -21,6 +22,72 @@ void rotate_log_signal(int sig) { // can be called asynchronously
   rotate_log_flag = 1;          // set flag
 }
 
+// Registered for every system before the main loop starts, so looking one
+// up never adds to the map
+struct System_Metrics {
+  Metric_Counter *control_messages;
+  Metric_Counter *grants;
+  Metric_Counter *calls_recorded;
+  Metric_Counter *calls_monitored;
+  Metric_Gauge *decode_rate;
+};
+
+static std::map<System *, System_Metrics> system_metrics;
+
+struct Recorder_State_Metric {
+  State state;
+  Metric_Gauge *gauge;
+};
+
+static std::vector<Recorder_State_Metric> recorder_state_metrics;
+
+void setup_metrics(std::vector<System *> &systems) {
+  for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
+    System *sys = *it;
+    Metric_Labels labels = {{"system", sys->get_short_name()}};
+    System_Metrics &metrics = system_metrics[sys];
+    metrics.control_messages = Metrics::counter("trunk_recorder_control_messages", "Control channel messages decoded", labels);
+    metrics.grants = Metrics::counter("trunk_recorder_grants", "Voice channel grants received", labels);
+    metrics.decode_rate = Metrics::gauge("trunk_recorder_decode_rate", "Control channel messages decoded per second", labels);
+    labels.push_back(std::make_pair("outcome", "recorded"));
+    metrics.calls_recorded = Metrics::counter("trunk_recorder_calls", "Calls started, by whether a recorder was assigned", labels);
+    labels.back().second = "monitored";
+    metrics.calls_monitored = Metrics::counter("trunk_recorder_calls", "Calls started, by whether a recorder was assigned", labels);
+  }
+
+  // format_state() adds colours, so the labels are spelled out here
+  const std::pair<State, const char *> states[] = {{AVAILABLE, "available"}, {RECORDING, "recording"}, {IDLE, "idle"}, {INACTIVE, "inactive"}, {ACTIVE, "active"}, {STOPPED, "stopped"}, {IGNORE, "ignore"}};
+  for (size_t i = 0; i < sizeof(states) / sizeof(states[0]); i++) {
+    Recorder_State_Metric metric;
+    metric.state = states[i].first;
+    metric.gauge = Metrics::gauge("trunk_recorder_recorders", "Recorders in each state", {{"state", states[i].second}});
+    recorder_state_metrics.push_back(metric);
+  }
+}
+
+System_Metrics *find_system_metrics(System *sys) {
+  std::map<System *, System_Metrics>::iterator it = system_metrics.find(sys);
+  if (it == system_metrics.end()) {
+    return NULL;
+  }
+  return &it->second;
+}
+
+void update_recorder_metrics(std::vector<Source *> &sources) {
+  for (std::vector<Recorder_State_Metric>::iterator metric = recorder_state_metrics.begin(); metric != recorder_state_metrics.end(); ++metric) {
+    int count = 0;
+    for (std::vector<Source *>::iterator src_it = sources.begin(); src_it != sources.end(); ++src_it) {
+      std::vector<Recorder *> recorders = (*src_it)->get_recorders();
+      for (std::vector<Recorder *>::iterator rec_it = recorders.begin(); rec_it != recorders.end(); ++rec_it) {
+        if ((*rec_it)->get_state() == metric->state) {
+          count++;
+        }
+      }
+    }
+    metric->gauge->set(count);
+  }
+}
+
 uint64_t time_since_epoch_millisec() {
   using namespace std::chrono;
   return duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
@@ -229,6 +296,15 @@ void print_status(std::vector<Source *> &sources, std::vector<System *> &systems
     }
   }
 
+  Call_Concluder_Stats concluder = Call_Concluder::get_stats();
+  BOOST_LOG_TRIVIAL(info) << "Call Concluder: " << concluder.running << "/" << concluder.workers << " workers busy"
+                          << "\tQueued: " << concluder.queued << "\tRetry: " << concluder.retry_waiting
+                          << "\tSpilled: " << concluder.spilled << "\tCompleted: " << concluder.completed
+                          << "\tDropped: " << concluder.dropped << "\tSpilled total: " << concluder.spilled_total
+                          << "\tWait avg/max: " << std::fixed << std::setprecision(2) << concluder.avg_wait << "/" << concluder.max_wait << "s";
+
+  plugman_print_stats();
+
   BOOST_LOG_TRIVIAL(info) << "Recorders: ";
 
   for (vector<Source *>::iterator it = sources.begin(); it != sources.end(); it++) {
@@ -307,7 +383,7 @@ void manage_calls(Config &config, std::vector<Call *> &calls) {
     if ((state == MONITORING) && (call->since_last_update() > config.call_timeout)) {
       ended_call = true;
       it = calls.erase(it);
-      delete call;
+      plugman_retire_call(call);
       continue;
     }
 
@@ -327,7 +403,7 @@ void manage_calls(Config &config, std::vector<Call *> &calls) {
           plugman_setup_recorder(recorder);
         }
         it = calls.erase(it);
-        delete call;
+        plugman_retire_call(call);
         continue;
       }
     } else if (call->since_last_update() > config.call_timeout) {
@@ -550,6 +626,15 @@ void handle_call_grant(TrunkMessage message, System *sys, bool grant_message, Co
         BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[36mThis was an UPDATE\u001b[0m";
       }
     }
+    System_Metrics *metrics = find_system_metrics(sys);
+    if (metrics) {
+      if (call->get_state() == RECORDING) {
+        metrics->calls_recorded->inc();
+      } else {
+        metrics->calls_monitored->inc();
+      }
+    }
+
     calls.push_back(call);
     plugman_call_start(call);
     plugman_calls_active(calls);
@@ -597,11 +682,16 @@ void handle_call_update(TrunkMessage message, System *sys, std::vector<Call *> &
 }
 
 void handle_message(std::vector<TrunkMessage> messages, System *sys, Config &config, std::vector<Source *> &sources, std::vector<Call *> &calls, gr::top_block_sptr &tb) {
+  System_Metrics *metrics = find_system_metrics(sys);
+
   for (std::vector<TrunkMessage>::iterator it = messages.begin(); it != messages.end(); it++) {
     TrunkMessage message = *it;
 
     switch (message.message_type) {
     case GRANT:
+      if (metrics) {
+        metrics->grants->inc();
+      }
       handle_call_grant(message, sys, true, config, sources, calls);
       break;
 
@@ -616,6 +706,9 @@ void handle_message(std::vector<TrunkMessage> messages, System *sys, Config &con
       break;
 
     case UU_V_GRANT:
+      if (metrics) {
+        metrics->grants->inc();
+      }
       if (config.record_uu_v_calls) {
         handle_call_grant(message, sys, true, config, sources, calls);
       }
@@ -768,6 +861,8 @@ void retune_system(System *sys, gr::top_block_sptr &tb, std::vector<Source *> &s
 void check_message_count(float timeDiff, Config &config, gr::top_block_sptr &tb, std::vector<Source *> &sources, std::vector<System *> &systems) {
   plugman_setup_config(sources, systems);
   plugman_system_rates(systems, timeDiff);
+  plugman_plugin_stats();
+  plugman_check_latency();
 
   for (std::vector<System *>::iterator it = systems.begin(); it != systems.end(); ++it) {
     System_impl *sys = (System_impl *)*it;
@@ -776,6 +871,11 @@ void check_message_count(float timeDiff, Config &config, gr::top_block_sptr &tb,
       int msgs_decoded_per_second = std::floor(sys->message_count / timeDiff);
       sys->set_decode_rate(msgs_decoded_per_second);
 
+      System_Metrics *metrics = find_system_metrics(sys);
+      if (metrics) {
+        metrics->decode_rate->set(sys->message_count / timeDiff);
+      }
+
       if (msgs_decoded_per_second < 2) {
 
         // if it loses track of the control channel, quit after a while
@@ -841,6 +941,8 @@ void process_recorder_message_queues(std::vector<Call *> &calls) {
         if (p25_rec && (p25_rec->is_active())) {
           p25_rec->process_message_queues();
         }
+      } else if (recorder && (recorder->get_type() == DMR)) {
+        recorder->process_message_queues();
       }
     }
   }
@@ -865,6 +967,8 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
   smartnet_parser = new SmartnetParser(systems.front()); // this has to eventually be generic;
   p25_parser = new P25Parser();
 
+  setup_metrics(systems);
+
   while (1) {
 
     if (exit_flag) { // my action when signal set it 1
@@ -875,7 +979,7 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
         call->conclude_call();
 
         it = calls.erase(it);
-        delete call;
+        plugman_retire_call(call);
       }
 
       BOOST_LOG_TRIVIAL(info) << "Cleaning up & Exiting...";
@@ -905,10 +1009,14 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
       System_impl *system = (System_impl *)*sys_it;
 
       if ((system->get_system_type() == "p25") || (system->get_system_type() == "smartnet")) {
+        System_Metrics *metrics = find_system_metrics(system);
         msg.reset();
         msg = system->get_msg_queue()->delete_head_nowait();
         while (msg != 0) {
           system->set_message_count(system->get_message_count() + 1);
+          if (metrics) {
+            metrics->control_messages->inc();
+          }
 
           if (system->get_system_type() == "smartnet") {
             trunk_messages = smartnet_parser->parse_message(msg, system);
@@ -941,6 +1049,7 @@ int monitor_messages(Config &config, gr::top_block_sptr &tb, std::vector<Source
     if ((current_time - management_timestamp) >= 1.0) {
       manage_calls(config, calls);
       Call_Concluder::manage_call_data_workers();
+      update_recorder_metrics(sources);
       management_timestamp = current_time;
     }
 
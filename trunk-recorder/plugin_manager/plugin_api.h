@@ -7,6 +7,7 @@
 #include "../systems/system.h"
 #include "../systems/parser.h"
 #include "../formatter.h"
+#include "plugin_stats.h"
 
 #include <json.hpp>
 
@@ -28,8 +29,23 @@ enum VoiceCodecType {
   CODEC_YSF_HALFRATE = 5, // YSF half rate: 9 AMBE2250 params, int b[9] cast to uint32_t
 };
 
+#define VOICE_CODEC_MAX_PARAMS 9
+
+// One voice codec frame, as passed to voice_codec_data()
+struct Voice_Codec_Frame {
+  int64_t time_us; // when the frame was decoded, microseconds since the epoch
+  int codec_type;
+  long tgid;
+  uint32_t src_id;
+  int errs;
+  int param_count;
+  uint32_t params[VOICE_CODEC_MAX_PARAMS];
+};
+
 using json = nlohmann::json;
 
+class Upload_Engine;
+
 class Plugin_Api {
 public:
   virtual int init(Config *config, std::vector<Source *> sources, std::vector<System *> systems) { frequency_format = config->frequency_format; return 0; };
@@ -65,4 +81,73 @@ public:
   virtual ~Plugin_Api(){};
 };
 
+/*
+ * Version 2 of the plugin interface.
+ *
+ * Same hooks as Plugin_Api, but vectors and Call_Data_t are passed by const
+ * reference instead of being copied for every plugin on every event. A plugin
+ * opts in by deriving from Plugin_Api_v2 and exporting its factory as
+ * create_plugin_v2 instead of create_plugin. Plugins built against
+ * Plugin_Api keep working: the plugin manager wraps them in an adapter that
+ * makes the copies they expect.
+ *
+ * The Call, System, Source and Recorder pointers are only valid for the
+ * duration of the hook.
+ *
+ * call_end() runs on a call concluder worker and may block, for example on
+ * an upload. Its return value decides whether the call is retried, and the
+ * call's files are removed once every plugin has returned, so the work has
+ * to be finished by then.
+ */
+class Plugin_Api_v2 {
+public:
+  virtual int init(Config *config, const std::vector<Source *> &sources, const std::vector<System *> &systems) { frequency_format = config->frequency_format; return 0; };
+  virtual int parse_config(json config_data) { return 0; };
+  virtual int start() { return 0; };
+  virtual int stop() { return 0; };
+  virtual int poll_one() { return 0; };
+  virtual int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) { return 0; };
+  virtual int audio_stream(Call *call, Recorder *recorder, const int16_t *samples, int sampleCount) { return 0; };
+  virtual int trunk_message(const std::vector<TrunkMessage> &messages, System *system) { return 0; };
+  virtual int call_start(Call *call) { return 0; };
+  virtual int call_end(const Call_Data_t &call_info) { return 0; };
+  virtual int calls_active(const std::vector<Call *> &calls) { return 0; };
+  virtual int setup_recorder(Recorder *recorder) { return 0; };
+  virtual int setup_system(System *system) { return 0; };
+  virtual int setup_systems(const std::vector<System *> &systems) { return 0; };
+  virtual int setup_sources(const std::vector<Source *> &sources) { return 0; };
+  virtual int setup_config(const std::vector<Source *> &sources, const std::vector<System *> &systems) { return 0; };
+  virtual int system_rates(const std::vector<System *> &systems, float timeDiff) { return 0; };
+  virtual int unit_registration(System *sys, long source_id) { return 0; };
+  virtual int unit_deregistration(System *sys, long source_id) { return 0; };
+  virtual int unit_acknowledge_response(System *sys, long source_id) { return 0; };
+  virtual int unit_group_affiliation(System *sys, long source_id, long talkgroup_num) { return 0; };
+  virtual int unit_data_grant(System *sys, long source_id) { return 0; };
+  virtual int unit_answer_request(System *sys, long source_id, long talkgroup) { return 0; };
+  virtual int unit_location(System *sys, long source_id, long talkgroup_num) { return 0; };
+  virtual int voice_codec_data(Call *call, int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs) { return 0; };
+  // Voice codec frames are collected by each recorder and delivered a
+  // superframe (180 ms) at a time, or sooner when the transmission ends. By
+  // default each frame is passed on to voice_codec_data().
+  virtual int voice_codec_batch(Call *call, const Voice_Codec_Frame *frames, int frame_count) {
+    int ret = 0;
+    for (int i = 0; i < frame_count; i++) {
+      const Voice_Codec_Frame &frame = frames[i];
+      if (voice_codec_data(call, frame.codec_type, frame.tgid, frame.src_id, frame.params, frame.param_count, frame.errs) < 0) {
+        ret = -1;
+      }
+    }
+    return ret;
+  };
+  // Hook timings for every loaded plugin, called every few seconds
+  virtual int plugin_stats(const std::vector<Plugin_Hook_Stats> &stats) { return 0; };
+  virtual ~Plugin_Api_v2(){};
+
+  // Shared HTTP upload engine, set by the plugin manager before parse_config()
+  void set_upload_engine(Upload_Engine *engine) { upload_engine = engine; };
+
+protected:
+  Upload_Engine *upload_engine = NULL;
+};
+
 #endif
@@ -0,0 +1,45 @@
+#ifndef PLUGIN_API_V1_ADAPTER_H
+#define PLUGIN_API_V1_ADAPTER_H
+
+#include <boost/shared_ptr.hpp>
+
+#include "plugin_api.h"
+
+// Presents a plugin built against the original Plugin_Api as a
+// Plugin_Api_v2. The copies the v1 hooks take by value are made here, and
+// only for plugins that still need them.
+class Plugin_Api_v1_Adapter : public Plugin_Api_v2 {
+public:
+  explicit Plugin_Api_v1_Adapter(boost::shared_ptr<Plugin_Api> api) : d_api(api) {}
+
+  int init(Config *config, const std::vector<Source *> &sources, const std::vector<System *> &systems) override { return d_api->init(config, sources, systems); }
+  int parse_config(json config_data) override { return d_api->parse_config(config_data); }
+  int start() override { return d_api->start(); }
+  int stop() override { return d_api->stop(); }
+  int poll_one() override { return d_api->poll_one(); }
+  int signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder) override { return d_api->signal(unitId, signaling_type, sig_type, call, system, recorder); }
+  int audio_stream(Call *call, Recorder *recorder, const int16_t *samples, int sampleCount) override { return d_api->audio_stream(call, recorder, const_cast<int16_t *>(samples), sampleCount); }
+  int trunk_message(const std::vector<TrunkMessage> &messages, System *system) override { return d_api->trunk_message(messages, system); }
+  int call_start(Call *call) override { return d_api->call_start(call); }
+  int call_end(const Call_Data_t &call_info) override { return d_api->call_end(call_info); }
+  int calls_active(const std::vector<Call *> &calls) override { return d_api->calls_active(calls); }
+  int setup_recorder(Recorder *recorder) override { return d_api->setup_recorder(recorder); }
+  int setup_system(System *system) override { return d_api->setup_system(system); }
+  int setup_systems(const std::vector<System *> &systems) override { return d_api->setup_systems(systems); }
+  int setup_sources(const std::vector<Source *> &sources) override { return d_api->setup_sources(sources); }
+  int setup_config(const std::vector<Source *> &sources, const std::vector<System *> &systems) override { return d_api->setup_config(sources, systems); }
+  int system_rates(const std::vector<System *> &systems, float timeDiff) override { return d_api->system_rates(systems, timeDiff); }
+  int unit_registration(System *sys, long source_id) override { return d_api->unit_registration(sys, source_id); }
+  int unit_deregistration(System *sys, long source_id) override { return d_api->unit_deregistration(sys, source_id); }
+  int unit_acknowledge_response(System *sys, long source_id) override { return d_api->unit_acknowledge_response(sys, source_id); }
+  int unit_group_affiliation(System *sys, long source_id, long talkgroup_num) override { return d_api->unit_group_affiliation(sys, source_id, talkgroup_num); }
+  int unit_data_grant(System *sys, long source_id) override { return d_api->unit_data_grant(sys, source_id); }
+  int unit_answer_request(System *sys, long source_id, long talkgroup) override { return d_api->unit_answer_request(sys, source_id, talkgroup); }
+  int unit_location(System *sys, long source_id, long talkgroup_num) override { return d_api->unit_location(sys, source_id, talkgroup_num); }
+  int voice_codec_data(Call *call, int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs) override { return d_api->voice_codec_data(call, codec_type, tgid, src_id, params, param_count, errs); }
+
+private:
+  boost::shared_ptr<Plugin_Api> d_api;
+};
+
+#endif
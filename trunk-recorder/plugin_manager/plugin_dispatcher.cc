@@ -0,0 +1,257 @@
+#include "plugin_dispatcher.h"
+
+#include <boost/log/trivial.hpp>
+
+Plugin_Dispatcher::Plugin_Dispatcher(const std::string &name, boost::shared_ptr<Plugin_Api_v2> api, Plugin_Stats *stats, size_t queue_size, Plugin_Overflow overflow)
+    : d_name(name), d_api(api), d_stats(stats), d_overflow(overflow), d_head(0), d_tail(0), d_have_coalesced(false),
+      d_waiting(false), d_stopping(false), d_dropped(0), d_coalesced_count(0), d_delivered(0) {
+  size_t size = 2;
+  while (size < queue_size) {
+    size <<= 1;
+  }
+  d_slots.reset(new Slot[size]);
+  d_mask = size - 1;
+  for (size_t i = 0; i < size; i++) {
+    d_slots[i].seq.store(i, std::memory_order_relaxed);
+  }
+}
+
+Plugin_Dispatcher::~Plugin_Dispatcher() {
+  stop();
+}
+
+void Plugin_Dispatcher::start() {
+  d_stopping = false;
+  d_thread = std::thread(&Plugin_Dispatcher::run, this);
+}
+
+void Plugin_Dispatcher::stop() {
+  if (!d_thread.joinable()) {
+    return;
+  }
+  d_stopping = true;
+  {
+    std::lock_guard<std::mutex> lock(d_wait_mutex);
+    d_wait_cv.notify_one();
+  }
+  d_thread.join();
+}
+
+// Bounded MPMC ring (Vyukov). Every slot carries a sequence number that tells
+// producers and the consumer whose turn it is.
+Plugin_Dispatcher::Slot *Plugin_Dispatcher::claim_slot(bool block) {
+  size_t pos = d_head.load(std::memory_order_relaxed);
+  while (true) {
+    Slot *slot = &d_slots[pos & d_mask];
+    const size_t seq = slot->seq.load(std::memory_order_acquire);
+    const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+
+    if (diff == 0) {
+      if (d_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+        return slot;
+      }
+    } else if (diff < 0) {
+      if (!block || d_stopping) {
+        return NULL;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(200));
+      pos = d_head.load(std::memory_order_relaxed);
+    } else {
+      pos = d_head.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void Plugin_Dispatcher::publish(Slot *slot) {
+  const size_t pos = slot->seq.load(std::memory_order_relaxed);
+  slot->seq.store(pos + 1, std::memory_order_release);
+
+  if (d_waiting.load()) {
+    std::lock_guard<std::mutex> lock(d_wait_mutex);
+    d_wait_cv.notify_one();
+  }
+}
+
+void Plugin_Dispatcher::retire_call(std::shared_ptr<Call> call) {
+  // Never dropped: the call would leak
+  Slot *slot = claim_slot(true);
+  if (!slot) {
+    return;
+  }
+  slot->event.type = EVENT_RETIRE_CALL;
+  slot->event.retired_call = std::move(call);
+  publish(slot);
+}
+
+bool Plugin_Dispatcher::deliver_next() {
+  const size_t tail = d_tail.load(std::memory_order_relaxed);
+  Slot *slot = &d_slots[tail & d_mask];
+  if (slot->seq.load(std::memory_order_acquire) != tail + 1) {
+    return false;
+  }
+
+  if (slot->event.type == EVENT_RETIRE_CALL) {
+    // Coalesced state may still point at the call
+    deliver_coalesced();
+    slot->event.retired_call.reset();
+  } else {
+    deliver(slot->event);
+  }
+
+  slot->seq.store(tail + d_mask + 1, std::memory_order_release);
+  d_tail.store(tail + 1, std::memory_order_relaxed);
+  return true;
+}
+
+void Plugin_Dispatcher::deliver_coalesced() {
+  if (!d_have_coalesced) {
+    return;
+  }
+  std::map<std::pair<int, const void *>, Plugin_Event> pending;
+  {
+    std::lock_guard<std::mutex> lock(d_coalesce_mutex);
+    pending.swap(d_coalesced);
+    d_have_coalesced = false;
+  }
+  for (auto &it : pending) {
+    deliver(it.second);
+  }
+}
+
+void Plugin_Dispatcher::run() {
+  while (true) {
+    int delivered = 0;
+    while ((delivered < 256) && deliver_next()) {
+      delivered++;
+    }
+
+    if (delivered == 0) {
+      deliver_coalesced();
+      if (d_stopping) {
+        return;
+      }
+
+      d_waiting = true;
+      const size_t tail = d_tail.load(std::memory_order_relaxed);
+      if (d_slots[tail & d_mask].seq.load(std::memory_order_acquire) != tail + 1) {
+        std::unique_lock<std::mutex> lock(d_wait_mutex);
+        d_wait_cv.wait_for(lock, std::chrono::milliseconds(10));
+      }
+      d_waiting = false;
+    }
+
+    const uint64_t start = Plugin_Stats::now_ns();
+    d_stats->record(HOOK_POLL_ONE, start, d_api->poll_one());
+  }
+}
+
+void Plugin_Dispatcher::deliver(Plugin_Event &event) {
+  const uint64_t start = Plugin_Stats::now_ns();
+  Plugin_Hook hook;
+  int ret;
+
+  d_delivered++;
+  switch (event.type) {
+  case EVENT_AUDIO_STREAM:
+    hook = HOOK_AUDIO_STREAM;
+    ret = d_api->audio_stream(event.call, event.recorder, event.samples.data(), (int)event.samples.size());
+    break;
+  case EVENT_SIGNAL:
+    hook = HOOK_SIGNAL;
+    ret = d_api->signal(event.source_id, event.signaling_type.c_str(), event.sig_type, event.call, event.system, event.recorder);
+    break;
+  case EVENT_TRUNK_MESSAGE:
+    hook = HOOK_TRUNK_MESSAGE;
+    ret = d_api->trunk_message(event.messages, event.system);
+    break;
+  case EVENT_CALL_START:
+    hook = HOOK_CALL_START;
+    ret = d_api->call_start(event.call);
+    break;
+  case EVENT_CALLS_ACTIVE:
+    hook = HOOK_CALLS_ACTIVE;
+    ret = d_api->calls_active(event.calls);
+    break;
+  case EVENT_SETUP_RECORDER:
+    hook = HOOK_SETUP_RECORDER;
+    ret = d_api->setup_recorder(event.recorder);
+    break;
+  case EVENT_SETUP_SYSTEM:
+    hook = HOOK_SETUP_SYSTEM;
+    ret = d_api->setup_system(event.system);
+    break;
+  case EVENT_SETUP_SYSTEMS:
+    hook = HOOK_SETUP_SYSTEMS;
+    ret = d_api->setup_systems(event.systems);
+    break;
+  case EVENT_SETUP_SOURCES:
+    hook = HOOK_SETUP_SOURCES;
+    ret = d_api->setup_sources(event.sources);
+    break;
+  case EVENT_SETUP_CONFIG:
+    hook = HOOK_SETUP_CONFIG;
+    ret = d_api->setup_config(event.sources, event.systems);
+    break;
+  case EVENT_SYSTEM_RATES:
+    hook = HOOK_SYSTEM_RATES;
+    ret = d_api->system_rates(event.systems, event.time_diff);
+    break;
+  case EVENT_UNIT_REGISTRATION:
+    hook = HOOK_UNIT_REGISTRATION;
+    ret = d_api->unit_registration(event.system, event.source_id);
+    break;
+  case EVENT_UNIT_DEREGISTRATION:
+    hook = HOOK_UNIT_DEREGISTRATION;
+    ret = d_api->unit_deregistration(event.system, event.source_id);
+    break;
+  case EVENT_UNIT_ACKNOWLEDGE_RESPONSE:
+    hook = HOOK_UNIT_ACKNOWLEDGE_RESPONSE;
+    ret = d_api->unit_acknowledge_response(event.system, event.source_id);
+    break;
+  case EVENT_UNIT_GROUP_AFFILIATION:
+    hook = HOOK_UNIT_GROUP_AFFILIATION;
+    ret = d_api->unit_group_affiliation(event.system, event.source_id, event.talkgroup);
+    break;
+  case EVENT_UNIT_DATA_GRANT:
+    hook = HOOK_UNIT_DATA_GRANT;
+    ret = d_api->unit_data_grant(event.system, event.source_id);
+    break;
+  case EVENT_UNIT_ANSWER_REQUEST:
+    hook = HOOK_UNIT_ANSWER_REQUEST;
+    ret = d_api->unit_answer_request(event.system, event.source_id, event.talkgroup);
+    break;
+  case EVENT_UNIT_LOCATION:
+    hook = HOOK_UNIT_LOCATION;
+    ret = d_api->unit_location(event.system, event.source_id, event.talkgroup);
+    break;
+  case EVENT_VOICE_CODEC_BATCH:
+    hook = HOOK_VOICE_CODEC_BATCH;
+    ret = d_api->voice_codec_batch(event.call, event.frames.data(), (int)event.frames.size());
+    break;
+  case EVENT_PLUGIN_STATS:
+    hook = HOOK_PLUGIN_STATS;
+    ret = d_api->plugin_stats(event.stats);
+    break;
+  default:
+    return;
+  }
+  d_stats->record(hook, start, ret);
+}
+
+unsigned long Plugin_Dispatcher::get_dropped() {
+  return d_dropped.load();
+}
+
+unsigned long Plugin_Dispatcher::get_coalesced() {
+  return d_coalesced_count.load();
+}
+
+unsigned long Plugin_Dispatcher::get_delivered() {
+  return d_delivered.load();
+}
+
+size_t Plugin_Dispatcher::get_depth() {
+  const size_t head = d_head.load(std::memory_order_relaxed);
+  const size_t tail = d_tail.load(std::memory_order_relaxed);
+  return head > tail ? head - tail : 0;
+}
@@ -0,0 +1,161 @@
+#ifndef PLUGIN_DISPATCHER_H
+#define PLUGIN_DISPATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "plugin_api.h"
+
+// What to do with an event when a plugin's queue is full
+enum Plugin_Overflow { OVERFLOW_DROP,
+                       OVERFLOW_COALESCE,
+                       OVERFLOW_BLOCK };
+
+enum Plugin_Event_Type { EVENT_AUDIO_STREAM,
+                         EVENT_SIGNAL,
+                         EVENT_TRUNK_MESSAGE,
+                         EVENT_CALL_START,
+                         EVENT_CALLS_ACTIVE,
+                         EVENT_SETUP_RECORDER,
+                         EVENT_SETUP_SYSTEM,
+                         EVENT_SETUP_SYSTEMS,
+                         EVENT_SETUP_SOURCES,
+                         EVENT_SETUP_CONFIG,
+                         EVENT_SYSTEM_RATES,
+                         EVENT_UNIT_REGISTRATION,
+                         EVENT_UNIT_DEREGISTRATION,
+                         EVENT_UNIT_ACKNOWLEDGE_RESPONSE,
+                         EVENT_UNIT_GROUP_AFFILIATION,
+                         EVENT_UNIT_DATA_GRANT,
+                         EVENT_UNIT_ANSWER_REQUEST,
+                         EVENT_UNIT_LOCATION,
+                         EVENT_VOICE_CODEC_BATCH,
+                         EVENT_PLUGIN_STATS,
+                         EVENT_RETIRE_CALL };
+
+// Queue slots are reused, so the vectors keep their capacity and posting an
+// event normally does not allocate.
+struct Plugin_Event {
+  Plugin_Event_Type type;
+  Call *call;
+  Recorder *recorder;
+  System *system;
+  long source_id;
+  long talkgroup;
+  std::string signaling_type;
+  gr::blocks::SignalType sig_type;
+  float time_diff;
+  std::vector<int16_t> samples;
+  std::vector<Voice_Codec_Frame> frames;
+  std::vector<TrunkMessage> messages;
+  std::vector<Call *> calls;
+  std::vector<System *> systems;
+  std::vector<Source *> sources;
+  std::vector<Plugin_Hook_Stats> stats;
+  std::shared_ptr<Call> retired_call;
+};
+
+/*
+ * Delivers plugin hooks on a thread owned by the plugin.
+ *
+ * The recorders and the control channel loop post events into a bounded
+ * lock-free multi-producer ring and return straight away. The plugin's thread
+ * runs the hooks in order, and also calls poll_one(), so a plugin only ever
+ * sees one thread apart from call_end().
+ *
+ * Calls are deleted through retire_call(). The call is only freed once every
+ * dispatcher has run all of the events queued before it, so a plugin never
+ * sees a dangling Call pointer.
+ */
+class Plugin_Dispatcher {
+public:
+  Plugin_Dispatcher(const std::string &name, boost::shared_ptr<Plugin_Api_v2> api, Plugin_Stats *stats, size_t queue_size, Plugin_Overflow overflow);
+  ~Plugin_Dispatcher();
+
+  void start();
+  void stop(); // delivers everything already queued first
+
+  // Coalescable events carry state that a newer event fully replaces. When the
+  // queue is full and the policy is OVERFLOW_COALESCE, only the latest one for
+  // each (type, key) is kept.
+  template <typename Fill>
+  void post(Plugin_Event_Type type, bool coalescable, const void *key, Fill fill);
+  void retire_call(std::shared_ptr<Call> call);
+
+  unsigned long get_dropped();
+  unsigned long get_coalesced();
+  unsigned long get_delivered();
+  size_t get_depth();
+
+private:
+  struct Slot {
+    std::atomic<size_t> seq;
+    Plugin_Event event;
+  };
+
+  std::string d_name;
+  boost::shared_ptr<Plugin_Api_v2> d_api;
+  Plugin_Stats *d_stats;
+  Plugin_Overflow d_overflow;
+
+  std::unique_ptr<Slot[]> d_slots;
+  size_t d_mask;
+  std::atomic<size_t> d_head;
+  std::atomic<size_t> d_tail; // only advanced by the dispatch thread
+
+  std::mutex d_coalesce_mutex;
+  std::map<std::pair<int, const void *>, Plugin_Event> d_coalesced;
+  std::atomic<bool> d_have_coalesced;
+
+  std::mutex d_wait_mutex;
+  std::condition_variable d_wait_cv;
+  std::atomic<bool> d_waiting;
+  std::atomic<bool> d_stopping;
+  std::thread d_thread;
+
+  std::atomic<unsigned long> d_dropped;
+  std::atomic<unsigned long> d_coalesced_count;
+  std::atomic<unsigned long> d_delivered;
+
+  Slot *claim_slot(bool block);
+  void publish(Slot *slot);
+  void run();
+  bool deliver_next();
+  void deliver_coalesced();
+  void deliver(Plugin_Event &event);
+};
+
+template <typename Fill>
+void Plugin_Dispatcher::post(Plugin_Event_Type type, bool coalescable, const void *key, Fill fill) {
+  Slot *slot = claim_slot(d_overflow == OVERFLOW_BLOCK);
+  if (slot) {
+    slot->event.type = type;
+    fill(slot->event);
+    publish(slot);
+    return;
+  }
+
+  if (coalescable && (d_overflow == OVERFLOW_COALESCE)) {
+    std::lock_guard<std::mutex> lock(d_coalesce_mutex);
+    Plugin_Event &event = d_coalesced[std::make_pair((int)type, key)];
+    event.type = type;
+    fill(event);
+    d_have_coalesced = true;
+    d_coalesced_count++;
+    return;
+  }
+
+  d_dropped++;
+}
+
+#endif
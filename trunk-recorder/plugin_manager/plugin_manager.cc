@@ -1,17 +1,72 @@
 #include "plugin_manager.h"
+#include "plugin_api_v1_adapter.h"
+#include "upload_engine.h"
 
 #include "../global_structs.h"
+#include "../metrics.h"
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/dll/import.hpp> // for import_alias
+#include <boost/dll/shared_library.hpp>
+#include <boost/make_shared.hpp>
 #include <boost/foreach.hpp>
 #include <boost/function.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
 #include <stdlib.h>
 #include <vector>
 
 std::vector<Plugin *> plugins;
+static Upload_Engine upload_engine;
+
+static std::string format_plugin_state(plugin_state_t state) {
+  switch (state) {
+  case PLUGIN_INITIALIZED:
+    return "initialized";
+  case PLUGIN_RUNNING:
+    return "running";
+  case PLUGIN_FAILED:
+    return "failed";
+  case PLUGIN_STOPPED:
+    return "stopped";
+  case PLUGIN_DISABLED:
+    return "disabled";
+  default:
+    return "unknown";
+  }
+}
+
+// Plugins run on their own dispatch thread unless they ask for inline, so
+// audio_stream and the other hooks never hold up a recorder or the main loop
+static void parse_dispatch_config(Plugin *plugin, json config_data) {
+  std::string dispatch = config_data.value("dispatch", "async");
+  std::string overflow = config_data.value("overflow", "drop");
+  plugin->async = !boost::iequals(dispatch, "inline");
+  plugin->queue_size = config_data.value("queueSize", 1024);
+
+  if (boost::iequals(overflow, "block")) {
+    plugin->overflow = OVERFLOW_BLOCK;
+  } else if (boost::iequals(overflow, "coalesce")) {
+    plugin->overflow = OVERFLOW_COALESCE;
+  } else {
+    plugin->overflow = OVERFLOW_DROP;
+  }
+
+  if (plugin->async) {
+    BOOST_LOG_TRIVIAL(info) << "Plugin " << plugin->name << " - Dispatch: async\tQueue Size: " << plugin->queue_size << "\tOverflow: " << overflow;
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "Plugin " << plugin->name << " - Dispatch: inline";
+  }
+}
+
+static void parse_watchdog_config(Plugin *plugin, json config_data) {
+  plugin->audio_latency_budget = config_data.value("audioLatencyBudget", 5.0);
+  plugin->disable_when_slow = config_data.value("disableWhenSlow", false);
+}
 
 Plugin *setup_plugin(std::string plugin_lib, std::string plugin_name) {
   BOOST_LOG_TRIVIAL(info) << "Setting up plugin -  Name: " << plugin_name << "\t Library file: " << plugin_lib;
@@ -20,20 +75,30 @@ Plugin *setup_plugin(std::string plugin_lib, std::string plugin_name) {
   // Based on factory plugin method from Boost: https://www.boost.org/doc/libs/1_64_0/doc/html/boost_dll/tutorial.html#boost_dll.tutorial.factory_method_in_plugin
   boost::filesystem::path lib_path("./");
   Plugin *plugin = new Plugin();
-  plugin->creator = boost::dll::import_alias<pluginapi_create_t>( // type of imported symbol must be explicitly specified
-      plugin_lib,                                                 // path to library
-      "create_plugin",                                            // symbol to import
-      boost::dll::load_mode::append_decorations                   // do append extensions and prefixes
-          | boost::dll::load_mode::search_system_folders);
-
-  plugin->api = plugin->creator();
+  const boost::dll::load_mode::type load_mode = boost::dll::load_mode::append_decorations // do append extensions and prefixes
+                                                 | boost::dll::load_mode::search_system_folders;
+
+  // Plugins built against Plugin_Api_v2 export create_plugin_v2, older ones
+  // only export create_plugin and are wrapped so they still get copies.
+  boost::dll::shared_library lib(plugin_lib, load_mode);
+  if (lib.has("create_plugin_v2")) {
+    plugin->creator_v2 = boost::dll::import_alias<pluginapi_v2_create_t>(plugin_lib, "create_plugin_v2", load_mode);
+    plugin->api = plugin->creator_v2();
+    plugin->api_version = 2;
+  } else {
+    plugin->creator = boost::dll::import_alias<pluginapi_create_t>(plugin_lib, "create_plugin", load_mode);
+    plugin->api = boost::make_shared<Plugin_Api_v1_Adapter>(plugin->creator());
+    plugin->api_version = 1;
+  }
+  BOOST_LOG_TRIVIAL(info) << "Plugin " << plugin_name << " uses plugin API v" << plugin->api_version;
+  plugin->api->set_upload_engine(&upload_engine);
   plugin->name = plugin_name;
   plugins.push_back(plugin);
 
   return plugin;
 }
 
-void initialize_plugins(json config_data, Config *config, std::vector<Source *> sources, std::vector<System *> systems) {
+void initialize_plugins(json config_data, Config *config, const Config_Ext &config_ext, const std::vector<Source *> &sources, const std::vector<System *> &systems) {
 
   bool plugins_exists = config_data.contains("plugins");
 
@@ -53,6 +118,8 @@ void initialize_plugins(json config_data, Config *config, std::vector<Source *>
       bool plugin_enabled = element.value("enabled", true);
       if (plugin_enabled) {
         Plugin *plugin = setup_plugin(plugin_lib, plugin_name);
+        parse_dispatch_config(plugin, element);
+        parse_watchdog_config(plugin, element);
         plugin->api->parse_config(element);
       }
     }
@@ -68,6 +135,8 @@ void initialize_plugins(json config_data, Config *config, std::vector<Source *>
     BOOST_LOG_TRIVIAL(info) << "No plugins configured";
   }
 
+  upload_engine.start(config_ext.upload_max_host_connections, config_ext.upload_max_connections);
+
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     int ret = plugin->api->init(config, sources, systems);
@@ -83,10 +152,57 @@ void initialize_plugins(json config_data, Config *config, std::vector<Source *>
 void add_internal_plugin(std::string name, std::string library, json config_data) {
 
   Plugin *plugin = setup_plugin(library, name);
+  parse_dispatch_config(plugin, config_data);
+  parse_watchdog_config(plugin, config_data);
   plugin->api->parse_config(config_data);
 }
 
-void start_plugins(std::vector<Source *> sources, std::vector<System *> systems) {
+// Runs on the metrics server's thread. The plugin list is fixed once the
+// plugins are started, and the server is stopped before they are.
+static void write_plugin_metrics(Metrics_Writer &writer) {
+  // 1us to 17s, four times apart
+  static const std::vector<int> exponents = {10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30, 32, 34};
+  std::vector<double> bounds;
+  for (size_t i = 0; i < exponents.size(); i++) {
+    bounds.push_back(std::ldexp(1.0, exponents[i]) / 1e9);
+  }
+
+  std::vector<uint64_t> buckets;
+  writer.family("trunk_recorder_plugin_hook_seconds", "histogram", "Time spent in each plugin hook");
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    for (int i = 0; i < HOOK_COUNT; i++) {
+      const Plugin_Hook_Histogram &hook = plugin->stats.get_hook((Plugin_Hook)i);
+      if (hook.get_count() == 0) {
+        continue;
+      }
+      hook.merge_buckets(exponents, buckets);
+      const std::string labels = Metrics_Writer::format_labels({{"plugin", plugin->name}, {"hook", plugin_hook_name((Plugin_Hook)i)}});
+      writer.histogram("trunk_recorder_plugin_hook_seconds", labels, bounds, buckets, hook.get_total_ns() / 1e9);
+    }
+  }
+
+  writer.family("trunk_recorder_plugin_hook_errors", "counter", "Plugin hook calls that returned an error");
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    for (int i = 0; i < HOOK_COUNT; i++) {
+      const Plugin_Hook_Histogram &hook = plugin->stats.get_hook((Plugin_Hook)i);
+      if (hook.get_count() > 0) {
+        writer.sample("trunk_recorder_plugin_hook_errors_total", Metric_Labels{{"plugin", plugin->name}, {"hook", plugin_hook_name((Plugin_Hook)i)}}, hook.get_errors());
+      }
+    }
+  }
+
+  writer.family("trunk_recorder_plugin_dropped_events", "counter", "Events an async plugin's queue had no room for");
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    if (plugin->dispatcher) {
+      writer.sample("trunk_recorder_plugin_dropped_events_total", Metric_Labels{{"plugin", plugin->name}}, plugin->dispatcher->get_dropped());
+    }
+  }
+}
+
+void start_plugins(const std::vector<Source *> &sources, const std::vector<System *> &systems) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
 
@@ -102,19 +218,35 @@ void start_plugins(std::vector<Source *> sources, std::vector<System *> systems)
 
     /* ----- Plugin Setup Sources ----- */
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_sources(sources);
+      const uint64_t start = Plugin_Stats::now_ns();
+      plugin->stats.record(HOOK_SETUP_SOURCES, start, plugin->api->setup_sources(sources));
     }
 
     /* ----- Plugin Setup Systems ----- */
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_systems(systems);
+      const uint64_t start = Plugin_Stats::now_ns();
+      plugin->stats.record(HOOK_SETUP_SYSTEMS, start, plugin->api->setup_systems(systems));
+    }
+
+    /* ----- Plugin Dispatch Thread ----- */
+    if ((plugin->state == PLUGIN_RUNNING) && plugin->async) {
+      plugin->dispatcher = new Plugin_Dispatcher(plugin->name, plugin->api, &plugin->stats, plugin->queue_size, plugin->overflow);
+      plugin->dispatcher->start();
     }
   }
+
+  Metrics::add_collector(write_plugin_metrics);
 }
 
 void stop_plugins() {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
+    if (plugin->dispatcher) {
+      plugin->dispatcher->stop();
+      BOOST_LOG_TRIVIAL(info) << "Plugin " << plugin->name << " - Delivered: " << plugin->dispatcher->get_delivered() << "\tDropped: " << plugin->dispatcher->get_dropped() << "\tCoalesced: " << plugin->dispatcher->get_coalesced();
+      delete plugin->dispatcher;
+      plugin->dispatcher = NULL;
+    }
     if (plugin->state == PLUGIN_RUNNING) {
       int err = plugin->api->stop();
       if (err != 0) {
@@ -124,13 +256,16 @@ void stop_plugins() {
     }
     plugin->state = PLUGIN_STOPPED;
   }
+  upload_engine.stop();
 }
 
 void plugman_poll_one() {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
-    if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->poll_one();
+    // async plugins are polled from their own dispatch thread
+    if ((plugin->state == PLUGIN_RUNNING) && !plugin->dispatcher) {
+      const uint64_t start = Plugin_Stats::now_ns();
+      plugin->stats.record(HOOK_POLL_ONE, start, plugin->api->poll_one());
     }
   }
 }
@@ -139,7 +274,16 @@ void plugman_audio_callback(Call *call, Recorder *recorder, int16_t *samples, in
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->audio_stream(call, recorder, samples, sampleCount);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_AUDIO_STREAM, false, NULL, [&](Plugin_Event &e) {
+          e.call = call;
+          e.recorder = recorder;
+          e.samples.assign(samples, samples + sampleCount);
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_AUDIO_STREAM, start, plugin->api->audio_stream(call, recorder, samples, sampleCount));
+      }
     }
   }
 }
@@ -149,18 +293,38 @@ int plugman_signal(long unitId, const char *signaling_type, gr::blocks::SignalTy
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->signal(unitId, signaling_type, sig_type, call, system, recorder);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SIGNAL, false, NULL, [&](Plugin_Event &e) {
+          e.source_id = unitId;
+          e.signaling_type = signaling_type ? signaling_type : "";
+          e.sig_type = sig_type;
+          e.call = call;
+          e.system = system;
+          e.recorder = recorder;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SIGNAL, start, plugin->api->signal(unitId, signaling_type, sig_type, call, system, recorder));
+      }
     }
   }
   return error;
 }
 
-int plugman_trunk_message(std::vector<TrunkMessage> messages, System *system) {
+int plugman_trunk_message(const std::vector<TrunkMessage> &messages, System *system) {
   int error = 0;
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->trunk_message(messages, system);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_TRUNK_MESSAGE, false, NULL, [&](Plugin_Event &e) {
+          e.messages = messages;
+          e.system = system;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_TRUNK_MESSAGE, start, plugin->api->trunk_message(messages, system));
+      }
     }
   }
   return error;
@@ -171,7 +335,14 @@ int plugman_call_start(Call *call) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->call_start(call);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_CALL_START, false, NULL, [&](Plugin_Event &e) {
+          e.call = call;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_CALL_START, start, plugin->api->call_start(call));
+      }
     }
   }
   return error;
@@ -190,7 +361,9 @@ int plugman_call_end(Call_Data_t& call_info) {
     for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
       Plugin *plugin = *it;
       if (plugin->state == PLUGIN_RUNNING) {
+        const uint64_t start = Plugin_Stats::now_ns();
         int plugin_error = plugin->api->call_end(call_info);
+        plugin->stats.record(HOOK_CALL_END, start, plugin_error);
         if (plugin_error) {
           BOOST_LOG_TRIVIAL(error) << loghdr << "Plugin Manager: call_end -  " << plugin->name << " failed.";
           int plugin_index = std::distance(plugins.begin(), it );
@@ -203,10 +376,16 @@ int plugman_call_end(Call_Data_t& call_info) {
   else if (call_info.status == RETRY)
   {
     for (std::vector<int>::iterator it = call_info.plugin_retry_list.begin(); it != call_info.plugin_retry_list.end(); it++) {
+      // Retries replayed from the call journal may predate a config change
+      if ((*it < 0) || (*it >= (int)plugins.size())) {
+        continue;
+      }
       Plugin *plugin = plugins[*it];
       if (plugin->state == PLUGIN_RUNNING) {
         BOOST_LOG_TRIVIAL(info) << loghdr << "Plugin Manager: call_end - retry (" << call_info.retry_attempt << "/" << Call_Concluder::MAX_RETRY << ") - " << plugin->name;
+        const uint64_t start = Plugin_Stats::now_ns();
         int plugin_error = plugin->api->call_end(call_info);
+        plugin->stats.record(HOOK_CALL_END, start, plugin_error);
         if (plugin_error) {
           BOOST_LOG_TRIVIAL(error) << loghdr << "Plugin Manager: call_end - retry (" << call_info.retry_attempt << "/" << Call_Concluder::MAX_RETRY << ") - " << plugin->name << " failed.";
           plugin_retry_list.push_back(*it);
@@ -223,12 +402,19 @@ int plugman_call_end(Call_Data_t& call_info) {
   }
 }
 
-int plugman_calls_active(std::vector<Call *> calls) {
+int plugman_calls_active(const std::vector<Call *> &calls) {
   int error = 0;
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->calls_active(calls);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_CALLS_ACTIVE, true, NULL, [&](Plugin_Event &e) {
+          e.calls = calls;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_CALLS_ACTIVE, start, plugin->api->calls_active(calls));
+      }
     }
   }
   return error;
@@ -238,7 +424,14 @@ void plugman_setup_recorder(Recorder *recorder) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_recorder(recorder);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SETUP_RECORDER, true, recorder, [&](Plugin_Event &e) {
+          e.recorder = recorder;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SETUP_RECORDER, start, plugin->api->setup_recorder(recorder));
+      }
     }
   }
 }
@@ -247,43 +440,80 @@ void plugman_setup_system(System *system) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_system(system);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SETUP_SYSTEM, true, system, [&](Plugin_Event &e) {
+          e.system = system;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SETUP_SYSTEM, start, plugin->api->setup_system(system));
+      }
     }
   }
 }
 
-void plugman_setup_systems(std::vector<System *> systems) {
+void plugman_setup_systems(const std::vector<System *> &systems) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_systems(systems);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SETUP_SYSTEMS, true, NULL, [&](Plugin_Event &e) {
+          e.systems = systems;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SETUP_SYSTEMS, start, plugin->api->setup_systems(systems));
+      }
     }
   }
 }
 
-void plugman_setup_sources(std::vector<Source *> sources) {
+void plugman_setup_sources(const std::vector<Source *> &sources) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_sources(sources);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SETUP_SOURCES, true, NULL, [&](Plugin_Event &e) {
+          e.sources = sources;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SETUP_SOURCES, start, plugin->api->setup_sources(sources));
+      }
     }
   }
 }
 
-void plugman_setup_config(std::vector<Source *> sources, std::vector<System *> systems) {
+void plugman_setup_config(const std::vector<Source *> &sources, const std::vector<System *> &systems) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->setup_config(sources, systems);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SETUP_CONFIG, true, NULL, [&](Plugin_Event &e) {
+          e.sources = sources;
+          e.systems = systems;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SETUP_CONFIG, start, plugin->api->setup_config(sources, systems));
+      }
     }
   }
 }
 
-void plugman_system_rates(std::vector<System *> systems, float timeDiff) {
+void plugman_system_rates(const std::vector<System *> &systems, float timeDiff) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->system_rates(systems, timeDiff);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_SYSTEM_RATES, true, NULL, [&](Plugin_Event &e) {
+          e.systems = systems;
+          e.time_diff = timeDiff;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_SYSTEM_RATES, start, plugin->api->system_rates(systems, timeDiff));
+      }
     }
   }
 }
@@ -292,7 +522,15 @@ void plugman_unit_registration(System *system, long source_id) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_registration(system, source_id);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_REGISTRATION, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_REGISTRATION, start, plugin->api->unit_registration(system, source_id));
+      }
     }
   }
 }
@@ -300,7 +538,15 @@ void plugman_unit_deregistration(System *system, long source_id) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_deregistration(system, source_id);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_DEREGISTRATION, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_DEREGISTRATION, start, plugin->api->unit_deregistration(system, source_id));
+      }
     }
   }
 }
@@ -308,7 +554,15 @@ void plugman_unit_acknowledge_response(System *system, long source_id) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_acknowledge_response(system, source_id);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_ACKNOWLEDGE_RESPONSE, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_ACKNOWLEDGE_RESPONSE, start, plugin->api->unit_acknowledge_response(system, source_id));
+      }
     }
   }
 }
@@ -316,7 +570,16 @@ void plugman_unit_group_affiliation(System *system, long source_id, long talkgro
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_group_affiliation(system, source_id, talkgroup_num);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_GROUP_AFFILIATION, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+          e.talkgroup = talkgroup_num;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_GROUP_AFFILIATION, start, plugin->api->unit_group_affiliation(system, source_id, talkgroup_num));
+      }
     }
   }
 }
@@ -324,7 +587,15 @@ void plugman_unit_data_grant(System *system, long source_id) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_data_grant(system, source_id);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_DATA_GRANT, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_DATA_GRANT, start, plugin->api->unit_data_grant(system, source_id));
+      }
     }
   }
 }
@@ -332,7 +603,16 @@ void plugman_unit_answer_request(System *system, long source_id, long talkgroup)
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_answer_request(system, source_id, talkgroup);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_ANSWER_REQUEST, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+          e.talkgroup = talkgroup;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_ANSWER_REQUEST, start, plugin->api->unit_answer_request(system, source_id, talkgroup));
+      }
     }
   }
 }
@@ -340,16 +620,149 @@ void plugman_unit_location(System *system, long source_id, long talkgroup_num) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->unit_location(system, source_id, talkgroup_num);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_UNIT_LOCATION, false, NULL, [&](Plugin_Event &e) {
+          e.system = system;
+          e.source_id = source_id;
+          e.talkgroup = talkgroup_num;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_UNIT_LOCATION, start, plugin->api->unit_location(system, source_id, talkgroup_num));
+      }
     }
   }
 }
 
-void plugman_voice_codec_data(Call *call, int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs) {
+void plugman_voice_codec_batch(Call *call, const Voice_Codec_Frame *frames, int frame_count) {
   for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
     Plugin *plugin = *it;
     if (plugin->state == PLUGIN_RUNNING) {
-      plugin->api->voice_codec_data(call, codec_type, tgid, src_id, params, param_count, errs);
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_VOICE_CODEC_BATCH, false, NULL, [&](Plugin_Event &e) {
+          e.call = call;
+          e.frames.assign(frames, frames + frame_count);
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        const int ret = plugin->api->voice_codec_batch(call, frames, frame_count);
+        plugin->stats.record(HOOK_VOICE_CODEC_BATCH, start, ret);
+        if (frame_count > 0) {
+          plugin->codec_frame_time.record((Plugin_Stats::now_ns() - start) / frame_count, ret != 0);
+        }
+      }
+    }
+  }
+}
+
+void plugman_retire_call(Call *call) {
+  // Deleted once every async plugin has caught up with the events before it
+  std::shared_ptr<Call> owner(call);
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    // Even a failed plugin may still have events for the call queued
+    if (plugin->dispatcher) {
+      plugin->dispatcher->retire_call(owner);
+    }
+  }
+}
+
+void plugman_plugin_stats() {
+  std::vector<Plugin_Hook_Stats> stats;
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    plugin->stats.get_stats(plugin->name, stats);
+  }
+
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    if (plugin->state == PLUGIN_RUNNING) {
+      if (plugin->dispatcher) {
+        plugin->dispatcher->post(EVENT_PLUGIN_STATS, true, NULL, [&](Plugin_Event &e) {
+          e.stats = stats;
+        });
+      } else {
+        const uint64_t start = Plugin_Stats::now_ns();
+        plugin->stats.record(HOOK_PLUGIN_STATS, start, plugin->api->plugin_stats(stats));
+      }
+    }
+  }
+}
+
+void plugman_check_latency() {
+  // Only the audio path is checked: it runs on the recorder threads, where a
+  // slow inline plugin makes GNU Radio drop samples. Async plugins run those
+  // hooks on their own dispatch thread, which can't hold up a recorder; when
+  // they fall behind, their queue overflow policy applies instead.
+  std::vector<uint64_t> audio;
+  std::vector<uint64_t> codec;
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    if ((plugin->state != PLUGIN_RUNNING) || plugin->dispatcher || (plugin->audio_latency_budget <= 0)) {
+      continue;
+    }
+
+    // A codec batch holds up to a flush worth of frames, and is sometimes
+    // flushed from the main loop, so it is counted per frame to be comparable
+    // with one audio buffer.
+    plugin->stats.get_hook(HOOK_AUDIO_STREAM).snapshot(audio);
+    plugin->codec_frame_time.snapshot(codec);
+    for (size_t i = 0; i < audio.size(); i++) {
+      audio[i] += codec[i];
+    }
+    if (plugin->watchdog_buckets.empty()) {
+      plugin->watchdog_buckets.assign(audio.size(), 0);
+    }
+
+    // Look at what happened since the last check, once there is enough of it
+    std::vector<uint64_t> interval(audio.size());
+    uint64_t count = 0;
+    for (size_t i = 0; i < audio.size(); i++) {
+      interval[i] = audio[i] - plugin->watchdog_buckets[i];
+      count += interval[i];
+    }
+    if (count < 100) {
+      continue;
+    }
+    plugin->watchdog_buckets.swap(audio);
+
+    const double p99 = Plugin_Hook_Histogram::percentile_ns(interval, 99) / 1000000.0;
+    if (p99 <= plugin->audio_latency_budget) {
+      continue;
+    }
+
+    if (plugin->disable_when_slow) {
+      BOOST_LOG_TRIVIAL(error) << "\033[0;31mPlugin " << plugin->name << " - audio path p99 is " << std::fixed << std::setprecision(2) << p99 << " ms, over its budget of " << plugin->audio_latency_budget << " ms. Disabling the plugin.\033[0m";
+      plugin->state = PLUGIN_FAILED;
+    } else if (time(NULL) - plugin->watchdog_warned >= 60) {
+      BOOST_LOG_TRIVIAL(error) << "\033[0;31mPlugin " << plugin->name << " - audio path p99 is " << std::fixed << std::setprecision(2) << p99 << " ms, over its budget of " << plugin->audio_latency_budget << " ms\033[0m";
+      plugin->watchdog_warned = time(NULL);
+    }
+  }
+}
+
+void plugman_print_stats() {
+  if (plugins.empty()) {
+    return;
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Plugins: ";
+  BOOST_LOG_TRIVIAL(info) << "Upload Engine: " << upload_engine.get_active() << " uploading\tCompleted: " << upload_engine.get_completed() << "\tFailed: " << upload_engine.get_failed();
+  for (std::vector<Plugin *>::iterator it = plugins.begin(); it != plugins.end(); it++) {
+    Plugin *plugin = *it;
+    std::vector<Plugin_Hook_Stats> stats;
+    plugin->stats.get_stats(plugin->name, stats);
+
+    std::stringstream line;
+    line << "[" << plugin->name << "]\tState: " << format_plugin_state(plugin->state);
+    if (plugin->dispatcher) {
+      line << "\tQueue: " << plugin->dispatcher->get_depth() << "\tDropped: " << plugin->dispatcher->get_dropped() << "\tCoalesced: " << plugin->dispatcher->get_coalesced();
+    }
+    BOOST_LOG_TRIVIAL(info) << line.str();
+
+    for (std::vector<Plugin_Hook_Stats>::iterator hook = stats.begin(); hook != stats.end(); hook++) {
+      BOOST_LOG_TRIVIAL(info) << "\t" << std::left << std::setw(26) << hook->hook << std::right << " Calls: " << std::setw(8) << hook->count << " Errors: " << std::setw(5) << hook->errors
+                              << std::fixed << std::setprecision(1) << "\tus mean/p50/p99/max: " << hook->mean_us << "/" << hook->p50_us << "/" << hook->p99_us << "/" << hook->max_us;
     }
   }
 }
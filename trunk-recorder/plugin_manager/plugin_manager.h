@@ -8,41 +8,57 @@
 #include "../systems/system_impl.h"
 
 #include "plugin_api.h"
+#include "plugin_dispatcher.h"
+#include "plugin_stats.h"
 #if GNURADIO_VERSION >= 0x030a00
 #include <boost/function.hpp>
 #endif
 #include <boost/optional/optional.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <atomic>
 #include <stdlib.h>
 #include <vector>
 
 typedef boost::shared_ptr<Plugin_Api>(pluginapi_create_t)();
+typedef boost::shared_ptr<Plugin_Api_v2>(pluginapi_v2_create_t)();
 
 struct Plugin {
   boost::function<pluginapi_create_t> creator;
-  boost::shared_ptr<Plugin_Api> api;
-  plugin_state_t state;
+  boost::function<pluginapi_v2_create_t> creator_v2;
+  boost::shared_ptr<Plugin_Api_v2> api;
+  int api_version = 0;
+  std::atomic<plugin_state_t> state{PLUGIN_UNKNOWN}; // the watchdog can fail a plugin while hooks are running
   std::string name;
+  bool async = false;
+  size_t queue_size = 1024;
+  Plugin_Overflow overflow = OVERFLOW_DROP;
+  Plugin_Dispatcher *dispatcher = NULL;
+  Plugin_Stats stats;
+  Plugin_Hook_Histogram codec_frame_time; // voice_codec_batch time divided by its frame count
+  double audio_latency_budget = 5.0; // ms at p99, 0 to disable
+  bool disable_when_slow = false;
+  std::vector<uint64_t> watchdog_buckets; // audio path histogram at the last check
+  time_t watchdog_warned = 0;
 };
 
-void initialize_plugins(json config_data, Config *config, std::vector<Source *> sources, std::vector<System *> systems);
+void initialize_plugins(json config_data, Config *config, const Config_Ext &config_ext, const std::vector<Source *> &sources, const std::vector<System *> &systems);
 void add_internal_plugin(std::string name, std::string library, json config_data);
-void start_plugins(std::vector<Source *> sources, std::vector<System *> systems);
+void start_plugins(const std::vector<Source *> &sources, const std::vector<System *> &systems);
 void stop_plugins();
 
 void plugman_poll_one();
 void plugman_audio_callback(Call *call, Recorder *recorder, int16_t *samples, int sampleCount);
 int plugman_signal(long unitId, const char *signaling_type, gr::blocks::SignalType sig_type, Call *call, System *system, Recorder *recorder);
-int plugman_trunk_message(std::vector<TrunkMessage> messages, System *system);
+int plugman_trunk_message(const std::vector<TrunkMessage> &messages, System *system);
 int plugman_call_start(Call *call);
 int plugman_call_end(Call_Data_t& call_info);
-int plugman_calls_active(std::vector<Call *> calls);
+int plugman_calls_active(const std::vector<Call *> &calls);
 void plugman_setup_recorder(Recorder *recorder);
 void plugman_setup_system(System *system);
-void plugman_setup_systems(std::vector<System *> systems);
-void plugman_setup_sources(std::vector<Source *> sources);
-void plugman_setup_config(std::vector<Source *> sources, std::vector<System *> systems);
-void plugman_system_rates(std::vector<System *> systems, float timeDiff);
+void plugman_setup_systems(const std::vector<System *> &systems);
+void plugman_setup_sources(const std::vector<Source *> &sources);
+void plugman_setup_config(const std::vector<Source *> &sources, const std::vector<System *> &systems);
+void plugman_system_rates(const std::vector<System *> &systems, float timeDiff);
 void plugman_unit_registration(System *system, long source_id);
 void plugman_unit_deregistration(System *system, long source_id);
 void plugman_unit_acknowledge_response(System *system, long source_id);
@@ -50,5 +66,9 @@ void plugman_unit_group_affiliation(System *system, long source_id, long talkgro
 void plugman_unit_data_grant(System *system, long source_id);
 void plugman_unit_answer_request(System *system, long source_id, long talkgroup);
 void plugman_unit_location(System *system, long source_id, long talkgroup_num);
-void plugman_voice_codec_data(Call *call, int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs);
+void plugman_retire_call(Call *call);
+void plugman_voice_codec_batch(Call *call, const Voice_Codec_Frame *frames, int frame_count);
+void plugman_plugin_stats();
+void plugman_check_latency();
+void plugman_print_stats();
 #endif // PLUGIN_MANAGER_H
@@ -0,0 +1,155 @@
+#include "plugin_stats.h"
+
+#include <cmath>
+
+const char *plugin_hook_name(Plugin_Hook hook) {
+  switch (hook) {
+  case HOOK_POLL_ONE:
+    return "poll_one";
+  case HOOK_SIGNAL:
+    return "signal";
+  case HOOK_AUDIO_STREAM:
+    return "audio_stream";
+  case HOOK_TRUNK_MESSAGE:
+    return "trunk_message";
+  case HOOK_CALL_START:
+    return "call_start";
+  case HOOK_CALL_END:
+    return "call_end";
+  case HOOK_CALLS_ACTIVE:
+    return "calls_active";
+  case HOOK_SETUP_RECORDER:
+    return "setup_recorder";
+  case HOOK_SETUP_SYSTEM:
+    return "setup_system";
+  case HOOK_SETUP_SYSTEMS:
+    return "setup_systems";
+  case HOOK_SETUP_SOURCES:
+    return "setup_sources";
+  case HOOK_SETUP_CONFIG:
+    return "setup_config";
+  case HOOK_SYSTEM_RATES:
+    return "system_rates";
+  case HOOK_UNIT_REGISTRATION:
+    return "unit_registration";
+  case HOOK_UNIT_DEREGISTRATION:
+    return "unit_deregistration";
+  case HOOK_UNIT_ACKNOWLEDGE_RESPONSE:
+    return "unit_acknowledge_response";
+  case HOOK_UNIT_GROUP_AFFILIATION:
+    return "unit_group_affiliation";
+  case HOOK_UNIT_DATA_GRANT:
+    return "unit_data_grant";
+  case HOOK_UNIT_ANSWER_REQUEST:
+    return "unit_answer_request";
+  case HOOK_UNIT_LOCATION:
+    return "unit_location";
+  case HOOK_VOICE_CODEC_BATCH:
+    return "voice_codec_batch";
+  case HOOK_PLUGIN_STATS:
+    return "plugin_stats";
+  default:
+    return "unknown";
+  }
+}
+
+Plugin_Hook_Histogram::Plugin_Hook_Histogram() : d_count(0), d_errors(0), d_total_ns(0), d_max_ns(0) {
+  for (int i = 0; i < BUCKETS; i++) {
+    d_buckets[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+int Plugin_Hook_Histogram::bucket_index(uint64_t ns) {
+  if (ns < SUB_BUCKETS) {
+    return (int)ns;
+  }
+  const int msb = 63 - __builtin_clzll(ns);
+  const int sub = (int)((ns >> (msb - 2)) & (SUB_BUCKETS - 1));
+  const int index = (msb - 1) * SUB_BUCKETS + sub;
+  return index < BUCKETS ? index : BUCKETS - 1;
+}
+
+double Plugin_Hook_Histogram::bucket_value(int index) {
+  if (index < SUB_BUCKETS) {
+    return index;
+  }
+  // Middle of the bucket
+  const int msb = index / SUB_BUCKETS + 1;
+  const int sub = index % SUB_BUCKETS;
+  return std::ldexp(SUB_BUCKETS + sub + 0.5, msb - 2);
+}
+
+void Plugin_Hook_Histogram::record(uint64_t ns, bool error) {
+  d_buckets[bucket_index(ns)].fetch_add(1, std::memory_order_relaxed);
+  d_count.fetch_add(1, std::memory_order_relaxed);
+  d_total_ns.fetch_add(ns, std::memory_order_relaxed);
+  if (error) {
+    d_errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  uint64_t max = d_max_ns.load(std::memory_order_relaxed);
+  while ((ns > max) && !d_max_ns.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+void Plugin_Hook_Histogram::snapshot(std::vector<uint64_t> &buckets) const {
+  buckets.resize(BUCKETS);
+  for (int i = 0; i < BUCKETS; i++) {
+    buckets[i] = d_buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+void Plugin_Hook_Histogram::merge_buckets(const std::vector<int> &exponents, std::vector<uint64_t> &buckets) const {
+  buckets.assign(exponents.size() + 1, 0);
+  size_t merged = 0;
+  for (int i = 0; i < BUCKETS; i++) {
+    // Values below 2^e are in the buckets before (e - 1) * SUB_BUCKETS
+    while ((merged < exponents.size()) && (i >= (exponents[merged] - 1) * SUB_BUCKETS)) {
+      merged++;
+    }
+    buckets[merged] += d_buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+double Plugin_Hook_Histogram::percentile_ns(const std::vector<uint64_t> &buckets, double percentile) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    total += buckets[i];
+  }
+  if (total == 0) {
+    return 0;
+  }
+
+  const uint64_t rank = (uint64_t)std::ceil(total * percentile / 100.0);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < buckets.size(); i++) {
+    seen += buckets[i];
+    if ((seen >= rank) && (buckets[i] > 0)) {
+      return bucket_value((int)i);
+    }
+  }
+  return bucket_value(BUCKETS - 1);
+}
+
+void Plugin_Stats::get_stats(const std::string &plugin, std::vector<Plugin_Hook_Stats> &stats) const {
+  std::vector<uint64_t> buckets;
+  for (int i = 0; i < HOOK_COUNT; i++) {
+    const Plugin_Hook_Histogram &hook = d_hooks[i];
+    const unsigned long count = hook.get_count();
+    if (count == 0) {
+      continue;
+    }
+
+    hook.snapshot(buckets);
+    Plugin_Hook_Stats entry;
+    entry.plugin = plugin;
+    entry.hook = plugin_hook_name((Plugin_Hook)i);
+    entry.count = count;
+    entry.errors = hook.get_errors();
+    entry.mean_us = hook.get_total_ns() / 1000.0 / count;
+    entry.p50_us = Plugin_Hook_Histogram::percentile_ns(buckets, 50) / 1000.0;
+    entry.p99_us = Plugin_Hook_Histogram::percentile_ns(buckets, 99) / 1000.0;
+    entry.max_us = hook.get_max_ns() / 1000.0;
+    stats.push_back(entry);
+  }
+}
@@ -0,0 +1,109 @@
+#ifndef PLUGIN_STATS_H
+#define PLUGIN_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+enum Plugin_Hook { HOOK_POLL_ONE,
+                   HOOK_SIGNAL,
+                   HOOK_AUDIO_STREAM,
+                   HOOK_TRUNK_MESSAGE,
+                   HOOK_CALL_START,
+                   HOOK_CALL_END,
+                   HOOK_CALLS_ACTIVE,
+                   HOOK_SETUP_RECORDER,
+                   HOOK_SETUP_SYSTEM,
+                   HOOK_SETUP_SYSTEMS,
+                   HOOK_SETUP_SOURCES,
+                   HOOK_SETUP_CONFIG,
+                   HOOK_SYSTEM_RATES,
+                   HOOK_UNIT_REGISTRATION,
+                   HOOK_UNIT_DEREGISTRATION,
+                   HOOK_UNIT_ACKNOWLEDGE_RESPONSE,
+                   HOOK_UNIT_GROUP_AFFILIATION,
+                   HOOK_UNIT_DATA_GRANT,
+                   HOOK_UNIT_ANSWER_REQUEST,
+                   HOOK_UNIT_LOCATION,
+                   HOOK_VOICE_CODEC_BATCH,
+                   HOOK_PLUGIN_STATS,
+                   HOOK_COUNT };
+
+const char *plugin_hook_name(Plugin_Hook hook);
+
+// What a plugin's plugin_stats() hook receives, one entry per plugin and hook
+// that has been called at least once. Times are in microseconds.
+struct Plugin_Hook_Stats {
+  std::string plugin;
+  std::string hook;
+  unsigned long count;
+  unsigned long errors;
+  double mean_us;
+  double p50_us;
+  double p99_us;
+  double max_us;
+};
+
+/*
+ * Latency histogram for one plugin hook.
+ *
+ * Buckets are log-linear: four per power of two of nanoseconds, so a
+ * percentile is accurate to within about 20%. Recording is a handful of
+ * relaxed atomic adds and is safe from any number of threads.
+ */
+class Plugin_Hook_Histogram {
+public:
+  static const int SUB_BUCKETS = 4;
+  static const int BUCKETS = 42 * SUB_BUCKETS; // up to 2^42 ns, about an hour
+
+  Plugin_Hook_Histogram();
+
+  void record(uint64_t ns, bool error);
+
+  unsigned long get_count() const { return d_count.load(std::memory_order_relaxed); }
+  unsigned long get_errors() const { return d_errors.load(std::memory_order_relaxed); }
+  uint64_t get_total_ns() const { return d_total_ns.load(std::memory_order_relaxed); }
+  uint64_t get_max_ns() const { return d_max_ns.load(std::memory_order_relaxed); }
+
+  // Copies the bucket counts, for computing percentiles over an interval
+  void snapshot(std::vector<uint64_t> &buckets) const;
+
+  static double percentile_ns(const std::vector<uint64_t> &buckets, double percentile);
+
+  // Merges the counts into coarser buckets with upper edges at 2^exponent ns,
+  // for the metrics endpoint. Every power of two is already an edge, so no
+  // bucket is split. The extra last entry counts everything above.
+  void merge_buckets(const std::vector<int> &exponents, std::vector<uint64_t> &buckets) const;
+
+private:
+  std::atomic<uint64_t> d_buckets[BUCKETS];
+  std::atomic<unsigned long> d_count;
+  std::atomic<unsigned long> d_errors;
+  std::atomic<uint64_t> d_total_ns;
+  std::atomic<uint64_t> d_max_ns;
+
+  static int bucket_index(uint64_t ns);
+  static double bucket_value(int index);
+};
+
+// Per-plugin timings for every hook
+class Plugin_Stats {
+public:
+  static uint64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
+  void record(Plugin_Hook hook, uint64_t start_ns, int ret) {
+    d_hooks[hook].record(now_ns() - start_ns, ret != 0);
+  }
+
+  const Plugin_Hook_Histogram &get_hook(Plugin_Hook hook) const { return d_hooks[hook]; }
+  void get_stats(const std::string &plugin, std::vector<Plugin_Hook_Stats> &stats) const;
+
+private:
+  Plugin_Hook_Histogram d_hooks[HOOK_COUNT];
+};
+
+#endif
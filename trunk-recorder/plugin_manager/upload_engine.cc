@@ -0,0 +1,278 @@
+#include "upload_engine.h"
+
+#include <algorithm>
+#include <future>
+#include <sys/stat.h>
+
+#include <boost/log/trivial.hpp>
+
+Upload_Engine::Upload_Engine()
+    : d_multi(NULL), d_share(NULL), d_running(false), d_stopping(false), d_active(0), d_completed(0), d_failed(0) {}
+
+Upload_Engine::~Upload_Engine() {
+  stop();
+}
+
+void Upload_Engine::start(int max_host_connections, int max_connections) {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (d_running) {
+    return;
+  }
+
+  d_multi = curl_multi_init();
+  curl_multi_setopt(d_multi, CURLMOPT_MAX_HOST_CONNECTIONS, (long)max_host_connections);
+  curl_multi_setopt(d_multi, CURLMOPT_MAX_TOTAL_CONNECTIONS, (long)max_connections);
+  curl_multi_setopt(d_multi, CURLMOPT_MAXCONNECTS, (long)max_connections);
+  curl_multi_setopt(d_multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+
+  d_share = curl_share_init();
+  curl_share_setopt(d_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+  BOOST_LOG_TRIVIAL(info) << "Upload Engine: " << max_host_connections << " connections per host, " << max_connections << " in total";
+
+  d_running = true;
+  d_stopping = false;
+  d_thread = std::thread(&Upload_Engine::run, this);
+}
+
+void Upload_Engine::stop() {
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (!d_running) {
+      return;
+    }
+    d_stopping = true;
+  }
+  wakeup();
+  d_thread.join();
+
+  std::lock_guard<std::mutex> lock(d_mutex);
+  for (std::vector<CURL *>::iterator it = d_idle_handles.begin(); it != d_idle_handles.end(); ++it) {
+    curl_easy_cleanup(*it);
+  }
+  d_idle_handles.clear();
+  curl_multi_cleanup(d_multi);
+  curl_share_cleanup(d_share);
+  d_multi = NULL;
+  d_share = NULL;
+  d_running = false;
+}
+
+void Upload_Engine::wakeup() {
+#if LIBCURL_VERSION_NUM >= 0x074400
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (d_multi) {
+    curl_multi_wakeup(d_multi);
+  }
+#endif
+}
+
+void Upload_Engine::submit(const Upload_Request &request, Callback callback) {
+  Transfer *transfer = new Transfer();
+  transfer->request = request;
+  transfer->callback = callback;
+
+  {
+    std::lock_guard<std::mutex> lock(d_mutex);
+    if (!d_stopping) {
+      d_pending.push_back(transfer);
+      transfer = NULL;
+    }
+  }
+
+  if (transfer) {
+    // Shutting down
+    transfer->result.curl_code = CURLE_ABORTED_BY_CALLBACK;
+    transfer->callback(transfer->result);
+    delete transfer;
+    return;
+  }
+  wakeup();
+}
+
+Upload_Result Upload_Engine::perform(const Upload_Request &request) {
+  std::promise<Upload_Result> done;
+  std::future<Upload_Result> result = done.get_future();
+  submit(request, [&done](const Upload_Result &r) { done.set_value(r); });
+  return result.get();
+}
+
+size_t Upload_Engine::write_callback(void *contents, size_t size, size_t nmemb, void *userp) {
+  ((std::string *)userp)->append((char *)contents, size * nmemb);
+  return size * nmemb;
+}
+
+CURLcode Upload_Engine::begin(Transfer *transfer) {
+  const Upload_Request &request = transfer->request;
+
+  CURL *curl;
+  if (!d_idle_handles.empty()) {
+    curl = d_idle_handles.back();
+    d_idle_handles.pop_back();
+  } else {
+    curl = curl_easy_init();
+    if (!curl) {
+      return CURLE_FAILED_INIT;
+    }
+  }
+  transfer->curl = curl;
+
+  curl_easy_setopt(curl, CURLOPT_URL, request.url.c_str());
+  curl_easy_setopt(curl, CURLOPT_USERAGENT, "TrunkRecorder1.0");
+  curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer);
+  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, write_callback);
+  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->result.response);
+  curl_easy_setopt(curl, CURLOPT_ERRORBUFFER, transfer->error_buffer);
+  curl_easy_setopt(curl, CURLOPT_SHARE, d_share);
+  curl_easy_setopt(curl, CURLOPT_DNS_CACHE_TIMEOUT, 300L);
+  curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+  // Wait for a connection that can be multiplexed rather than opening another
+  curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+  curl_easy_setopt(curl, CURLOPT_CONNECTTIMEOUT, request.connect_timeout);
+  if (request.timeout > 0) {
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, request.timeout);
+  }
+  if (!request.verify_ssl) {
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 0L);
+    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYHOST, 0L);
+  }
+
+  /* Expect: 100-continue is not wanted */
+  transfer->headers = curl_slist_append(transfer->headers, "Expect:");
+  for (std::vector<std::string>::const_iterator it = request.headers.begin(); it != request.headers.end(); ++it) {
+    transfer->headers = curl_slist_append(transfer->headers, it->c_str());
+  }
+
+  if (!request.put_file.empty()) {
+    struct stat file_info;
+    transfer->put_file = fopen(request.put_file.c_str(), "rb");
+    if (!transfer->put_file || (fstat(fileno(transfer->put_file), &file_info) != 0)) {
+      BOOST_LOG_TRIVIAL(error) << "Upload Engine: error opening file " << request.put_file;
+      return CURLE_READ_ERROR;
+    }
+
+    /* Transfer-Encoding: chunked is not wanted */
+    transfer->headers = curl_slist_append(transfer->headers, "Transfer-Encoding:");
+    curl_easy_setopt(curl, CURLOPT_UPLOAD, 1L);
+    curl_easy_setopt(curl, CURLOPT_READDATA, transfer->put_file);
+    curl_easy_setopt(curl, CURLOPT_INFILESIZE_LARGE, (curl_off_t)file_info.st_size);
+  } else {
+    transfer->mime = curl_mime_init(curl);
+    for (std::vector<Upload_Part>::const_iterator it = request.parts.begin(); it != request.parts.end(); ++it) {
+      curl_mimepart *part = curl_mime_addpart(transfer->mime);
+      if (!it->file.empty()) {
+        curl_mime_filedata(part, it->file.c_str());
+      } else {
+        curl_mime_data(part, it->data.c_str(), it->data.size());
+      }
+      if (!it->filename.empty()) {
+        curl_mime_filename(part, it->filename.c_str());
+      }
+      if (!it->type.empty()) {
+        curl_mime_type(part, it->type.c_str());
+      }
+      curl_mime_name(part, it->name.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_MIMEPOST, transfer->mime);
+  }
+  curl_easy_setopt(curl, CURLOPT_HTTPHEADER, transfer->headers);
+
+  if (curl_multi_add_handle(d_multi, curl) != CURLM_OK) {
+    return CURLE_FAILED_INIT;
+  }
+  d_in_flight.push_back(transfer);
+  return CURLE_OK;
+}
+
+void Upload_Engine::finish(Transfer *transfer, CURLcode code) {
+  std::vector<Transfer *>::iterator in_flight = std::find(d_in_flight.begin(), d_in_flight.end(), transfer);
+  if (in_flight != d_in_flight.end()) {
+    d_in_flight.erase(in_flight);
+    curl_multi_remove_handle(d_multi, transfer->curl);
+  }
+
+  if (transfer->curl) {
+    curl_easy_getinfo(transfer->curl, CURLINFO_RESPONSE_CODE, &transfer->result.response_code);
+    curl_easy_getinfo(transfer->curl, CURLINFO_TOTAL_TIME, &transfer->result.total_time);
+    // The handle goes back to the pool; the connection stays in the multi
+    // handle's cache for the next request to the same host.
+    curl_easy_reset(transfer->curl);
+    d_idle_handles.push_back(transfer->curl);
+  }
+  if (transfer->mime) {
+    curl_mime_free(transfer->mime);
+  }
+  if (transfer->headers) {
+    curl_slist_free_all(transfer->headers);
+  }
+  if (transfer->put_file) {
+    fclose(transfer->put_file);
+  }
+
+  transfer->result.curl_code = code;
+  if ((code != CURLE_OK) && transfer->error_buffer[0]) {
+    transfer->result.error_detail = transfer->error_buffer;
+  }
+  if ((code != CURLE_OK) || (transfer->result.response_code >= 400)) {
+    d_failed++;
+  } else {
+    d_completed++;
+  }
+
+  transfer->callback(transfer->result);
+  delete transfer;
+}
+
+void Upload_Engine::run() {
+  std::deque<Transfer *> starting;
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(d_mutex);
+      if (d_stopping) {
+        starting.swap(d_pending);
+        break;
+      }
+      starting.swap(d_pending);
+    }
+
+    for (std::deque<Transfer *>::iterator it = starting.begin(); it != starting.end(); ++it) {
+      CURLcode code = begin(*it);
+      if (code != CURLE_OK) {
+        finish(*it, code);
+      }
+    }
+    starting.clear();
+
+    int still_running = 0;
+    curl_multi_perform(d_multi, &still_running);
+
+    CURLMsg *msg;
+    int msgs_left;
+    while ((msg = curl_multi_info_read(d_multi, &msgs_left))) {
+      if (msg->msg == CURLMSG_DONE) {
+        Transfer *transfer = NULL;
+        const CURLcode code = msg->data.result;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, (char **)&transfer);
+        finish(transfer, code);
+      }
+    }
+    d_active = d_in_flight.size();
+
+#if LIBCURL_VERSION_NUM >= 0x074400
+    curl_multi_poll(d_multi, NULL, 0, 1000, NULL);
+#else
+    curl_multi_wait(d_multi, NULL, 0, 100, NULL);
+#endif
+  }
+
+  // Nothing is left waiting on a result that will never come
+  while (!d_in_flight.empty()) {
+    finish(d_in_flight.back(), CURLE_ABORTED_BY_CALLBACK);
+  }
+  for (std::deque<Transfer *>::iterator it = starting.begin(); it != starting.end(); ++it) {
+    finish(*it, CURLE_ABORTED_BY_CALLBACK);
+  }
+  d_active = 0;
+}
@@ -0,0 +1,117 @@
+#ifndef UPLOAD_ENGINE_H
+#define UPLOAD_ENGINE_H
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// One field of a multipart/form-data POST
+struct Upload_Part {
+  std::string name;
+  std::string data;     // sent as the value unless file is set
+  std::string file;     // send the contents of this file instead
+  std::string filename; // optional filename for the part
+  std::string type;     // optional content type for the part
+};
+
+// What the uploader plugins use when uploadTimeout is not set. Their
+// call_end() waits for the upload, so without a limit a server that stops
+// responding would hold a call concluder worker for good.
+static const long UPLOAD_DEFAULT_TIMEOUT = 300; // seconds
+
+struct Upload_Request {
+  std::string url;
+  std::vector<Upload_Part> parts; // multipart/form-data POST
+  std::string put_file;           // when set, PUT this file instead of POSTing parts
+  std::vector<std::string> headers;
+  bool verify_ssl = true;
+  long connect_timeout = 15; // seconds
+  long timeout = 0;          // seconds for the whole transfer, 0 for none
+};
+
+struct Upload_Result {
+  CURLcode curl_code = CURLE_OK;
+  long response_code = 0;
+  std::string response;
+  std::string error_detail; // from curl's error buffer, when it has more to say
+  double total_time = 0;
+
+  std::string error() const { return error_detail.empty() ? curl_easy_strerror(curl_code) : error_detail; }
+};
+
+/*
+ * HTTP upload engine shared by the uploader plugins.
+ *
+ * One thread drives a curl_multi handle for every upload, so connections,
+ * TLS sessions and DNS lookups are kept and reused between calls instead of
+ * being set up again for each one. The number of connections to a single
+ * host, and in total, is bounded and requests to a host wait for a free
+ * connection. HTTP/2 servers get their requests multiplexed on one
+ * connection.
+ *
+ * Completion callbacks run on the engine thread and must not block.
+ */
+class Upload_Engine {
+public:
+  typedef std::function<void(const Upload_Result &)> Callback;
+
+  Upload_Engine();
+  ~Upload_Engine();
+
+  void start(int max_host_connections, int max_connections);
+  void stop(); // fails anything still pending or in flight
+
+  void submit(const Upload_Request &request, Callback callback);
+
+  // Submits the request and waits for it. The calling thread only sleeps,
+  // the transfer itself still runs on the engine thread.
+  Upload_Result perform(const Upload_Request &request);
+
+  unsigned long get_completed() const { return d_completed.load(); }
+  unsigned long get_failed() const { return d_failed.load(); }
+  size_t get_active() const { return d_active.load(); }
+
+private:
+  struct Transfer {
+    Upload_Request request;
+    Callback callback;
+    Upload_Result result;
+    CURL *curl = NULL;
+    curl_mime *mime = NULL;
+    struct curl_slist *headers = NULL;
+    FILE *put_file = NULL;
+    char error_buffer[CURL_ERROR_SIZE] = {0};
+  };
+
+  CURLM *d_multi;
+  CURLSH *d_share; // TLS sessions for every pooled handle
+  std::thread d_thread;
+
+  std::mutex d_mutex;
+  std::deque<Transfer *> d_pending;
+  bool d_running;
+  bool d_stopping;
+
+  // Only touched by the engine thread
+  std::vector<CURL *> d_idle_handles;
+  std::vector<Transfer *> d_in_flight;
+
+  std::atomic<size_t> d_active;
+  std::atomic<unsigned long> d_completed;
+  std::atomic<unsigned long> d_failed;
+
+  void run();
+  CURLcode begin(Transfer *transfer);
+  void finish(Transfer *transfer, CURLcode code);
+  void wakeup();
+
+  static size_t write_callback(void *contents, size_t size, size_t nmemb, void *userp);
+};
+
+#endif
@@ -0,0 +1,321 @@
+/*
+ * Runs Upload_Engine against a small HTTP server on 127.0.0.1, so the
+ * connection pooling, timeouts and shutdown can be checked without an
+ * OpenMHz, Broadcastify or Rdio Scanner server.
+ *
+ * Build with -DUPLOAD_ENGINE_TEST=ON and run:
+ *
+ *   ./upload_engine_test
+ *
+ * It exits with a non-zero status if any check fails.
+ */
+
+#include "upload_engine.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * Just enough HTTP/1.1 for the engine: reads a request with a
+ * Content-Length body, answers 200 with a short body and keeps the
+ * connection open. A request for /slow is answered after a delay.
+ */
+class Stand_In_Server {
+public:
+  Stand_In_Server() : d_fd(-1), d_port(0), d_stopping(false), d_connections(0), d_requests(0), d_bytes(0) {}
+
+  ~Stand_In_Server() {
+    stop();
+  }
+
+  bool start() {
+    d_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (d_fd < 0) {
+      return false;
+    }
+    int one = 1;
+    setsockopt(d_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    socklen_t len = sizeof(addr);
+    if ((bind(d_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) || (listen(d_fd, 64) != 0) || (getsockname(d_fd, (struct sockaddr *)&addr, &len) != 0)) {
+      close(d_fd);
+      d_fd = -1;
+      return false;
+    }
+    d_port = ntohs(addr.sin_port);
+    d_accept = std::thread(&Stand_In_Server::accept_loop, this);
+    return true;
+  }
+
+  void stop() {
+    if (d_fd < 0) {
+      return;
+    }
+    // shutdown() wakes accept(); the socket is closed once nothing uses it
+    d_stopping = true;
+    shutdown(d_fd, SHUT_RDWR);
+    d_accept.join();
+    close(d_fd);
+    d_fd = -1;
+
+    std::lock_guard<std::mutex> lock(d_mutex);
+    for (size_t i = 0; i < d_clients.size(); i++) {
+      shutdown(d_clients[i], SHUT_RDWR);
+    }
+    for (size_t i = 0; i < d_threads.size(); i++) {
+      d_threads[i].join();
+    }
+  }
+
+  std::string url(const std::string &path) const {
+    return "http://127.0.0.1:" + std::to_string(d_port) + path;
+  }
+
+  unsigned long get_connections() const { return d_connections.load(); }
+  unsigned long get_requests() const { return d_requests.load(); }
+  unsigned long long get_bytes() const { return d_bytes.load(); }
+
+private:
+  int d_fd;
+  int d_port;
+  std::atomic<bool> d_stopping;
+  std::atomic<unsigned long> d_connections;
+  std::atomic<unsigned long> d_requests;
+  std::atomic<unsigned long long> d_bytes;
+  std::thread d_accept;
+  std::mutex d_mutex;
+  std::vector<int> d_clients;
+  std::vector<std::thread> d_threads;
+
+  void accept_loop() {
+    while (!d_stopping) {
+      int client = accept(d_fd, NULL, NULL);
+      if (client < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        return;
+      }
+      d_connections++;
+      std::lock_guard<std::mutex> lock(d_mutex);
+      d_clients.push_back(client);
+      d_threads.push_back(std::thread(&Stand_In_Server::serve, this, client));
+    }
+  }
+
+  void serve(int client) {
+    std::string buffer;
+    char chunk[16384];
+
+    while (!d_stopping) {
+      size_t header_end;
+      while ((header_end = buffer.find("\r\n\r\n")) == std::string::npos) {
+        ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          close(client);
+          return;
+        }
+        buffer.append(chunk, n);
+      }
+
+      const std::string headers = buffer.substr(0, header_end);
+      size_t content_length = 0;
+      size_t pos = headers.find("Content-Length:");
+      if (pos == std::string::npos) {
+        pos = headers.find("content-length:");
+      }
+      if (pos != std::string::npos) {
+        content_length = strtoul(headers.c_str() + pos + 15, NULL, 10);
+      }
+
+      while (buffer.size() < header_end + 4 + content_length) {
+        ssize_t n = recv(client, chunk, sizeof(chunk), 0);
+        if (n <= 0) {
+          close(client);
+          return;
+        }
+        buffer.append(chunk, n);
+      }
+      buffer.erase(0, header_end + 4 + content_length);
+      d_requests++;
+      d_bytes += content_length;
+
+      if (headers.find(" /slow ") != std::string::npos) {
+        std::this_thread::sleep_for(std::chrono::seconds(3));
+      }
+
+      static const char response[] = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Type: text/plain\r\n\r\nok";
+      if (send(client, response, sizeof(response) - 1, MSG_NOSIGNAL) < 0) {
+        close(client);
+        return;
+      }
+    }
+    close(client);
+  }
+};
+
+static int failures = 0;
+
+static void check(bool ok, const char *what) {
+  printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+  if (!ok) {
+    failures++;
+  }
+}
+
+static Upload_Request form_request(const std::string &url) {
+  Upload_Request request;
+  request.url = url;
+  request.parts = {
+      {"call", std::string(4096, 'x'), "", "call.m4a", "application/octet-stream"},
+      {"talkgroup_num", "1234"}};
+  return request;
+}
+
+// Many concurrent uploads share the few connections the engine may open
+static void test_concurrent(Stand_In_Server &server, Upload_Engine &engine) {
+  const int uploads = 400;
+  std::mutex mutex;
+  std::condition_variable done;
+  int finished = 0;
+  int succeeded = 0;
+
+  const unsigned long connections = server.get_connections();
+  for (int i = 0; i < uploads; i++) {
+    engine.submit(form_request(server.url("/upload")), [&](const Upload_Result &result) {
+      std::lock_guard<std::mutex> lock(mutex);
+      finished++;
+      if ((result.curl_code == CURLE_OK) && (result.response_code == 200) && (result.response == "ok")) {
+        succeeded++;
+      }
+      done.notify_one();
+    });
+  }
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [&] { return finished == uploads; });
+  printf("%d uploads, %lu new connections\n", uploads, server.get_connections() - connections);
+  check(succeeded == uploads, "concurrent uploads all succeed");
+  check(server.get_connections() - connections <= 2, "concurrent uploads stay within 2 connections per host");
+}
+
+static void test_put(Stand_In_Server &server, Upload_Engine &engine) {
+  char path[] = "/tmp/upload_engine_testXXXXXX";
+  int fd = mkstemp(path);
+  const std::string data(100000, 'a');
+  const bool written = (fd >= 0) && (write(fd, data.data(), data.size()) == (ssize_t)data.size());
+  if (fd >= 0) {
+    close(fd);
+  }
+
+  const unsigned long long bytes = server.get_bytes();
+  Upload_Request request;
+  request.url = server.url("/audio");
+  request.put_file = path;
+  request.headers.push_back("Content-Type: audio/aac");
+  Upload_Result result = engine.perform(request);
+  unlink(path);
+
+  check(written && (result.curl_code == CURLE_OK) && (result.response_code == 200), "PUT of a file succeeds");
+  check(server.get_bytes() - bytes == data.size(), "PUT sends the whole file");
+
+  request.put_file = "/nonexistent/upload_engine_test";
+  result = engine.perform(request);
+  check(result.curl_code == CURLE_READ_ERROR, "PUT of a missing file fails");
+}
+
+static void test_timeout(Stand_In_Server &server, Upload_Engine &engine) {
+  Upload_Request request = form_request(server.url("/slow"));
+  Upload_Result result = engine.perform(request);
+  check((result.curl_code == CURLE_OK) && (result.response_code == 200), "no timeout by default, a slow server still succeeds");
+
+  request.timeout = 1;
+  result = engine.perform(request);
+  check(result.curl_code == CURLE_OPERATION_TIMEDOUT, "timeout gives up on a slow server");
+}
+
+static void test_refused(Upload_Engine &engine) {
+  // Bind a port and close it again, so nothing is listening on it
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  struct sockaddr_in addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t len = sizeof(addr);
+  bind(fd, (struct sockaddr *)&addr, sizeof(addr));
+  getsockname(fd, (struct sockaddr *)&addr, &len);
+  close(fd);
+
+  Upload_Result result = engine.perform(form_request("http://127.0.0.1:" + std::to_string(ntohs(addr.sin_port)) + "/upload"));
+  check(result.curl_code == CURLE_COULDNT_CONNECT, "connection refused is reported");
+}
+
+// stop() fails what is still pending or in flight, and every callback runs
+static void test_stop(Stand_In_Server &server, Upload_Engine &engine) {
+  const int uploads = 50;
+  std::atomic<int> finished(0);
+  std::atomic<int> aborted(0);
+  for (int i = 0; i < uploads; i++) {
+    engine.submit(form_request(server.url("/slow")), [&](const Upload_Result &result) {
+      if (result.curl_code == CURLE_ABORTED_BY_CALLBACK) {
+        aborted++;
+      }
+      finished++;
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  engine.stop();
+  check(finished == uploads, "stop() runs the callback of every upload");
+  check(aborted > 0, "stop() aborts uploads still in flight");
+
+  Upload_Result result = engine.perform(form_request(server.url("/upload")));
+  check(result.curl_code == CURLE_ABORTED_BY_CALLBACK, "uploads after stop() fail at once");
+}
+
+int main(int argc, char **argv) {
+  curl_global_init(CURL_GLOBAL_ALL);
+
+  Stand_In_Server server;
+  if (!server.start()) {
+    fprintf(stderr, "unable to start the local HTTP server\n");
+    return 1;
+  }
+
+  Upload_Engine engine;
+  engine.start(2, 4);
+
+  test_concurrent(server, engine);
+  test_put(server, engine);
+  test_timeout(server, engine);
+  test_refused(engine);
+  test_stop(server, engine);
+
+  server.stop();
+  curl_global_cleanup();
+
+  if (failures) {
+    printf("%d checks FAILED\n", failures);
+    return 1;
+  }
+  printf("all checks passed\n");
+  return 0;
+}
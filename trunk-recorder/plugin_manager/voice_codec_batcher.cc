@@ -0,0 +1,65 @@
+#include "voice_codec_batcher.h"
+#include "plugin_manager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <string.h>
+
+Voice_Codec_Batcher::Voice_Codec_Batcher() : d_call(NULL), d_frames(VOICE_CODEC_BATCH_FRAMES), d_count(0), d_last_us(0) {}
+
+int64_t Voice_Codec_Batcher::now_us() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void Voice_Codec_Batcher::send() {
+  if (d_count > 0) {
+    plugman_voice_codec_batch(d_call, d_frames.data(), (int)d_count);
+    d_count = 0;
+  }
+}
+
+void Voice_Codec_Batcher::start(Call *call) {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  send();
+  d_call = call;
+}
+
+void Voice_Codec_Batcher::stop() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  send();
+  d_call = NULL;
+}
+
+void Voice_Codec_Batcher::add(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs) {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if (!d_call) {
+    return;
+  }
+
+  const int64_t now = now_us();
+  // Frames from before a gap belong to the last transmission
+  if (now - d_last_us > VOICE_CODEC_IDLE_US) {
+    send();
+  }
+
+  Voice_Codec_Frame &frame = d_frames[d_count++];
+  frame.time_us = now;
+  frame.codec_type = codec_type;
+  frame.tgid = tgid;
+  frame.src_id = src_id;
+  frame.errs = errs;
+  frame.param_count = std::min(param_count, VOICE_CODEC_MAX_PARAMS);
+  memcpy(frame.params, params, frame.param_count * sizeof(uint32_t));
+  d_last_us = now;
+
+  if (d_count == d_frames.size()) {
+    send();
+  }
+}
+
+void Voice_Codec_Batcher::flush_if_idle() {
+  std::lock_guard<std::mutex> lock(d_mutex);
+  if ((d_count > 0) && (now_us() - d_last_us > VOICE_CODEC_IDLE_US)) {
+    send();
+  }
+}
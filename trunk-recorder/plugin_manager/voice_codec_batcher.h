@@ -0,0 +1,48 @@
+#ifndef VOICE_CODEC_BATCHER_H
+#define VOICE_CODEC_BATCHER_H
+
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+#include "plugin_api.h"
+
+// A P25 Phase 1 superframe, 180 ms of voice
+#define VOICE_CODEC_BATCH_FRAMES 9
+// A partial batch is sent once no frame has arrived for this long
+#define VOICE_CODEC_IDLE_US 100000
+
+/*
+ * Collects a recorder's voice codec frames and hands them to the plugins in
+ * batches, instead of calling every plugin for every 20 ms frame on the
+ * decoder thread.
+ *
+ * Frames go into storage that is allocated once, when the recorder is built.
+ * A batch is sent when it is full, when the transmission pauses or ends,
+ * and when the recorder stops. Frames that arrive while the recorder is
+ * stopped are dropped, so a batch never outlives its call.
+ */
+class Voice_Codec_Batcher {
+public:
+  Voice_Codec_Batcher();
+
+  void start(Call *call);
+  void stop(); // sends whatever is waiting
+
+  // From the decoder thread
+  void add(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs);
+  // From the main loop, sends a partial batch once the recorder has gone quiet
+  void flush_if_idle();
+
+private:
+  std::mutex d_mutex;
+  Call *d_call;
+  std::vector<Voice_Codec_Frame> d_frames;
+  size_t d_count;
+  int64_t d_last_us;
+
+  static int64_t now_us();
+  void send();
+};
+
+#endif
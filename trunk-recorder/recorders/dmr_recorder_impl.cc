@@ -128,9 +128,11 @@ void dmr_recorder_impl::plugin_callback_handler(int16_t *samples, int sampleCoun
 
 void dmr_recorder_impl::voice_codec_cb_handler(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data) {
   dmr_recorder_impl *self = static_cast<dmr_recorder_impl *>(user_data);
-  if (self->call) {
-    plugman_voice_codec_data(self->call, codec_type, tgid, src_id, params, param_count, errs);
-  }
+  self->codec_batcher.add(codec_type, tgid, src_id, params, param_count, errs);
+}
+
+void dmr_recorder_impl::process_message_queues() {
+  codec_batcher.flush_if_idle();
 }
 
 void dmr_recorder_impl::switch_tdma(bool phase2) {
@@ -254,6 +256,7 @@ void dmr_recorder_impl::stop() {
   if (state == ACTIVE) {
 
     recording_duration += wav_sink_slot0->total_length_in_seconds();
+    BOOST_LOG_TRIVIAL(debug) << "DMR Recorder Num [" << rec_num << "] decoder memory: " << framer->memory_usage() << " bytes";
     
     //std::string loghdr = log_header(this->call->get_short_name(),this->call->get_call_num(),this->call->get_talkgroup_display(),chan_freq);
     // BOOST_LOG_TRIVIAL(info) << loghdr << "Stopping P25 Recorder Num [" << rec_num << "]\tTDMA: " << d_phase2_tdma << "\tSlot: " << tdma_slot;
@@ -262,6 +265,7 @@ void dmr_recorder_impl::stop() {
     set_enabled(false);
     wav_sink_slot0->stop_recording();
     wav_sink_slot1->stop_recording();
+    codec_batcher.stop();
   } else {
     BOOST_LOG_TRIVIAL(error) << "dmr_recorder.cc: Trying to Stop an Inactive Logger!!!";
   }
@@ -292,6 +296,7 @@ bool dmr_recorder_impl::start(Call *call) {
     levels->set_k(call->get_system()->get_digital_levels());
     wav_sink_slot0->start_recording(call, 0);
     wav_sink_slot1->start_recording(call, 1);
+    codec_batcher.start(call);
     state = ACTIVE;
 
   if (conventional) {
@@ -78,6 +78,7 @@
 #include "../gr_blocks/selector.h"
 #include "../gr_blocks/transmission_sink.h"
 #include "../gr_blocks/xlat_channelizer.h"
+#include "../plugin_manager/voice_codec_batcher.h"
 #include "../source.h"
 #include "../call_conventional.h"
 #include "dmr_recorder.h"
@@ -113,6 +114,7 @@ public:
   int lastupdate();
   long elapsed();
   Source *get_source();
+  void process_message_queues();
 
   void plugin_callback_handler(int16_t *samples, int sampleCount);
   static void voice_codec_cb_handler(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data);
@@ -124,6 +126,7 @@ protected:
   long talkgroup;
   std::string short_name;
   Call *call;
+  Voice_Codec_Batcher codec_batcher;
   Config *config;
   Source *source;
   double chan_freq;
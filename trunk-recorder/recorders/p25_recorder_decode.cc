@@ -7,9 +7,9 @@
 #include "../unit_tags_ota.h"
 #include <chrono>
 
-p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder) {
+p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder, bool d_defer_vocoding) {
   p25_recorder_decode *decoder = new p25_recorder_decode(recorder);
-  decoder->initialize(silence_frames, d_soft_vocoder);
+  decoder->initialize(silence_frames, d_soft_vocoder, d_defer_vocoding);
   return gnuradio::get_initial_sptr(decoder);
 }
 
@@ -25,6 +25,7 @@ p25_recorder_decode::~p25_recorder_decode() {
 
 void p25_recorder_decode::stop() {
   wav_sink->stop_recording();
+  d_codec_batcher.stop();
   d_call = NULL;
 }
 
@@ -38,6 +39,7 @@ void p25_recorder_decode::start(Call *call) {
   }
   
   d_call = call;
+  d_codec_batcher.start(call);
 }
 
 void p25_recorder_decode::set_xor_mask(const char *mask) {
@@ -75,7 +77,7 @@ void p25_recorder_decode::switch_tdma(bool phase2_tdma) {
   op25_frame_assembler->set_phase2_tdma(phase2_tdma);
 }
 
-void p25_recorder_decode::initialize(int silence_frames, bool d_soft_vocoder) {
+void p25_recorder_decode::initialize(int silence_frames, bool d_soft_vocoder, bool d_defer_vocoding) {
   // OP25 Slicer
   const float l[] = {-2.0, 0.0, 2.0, 4.0};
   std::vector<float> slices(l, l + sizeof(l) / sizeof(l[0]));
@@ -103,6 +105,7 @@ void p25_recorder_decode::initialize(int silence_frames, bool d_soft_vocoder) {
 
   op25_frame_assembler = gr::op25_repeater::p25_frame_assembler::make(silence_frames, d_soft_vocoder, udp_host, udp_port, verbosity, do_imbe, do_output, do_msgq, rx_queue, do_audio_output, do_tdma, do_nocrypt);
   op25_frame_assembler->set_voice_codec_callback(voice_codec_cb_handler, this);
+  op25_frame_assembler->set_defer_vocoding(d_defer_vocoding);
   levels = gr::blocks::multiply_const_ss::make(1);
 
   if (use_streaming) {
@@ -127,9 +130,7 @@ void p25_recorder_decode::plugin_callback_handler(int16_t *samples, int sampleCo
 
 void p25_recorder_decode::voice_codec_cb_handler(int codec_type, long tgid, uint32_t src_id, const uint32_t *params, int param_count, int errs, void *user_data) {
   p25_recorder_decode *self = static_cast<p25_recorder_decode *>(user_data);
-  if (self->d_call) {
-    plugman_voice_codec_data(self->d_call, codec_type, tgid, src_id, params, param_count, errs);
-  }
+  self->d_codec_batcher.add(codec_type, tgid, src_id, params, param_count, errs);
 }
 
 double p25_recorder_decode::get_output_sample_rate() {
@@ -298,6 +299,8 @@ void p25_recorder_decode::handle_alias_message(const nlohmann::json& j) {
 }
 
 void p25_recorder_decode::check_message_queue() {
+  d_codec_batcher.flush_if_idle();
+
   if (!rx_queue || !d_call) {
     return;
   }
@@ -25,6 +25,7 @@
 
 #include "../gr_blocks/plugin_wrapper.h"
 #include "../gr_blocks/transmission_sink.h"
+#include "../plugin_manager/voice_codec_batcher.h"
 #include "recorder.h"
 
 class p25_recorder_decode;
@@ -35,13 +36,13 @@ typedef boost::shared_ptr<p25_recorder_decode> p25_recorder_decode_sptr;
 typedef std::shared_ptr<p25_recorder_decode> p25_recorder_decode_sptr;
 #endif
 
-p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder);
+p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder, bool d_defer_vocoding);
 
 class p25_recorder_decode : public gr::hier_block2 {
-  friend p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder);
+  friend p25_recorder_decode_sptr make_p25_recorder_decode(Recorder *recorder, int silence_frames, bool d_soft_vocoder, bool d_defer_vocoding);
 
 protected:
-  virtual void initialize(int silence_frames, bool d_soft_vocoder);
+  virtual void initialize(int silence_frames, bool d_soft_vocoder, bool d_defer_vocoding);
   Recorder *d_recorder;
   Call *d_call;
   gr::op25_repeater::p25_frame_assembler::sptr op25_frame_assembler;
@@ -52,6 +53,7 @@ protected:
   gr::blocks::multiply_const_ss::sptr levels;
   gr::blocks::transmission_sink::sptr wav_sink;
   gr::blocks::plugin_wrapper::sptr plugin_sink;
+  Voice_Codec_Batcher d_codec_batcher;
 
 public:
   p25_recorder_decode(Recorder *recorder);
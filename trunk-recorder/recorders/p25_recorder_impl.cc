@@ -1,5 +1,6 @@
 
 #include "p25_recorder_impl.h"
+#include "../config.h"
 #include "../formatter.h"
 #include "p25_recorder.h"
 #include <boost/log/trivial.hpp>
@@ -29,6 +30,7 @@ void p25_recorder_impl::initialize(Source *src) {
   center_freq = source->get_center();
   config = source->get_config();
   d_soft_vocoder = config->soft_vocoder;
+  d_defer_vocoding = config_ext.deferred_vocoding;
   input_rate = source->get_rate();
   qpsk_mod = true;
   silence_frames = source->get_silence_frames();
@@ -56,9 +58,9 @@ void p25_recorder_impl::initialize(Source *src) {
 
   modulation_selector = gr::blocks::selector::make(sizeof(gr_complex), 0, 0);
   qpsk_demod = make_p25_recorder_qpsk_demod();
-  qpsk_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
+  qpsk_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder, d_defer_vocoding);
   fsk4_demod = make_p25_recorder_fsk4_demod();
-  fsk4_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder);
+  fsk4_p25_decode = make_p25_recorder_decode(this, silence_frames, d_soft_vocoder, d_defer_vocoding);
 
   connect(self(), 0, prefilter, 0);
   connect(prefilter, 0, modulation_selector, 0);
@@ -276,6 +278,7 @@ void p25_recorder_impl::stop() {
     }
     std::string loghdr = log_header(this->call->get_short_name(),this->call->get_call_num(),this->call->get_talkgroup_display(),chan_freq);
     BOOST_LOG_TRIVIAL(info) << loghdr << "\u001b[33mStopping P25 Recorder Num [" << rec_num << "]\u001b[0m\tTDMA: " << d_phase2_tdma << "\tSlot: " << tdma_slot << "\tTuningErr: " << std::showpos << this->get_freq_error() << std::noshowpos << " Hz";
+    BOOST_LOG_TRIVIAL(debug) << loghdr << "P25 Recorder Num [" << rec_num << "] decoder memory: " << qpsk_p25_decode->get_transmission_sink()->memory_usage() + fsk4_p25_decode->get_transmission_sink()->memory_usage() << " bytes";
 
     state = INACTIVE;
     set_enabled(false);
@@ -139,6 +139,7 @@ private:
   int tdma_slot;
   bool d_phase2_tdma;
   bool d_soft_vocoder;
+  bool d_defer_vocoding;
   long input_rate;
   const int phase1_samples_per_symbol = 5;
   const int phase2_samples_per_symbol = 4;
@@ -28,15 +28,7 @@ void p25_recorder_qpsk_demod::reset_block(gr::basic_block_sptr block) {
 }
 
 void p25_recorder_qpsk_demod::reset() {
-    costas->set_phase(0);
-    costas->set_frequency(0);
-    clock->reset();
-/*
-    reset_block(clock);
-    reset_block(costas);
-    reset_block(diffdec);
-    reset_block(to_float);
-    reset_block(rescale);*/
+    cqpsk_demod->reset();
 }
 
 void p25_recorder_qpsk_demod::switch_tdma(bool phase2) {
@@ -58,7 +50,7 @@ void p25_recorder_qpsk_demod::switch_tdma(bool phase2) {
   omega = double(system_channel_rate) / double(symbol_rate);
   fmax = symbol_rate / 2; // Hz
   fmax = 2 * pi * fmax / double(system_channel_rate);
-  clock->set_omega(omega);
+  cqpsk_demod->set_omega(omega);
   //costas_clock->update_fmax(fmax);
   this->reset();
   // op25_frame_assembler->set_phase2_tdma(d_phase2_tdma);
@@ -77,22 +69,10 @@ void p25_recorder_qpsk_demod::initialize() {
   double fmax = 3000; // Hz
   fmax = 2 * pi * fmax / double(system_channel_rate);
 
-  costas = gr::op25_repeater::costas_loop_cc::make(costas_alpha,  4, (2 * pi)/4 );
-  clock = gr::op25_repeater::gardner_cc::make(omega, gain_mu, gain_omega);
-  // QPSK: Perform Differential decoding on the constellation
-  diffdec = gr::digital::diff_phasor_cc::make();
+  // QPSK: Gardner clock recovery, differential decoding, Costas loop and
+  // conversion of the phase to -3/-1/+1/+3 symbols, all in one block
+  cqpsk_demod = gr::op25_repeater::cqpsk_demod_cf::make(omega, gain_mu, gain_omega, costas_alpha);
 
-  // QPSK: take angle of the difference (in radians)
-  to_float = gr::blocks::complex_to_arg::make();
-
-  // QPSK: convert from radians such that signal is in -3/-1/+1/+3
-  rescale = gr::blocks::multiply_const_ff::make((1 / (pi / 4)));
-
-
-  connect(self(), 0, clock, 0);
-  connect(clock, 0, diffdec, 0);
-  connect(diffdec, 0, costas,0);
-  connect(costas,0, to_float, 0);
-  connect(to_float, 0, rescale, 0);
-  connect(rescale, 0, self(), 0);
+  connect(self(), 0, cqpsk_demod, 0);
+  connect(cqpsk_demod, 0, self(), 0);
 }
@@ -66,27 +66,12 @@ void p25_trunking::initialize_qpsk() {
   double fmax = 3000; // Hz
   fmax = 2 * pi * fmax / double(system_channel_rate);
 
-  costas = gr::op25_repeater::costas_loop_cc::make(costas_alpha,  4, (2 * pi)/4 ); 
-  clock = gr::op25_repeater::gardner_cc::make(omega, gain_mu, gain_omega);
+  // QPSK: Gardner clock recovery, differential decoding, Costas loop and
+  // conversion of the phase to -3/-1/+1/+3 symbols, all in one block
+  cqpsk_demod = gr::op25_repeater::cqpsk_demod_cf::make(omega, gain_mu, gain_omega, costas_alpha);
 
-  // QPSK: Perform Differential decoding on the constellation
-  diffdec = gr::digital::diff_phasor_cc::make();
-
-  // QPSK: take angle of the difference (in radians)
-  to_float = gr::blocks::complex_to_arg::make();
-
-  // QPSK: convert from radians such that signal is in -3/-1/+1/+3
-  rescale = gr::blocks::multiply_const_ff::make((1 / (pi / 4)));
-
-
-
-
-  connect(prefilter, 0, clock, 0);
-  connect(clock, 0, diffdec, 0);
-  connect(diffdec, 0, costas,0);
-  connect(costas,0, to_float, 0);
-  connect(to_float, 0, rescale, 0);
-  connect(rescale, 0, slicer, 0);
+  connect(prefilter, 0, cqpsk_demod, 0);
+  connect(cqpsk_demod, 0, slicer, 0);
 }
 
 void p25_trunking::initialize_p25() {
@@ -165,8 +150,8 @@ void p25_trunking::tune_freq(double f) {
   int offset_amount = (center_freq - f);
   prefilter->tune_offset(offset_amount);
   if (qpsk_mod) {
-    costas->set_phase(0);
-    costas->set_frequency(0);
+    cqpsk_demod->set_phase(0);
+    cqpsk_demod->set_frequency(0);
   } else {
     //fsk4_demod->reset();
   }
@@ -33,7 +33,6 @@
 #include <gnuradio/filter/fir_filter_blk.h>
 #endif
 
-#include <gnuradio/blocks/complex_to_arg.h>
 #include <gnuradio/blocks/short_to_float.h>
 
 #include <gnuradio/filter/fft_filter_ccf.h>
@@ -45,12 +44,9 @@
 #include <gnuradio/analog/pll_freqdet_cf.h>
 #include <gnuradio/analog/quadrature_demod_cf.h>
 
-#include <gnuradio/digital/diff_phasor_cc.h>
-
 #include <op25_repeater/fsk4_demod_ff.h>
 #include <op25_repeater/fsk4_slicer_fb.h>
-#include <op25_repeater/costas_loop_cc.h>
-#include <op25_repeater/gardner_cc.h>
+#include <op25_repeater/cqpsk_demod_cf.h>
 #include <op25_repeater/include/op25_repeater/p25_frame_assembler.h>
 #include <gnuradio/digital/fll_band_edge_cc.h>
 #include <gnuradio/message.h>
@@ -159,22 +155,17 @@ private:
   gr::filter::fft_filter_fff::sptr noise_filter;
   gr::filter::pfb_arb_resampler_ccf::sptr arb_resampler;
 
-  gr::digital::diff_phasor_cc::sptr diffdec;
-
   gr::analog::quadrature_demod_cf::sptr fm_demod;
   gr::analog::feedforward_agc_cc::sptr agc;
   gr::blocks::multiply_const_ff::sptr pll_amp;
   gr::analog::pll_freqdet_cf::sptr pll_freq_lock;
 
   gr::blocks::short_to_float::sptr converter;
-  gr::blocks::multiply_const_ff::sptr rescale;
-  gr::blocks::complex_to_arg::sptr to_float;
 
   gr::op25_repeater::fsk4_demod_ff::sptr fsk4_demod;
   gr::op25_repeater::p25_frame_assembler::sptr op25_frame_assembler;
   gr::op25_repeater::fsk4_slicer_fb::sptr slicer;
-  gr::op25_repeater::gardner_cc::sptr clock;
-  gr::op25_repeater::costas_loop_cc::sptr costas;
+  gr::op25_repeater::cqpsk_demod_cf::sptr cqpsk_demod;
   gr::digital::fll_band_edge_cc::sptr fll_band_edge;
   gr::blocks::rms_agc::sptr rms_agc;
   //gr::op25_repeater::rmsagc_ff::sptr rms_agc;